@@ -0,0 +1,420 @@
+/**
+ * Edge-storm benchmark of BasicInterrupt and FilteredInterrupt on the host.
+ * A generator thread toggles M simulated pins in bursts of edges while the main thread
+ * consumes them with "waitForInterruptMask()" and "receiveInterrupt()", as an application
+ * task would. Every scenario prints one CSV row:
+ *  - generated: raw edges generated (all pins)
+ *  - isrCalls: ISR calls (edges that arrive while an interrupt is latched are coalesced)
+ *  - expected: edges that should be delivered (the generated ones, or the filtered edges
+ *    computed by EdgeTraceReplay from the trace of the generated edges)
+ *  - delivered: edges returned by "receiveInterrupt()"
+ *  - parityErrors: delivered states equal to the previous one of the same pin
+ *  - stalePins: pins whose final state is wrong once the storm is over
+ *  - corrections: states fixed by the MissedEdgeSweeper
+ *  - latency p50/p99/max (us): ISR (or filter commit) to "receiveInterrupt()" returning.
+ *    p50 and p99 are the upper bounds of their log2 buckets, capped to the max
+ *  - cpu per edge (ns): ISR thread, consumer thread, deferred tasks of FilteredInterrupt and
+ *    whole process without the generator
+ *
+ * Usage: edgeStormBenchmark [--class basic|filtered] [--pins|--chatter M] [--idle N] [--burst N]
+ *                           [--spacing us] [--period us] [--duration ms] [--filter ms]
+ * "--idle N" adds N objects of the same class on pins that never change. With "--chatter 1" it
+ * shows what the idle objects cost to the edges of one chattering pin, the deferred task of
+ * FilteredInterrupt should only spend time on the objects that fired. The idle objects go past
+ * the ReadySet::s_MAX_SLOTS objects of the ready mask (the host has HostGpio::s_NUM_PINS pins).
+ * The delivery of the basic scenarios measures the simulator as much as the toolkit. The ISR
+ * thread and the consumer are host threads that the host scheduler can wake up late, and edges
+ * that arrive in the meantime are coalesced like on the hardware. Even one pin at 1 kHz loses
+ * up to 10% of its edges that way (it changes from run to run), where the ESP32 takes every
+ * interrupt in a few microseconds.
+ * Compare the rows against the baseline, not against 100%.
+ *
+ * Without arguments the default suite is run. Its output on the reference host is kept in
+ * bench/host/baseline.csv, regenerate it when a change is expected to move the numbers.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <ArduinoToolkit/Interrupt/BasicInterrupt.h>
+#include <ArduinoToolkit/Interrupt/EdgeTrace.h>
+#include <ArduinoToolkit/Interrupt/EdgeTraceReplay.h>
+#include <ArduinoToolkit/Interrupt/FilteredInterrupt.h>
+#include <ArduinoToolkit/Interrupt/MissedEdgeSweeper.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+namespace
+{
+
+    enum class Class : uint8_t
+    {
+        Basic,
+        Filtered
+    };
+
+    struct Scenario
+    {
+        Class type{Class::Basic};
+        uint8_t pins{4};
+        // Edges per burst on every pin and time between them
+        uint32_t burstEdges{8};
+        uint32_t spacingUs{20};
+        // Time between the start of two bursts
+        uint32_t periodUs{2000};
+        uint32_t durationMs{1000};
+        // Filter time of FilteredInterrupt (both directions)
+        uint32_t filterMs{1};
+        // Objects on pins that never change, after the M toggled ones
+        uint8_t idle{0};
+    };
+
+    struct Result
+    {
+        uint64_t generated{0};
+        uint64_t isrCalls{0};
+        uint64_t expected{0};
+        uint64_t delivered{0};
+        uint64_t parityErrors{0};
+        uint32_t stalePins{0};
+        uint32_t corrections{0};
+        uint32_t traceDropped{0};
+        uint32_t latencyP50Us{0};
+        uint32_t latencyP99Us{0};
+        uint32_t latencyMaxUs{0};
+        double isrNsPerCall{0};
+        double consumerNsPerEdge{0};
+        double deferredNsPerEdge{0};
+        double cpuNsPerEdge{0};
+    };
+
+    // The consumer waits on the ready mask, the toggled pins must have its ReadySet::s_MAX_SLOTS bits
+    constexpr uint8_t s_MAX_PINS{ReadySet::s_MAX_SLOTS};
+
+    uint64_t cpuTimeNs(const clockid_t clock)
+    {
+        timespec time;
+        clock_gettime(clock, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL + time.tv_nsec;
+    }
+
+    // Run time of the deferred tasks of FilteredInterrupt, their thread CPU time on the host
+    uint64_t deferredTaskTimeUs()
+    {
+        TaskStatus_t tasks[64];
+        const UBaseType_t count{uxTaskGetSystemState(tasks, 64, nullptr)};
+        uint64_t timeUs{0};
+        for (UBaseType_t i{0}; i < count; i++)
+            if (!std::strncmp(tasks[i].pcTaskName, "deferredInterruptTask", 21))
+                timeUs += tasks[i].ulRunTimeCounter;
+        return timeUs;
+    }
+
+    // Busy wait for short times, the sleep granularity of the host is too coarse
+    void waitUntilUs(const int64_t timeUs)
+    {
+        const int64_t remaining{timeUs - esp_timer_get_time()};
+        if (remaining > 200)
+            std::this_thread::sleep_for(std::chrono::microseconds(remaining - 100));
+        while (esp_timer_get_time() < timeUs)
+            ;
+    }
+
+    // Interface of both classes used by the consumer
+    class Input
+    {
+    public:
+        virtual ~Input() = default;
+        virtual PinState receive() const = 0;
+        virtual PinState getState() const = 0;
+        virtual uint32_t getInterruptMask() const = 0;
+        virtual const LatencyStats &getLatencyStats() const = 0;
+    };
+
+    template <typename T>
+    class InputOf : public Input
+    {
+    public:
+        template <typename... Args>
+        explicit InputOf(Args... args) : m_input(args...) {}
+
+        PinState receive() const override { return m_input.receiveInterrupt(0); }
+        PinState getState() const override { return m_input.getState(); }
+        uint32_t getInterruptMask() const override { return m_input.getInterruptMask(); }
+        const LatencyStats &getLatencyStats() const override { return m_input.getLatencyStats(); }
+
+    private:
+        T m_input;
+    };
+
+    void countExpectedEdge(void *const context, const EdgeTraceRecord &filtered)
+    {
+        (void)filtered;
+        (*static_cast<uint64_t *>(context))++;
+    }
+
+    Result run(const Scenario &scenario)
+    {
+        Result result;
+        const uint8_t allPins{static_cast<uint8_t>(scenario.pins + scenario.idle)};
+        // Start every pin low before attaching the interrupts
+        for (uint8_t pin{0}; pin < allPins; pin++)
+            HostGpio::setLevel(pin, false);
+        // The toggled pins first, so they get the slots of the ready mask
+        std::vector<std::unique_ptr<Input>> inputs;
+        for (uint8_t pin{0}; pin < allPins; pin++)
+        {
+            if (scenario.type == Class::Basic)
+                inputs.emplace_back(new InputOf<BasicInterrupt>(pin, INPUT));
+            else
+                inputs.emplace_back(new InputOf<FilteredInterrupt>(pin, INPUT, scenario.filterMs, scenario.filterMs));
+        }
+        PinState lastState[s_MAX_PINS];
+        for (uint8_t pin{0}; pin < scenario.pins; pin++)
+            lastState[pin] = inputs[pin]->getState();
+
+        // Trace of the generated edges, sized for the whole storm
+        const uint64_t bursts{scenario.durationMs * 1000ULL / scenario.periodUs + 1};
+        const uint64_t edges{bursts * scenario.burstEdges * scenario.pins};
+        std::vector<uint8_t> traceBuffer(EdgeTrace::s_HEADER_SIZE + edges * 4 + EdgeTrace::s_MAX_RECORD_SIZE);
+        EdgeTraceWriter writer(traceBuffer.data(), traceBuffer.size());
+
+        const uint32_t correctionsBefore{MissedEdgeSweeper::getCorrectionCount()};
+        const uint64_t isrCallsBefore{HostGpio::getIsrCount()};
+        const uint64_t isrCpuBefore{HostGpio::getIsrCpuTimeNs()};
+        const uint64_t processCpuBefore{cpuTimeNs(CLOCK_PROCESS_CPUTIME_ID)};
+        const uint64_t consumerCpuBefore{cpuTimeNs(CLOCK_THREAD_CPUTIME_ID)};
+        const uint64_t deferredTimeBefore{deferredTaskTimeUs()};
+        uint64_t generatorCpu{0};
+        std::atomic<bool> generating{true};
+
+        std::thread generator([&]()
+                              {
+                                  const uint64_t cpuBefore{cpuTimeNs(CLOCK_THREAD_CPUTIME_ID)};
+                                  const int64_t startUs{esp_timer_get_time()};
+                                  const int64_t endUs{startUs + scenario.durationMs * 1000LL};
+                                  bool level{false};
+                                  for (int64_t burstUs{startUs}; burstUs < endUs; burstUs += scenario.periodUs)
+                                  {
+                                      waitUntilUs(burstUs);
+                                      for (uint32_t edge{0}; edge < scenario.burstEdges; edge++)
+                                      {
+                                          if (edge)
+                                              waitUntilUs(burstUs + edge * scenario.spacingUs);
+                                          level = !level;
+                                          const uint64_t timeUs{static_cast<uint64_t>(esp_timer_get_time())};
+                                          for (uint8_t pin{0}; pin < scenario.pins; pin++)
+                                          {
+                                              HostGpio::setLevel(pin, level);
+                                              writer.write(pin, timeUs, level ? PinState::High : PinState::Low);
+                                          }
+                                          result.generated += scenario.pins;
+                                      }
+                                  }
+                                  generatorCpu = cpuTimeNs(CLOCK_THREAD_CPUTIME_ID) - cpuBefore;
+                                  generating = false;
+                              });
+
+        // Consume until the storm is over and every pending edge (and filter) has settled
+        const uint32_t settleMs{2 * BasicInterrupt::s_DEFAULT_PERIODIC_CALL_ISR_MS + 2 * scenario.filterMs};
+        int64_t idleSinceUs{-1};
+        while (true)
+        {
+            const uint32_t mask{scenario.type == Class::Basic ? BasicInterrupt::waitForInterruptMask(pdMS_TO_TICKS(10))
+                                                              : FilteredInterrupt::waitForInterruptMask(pdMS_TO_TICKS(10))};
+            for (uint8_t pin{0}; pin < scenario.pins; pin++)
+            {
+                if (!(mask & inputs[pin]->getInterruptMask()))
+                    continue;
+                PinState state;
+                while ((state = inputs[pin]->receive()) != PinState::Unknown)
+                {
+                    result.delivered++;
+                    if (state == lastState[pin])
+                        result.parityErrors++;
+                    lastState[pin] = state;
+                }
+            }
+            if (generating || mask)
+                idleSinceUs = -1;
+            else if (idleSinceUs < 0)
+                idleSinceUs = esp_timer_get_time();
+            else if (esp_timer_get_time() - idleSinceUs > settleMs * 1000LL)
+                break;
+        }
+        generator.join();
+
+        const uint64_t consumerCpu{cpuTimeNs(CLOCK_THREAD_CPUTIME_ID) - consumerCpuBefore};
+        const uint64_t deferredTime{deferredTaskTimeUs() - deferredTimeBefore};
+        const uint64_t processCpu{cpuTimeNs(CLOCK_PROCESS_CPUTIME_ID) - processCpuBefore - generatorCpu};
+        result.isrCalls = HostGpio::getIsrCount() - isrCallsBefore;
+        const uint64_t isrCpu{HostGpio::getIsrCpuTimeNs() - isrCpuBefore};
+        result.corrections = MissedEdgeSweeper::getCorrectionCount() - correctionsBefore;
+        result.traceDropped = writer.getDroppedCount();
+        for (uint8_t pin{0}; pin < allPins; pin++)
+            if ((inputs[pin]->getState() == PinState::High) != HostGpio::getLevel(pin))
+                result.stalePins++;
+
+        // Merge the latency histograms of every pin. Every value is recorded as the upper bound of
+        // its bucket (or the maximum of its pin), so the merged maximum is the real one
+        LatencyHistogram latency;
+        for (const std::unique_ptr<Input> &input : inputs)
+        {
+            const LatencyHistogram &histogram{input->getLatencyStats().get(LatencyStage::Receive)};
+            for (uint8_t bucket{0}; bucket < LatencyHistogram::s_NUM_BUCKETS; bucket++)
+            {
+                const uint32_t upperBound{LatencyHistogram::bucketUpperBound(bucket)};
+                for (uint32_t i{0}; i < histogram.getBucket(bucket); i++)
+                    latency.record(upperBound < histogram.getMax() ? upperBound : histogram.getMax());
+            }
+            if (histogram.getMax() > result.latencyMaxUs)
+                result.latencyMaxUs = histogram.getMax();
+        }
+        result.latencyP50Us = latency.getPercentileUpperBound(50);
+        result.latencyP99Us = latency.getPercentileUpperBound(99);
+
+        if (scenario.type == Class::Basic)
+        {
+            result.expected = result.generated;
+        }
+        else
+        {
+            EdgeTraceReader reader(writer.data(), writer.size());
+            EdgeTraceReplay replay(countExpectedEdge, &result.expected);
+            for (uint8_t pin{0}; pin < scenario.pins; pin++)
+                replay.addFilter(pin, scenario.filterMs, scenario.filterMs);
+            replay.run(reader);
+        }
+
+        if (result.isrCalls)
+            result.isrNsPerCall = static_cast<double>(isrCpu) / result.isrCalls;
+        if (result.delivered)
+        {
+            result.consumerNsPerEdge = static_cast<double>(consumerCpu) / result.delivered;
+            result.deferredNsPerEdge = deferredTime * 1000.0 / result.delivered;
+            result.cpuNsPerEdge = static_cast<double>(processCpu) / result.delivered;
+        }
+        return result;
+    }
+
+    void printHeader()
+    {
+        std::printf("class,pins,idle,burstEdges,spacingUs,periodUs,durationMs,filterMs,"
+                    "generated,isrCalls,expected,delivered,deliveredPct,parityErrors,stalePins,corrections,"
+                    "latencyP50Us,latencyP99Us,latencyMaxUs,isrNsPerCall,consumerNsPerEdge,deferredNsPerEdge,"
+                    "cpuNsPerEdge\n");
+    }
+
+    void printRow(const Scenario &scenario, const Result &result)
+    {
+        if (result.traceDropped)
+            std::fprintf(stderr, "Warning: %u edges did not fit in the trace\n", result.traceDropped);
+        std::printf("%s,%u,%u,%u,%u,%u,%u,%u,%llu,%llu,%llu,%llu,%.1f,%llu,%u,%u,%u,%u,%u,%.0f,%.0f,%.0f,%.0f\n",
+                    scenario.type == Class::Basic ? "basic" : "filtered",
+                    scenario.pins, scenario.idle, scenario.burstEdges, scenario.spacingUs, scenario.periodUs,
+                    scenario.durationMs, scenario.type == Class::Basic ? 0 : scenario.filterMs,
+                    static_cast<unsigned long long>(result.generated),
+                    static_cast<unsigned long long>(result.isrCalls),
+                    static_cast<unsigned long long>(result.expected),
+                    static_cast<unsigned long long>(result.delivered),
+                    result.expected ? 100.0 * result.delivered / result.expected : 100.0,
+                    static_cast<unsigned long long>(result.parityErrors),
+                    result.stalePins, result.corrections,
+                    result.latencyP50Us, result.latencyP99Us, result.latencyMaxUs,
+                    result.isrNsPerCall, result.consumerNsPerEdge, result.deferredNsPerEdge, result.cpuNsPerEdge);
+        std::fflush(stdout);
+    }
+
+    bool parseArguments(const int argc, char **const argv, Scenario &scenario)
+    {
+        for (int i{1}; i < argc; i++)
+        {
+            const char *const option{argv[i]};
+            if (i + 1 >= argc)
+                return false;
+            const char *const value{argv[++i]};
+            if (!std::strcmp(option, "--class"))
+            {
+                if (!std::strcmp(value, "basic"))
+                    scenario.type = Class::Basic;
+                else if (!std::strcmp(value, "filtered"))
+                    scenario.type = Class::Filtered;
+                else
+                    return false;
+            }
+            else if (!std::strcmp(option, "--pins") || !std::strcmp(option, "--chatter"))
+                scenario.pins = std::atoi(value);
+            else if (!std::strcmp(option, "--idle"))
+                scenario.idle = std::atoi(value);
+            else if (!std::strcmp(option, "--burst"))
+                scenario.burstEdges = std::atoi(value);
+            else if (!std::strcmp(option, "--spacing"))
+                scenario.spacingUs = std::atoi(value);
+            else if (!std::strcmp(option, "--period"))
+                scenario.periodUs = std::atoi(value);
+            else if (!std::strcmp(option, "--duration"))
+                scenario.durationMs = std::atoi(value);
+            else if (!std::strcmp(option, "--filter"))
+                scenario.filterMs = std::atoi(value);
+            else
+                return false;
+        }
+        return scenario.pins && scenario.pins <= s_MAX_PINS && scenario.idle <= HostGpio::s_NUM_PINS - scenario.pins &&
+               scenario.burstEdges && scenario.periodUs &&
+               scenario.durationMs && scenario.burstEdges * scenario.spacingUs <= scenario.periodUs;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Scenario scenario;
+    if (!parseArguments(argc, argv, scenario))
+    {
+        std::fprintf(stderr, "Usage: %s [--class basic|filtered] [--pins|--chatter M] [--idle N] [--burst N] "
+                             "[--spacing us] [--period us] [--duration ms] [--filter ms]\n"
+                             "(a burst must fit in its period, up to %u toggled pins and %u pins in all)\n",
+                     argv[0], s_MAX_PINS, HostGpio::s_NUM_PINS);
+        return 1;
+    }
+    printHeader();
+    if (argc > 1)
+    {
+        printRow(scenario, run(scenario));
+    }
+    else
+    {
+        // Default suite: rising edge rate and pin count for both classes
+        static const Scenario suite[]{
+            {Class::Basic, 1, 1, 0, 1000, 1000, 0},
+            {Class::Basic, 4, 8, 50, 2000, 1000, 0},
+            {Class::Basic, 4, 32, 10, 2000, 1000, 0},
+            {Class::Basic, 16, 32, 10, 2000, 1000, 0},
+            {Class::Basic, 32, 64, 2, 1000, 1000, 0},
+            // Odd bursts so the filtered state flips after every one of them
+            {Class::Filtered, 1, 1, 0, 5000, 1000, 1},
+            {Class::Filtered, 4, 7, 50, 5000, 1000, 1},
+            {Class::Filtered, 16, 31, 10, 5000, 1000, 1},
+            {Class::Filtered, 32, 63, 2, 5000, 1000, 1},
+            // One chattering pin among idle objects, up to twice the slots of the ready mask
+            {Class::Filtered, 1, 7, 50, 2000, 1000, 1, 0},
+            {Class::Filtered, 1, 7, 50, 2000, 1000, 1, 31},
+            {Class::Filtered, 1, 7, 50, 2000, 1000, 1, 63},
+        };
+        for (const Scenario &entry : suite)
+            printRow(entry, run(entry));
+    }
+    // The tasks of the interrupt classes never return, leave without joining them
+    std::fflush(stdout);
+    _exit(0);
+}
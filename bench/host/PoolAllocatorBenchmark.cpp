@@ -0,0 +1,188 @@
+/**
+ * Benchmark of the toolkit Pool against malloc on the host.
+ * Every scenario runs the same random sequence of allocations and frees (up to "live"
+ * blocks of "size" bytes alive at once, per thread) through "Pool::allocate()" and through
+ * malloc, timing every call. It prints one CSV row per scenario:
+ *  - ops: allocations plus frees per thread
+ *  - pool/malloc ns per op, p99 and max (ns): time of a single call
+ *  - poolFailures: allocations the pool could not serve (they fell back to malloc)
+ * The behaviour of the pool is covered by the unit tests in test/test_pool.
+ *
+ * Usage: poolAllocatorBenchmark [--size bytes] [--live blocks] [--threads N] [--ops N]
+ * Without arguments the default suite is run. Its output on the reference host is kept in
+ * bench/host/pool_baseline.csv, regenerate it when a change is expected to move the numbers.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <ArduinoToolkit/Core/Pool.h>
+
+using namespace AT;
+
+namespace
+{
+
+    struct Scenario
+    {
+        uint16_t size{24};
+        uint16_t live{8};
+        uint8_t threads{1};
+        uint32_t ops{200000};
+    };
+
+    struct Timing
+    {
+        double nsPerOp{0};
+        uint32_t p99Ns{0};
+        uint32_t maxNs{0};
+    };
+
+    // Size class a size is served from
+    size_t sizeClassOf(const size_t size)
+    {
+        for (size_t i{0}; i < Pool::s_NUM_SIZE_CLASSES; i++)
+            if (size <= Pool::getStats(i).blockSize)
+                return i;
+        return Pool::s_NUM_SIZE_CLASSES;
+    }
+
+    template <typename Allocate, typename Free>
+    std::vector<uint32_t> runSequence(const Scenario &scenario, const uint32_t seed, Allocate allocate, Free free)
+    {
+        std::vector<uint32_t> durations;
+        durations.reserve(scenario.ops);
+        std::vector<void *> live(scenario.live, nullptr);
+        std::minstd_rand random{seed};
+        for (uint32_t op{0}; op < scenario.ops; op++)
+        {
+            void *&slot{live[random() % scenario.live]};
+            const auto start{std::chrono::steady_clock::now()};
+            if (slot)
+            {
+                free(slot);
+                slot = nullptr;
+            }
+            else
+            {
+                slot = allocate(scenario.size);
+                // Touch the memory as a user would
+                static_cast<volatile uint8_t *>(slot)[0] = 1;
+            }
+            durations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count());
+        }
+        for (void *const slot : live)
+            if (slot)
+                free(slot);
+        return durations;
+    }
+
+    template <typename Allocate, typename Free>
+    Timing run(const Scenario &scenario, Allocate allocate, Free free)
+    {
+        std::vector<std::vector<uint32_t>> durations(scenario.threads);
+        std::vector<std::thread> threads;
+        for (uint8_t i{0}; i < scenario.threads; i++)
+            threads.emplace_back([&, i]
+                                 { durations[i] = runSequence(scenario, 1 + i, allocate, free); });
+        for (std::thread &thread : threads)
+            thread.join();
+
+        std::vector<uint32_t> all;
+        for (const std::vector<uint32_t> &entry : durations)
+            all.insert(all.end(), entry.begin(), entry.end());
+        std::sort(all.begin(), all.end());
+        Timing timing;
+        uint64_t total{0};
+        for (const uint32_t duration : all)
+            total += duration;
+        timing.nsPerOp = static_cast<double>(total) / all.size();
+        timing.p99Ns = all[all.size() * 99 / 100];
+        timing.maxNs = all.back();
+        return timing;
+    }
+
+    void printHeader()
+    {
+        std::printf("size,live,threads,ops,poolNsPerOp,poolP99Ns,poolMaxNs,"
+                    "mallocNsPerOp,mallocP99Ns,mallocMaxNs,poolFailures\n");
+    }
+
+    void runAndPrint(const Scenario &scenario)
+    {
+        const size_t sizeClass{sizeClassOf(scenario.size)};
+        const uint32_t failuresBefore{sizeClass < Pool::s_NUM_SIZE_CLASSES ? Pool::getStats(sizeClass).failures : 0};
+        const Timing pool{run(scenario, Pool::allocate, Pool::deallocate)};
+        const uint32_t failures{sizeClass < Pool::s_NUM_SIZE_CLASSES ? Pool::getStats(sizeClass).failures - failuresBefore : 0};
+        const Timing heap{run(scenario, malloc, ::free)};
+        std::printf("%u,%u,%u,%u,%.1f,%u,%u,%.1f,%u,%u,%u\n",
+                    scenario.size, scenario.live, scenario.threads, scenario.ops,
+                    pool.nsPerOp, pool.p99Ns, pool.maxNs, heap.nsPerOp, heap.p99Ns, heap.maxNs, failures);
+    }
+
+    bool parseArguments(const int argc, char **const argv, Scenario &scenario)
+    {
+        for (int i{1}; i < argc; i += 2)
+        {
+            if (i + 1 >= argc)
+                return false;
+            const long value{std::strtol(argv[i + 1], nullptr, 10)};
+            if (value <= 0)
+                return false;
+            if (!std::strcmp(argv[i], "--size"))
+                scenario.size = value;
+            else if (!std::strcmp(argv[i], "--live"))
+                scenario.live = value;
+            else if (!std::strcmp(argv[i], "--threads"))
+                scenario.threads = value;
+            else if (!std::strcmp(argv[i], "--ops"))
+                scenario.ops = value;
+            else
+                return false;
+        }
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Scenario scenario;
+    if (!parseArguments(argc, argv, scenario))
+    {
+        std::fprintf(stderr, "Usage: %s [--size bytes] [--live blocks] [--threads N] [--ops N]\n", argv[0]);
+        return 1;
+    }
+    printHeader();
+    if (argc > 1)
+    {
+        runAndPrint(scenario);
+    }
+    else
+    {
+        // Default suite: every size class within its blocks, two tasks sharing them and
+        // an exhausted class that falls back to the heap
+        static const Scenario suite[]{
+            {24, 8, 1, 200000},
+            {48, 8, 1, 200000},
+            {100, 4, 1, 200000},
+            {200, 2, 1, 200000},
+            {24, 4, 2, 200000},
+            {100, 16, 1, 200000},
+        };
+        for (const Scenario &entry : suite)
+            runAndPrint(entry);
+    }
+    std::fflush(stdout);
+    _exit(0);
+}
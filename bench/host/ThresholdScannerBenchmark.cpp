@@ -0,0 +1,192 @@
+/**
+ * Benchmark of ThresholdScanner, the hysteresis detector of AnalogThresholdInterrupt, on the host.
+ * Every scenario scans the same random 12-bit signal, cut in blocks like the DMA blocks of
+ * AnalogThresholdInterrupt, with "ThresholdScanner::scan()" and with a naive loop that compares
+ * every sample, as a reference. The signal is noise inside the hysteresis band that crosses
+ * both thresholds every "period" samples (never with a period of 0). The signal is short enough
+ * to stay in the cache and is scanned again until "samples" are scanned, so the rows measure the
+ * scan rather than the memory bandwidth of the host. It prints one CSV row per scenario:
+ *  - blockSamples: samples per scanned block
+ *  - periodSamples: samples between two crossings (0: quiet signal)
+ *  - samples: samples scanned by both
+ *  - crossings: state changes found (the same for both, checked)
+ *  - scanner/naive ns per sample: time of a block divided by its samples, averaged
+ * The behaviour of the scanner is covered by the unit tests in test/test_threshold_scanner.
+ *
+ * Usage: thresholdScannerBenchmark [--block samples] [--period samples] [--samples N]
+ * Without arguments the default suite is run. Its output on the reference host is kept in
+ * bench/host/threshold_scanner_baseline.csv, regenerate it when a change is expected to move
+ * the numbers.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include <ArduinoToolkit/Interrupt/ThresholdScanner.h>
+
+using namespace AT;
+
+namespace
+{
+
+    constexpr uint16_t s_LOW_THRESHOLD{1000};
+    constexpr uint16_t s_HIGH_THRESHOLD{3000};
+    // Samples of the signal (64 KiB)
+    constexpr size_t s_SIGNAL_SAMPLES{32768};
+
+    struct Scenario
+    {
+        uint32_t block{256};
+        uint32_t period{0};
+        uint32_t samples{16000000};
+    };
+
+    struct Timing
+    {
+        double nsPerSample{0};
+        uint64_t crossings{0};
+    };
+
+    // Sample by sample detector, what the scanner replaces
+    uint32_t scanNaive(const uint16_t *const samples, const size_t count, bool &high)
+    {
+        uint32_t crossings{0};
+        for (size_t i{0}; i < count; i++)
+        {
+            if (high ? samples[i] <= s_LOW_THRESHOLD : samples[i] >= s_HIGH_THRESHOLD)
+            {
+                high = !high;
+                crossings++;
+            }
+        }
+        return crossings;
+    }
+
+    std::vector<uint16_t> makeSamples(const Scenario &scenario)
+    {
+        std::vector<uint16_t> samples(s_SIGNAL_SAMPLES);
+        std::minstd_rand random{9};
+        bool high{false};
+        for (size_t i{0}; i < s_SIGNAL_SAMPLES; i++)
+        {
+            if (scenario.period && i % scenario.period == 0)
+            {
+                high = !high;
+                samples[i] = high ? 4095 : 0;
+            }
+            else
+            {
+                samples[i] = s_LOW_THRESHOLD + 1 + random() % (s_HIGH_THRESHOLD - s_LOW_THRESHOLD - 1);
+            }
+        }
+        return samples;
+    }
+
+    template <typename Scan>
+    Timing run(const Scenario &scenario, const std::vector<uint16_t> &samples, Scan scan)
+    {
+        Timing timing;
+        bool high{false};
+        const auto start{std::chrono::steady_clock::now()};
+        for (uint32_t scanned{0}; scanned < scenario.samples;)
+        {
+            for (size_t first{0}; first < samples.size() && scanned < scenario.samples; first += scenario.block)
+            {
+                size_t count{samples.size() - first < scenario.block ? samples.size() - first : scenario.block};
+                if (count > scenario.samples - scanned)
+                    count = scenario.samples - scanned;
+                timing.crossings += scan(samples.data() + first, count, high);
+                scanned += count;
+            }
+        }
+        const auto duration{std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)};
+        timing.nsPerSample = static_cast<double>(duration.count()) / scenario.samples;
+        return timing;
+    }
+
+    void printHeader()
+    {
+        std::printf("blockSamples,periodSamples,samples,crossings,scannerNsPerSample,naiveNsPerSample\n");
+    }
+
+    void runAndPrint(const Scenario &scenario)
+    {
+        const std::vector<uint16_t> samples{makeSamples(scenario)};
+        const ThresholdScanner scanner{s_LOW_THRESHOLD, s_HIGH_THRESHOLD};
+        const Timing scanned{run(scenario, samples, [&scanner](const uint16_t *const block, const size_t count, bool &high)
+                                 { return scanner.scan(block, count, high); })};
+        const Timing naive{run(scenario, samples, scanNaive)};
+        if (scanned.crossings != naive.crossings)
+            std::fprintf(stderr, "Warning: %llu crossings with ThresholdScanner, %llu with the naive loop\n",
+                         static_cast<unsigned long long>(scanned.crossings),
+                         static_cast<unsigned long long>(naive.crossings));
+        std::printf("%u,%u,%u,%llu,%.3f,%.3f\n",
+                    scenario.block, scenario.period, scenario.samples,
+                    static_cast<unsigned long long>(scanned.crossings), scanned.nsPerSample, naive.nsPerSample);
+        std::fflush(stdout);
+    }
+
+    bool parseArguments(const int argc, char **const argv, Scenario &scenario)
+    {
+        for (int i{1}; i < argc; i += 2)
+        {
+            if (i + 1 >= argc)
+                return false;
+            const long value{std::strtol(argv[i + 1], nullptr, 10)};
+            if (value < 0)
+                return false;
+            if (!std::strcmp(argv[i], "--block"))
+                scenario.block = value;
+            else if (!std::strcmp(argv[i], "--period"))
+                scenario.period = value;
+            else if (!std::strcmp(argv[i], "--samples"))
+                scenario.samples = value;
+            else
+                return false;
+        }
+        return scenario.block && scenario.block <= s_SIGNAL_SAMPLES && scenario.samples;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Scenario scenario;
+    if (!parseArguments(argc, argv, scenario))
+    {
+        std::fprintf(stderr, "Usage: %s [--block samples] [--period samples] [--samples N]\n"
+                             "(blocks of up to %u samples)\n",
+                     argv[0], static_cast<unsigned>(s_SIGNAL_SAMPLES));
+        return 1;
+    }
+    printHeader();
+    if (argc > 1)
+    {
+        runAndPrint(scenario);
+    }
+    else
+    {
+        // Default suite: quiet blocks (the common case) to a crossing every few samples, with the
+        // default AT_ANALOG_BLOCK_SAMPLES and shorter blocks
+        static const Scenario suite[]{
+            {256, 0, 16000000},
+            {256, 1000, 16000000},
+            {256, 100, 16000000},
+            {256, 16, 16000000},
+            {256, 4, 16000000},
+            {64, 0, 16000000},
+            {64, 16, 16000000},
+        };
+        for (const Scenario &entry : suite)
+            runAndPrint(entry);
+    }
+    std::fflush(stdout);
+    _exit(0);
+}
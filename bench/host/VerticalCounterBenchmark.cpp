@@ -0,0 +1,202 @@
+/**
+ * Benchmark of VerticalCounter, the 32-pin debouncer of BankDebouncer, on the host.
+ * Every scenario feeds the same random sequence of 32-pin samples to "VerticalCounter::update()"
+ * and to a per-pin counter loop that debounces the pins one at a time, as a reference.
+ * The samples start from a random value and "noise" percent of them flip one random pin.
+ * It prints one CSV row per scenario:
+ *  - counterBits: bits of the counters (a pin toggles after 2^counterBits different samples)
+ *  - noisePct: samples that flip a pin
+ *  - samples: 32-pin samples fed to both debouncers
+ *  - vertical/perPin ns per sample: time of one 32-pin sample, averaged over the sequence
+ *  - toggles: debounced pin toggles (the same for both, checked)
+ * The behaviour of the counter is covered by the unit tests in test/test_vertical_counter.
+ *
+ * Usage: verticalCounterBenchmark [--bits 1-4] [--noise percent] [--samples N]
+ * Without arguments the default suite is run. Its output on the reference host is kept in
+ * bench/host/vertical_counter_baseline.csv, regenerate it when a change is expected to move
+ * the numbers.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include <ArduinoToolkit/Interrupt/VerticalCounter.h>
+
+using namespace AT;
+
+namespace
+{
+
+    struct Scenario
+    {
+        uint8_t bits{2};
+        uint8_t noise{25};
+        uint32_t samples{10000000};
+    };
+
+    struct Timing
+    {
+        double nsPerSample{0};
+        uint64_t toggles{0};
+    };
+
+    // One counter per pin, debounced one pin after the other
+    template <uint8_t CounterBits>
+    class PerPinCounter
+    {
+    public:
+        uint32_t update(const uint32_t sample)
+        {
+            uint32_t toggled{0};
+            for (uint8_t pin{0}; pin < 32; pin++)
+            {
+                if (((sample ^ m_state) >> pin) & 1)
+                {
+                    if (++m_counters[pin] == VerticalCounter<CounterBits>::s_SAMPLES_TO_TOGGLE)
+                    {
+                        m_counters[pin] = 0;
+                        toggled |= 1UL << pin;
+                    }
+                }
+                else
+                {
+                    m_counters[pin] = 0;
+                }
+            }
+            m_state ^= toggled;
+            return toggled;
+        }
+
+    private:
+        uint32_t m_state{0};
+        uint16_t m_counters[32]{};
+    };
+
+    std::vector<uint32_t> makeSamples(const Scenario &scenario)
+    {
+        std::vector<uint32_t> samples(scenario.samples);
+        std::minstd_rand random{7};
+        uint32_t raw{static_cast<uint32_t>(random())};
+        for (uint32_t &sample : samples)
+        {
+            if (random() % 100 < scenario.noise)
+                raw ^= 1UL << (random() % 32);
+            sample = raw;
+        }
+        return samples;
+    }
+
+    template <typename Counter>
+    Timing run(const std::vector<uint32_t> &samples)
+    {
+        Counter counter;
+        Timing timing;
+        const auto start{std::chrono::steady_clock::now()};
+        for (const uint32_t sample : samples)
+            timing.toggles += __builtin_popcount(counter.update(sample));
+        const auto duration{std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)};
+        timing.nsPerSample = static_cast<double>(duration.count()) / samples.size();
+        return timing;
+    }
+
+    template <uint8_t CounterBits>
+    void runAndPrint(const Scenario &scenario, const std::vector<uint32_t> &samples)
+    {
+        const Timing vertical{run<VerticalCounter<CounterBits>>(samples)};
+        const Timing perPin{run<PerPinCounter<CounterBits>>(samples)};
+        if (vertical.toggles != perPin.toggles)
+            std::fprintf(stderr, "Warning: %llu toggles with VerticalCounter, %llu with the per-pin counters\n",
+                         static_cast<unsigned long long>(vertical.toggles),
+                         static_cast<unsigned long long>(perPin.toggles));
+        std::printf("%u,%u,%u,%.2f,%.2f,%llu\n",
+                    scenario.bits, scenario.noise, scenario.samples,
+                    vertical.nsPerSample, perPin.nsPerSample, static_cast<unsigned long long>(vertical.toggles));
+        std::fflush(stdout);
+    }
+
+    void printHeader()
+    {
+        std::printf("counterBits,noisePct,samples,verticalNsPerSample,perPinNsPerSample,toggles\n");
+    }
+
+    void runAndPrint(const Scenario &scenario)
+    {
+        const std::vector<uint32_t> samples{makeSamples(scenario)};
+        switch (scenario.bits)
+        {
+        case 1:
+            runAndPrint<1>(scenario, samples);
+            break;
+        case 2:
+            runAndPrint<2>(scenario, samples);
+            break;
+        case 3:
+            runAndPrint<3>(scenario, samples);
+            break;
+        default:
+            runAndPrint<4>(scenario, samples);
+            break;
+        }
+    }
+
+    bool parseArguments(const int argc, char **const argv, Scenario &scenario)
+    {
+        for (int i{1}; i < argc; i += 2)
+        {
+            if (i + 1 >= argc)
+                return false;
+            const long value{std::strtol(argv[i + 1], nullptr, 10)};
+            if (value < 0)
+                return false;
+            if (!std::strcmp(argv[i], "--bits"))
+                scenario.bits = value;
+            else if (!std::strcmp(argv[i], "--noise"))
+                scenario.noise = value;
+            else if (!std::strcmp(argv[i], "--samples"))
+                scenario.samples = value;
+            else
+                return false;
+        }
+        return scenario.bits >= 1 && scenario.bits <= 4 && scenario.noise <= 100 && scenario.samples;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Scenario scenario;
+    if (!parseArguments(argc, argv, scenario))
+    {
+        std::fprintf(stderr, "Usage: %s [--bits 1-4] [--noise percent] [--samples N]\n", argv[0]);
+        return 1;
+    }
+    printHeader();
+    if (argc > 1)
+    {
+        runAndPrint(scenario);
+    }
+    else
+    {
+        // Default suite: quiet pins (the common case) to a noisy bank, for short and long counters
+        static const Scenario suite[]{
+            {2, 0, 10000000},
+            {2, 5, 10000000},
+            {2, 25, 10000000},
+            {2, 100, 10000000},
+            {4, 0, 10000000},
+            {4, 25, 10000000},
+            {4, 100, 10000000},
+        };
+        for (const Scenario &entry : suite)
+            runAndPrint(entry);
+    }
+    std::fflush(stdout);
+    _exit(0);
+}
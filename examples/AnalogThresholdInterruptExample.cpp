@@ -0,0 +1,42 @@
+#include <ArduinoToolkit/Interrupt/AnalogThresholdInterrupt.h>
+
+static constexpr uint8_t PIN_LIGHT_SENSOR{34};
+static constexpr uint8_t PIN_WATER_LEVEL{35};
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    // Both channels are sampled at 10 kHz each
+    AT::AnalogThresholdInterrupt::setSamplerConfig({.sampleFreqHz = 20000});
+    static AT::AnalogThresholdInterrupt lightInt(PIN_LIGHT_SENSOR, 1200, 1600);
+    static AT::AnalogThresholdInterrupt waterInt(PIN_WATER_LEVEL, 2000, 2400);
+    while (true)
+    {
+        // Only the objects whose bit is set in the mask have pending crossings
+        const uint32_t interruptMask{AT::AnalogThresholdInterrupt::waitForInterruptMask()};
+        if (interruptMask & lightInt.getInterruptMask())
+        {
+            if (lightInt.receiveLastInterrupt(0) == AT::PinState::High)
+                LOG_I("Light on");
+            else
+                LOG_I("Light off");
+        }
+        if (interruptMask & waterInt.getInterruptMask())
+        {
+            if (waterInt.receiveLastInterrupt(0) == AT::PinState::High)
+                LOG_I("Water level high");
+            else
+                LOG_I("Water level low");
+        }
+    }
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
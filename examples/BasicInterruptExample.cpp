@@ -10,30 +10,39 @@ void setup()
 {
     static AT::BasicInterrupt doorInt(PIN_INT_DOOR, INPUT_PULLUP, true);
     static AT::BasicInterrupt pirInt(PIN_INT_PIR, INPUT_PULLDOWN, false);
+    // Poll the door instead of interrupting if a loose contact fires it more than 100 times in 10 ms
+    doorInt.enableStormGuard({.maxInterrupts = 100, .windowMs = 10, .pollPeriodMs = 10, .quietMs = 100});
     while (true)
     {
-        AT::BasicInterrupt::waitUntilAnyInterrupt();
-        switch (doorInt.receiveInterruptDiscardIntermediate(0))
+        // Only the objects whose bit is set in the mask have pending interrupts
+        const uint32_t interruptMask{AT::BasicInterrupt::waitForInterruptMask()};
+        if (interruptMask & doorInt.getInterruptMask())
         {
-        case AT::PinState::High:
-            LOG_I("Pin %u: HIGH", doorInt.getPin());
-            break;
-        case AT::PinState::Low:
-            LOG_I("Pin %u: LOW", doorInt.getPin());
-            break;
-        default:
-            break;
+            switch (doorInt.receiveInterruptDiscardIntermediate(0))
+            {
+            case AT::PinState::High:
+                LOG_I("Pin %u: HIGH", doorInt.getPin());
+                break;
+            case AT::PinState::Low:
+                LOG_I("Pin %u: LOW", doorInt.getPin());
+                break;
+            default:
+                break;
+            }
         }
-        switch (pirInt.receiveInterruptDiscardIntermediate(0))
+        if (interruptMask & pirInt.getInterruptMask())
         {
-        case AT::PinState::High:
-            LOG_I("Pin %u: HIGH", pirInt.getPin());
-            break;
-        case AT::PinState::Low:
-            LOG_I("Pin %u: LOW", pirInt.getPin());
-            break;
-        default:
-            break;
+            switch (pirInt.receiveInterruptDiscardIntermediate(0))
+            {
+            case AT::PinState::High:
+                LOG_I("Pin %u: HIGH", pirInt.getPin());
+                break;
+            case AT::PinState::Low:
+                LOG_I("Pin %u: LOW", pirInt.getPin());
+                break;
+            default:
+                break;
+            }
         }
     }
 }
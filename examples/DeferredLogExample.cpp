@@ -0,0 +1,32 @@
+// Build with "-D AT_DEFERRED_LOG" so the log macros go through the DeferredLog
+#include <ArduinoToolkit/Core/DeferredLog.h>
+#include <ArduinoToolkit/Interrupt/BasicInterrupt.h>
+
+static constexpr uint8_t PIN_INT_DOOR{25};
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    Serial.begin(115200);
+    // Binary frames are smaller, decode them on the host with tools/log_decoder
+    AT::DeferredLog::begin({.out = &Serial, .binary = false});
+    static AT::BasicInterrupt doorInt(PIN_INT_DOOR, INPUT_PULLUP, true);
+    uint32_t count{0};
+    while (true)
+    {
+        const AT::PinState state{doorInt.receiveInterrupt()};
+        // Only the arguments are copied here, the text is written by the drain task
+        LOG_I("Door %s (%u changes, %u log records dropped)",
+              state == AT::PinState::High ? "OPEN" : "CLOSED", ++count, AT::DeferredLog::getDroppedCount());
+    }
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
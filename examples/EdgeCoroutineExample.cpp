@@ -0,0 +1,61 @@
+#include <ArduinoToolkit/Interrupt/BasicInterrupt.h>
+#include <ArduinoToolkit/Interrupt/FilteredInterrupt.h>
+
+// Build with "-fcoroutines" (GCC 10 or newer) to enable AT_COROUTINES
+
+static constexpr uint8_t PIN_INT_DOOR{25};
+static constexpr uint8_t PIN_INT_BUTTON{27};
+
+// Log how long the door stays open
+static AT::EdgeCoroutine doorMonitor(AT::FilteredInterrupt &doorInt)
+{
+    while (true)
+    {
+        if (co_await doorInt.nextEdge() != AT::PinState::High)
+            continue;
+        const uint32_t openedMs{millis()};
+        LOG_I("Door opened");
+        while (co_await doorInt.nextEdge() != AT::PinState::Low)
+            ;
+        LOG_I("Door closed after %u ms", millis() - openedMs);
+    }
+}
+
+// Detect double clicks of the button (second press within 400 ms of the first release)
+static AT::EdgeCoroutine buttonMonitor(AT::BasicInterrupt &buttonInt)
+{
+    while (true)
+    {
+        if (co_await buttonInt.nextEdge() != AT::PinState::High)
+            continue;
+        co_await buttonInt.nextEdge();
+        if (co_await buttonInt.nextEdge(pdMS_TO_TICKS(400)) == AT::PinState::High)
+            LOG_I("Double click");
+        else
+            LOG_I("Single click");
+    }
+}
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    static AT::FilteredInterrupt doorInt(PIN_INT_DOOR, INPUT_PULLUP, 500, 1000, true);
+    static AT::BasicInterrupt buttonInt(PIN_INT_BUTTON, INPUT_PULLUP, true);
+
+    // Both monitors share the stack of the executor task
+    static AT::CoroutineExecutor executor;
+    executor.spawn(doorMonitor(doorInt));
+    executor.spawn(buttonMonitor(buttonInt));
+    executor.start();
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Everything is done by the executor task
+    vTaskDelete(nullptr);
+}
@@ -0,0 +1,43 @@
+#include <ArduinoToolkit/Interrupt/EdgeTraceRecorder.h>
+#include <ArduinoToolkit/Interrupt/EdgeTraceReplay.h>
+#include <ArduinoToolkit/Interrupt/FilteredInterrupt.h>
+
+static constexpr uint8_t PIN_INT_DOOR{25};
+
+// Log the filtered edges computed from the trace
+static void logFilteredEdge(void *const context, const AT::EdgeTraceRecord &filtered)
+{
+    (void)context;
+    LOG_I("Pin %u: %s at %llu us", filtered.pin, filtered.state == AT::PinState::High ? "HIGH" : "LOW", filtered.timeUs);
+}
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    static AT::FilteredInterrupt doorInt(PIN_INT_DOOR, INPUT_PULLUP, 500, 1000, true);
+    static uint8_t traceBuffer[8 * 1024];
+    static AT::EdgeTraceRecorder recorder(traceBuffer, sizeof(traceBuffer));
+    // Record the raw edges of the door for one minute
+    recorder.add(doorInt);
+    for (uint8_t i{0}; i < 60 && !recorder.isFull(); i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        recorder.poll();
+    }
+    LOG_I("Trace of %u bytes (%u edges lost)", recorder.size(), recorder.getLostEventCount());
+    // Run the trace through the same filter (this can be done on the host too)
+    AT::EdgeTraceReader reader(recorder.data(), recorder.size());
+    AT::EdgeTraceReplay replay(logFilteredEdge);
+    replay.addFilter(PIN_INT_DOOR, 500, 1000);
+    LOG_I("%u raw edges replayed", replay.run(reader));
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
@@ -13,28 +13,35 @@ void setup()
     static AT::FilteredInterrupt pirInt(PIN_INT_PIR, INPUT_PULLDOWN, 100, 1000, false);
     while (true)
     {
-        AT::FilteredInterrupt::waitUntilAnyInterrupt();
-        switch (doorInt.receiveInterruptDiscardIntermediate(0))
+        // Only the objects whose bit is set in the mask have pending interrupts
+        const uint32_t interruptMask{AT::FilteredInterrupt::waitForInterruptMask()};
+        if (interruptMask & doorInt.getInterruptMask())
         {
-        case AT::PinState::High:
-            LOG_I("Pin %u: HIGH", doorInt.getPin());
-            break;
-        case AT::PinState::Low:
-            LOG_I("Pin %u: LOW", doorInt.getPin());
-            break;
-        default:
-            break;
+            switch (doorInt.receiveInterruptDiscardIntermediate(0))
+            {
+            case AT::PinState::High:
+                LOG_I("Pin %u: HIGH", doorInt.getPin());
+                break;
+            case AT::PinState::Low:
+                LOG_I("Pin %u: LOW", doorInt.getPin());
+                break;
+            default:
+                break;
+            }
         }
-        switch (pirInt.receiveInterruptDiscardIntermediate(0))
+        if (interruptMask & pirInt.getInterruptMask())
         {
-        case AT::PinState::High:
-            LOG_I("Pin %u: HIGH", pirInt.getPin());
-            break;
-        case AT::PinState::Low:
-            LOG_I("Pin %u: LOW", pirInt.getPin());
-            break;
-        default:
-            break;
+            switch (pirInt.receiveInterruptDiscardIntermediate(0))
+            {
+            case AT::PinState::High:
+                LOG_I("Pin %u: HIGH", pirInt.getPin());
+                break;
+            case AT::PinState::Low:
+                LOG_I("Pin %u: LOW", pirInt.getPin());
+                break;
+            default:
+                break;
+            }
         }
     }
 }
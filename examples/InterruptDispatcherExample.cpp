@@ -0,0 +1,41 @@
+#include <ArduinoToolkit/Interrupt/InterruptDispatcher.h>
+
+static constexpr uint8_t PIN_INT_DOOR{25};
+static constexpr uint8_t PIN_INT_PIR{26};
+static constexpr uint8_t PIN_INT_BUTTON{27};
+
+// The context is the pin of the interrupt
+static void logEdge(void *const context, const AT::PinState state)
+{
+    const uint8_t pin{*static_cast<const uint8_t *>(context)};
+    LOG_I("Pin %u: %s", pin, state == AT::PinState::High ? "HIGH" : "LOW");
+}
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    static AT::FilteredInterrupt doorInt(PIN_INT_DOOR, INPUT_PULLUP, 500, 1000, true);
+    static AT::FilteredInterrupt pirInt(PIN_INT_PIR, INPUT_PULLDOWN, 100, 1000, false);
+    static AT::BasicInterrupt buttonInt(PIN_INT_BUTTON, INPUT_PULLUP, true);
+    static uint8_t doorPin{PIN_INT_DOOR};
+    static uint8_t pirPin{PIN_INT_PIR};
+    static uint8_t buttonPin{PIN_INT_BUTTON};
+
+    static AT::InterruptDispatcher dispatcher;
+    // The button is served before the filtered inputs
+    dispatcher.add(buttonInt, logEdge, &buttonPin, 0);
+    dispatcher.add(doorInt, logEdge, &doorPin, 1, AT::ReceiveMode::DiscardIntermediate);
+    dispatcher.add(pirInt, logEdge, &pirPin, 1, AT::ReceiveMode::DiscardIntermediate);
+    dispatcher.start();
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Everything is done by the dispatch task
+    vTaskDelete(nullptr);
+}
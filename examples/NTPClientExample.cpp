@@ -8,16 +8,16 @@
 void setup()
 {
     // Start the WiFi Daemon
-    AT::WiFiDaemon::start(WIFI_SSID, WIFI_PASS, 2);
+    AT::WiFiDaemon::instance().start(WIFI_SSID, WIFI_PASS, 2);
     // Wait for WiFi to connect
-    AT::WiFiDaemon::blockUntilConnected();
+    AT::WiFiDaemon::instance().blockUntilConnected();
     // Start the NTPClient datetime daemon
-    AT::NTPClientDaemon::start();
+    AT::NTPClientDaemon::instance().start();
     vTaskDelay(pdMS_TO_TICKS(30 * 1000));
     // Stop the NTPClient datetime daemon
-    AT::NTPClientDaemon::stop();
+    AT::NTPClientDaemon::instance().stop();
     // Stop the WiFi Daemon
-    AT::WiFiDaemon::stop();
+    AT::WiFiDaemon::instance().stop();
     // Delete setup and loop task
     vTaskDelete(NULL);
 }
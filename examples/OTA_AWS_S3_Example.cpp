@@ -17,13 +17,13 @@
 void setup()
 {
     // Start the WiFi Daemon
-    AT::WiFiDaemon::start(WIFI_SSID, WIFI_PASS, 2);
+    AT::WiFiDaemon::instance().start(WIFI_SSID, WIFI_PASS, 2);
     // Wait for WiFi to connect
-    AT::WiFiDaemon::blockUntilConnected();
+    AT::WiFiDaemon::instance().blockUntilConnected();
     // Execute OTA
     AT::OTA::executeOTA("OTA_URL");
-    // WiFiDaemon is destroyed here as it goes out of scope
-    AT::WiFiDaemon::stop();
+    // Stop the WiFi Daemon
+    AT::WiFiDaemon::instance().stop();
     // Delete setup and loop task
     vTaskDelete(NULL);
 }
@@ -0,0 +1,35 @@
+#include <ArduinoToolkit/Interrupt/PipelineInterrupt.h>
+
+static constexpr uint8_t PIN_INT_DOOR{25};
+static constexpr uint8_t PIN_INT_FLOW{26};
+
+// Debounce the contact 5 ms, keep every state at least 200 ms and report up to 10 edges per second
+using DoorFilter = AT::FilterPipeline<AT::Debounce<5>, AT::MinHold<200>, AT::RateLimit<10>>;
+// Majority of the last 5 samples taken every 20 ms
+using FlowFilter = AT::FilterPipeline<AT::Majority<5, 20>>;
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    static AT::PipelineInterrupt<DoorFilter> doorInt(PIN_INT_DOOR, INPUT_PULLUP, true);
+    static AT::PipelineInterrupt<FlowFilter> flowInt(PIN_INT_FLOW, INPUT_PULLDOWN);
+    while (true)
+    {
+        // Only the objects whose bit is set in the mask have pending interrupts
+        const uint32_t interruptMask{AT::FilteredInterrupt::waitForInterruptMask()};
+        if (interruptMask & doorInt.getInterruptMask())
+            LOG_I("Door: %s", doorInt.receiveLastInterrupt(0) == AT::PinState::High ? "OPEN" : "CLOSED");
+        if (interruptMask & flowInt.getInterruptMask())
+            LOG_I("Flow: %s", flowInt.receiveLastInterrupt(0) == AT::PinState::High ? "ON" : "OFF");
+    }
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
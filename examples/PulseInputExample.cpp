@@ -0,0 +1,31 @@
+#include <ArduinoToolkit/Interrupt/PcntPulseBackend.h>
+#include <ArduinoToolkit/Interrupt/PulseInput.h>
+
+static constexpr uint8_t PIN_FLOW_METER{25};
+// Free pin used to generate the reference clock that measures the duty cycle
+static constexpr int8_t PIN_REFERENCE_CLOCK{27};
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    static AT::PcntPulseBackend flowMeterBackend(PIN_FLOW_METER, INPUT_PULLUP, false, 100, PIN_REFERENCE_CLOCK);
+    static AT::PulseInput flowMeter(flowMeterBackend, 1000);
+    AT::PulseMeasurement measurement;
+    while (true)
+    {
+        if (flowMeter.receiveMeasurement(measurement))
+            LOG_I("Pin %u: %u pulses, %.1f Hz, duty %.2f (total %llu)",
+                  flowMeter.getPin(), measurement.count, measurement.frequencyHz,
+                  measurement.dutyCycle, measurement.totalCount);
+    }
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
@@ -0,0 +1,55 @@
+#include <ArduinoToolkit/Interrupt/BasicInterrupt.h>
+#include <ArduinoToolkit/Interrupt/StaticBasicInterrupt.h>
+
+// Connect both pins with a jumper wire
+static constexpr uint8_t PIN_OUTPUT{26};
+static constexpr uint8_t PIN_INT{25};
+
+static constexpr uint32_t NUM_EDGES{1000};
+
+// Toggle the output pin and measure the CPU cycles until the ISR has updated the state
+static uint32_t measureEdgeLatency(const AT::BasicInterrupt &interrupt)
+{
+    uint64_t totalCycles{0};
+    for (uint32_t i{0}; i < NUM_EDGES; i++)
+    {
+        const AT::PinState expectedState{i % 2 ? AT::PinState::Low : AT::PinState::High};
+        const uint32_t startCycles{ESP.getCycleCount()};
+        digitalWrite(PIN_OUTPUT, expectedState == AT::PinState::High);
+        while (interrupt.getState() != expectedState)
+        {
+        }
+        totalCycles += ESP.getCycleCount() - startCycles;
+        // Drop the pending edges so they do not accumulate
+        interrupt.receiveLastInterrupt(0);
+    }
+    return totalCycles / NUM_EDGES;
+}
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    pinMode(PIN_OUTPUT, OUTPUT);
+    digitalWrite(PIN_OUTPUT, LOW);
+    {
+        AT::BasicInterrupt basicInt(PIN_INT, INPUT);
+        LOG_I("BasicInterrupt: %u cycles per edge", measureEdgeLatency(basicInt));
+    }
+    {
+        AT::StaticBasicInterrupt<PIN_INT, INPUT> staticInt;
+        LOG_I("StaticBasicInterrupt: %u cycles per edge", measureEdgeLatency(staticInt));
+        // The pin read of both ISRs must give the same state
+        if (AT::StaticBasicInterrupt<PIN_INT, INPUT>::readPin() != static_cast<AT::PinState>(digitalRead(PIN_INT)))
+            LOG_E("StaticBasicInterrupt does not read the same state as digitalRead()");
+    }
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
@@ -0,0 +1,38 @@
+// Send "profile" (or "profile <age>") through the serial monitor to print a sample
+#include <ArduinoToolkit/Core/TaskProfiler.h>
+
+static void busyTask(void *const parameters)
+{
+    (void)parameters;
+    while (true)
+    {
+        // Keep the core busy for ~20 ms out of every 100 ms
+        const int64_t endUs{esp_timer_get_time() + 20 * 1000};
+        while (esp_timer_get_time() < endUs)
+            ;
+        vTaskDelay(pdMS_TO_TICKS(80));
+    }
+}
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    Serial.begin(115200);
+    AT::TaskProfiler::begin({.intervalMs = 1000, .commandStream = &Serial});
+    xTaskCreatePinnedToCore(busyTask, "busyTask", 2 * 1024, nullptr, 1, nullptr, 1);
+    while (true)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10 * 1000));
+        AT::TaskProfiler::print(Serial);
+    }
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
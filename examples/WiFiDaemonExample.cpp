@@ -8,10 +8,10 @@
 void setup()
 {
     // Start the WiFi Daemon
-    AT::WiFiDaemon::start(WIFI_SSID, WIFI_PASS, 2);
+    AT::WiFiDaemon::instance().start(WIFI_SSID, WIFI_PASS, 2);
     vTaskDelay(pdMS_TO_TICKS(10 * 1000));
-    // WiFiDaemon is destroyed here as it goes out of scope
-    AT::WiFiDaemon::stop();
+    // Stop the WiFi Daemon
+    AT::WiFiDaemon::instance().stop();
     // Delete setup and loop task
     LOG_I("Deleting setup and loop task");
     vTaskDelete(NULL);
@@ -0,0 +1,84 @@
+/**
+ * Run the daemons and an interrupt on the host (pio run -e native -t exec).
+ * The access point, the NTP server and the S3 bucket are local stand-ins and the
+ * door is a simulated pin toggled by a task.
+ */
+
+#include <HostGpio.h>
+#include <HostNetwork.h>
+#include <HostWiFi.h>
+#include <Update.h>
+
+#include <ArduinoToolkit/Interrupt/FilteredInterrupt.h>
+#include <ArduinoToolkit/WiFi/NTPClientDaemon.h>
+#include <ArduinoToolkit/WiFi/OTA_AWS_S3.h>
+
+static constexpr char WIFI_SSID[]{"SimulatedAP"};
+static constexpr char WIFI_PASS[]{"SimulatedPass"};
+static constexpr char OTA_URL[]{"bucket-name.s3.eu-central-1.amazonaws.com/sketchname.bin"};
+static constexpr uint8_t PIN_INT_DOOR{25};
+// Unprivileged local ports of the servers
+static constexpr uint16_t NTP_LOCAL_PORT{12300};
+static constexpr uint16_t HTTP_LOCAL_PORT{18080};
+
+// Open and close the door every second
+static void doorTask(void *const parameters)
+{
+    (void)parameters;
+    bool level{false};
+    while (true)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        level = !level;
+        HostGpio::setLevel(PIN_INT_DOOR, level);
+    }
+}
+
+/* * * * * *
+ *  SETUP  *
+ * * * * * */
+void setup()
+{
+    // Network stand-ins
+    static uint8_t firmware[256 * 1024];
+    firmware[0] = 0xE9; // Magic byte of an ESP32 image
+    HostWiFi::setAccessPoint(WIFI_SSID, WIFI_PASS);
+    HostNetwork::mapPort(123, NTP_LOCAL_PORT);
+    HostNetwork::mapPort(80, HTTP_LOCAL_PORT);
+    HostNetwork::startNtpServer(NTP_LOCAL_PORT);
+    HostNetwork::startHttpServer(HTTP_LOCAL_PORT);
+    HostNetwork::addHttpFile("/sketchname.bin", firmware, sizeof(firmware));
+
+    // Start the WiFi Daemon and wait for WiFi to connect
+    AT::WiFiDaemon::instance().start(WIFI_SSID, WIFI_PASS, 2);
+    while (!AT::WiFiDaemon::instance().blockUntilConnected())
+        vTaskDelay(pdMS_TO_TICKS(10));
+    AT::NTPClientDaemon::instance().start(pdMS_TO_TICKS(5 * 1000));
+    AT::OTA::executeOTA(OTA_URL);
+    LOG_I("Installed image of %u bytes", static_cast<unsigned>(Update.getInstalledImage().size()));
+
+    static AT::FilteredInterrupt doorInt(PIN_INT_DOOR, INPUT_PULLUP, 50, 50);
+    xTaskCreatePinnedToCore(doorTask, "doorTask", 2 * 1024, nullptr, 1, nullptr, ARDUINO_RUNNING_CORE);
+    // Lose the access point for a while, the WiFi Daemon reconnects when it comes back
+    for (uint8_t i{0}; i < 10; i++)
+    {
+        if (i == 3)
+            HostWiFi::setAccessPointEnabled(false);
+        if (i == 6)
+            HostWiFi::setAccessPointEnabled(true);
+        const AT::PinState state{doorInt.receiveInterrupt(pdMS_TO_TICKS(2000))};
+        LOG_I("Door %s, WiFi %s", state == AT::PinState::High ? "HIGH" : "LOW",
+              AT::WiFiDaemon::instance().isConnected() ? "connected" : "disconnected");
+    }
+    AT::NTPClientDaemon::instance().stop();
+    AT::WiFiDaemon::instance().stop();
+    std::exit(0);
+}
+
+/* * * * * *
+ *  LOOP   *
+ * * * * * */
+void loop()
+{
+    // Code written here won't run
+}
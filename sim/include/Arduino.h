@@ -0,0 +1,326 @@
+#pragma once
+
+// Arduino-ESP32 / FreeRTOS / ESP-IDF layer of the POSIX simulation backend.
+// Tasks are threads, the GPIO interrupts are raised by HostGpio and run in a dedicated
+// "ISR" thread, the esp_timer and FreeRTOS timer callbacks run in a timer thread.
+// Priorities and core affinities are ignored. It only covers what the toolkit uses,
+// see HostPlatform.cpp for the implementation.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+// Arduino
+#define IRAM_ATTR
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define LOW 0x0
+#define HIGH 0x1
+
+// Sketch entry points, called by the "main()" of HostMain.cpp
+void setup();
+void loop();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+class String
+{
+public:
+    String(const char *text = "") : m_string(text ? text : "") {}
+    String(const std::string &text) : m_string(text) {}
+
+    inline const char *c_str() const { return m_string.c_str(); }
+    inline unsigned int length() const { return m_string.length(); }
+    inline bool startsWith(const char *prefix) const { return !m_string.compare(0, std::strlen(prefix), prefix); }
+    inline int indexOf(const char *text) const
+    {
+        const size_t index{m_string.find(text)};
+        return index == std::string::npos ? -1 : static_cast<int>(index);
+    }
+    inline String &operator+=(const char c)
+    {
+        m_string += c;
+        return *this;
+    }
+    inline bool operator==(const char *text) const { return m_string == text; }
+
+private:
+    std::string m_string;
+};
+
+class Print
+{
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    inline size_t print(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), std::strlen(text)); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    inline void setTimeout(unsigned long timeoutMs) { m_timeoutMs = timeoutMs; }
+    size_t readBytes(uint8_t *buffer, size_t length);
+    String readStringUntil(char terminator);
+
+protected:
+    // Wait up to the timeout for the next byte (-1 on timeout)
+    int timedRead();
+
+private:
+    unsigned long m_timeoutMs{1000};
+};
+
+// Serial port printed to the standard output
+class HardwareSerial : public Stream
+{
+public:
+    inline void begin(unsigned long baud) { (void)baud; }
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    inline int available() override { return 0; }
+    inline int read() override { return -1; }
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    // Virtual cycle counter of a 240 MHz CPU
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+};
+extern EspClass ESP;
+
+#define log_v(format, ...) std::printf("[V] " format "\n", ##__VA_ARGS__)
+#define log_d(format, ...) std::printf("[D] " format "\n", ##__VA_ARGS__)
+#define log_i(format, ...) std::printf("[I] " format "\n", ##__VA_ARGS__)
+#define log_w(format, ...) std::printf("[W] " format "\n", ##__VA_ARGS__)
+#define log_e(format, ...) std::printf("[E] " format "\n", ##__VA_ARGS__)
+
+// Hardware timers (Arduino-ESP32 2.x API) on top of the timer thread
+typedef struct HostHwTimer hw_timer_t;
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerEnd(hw_timer_t *timer);
+void timerAttachInterrupt(hw_timer_t *timer, void (*handler)(void), bool edge);
+void timerDetachInterrupt(hw_timer_t *timer);
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarmValue, bool autoReload);
+void timerAlarmEnable(hw_timer_t *timer);
+void timerAlarmDisable(hw_timer_t *timer);
+
+// ESP-IDF
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERROR_CHECK(x)                                                   \
+    do                                                                       \
+    {                                                                        \
+        const esp_err_t err_rc_{x};                                          \
+        if (err_rc_ != ESP_OK)                                               \
+        {                                                                    \
+            std::fprintf(stderr, "ESP_ERROR_CHECK failed: 0x%x\n", err_rc_); \
+            std::abort();                                                    \
+        }                                                                    \
+    } while (0)
+
+// Input registers of the GPIO banks, read from the simulated pins
+#define GPIO_IN_REG 0
+#define GPIO_IN1_REG 1
+uint32_t hostReadGpioBank(uint8_t bank);
+#define REG_READ(reg) hostReadGpioBank(reg)
+
+typedef struct HostTimer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+typedef enum
+{
+    ESP_TIMER_TASK
+} esp_timer_dispatch_t;
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+int64_t esp_timer_get_time();
+
+// FreeRTOS
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+typedef struct HostTask *TaskHandle_t;
+typedef struct HostSemaphore *SemaphoreHandle_t;
+// Only semaphores are used as queues (to peek them)
+typedef SemaphoreHandle_t QueueHandle_t;
+typedef struct HostSoftwareTimer *TimerHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+typedef struct
+{
+    uint8_t unused;
+} StaticTask_t;
+typedef struct
+{
+    uint8_t unused;
+} StaticSemaphore_t;
+typedef struct
+{
+    uint8_t unused;
+} StaticTimer_t;
+typedef struct
+{
+    TickType_t start;
+} TimeOut_t;
+
+// Recursive lock standing for the spinlock of a critical section
+typedef struct
+{
+    std::recursive_mutex lock;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED \
+    {                                \
+    }
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY UINT32_MAX
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define pdTICKS_TO_MS(ticks) (static_cast<TickType_t>(ticks))
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define portNUM_PROCESSORS 2
+#define ARDUINO_RUNNING_CORE 1
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configUSE_TRACE_FACILITY 1
+#define configGENERATE_RUN_TIME_STATS 1
+#define configTASKLIST_INCLUDE_COREID 1
+#define configMAX_TASK_NAME_LEN 16
+
+#define portENTER_CRITICAL(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL(mux) (mux)->lock.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->lock.unlock()
+#define portENTER_CRITICAL_SAFE(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL_SAFE(mux) (mux)->lock.unlock()
+#define portYIELD_FROM_ISR() \
+    do                       \
+    {                        \
+    } while (0)
+// Serializes the sections that mask the interrupts of the (single) simulated core
+UBaseType_t xPortSetInterruptMaskFromISR();
+void vPortClearInterruptMaskFromISR(UBaseType_t state);
+#define portSET_INTERRUPT_MASK_FROM_ISR() xPortSetInterruptMaskFromISR()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(state) vPortClearInterruptMaskFromISR(state)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize,
+                                           void *parameters, UBaseType_t priority, StackType_t *stack,
+                                           StaticTask_t *buffer, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+// Threads can not be stopped from outside, so a task suspended by another one
+// stops at its next FreeRTOS call (and right away if it suspends itself)
+void vTaskSuspend(TaskHandle_t task);
+void vTaskResume(TaskHandle_t task);
+BaseType_t xTaskResumeFromISR(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t xTaskGetTickCount();
+const char *pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks();
+BaseType_t xPortGetCoreID();
+// Run time counters are the CPU time of the threads (us). Each core has an idle task that takes
+// the time not used by the tasks pinned to it (the unpinned ones are counted on core 0)
+typedef enum
+{
+    eRunning,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;
+    StackType_t *pxStackBase;
+    uint32_t usStackHighWaterMark;
+    BaseType_t xCoreID;
+} TaskStatus_t;
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime);
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpu);
+void vTaskSetTimeOutState(TimeOut_t *timeOut);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *timeOut, TickType_t *ticksToWait);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer);
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore);
+// Wait until the semaphore can be taken, without taking it
+BaseType_t xQueuePeek(QueueHandle_t queue, void *buffer, TickType_t ticksToWait);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *timerId,
+                           TimerCallbackFunction_t callback);
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t autoReload, void *timerId,
+                                 TimerCallbackFunction_t callback, StaticTimer_t *buffer);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticksToWait);
+BaseType_t xTimerChangePeriodFromISR(TimerHandle_t timer, TickType_t period, BaseType_t *higherPriorityTaskWoken);
+TickType_t xTimerGetPeriod(TimerHandle_t timer);
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+void *pvTimerGetTimerID(TimerHandle_t timer);
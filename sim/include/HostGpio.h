@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Simulated GPIOs of the host layer.
+ * Changing the level of a pin with an attached interrupt latches its interrupt status and
+ * wakes up the ISR thread, which runs the handlers of the latched pins. Like the hardware,
+ * edges that happen while the status of a pin is latched are coalesced into one ISR call,
+ * which reads the level the pin has by then.
+ * Until a pin is set, its level is the one of its pull resistor (see "pinMode()").
+ */
+namespace HostGpio
+{
+
+    static constexpr uint8_t s_NUM_PINS{64};
+
+    // Drive a pin. It raises the interrupt of the pin if it has one attached
+    void setLevel(const uint8_t pin, const bool level);
+    bool getLevel(const uint8_t pin);
+    // ISR calls since the start of the program
+    uint64_t getIsrCount();
+    // CPU time consumed by the ISR thread (in ns)
+    uint64_t getIsrCpuTimeNs();
+
+} // namespace HostGpio
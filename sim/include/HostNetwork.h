@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Network of the simulated station.
+ * Every host name resolves to localhost, so the client sockets of the toolkit reach the local
+ * servers. Remote ports can be mapped to local ones (e.g. to run the servers on unprivileged
+ * ports). Sockets can only be used while the station is connected to the fake access point.
+ * The NTP and HTTP servers are local stand-ins of the ones the toolkit talks to.
+ */
+namespace HostNetwork
+{
+
+    void mapPort(const uint16_t remotePort, const uint16_t localPort);
+    // Local port the connections to "remotePort" go to
+    uint16_t getLocalPort(const uint16_t remotePort);
+
+    // NTP server answering with the time of the host plus "offsetSeconds"
+    bool startNtpServer(const uint16_t port, const int64_t offsetSeconds = 0);
+
+    // HTTP/1.1 server of static files, answering 404 to the paths without a file
+    bool startHttpServer(const uint16_t port);
+    // The data must outlive the server
+    void addHttpFile(const char *const path,
+                     const uint8_t *const data,
+                     const size_t size,
+                     const char *const contentType = "application/octet-stream");
+
+} // namespace HostNetwork
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Fake access point of the simulated WiFi station.
+ * "WiFi.begin()" connects after the connection delay if the access point is enabled and the
+ * credentials match, otherwise it fails with WIFI_REASON_NO_AP_FOUND or WIFI_REASON_AUTH_FAIL.
+ * The events are delivered by an "arduino_events" task, as on the target.
+ */
+namespace HostWiFi
+{
+
+    void setAccessPoint(const char *const ssid, const char *const passphrase);
+    // Disabling the access point disconnects the station (WIFI_REASON_BEACON_TIMEOUT)
+    void setAccessPointEnabled(const bool enabled);
+    // Time to associate and get an IP
+    void setConnectDelayMs(const uint32_t delayMs);
+    // Disconnect the station with the given reason, as if the access point dropped it
+    void dropStation(const uint8_t reason);
+
+} // namespace HostWiFi
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <WiFiUdp.h>
+
+// Simulated NTPClient library (arduino-libraries/NTPClient API) on top of the WiFiUDP socket
+class NTPClient
+{
+public:
+    explicit NTPClient(WiFiUDP &udp,
+                       const char *poolServerName = "pool.ntp.org",
+                       long timeOffset = 0,
+                       unsigned long updateIntervalMs = 60000);
+
+    void begin(uint16_t port = 1337);
+    void end();
+    bool update();
+    bool forceUpdate();
+    inline bool isTimeSet() const { return m_lastUpdateMs != 0; }
+
+    unsigned long getEpochTime() const;
+    int getDay() const;
+    int getHours() const;
+    int getMinutes() const;
+    int getSeconds() const;
+    String getFormattedTime() const;
+
+    inline void setTimeOffset(int timeOffset) { m_timeOffset = timeOffset; }
+    inline void setUpdateInterval(unsigned long updateIntervalMs) { m_updateIntervalMs = updateIntervalMs; }
+    inline void setPoolServerName(const char *poolServerName) { m_poolServerName = poolServerName; }
+
+private:
+    WiFiUDP &m_udp;
+    const char *m_poolServerName;
+    long m_timeOffset;
+    unsigned long m_updateIntervalMs;
+    uint16_t m_port{1337};
+    bool m_udpSetup{false};
+    unsigned long m_currentEpoch{0};
+    unsigned long m_lastUpdateMs{0};
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include <Arduino.h>
+
+#define UPDATE_ERROR_OK 0
+#define UPDATE_ERROR_WRITE 1
+#define UPDATE_ERROR_SPACE 4
+#define UPDATE_ERROR_SIZE 5
+#define UPDATE_ERROR_STREAM 6
+#define UPDATE_ERROR_MAGIC_BYTE 8
+#define UPDATE_ERROR_ABORT 12
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+
+// Simulated OTA partition. The image is kept in memory instead of being flashed
+class UpdateClass
+{
+public:
+    // Size of the OTA partition of the default partition table
+    static constexpr size_t s_PARTITION_SIZE{0x140000};
+
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH);
+    size_t write(const uint8_t *data, size_t length);
+    size_t writeStream(Stream &data);
+    bool end(bool evenIfRemaining = false);
+
+    inline uint8_t getError() const { return m_error; }
+    inline bool hasError() const { return m_error != UPDATE_ERROR_OK; }
+    inline bool isFinished() const { return m_image.size() == m_size; }
+    inline size_t size() const { return m_size; }
+    inline size_t progress() const { return m_image.size(); }
+    // Image of the last update that ended successfully
+    inline const std::vector<uint8_t> &getInstalledImage() const { return m_installed; }
+
+private:
+    size_t m_size{0};
+    uint8_t m_error{UPDATE_ERROR_OK};
+    std::vector<uint8_t> m_image;
+    std::vector<uint8_t> m_installed;
+};
+extern UpdateClass Update;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+// TCP client socket. The host is resolved to localhost (see HostNetwork.h)
+class WiFiClient : public Stream
+{
+public:
+    WiFiClient() = default;
+    ~WiFiClient() override { stop(); }
+    WiFiClient(const WiFiClient &) = delete;
+    WiFiClient &operator=(const WiFiClient &) = delete;
+
+    int connect(const char *host, uint16_t port, int32_t timeoutMs = 3000);
+    uint8_t connected();
+    void stop();
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+    // Discard the received data
+    void flush();
+
+    inline operator bool() { return connected(); }
+
+private:
+    int m_socket{-1};
+};
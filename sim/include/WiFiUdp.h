@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <Arduino.h>
+
+// UDP socket. The remote host is resolved to localhost (see HostNetwork.h)
+class WiFiUDP : public Stream
+{
+public:
+    WiFiUDP() = default;
+    ~WiFiUDP() override { stop(); }
+    WiFiUDP(const WiFiUDP &) = delete;
+    WiFiUDP &operator=(const WiFiUDP &) = delete;
+
+    uint8_t begin(uint16_t port);
+    void stop();
+
+    int beginPacket(const char *host, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    // Receive the next packet without blocking. Return its size (0 if there is none)
+    int parsePacket();
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+
+private:
+    bool open();
+
+private:
+    int m_socket{-1};
+    uint16_t m_remotePort{0};
+    std::vector<uint8_t> m_txPacket;
+    std::vector<uint8_t> m_rxPacket;
+    size_t m_rxPosition{0};
+};
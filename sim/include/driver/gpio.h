@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Enable and disable the interrupt of a pin without detaching its handler.
+// Edges that happen while it is disabled are lost
+typedef int gpio_num_t;
+
+// GPIOs of the simulated chip, an ESP32 (as in soc/soc_caps.h)
+#define SOC_GPIO_PIN_COUNT 40
+#define SOC_GPIO_VALID_GPIO_MASK (0xFFFFFFFFFFULL & ~(0ULL | 1ULL << 24 | 1ULL << 28 | 1ULL << 29 | 1ULL << 30 | 1ULL << 31))
+#define GPIO_IS_VALID_GPIO(gpio_num) ((gpio_num >= 0) && (((1ULL << (gpio_num)) & SOC_GPIO_VALID_GPIO_MASK) != 0))
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Run the function directly, the host layer has no cores to dispatch to
+inline esp_err_t esp_ipc_call_blocking(BaseType_t core, void (*function)(void *), void *arg)
+{
+    (void)core;
+    function(arg);
+    return ESP_OK;
+}
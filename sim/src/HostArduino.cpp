@@ -0,0 +1,79 @@
+#include <Arduino.h>
+
+#include <cstdarg>
+#include <algorithm>
+
+// Arduino objects
+
+HardwareSerial Serial;
+EspClass ESP;
+
+unsigned long millis() { return esp_timer_get_time() / 1000; }
+unsigned long micros() { return esp_timer_get_time(); }
+void delay(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+uint32_t EspClass::getCycleCount()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() * getCpuFreqMHz());
+}
+
+// Print and Stream
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written{0};
+    while (written < size && write(buffer[written]))
+        written++;
+    return written;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    const int length{std::vsnprintf(text, sizeof(text), format, args)};
+    va_end(args);
+    if (length <= 0)
+        return 0;
+    return write(reinterpret_cast<const uint8_t *>(text), std::min<size_t>(length, sizeof(text) - 1));
+}
+
+int Stream::timedRead()
+{
+    const unsigned long startMs{millis()};
+    do
+    {
+        const int byte{read()};
+        if (byte >= 0)
+            return byte;
+        vTaskDelay(1);
+    } while (millis() - startMs < m_timeoutMs);
+    return -1;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length)
+{
+    size_t count{0};
+    for (int byte; count < length && (byte = timedRead()) >= 0; count++)
+        buffer[count] = byte;
+    return count;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    String text;
+    for (int byte; (byte = timedRead()) >= 0 && byte != terminator;)
+        text += static_cast<char>(byte);
+    return text;
+}
+
+size_t HardwareSerial::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    return std::fwrite(buffer, 1, size, stdout);
+}
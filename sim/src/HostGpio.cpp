@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include <driver/gpio.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+#include <pthread.h>
+
+#include "HostGpio.h"
+
+// One thread stands for the interrupt controller of the CPU
+
+namespace
+{
+
+    struct Pin
+    {
+        std::atomic<bool> level{false};
+        // Set by "HostGpio::setLevel()", otherwise the level comes from the pull resistor
+        bool driven{false};
+        void (*handler)(void *){nullptr};
+        void *arg{nullptr};
+        // Cleared by "gpio_intr_disable()"
+        std::atomic<bool> interruptEnabled{true};
+    };
+
+    Pin s_pins[HostGpio::s_NUM_PINS];
+    // Latched interrupt status of the pins
+    std::atomic<uint64_t> s_interruptStatus{0};
+    std::mutex s_isrMutex;
+
+    // Never destroyed (the ISR thread keeps waiting on it after "main()" returns) and
+    // created on first use, so static objects of the sketch can attach interrupts
+    std::condition_variable &isrCv()
+    {
+        static std::condition_variable *const cv{new std::condition_variable};
+        return *cv;
+    }
+
+    // Held while the handlers run, so a handler is not running after "detachInterrupt()"
+    std::mutex s_handlerMutex;
+    std::atomic<uint64_t> s_isrCount{0};
+    std::atomic<clockid_t> s_isrClock{0};
+    std::once_flag s_isrStarted;
+
+    void isrThread()
+    {
+        clockid_t clock;
+        pthread_getcpuclockid(pthread_self(), &clock);
+        s_isrClock = clock;
+        while (true)
+        {
+            uint64_t status;
+            {
+                std::unique_lock<std::mutex> lock{s_isrMutex};
+                isrCv().wait(lock, []()
+                             { return s_interruptStatus.load() != 0; });
+                status = s_interruptStatus.exchange(0);
+            }
+            const std::lock_guard<std::mutex> lock{s_handlerMutex};
+            for (; status; status &= status - 1)
+            {
+                Pin &pin{s_pins[__builtin_ctzll(status)]};
+                if (pin.handler && pin.interruptEnabled.load())
+                {
+                    pin.handler(pin.arg);
+                    s_isrCount++;
+                }
+            }
+        }
+    }
+
+} // namespace
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (!s_pins[pin].driven)
+        s_pins[pin].level = (mode & PULLUP) != 0;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return s_pins[pin].level.load() ? HIGH : LOW;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+    (void)mode;
+    std::call_once(s_isrStarted, []()
+                   { std::thread(isrThread).detach(); });
+    const std::lock_guard<std::mutex> lock{s_handlerMutex};
+    s_pins[pin].arg = arg;
+    s_pins[pin].handler = handler;
+    s_pins[pin].interruptEnabled = true;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    const std::lock_guard<std::mutex> lock{s_handlerMutex};
+    s_pins[pin].handler = nullptr;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+{
+    s_pins[gpio_num].interruptEnabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+{
+    s_pins[gpio_num].interruptEnabled = false;
+    return ESP_OK;
+}
+
+uint32_t hostReadGpioBank(uint8_t bank)
+{
+    uint32_t levels{0};
+    for (uint8_t bit{0}; bit < 32; bit++)
+        levels |= static_cast<uint32_t>(s_pins[bank * 32 + bit].level.load()) << bit;
+    return levels;
+}
+
+namespace HostGpio
+{
+
+    void setLevel(const uint8_t pin, const bool level)
+    {
+        s_pins[pin].driven = true;
+        if (s_pins[pin].level.exchange(level) == level || !s_pins[pin].handler ||
+            !s_pins[pin].interruptEnabled.load())
+            return;
+        // Latch the interrupt and wake up the ISR thread if it was not latched yet
+        if (s_interruptStatus.fetch_or(1ULL << pin) & (1ULL << pin))
+            return;
+        {
+            const std::lock_guard<std::mutex> lock{s_isrMutex};
+        }
+        isrCv().notify_one();
+    }
+
+    bool getLevel(const uint8_t pin) { return s_pins[pin].level.load(); }
+
+    uint64_t getIsrCount() { return s_isrCount.load(); }
+
+    uint64_t getIsrCpuTimeNs()
+    {
+        const clockid_t clock{s_isrClock.load()};
+        if (!clock)
+            return 0;
+        timespec time;
+        clock_gettime(clock, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL + time.tv_nsec;
+    }
+
+} // namespace HostGpio
@@ -0,0 +1,11 @@
+#include <Arduino.h>
+
+// Run the sketch like the loop task of Arduino-ESP32
+int main()
+{
+    // Keep the log lines in order with the other output when it is redirected
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    setup();
+    while (true)
+        loop();
+}
@@ -0,0 +1,397 @@
+#include <WiFi.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HostNetwork.h"
+
+namespace
+{
+
+    std::mutex s_mutex;
+    std::map<uint16_t, uint16_t> s_portMap;
+
+    struct HttpFile
+    {
+        const uint8_t *data;
+        size_t size;
+        std::string contentType;
+    };
+    std::map<std::string, HttpFile> s_httpFiles;
+
+    sockaddr_in localAddress(const uint16_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+
+    // Seconds from 1900 (NTP epoch) to 1970 (Unix epoch)
+    constexpr uint32_t s_NTP_UNIX_OFFSET{2208988800UL};
+
+    void ntpServer(const int sock, const int64_t offsetSeconds)
+    {
+        while (true)
+        {
+            uint8_t packet[48];
+            sockaddr_in client{};
+            socklen_t clientLength{sizeof(client)};
+            const ssize_t length{recvfrom(sock, packet, sizeof(packet), 0, reinterpret_cast<sockaddr *>(&client), &clientLength)};
+            if (length < static_cast<ssize_t>(sizeof(packet)))
+                continue;
+            const uint32_t seconds{static_cast<uint32_t>(std::time(nullptr) + offsetSeconds + s_NTP_UNIX_OFFSET)};
+            uint8_t reply[48]{};
+            reply[0] = 0x24; // LI 0, version 4, server mode
+            reply[1] = 1;    // Stratum 1
+            // Originate timestamp is the transmit timestamp of the request
+            std::memcpy(&reply[24], &packet[40], 8);
+            for (const uint8_t offset : {32, 40}) // Receive and transmit timestamps
+            {
+                reply[offset] = seconds >> 24;
+                reply[offset + 1] = seconds >> 16;
+                reply[offset + 2] = seconds >> 8;
+                reply[offset + 3] = seconds;
+            }
+            sendto(sock, reply, sizeof(reply), 0, reinterpret_cast<sockaddr *>(&client), clientLength);
+        }
+    }
+
+    void sendAll(const int sock, const void *const data, const size_t size)
+    {
+        const uint8_t *bytes{static_cast<const uint8_t *>(data)};
+        for (size_t sent{0}; sent < size;)
+        {
+            const ssize_t ret{send(sock, bytes + sent, size - sent, MSG_NOSIGNAL)};
+            if (ret <= 0)
+                return;
+            sent += ret;
+        }
+    }
+
+    void serveHttpConnection(const int sock)
+    {
+        // Read the request up to the empty line (the clients may end the lines with "\n" only)
+        std::string request;
+        char buffer[512];
+        while (request.find("\n\n") == std::string::npos && request.find("\r\n\r\n") == std::string::npos)
+        {
+            const ssize_t length{recv(sock, buffer, sizeof(buffer), 0)};
+            if (length <= 0)
+                return;
+            request.append(buffer, length);
+        }
+        std::string path;
+        if (!request.compare(0, 4, "GET "))
+            path = request.substr(4, request.find(' ', 4) - 4);
+        HttpFile file{nullptr, 0, {}};
+        {
+            const std::lock_guard<std::mutex> lock{s_mutex};
+            const auto it{s_httpFiles.find(path)};
+            if (it != s_httpFiles.end())
+                file = it->second;
+        }
+        if (!file.data)
+        {
+            static constexpr char notFound[]{"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"};
+            sendAll(sock, notFound, sizeof(notFound) - 1);
+            return;
+        }
+        const std::string header{"HTTP/1.1 200 OK\r\nContent-Type: " + file.contentType +
+                                 "\r\nContent-Length: " + std::to_string(file.size) +
+                                 "\r\nConnection: close\r\n\r\n"};
+        sendAll(sock, header.data(), header.size());
+        sendAll(sock, file.data, file.size);
+    }
+
+    void httpServer(const int sock)
+    {
+        while (true)
+        {
+            const int client{accept(sock, nullptr, nullptr)};
+            if (client < 0)
+                continue;
+            serveHttpConnection(client);
+            shutdown(client, SHUT_WR);
+            close(client);
+        }
+    }
+
+} // namespace
+
+namespace HostNetwork
+{
+
+    void mapPort(const uint16_t remotePort, const uint16_t localPort)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        s_portMap[remotePort] = localPort;
+    }
+
+    uint16_t getLocalPort(const uint16_t remotePort)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        const auto it{s_portMap.find(remotePort)};
+        return it == s_portMap.end() ? remotePort : it->second;
+    }
+
+    bool startNtpServer(const uint16_t port, const int64_t offsetSeconds)
+    {
+        const int sock{socket(AF_INET, SOCK_DGRAM, 0)};
+        const sockaddr_in address{localAddress(port)};
+        if (sock < 0 || bind(sock, reinterpret_cast<const sockaddr *>(&address), sizeof(address)))
+        {
+            log_e("Could not start the NTP server on port %u", port);
+            if (sock >= 0)
+                close(sock);
+            return false;
+        }
+        std::thread(ntpServer, sock, offsetSeconds).detach();
+        return true;
+    }
+
+    bool startHttpServer(const uint16_t port)
+    {
+        const int sock{socket(AF_INET, SOCK_STREAM, 0)};
+        const int reuse{1};
+        const sockaddr_in address{localAddress(port)};
+        if (sock < 0 ||
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) ||
+            bind(sock, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) ||
+            listen(sock, 4))
+        {
+            log_e("Could not start the HTTP server on port %u", port);
+            if (sock >= 0)
+                close(sock);
+            return false;
+        }
+        std::thread(httpServer, sock).detach();
+        return true;
+    }
+
+    void addHttpFile(const char *const path,
+                     const uint8_t *const data,
+                     const size_t size,
+                     const char *const contentType)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        s_httpFiles[path] = {data, size, contentType};
+    }
+
+} // namespace HostNetwork
+
+// WiFiClient
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeoutMs)
+{
+    (void)host;
+    stop();
+    if (!WiFi.isConnected())
+        return 0;
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket < 0)
+        return 0;
+    const sockaddr_in address{localAddress(HostNetwork::getLocalPort(port))};
+    // Connect without blocking to apply the timeout
+    fcntl(m_socket, F_SETFL, O_NONBLOCK);
+    int ret{::connect(m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address))};
+    if (ret && errno == EINPROGRESS)
+    {
+        pollfd pollSocket{m_socket, POLLOUT, 0};
+        int error{0};
+        socklen_t errorLength{sizeof(error)};
+        if (poll(&pollSocket, 1, timeoutMs) == 1 &&
+            !getsockopt(m_socket, SOL_SOCKET, SO_ERROR, &error, &errorLength) && !error)
+            ret = 0;
+    }
+    if (ret)
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (m_socket < 0)
+        return false;
+    // Still connected if there is data to read or the peer has not closed it
+    uint8_t byte;
+    const ssize_t ret{recv(m_socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT)};
+    return ret > 0 || (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+void WiFiClient::stop()
+{
+    if (m_socket < 0)
+        return;
+    close(m_socket);
+    m_socket = -1;
+}
+
+size_t WiFiClient::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+    if (m_socket < 0 || !WiFi.isConnected())
+        return 0;
+    size_t written{0};
+    while (written < size)
+    {
+        const ssize_t ret{send(m_socket, buffer + written, size - written, MSG_NOSIGNAL)};
+        if (ret > 0)
+            written += ret;
+        else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            vTaskDelay(1);
+        else
+            break;
+    }
+    return written;
+}
+
+int WiFiClient::available()
+{
+    if (m_socket < 0 || !WiFi.isConnected())
+        return 0;
+    int count{0};
+    if (ioctl(m_socket, FIONREAD, &count))
+        return 0;
+    return count;
+}
+
+int WiFiClient::read()
+{
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+    if (m_socket < 0 || !WiFi.isConnected())
+        return -1;
+    const ssize_t ret{recv(m_socket, buffer, size, MSG_DONTWAIT)};
+    return ret > 0 ? ret : -1;
+}
+
+void WiFiClient::flush()
+{
+    uint8_t buffer[256];
+    while (available() && read(buffer, sizeof(buffer)) > 0)
+        ;
+}
+
+// WiFiUDP
+
+bool WiFiUDP::open()
+{
+    if (m_socket >= 0)
+        return true;
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    return m_socket >= 0;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    stop();
+    if (!open())
+        return 0;
+    const sockaddr_in address{localAddress(port)};
+    if (bind(m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)))
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop()
+{
+    if (m_socket >= 0)
+        close(m_socket);
+    m_socket = -1;
+    m_rxPacket.clear();
+    m_rxPosition = 0;
+}
+
+int WiFiUDP::beginPacket(const char *host, uint16_t port)
+{
+    (void)host;
+    if (!open())
+        return 0;
+    m_remotePort = HostNetwork::getLocalPort(port);
+    m_txPacket.clear();
+    return 1;
+}
+
+int WiFiUDP::endPacket()
+{
+    if (m_socket < 0 || !WiFi.isConnected())
+        return 0;
+    const sockaddr_in address{localAddress(m_remotePort)};
+    const ssize_t ret{sendto(m_socket, m_txPacket.data(), m_txPacket.size(), 0,
+                             reinterpret_cast<const sockaddr *>(&address), sizeof(address))};
+    m_txPacket.clear();
+    return ret >= 0;
+}
+
+size_t WiFiUDP::write(uint8_t byte)
+{
+    m_txPacket.push_back(byte);
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+    m_txPacket.insert(m_txPacket.end(), buffer, buffer + size);
+    return size;
+}
+
+int WiFiUDP::parsePacket()
+{
+    m_rxPacket.clear();
+    m_rxPosition = 0;
+    if (m_socket < 0)
+        return 0;
+    uint8_t packet[1500];
+    const ssize_t length{recv(m_socket, packet, sizeof(packet), MSG_DONTWAIT)};
+    // Packets received while disconnected are lost
+    if (length <= 0 || !WiFi.isConnected())
+        return 0;
+    m_rxPacket.assign(packet, packet + length);
+    return length;
+}
+
+int WiFiUDP::available()
+{
+    return m_rxPacket.size() - m_rxPosition;
+}
+
+int WiFiUDP::read()
+{
+    return available() ? m_rxPacket[m_rxPosition++] : -1;
+}
+
+int WiFiUDP::read(uint8_t *buffer, size_t size)
+{
+    const size_t count{std::min<size_t>(size, available())};
+    std::memcpy(buffer, m_rxPacket.data() + m_rxPosition, count);
+    m_rxPosition += count;
+    return count;
+}
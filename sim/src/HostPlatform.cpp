@@ -0,0 +1,794 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+#include <pthread.h>
+
+namespace
+{
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point s_startTime{Clock::now()};
+
+    // Wait on "cv" until "ready()" or the timeout (in ticks) elapses
+    template <typename Predicate>
+    bool waitFor(std::unique_lock<std::mutex> &lock, std::condition_variable &cv,
+                 const TickType_t ticksToWait, Predicate ready)
+    {
+        if (ticksToWait == portMAX_DELAY)
+        {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+    }
+
+} // namespace
+
+// Tasks
+
+struct HostTask
+{
+    std::string name;
+    UBaseType_t priority{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifyValue{0};
+    bool suspended{false};
+    UBaseType_t number{0};
+    BaseType_t core{tskNO_AFFINITY};
+    // CPU time clock of the thread, set by the thread itself
+    clockid_t cpuClock{};
+    std::atomic<bool> hasCpuClock{false};
+    std::atomic<bool> deleted{false};
+};
+
+namespace
+{
+
+    thread_local HostTask *t_currentTask{nullptr};
+
+    // Every task created, for "uxTaskGetSystemState()". Never destroyed and created on first use
+    struct TaskList
+    {
+        std::mutex mutex;
+        std::vector<HostTask *> tasks;
+        UBaseType_t nextNumber{1};
+    };
+    TaskList &taskList()
+    {
+        static TaskList *const list{new TaskList};
+        return *list;
+    }
+
+    void registerTask(HostTask *const task)
+    {
+        TaskList &list{taskList()};
+        const std::lock_guard<std::mutex> lock{list.mutex};
+        task->number = list.nextNumber++;
+        list.tasks.push_back(task);
+    }
+
+    // Called by the thread of the task
+    void setCpuClock(HostTask *const task)
+    {
+        if (!pthread_getcpuclockid(pthread_self(), &task->cpuClock))
+            task->hasCpuClock = true;
+    }
+
+    HostTask *startTask(TaskFunction_t function, const char *name, void *parameters, UBaseType_t priority,
+                        const BaseType_t core)
+    {
+        HostTask *const task{new HostTask};
+        task->name = name;
+        task->priority = priority;
+        task->core = core;
+        registerTask(task);
+        std::thread([task, function, parameters]()
+                    {
+                        t_currentTask = task;
+                        setCpuClock(task);
+                        function(parameters);
+                    })
+            .detach();
+        return task;
+    }
+
+    // Scheduling point of the current task. Block while it is suspended
+    void honorSuspension()
+    {
+        HostTask *const task{xTaskGetCurrentTaskHandle()};
+        std::unique_lock<std::mutex> lock{task->mutex};
+        task->cv.wait(lock, [task]()
+                      { return !task->suspended; });
+    }
+
+} // namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    (void)stackSize;
+    HostTask *const task{startTask(function, name, parameters, priority, core)};
+    if (handle)
+        *handle = task;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize,
+                                           void *parameters, UBaseType_t priority, StackType_t *stack,
+                                           StaticTask_t *buffer, BaseType_t core)
+{
+    (void)stackSize;
+    (void)stack;
+    (void)buffer;
+    return startTask(function, name, parameters, priority, core);
+}
+
+// Threads can not be killed. The calling thread exits, any other task is suspended forever
+void vTaskDelete(TaskHandle_t task)
+{
+    (task ? task : xTaskGetCurrentTaskHandle())->deleted = true;
+    if (!task || task == t_currentTask)
+        pthread_exit(nullptr);
+    vTaskSuspend(task);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    honorSuspension();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+void vTaskSuspend(TaskHandle_t task)
+{
+    if (!task)
+        task = xTaskGetCurrentTaskHandle();
+    {
+        const std::lock_guard<std::mutex> lock{task->mutex};
+        task->suspended = true;
+    }
+    if (task == t_currentTask)
+        honorSuspension();
+}
+
+void vTaskResume(TaskHandle_t task)
+{
+    {
+        const std::lock_guard<std::mutex> lock{task->mutex};
+        task->suspended = false;
+    }
+    task->cv.notify_all();
+}
+
+BaseType_t xTaskResumeFromISR(TaskHandle_t task)
+{
+    vTaskResume(task);
+    return pdFALSE;
+}
+
+// Threads not created as tasks (e.g. main) get a task the first time they need it
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    if (!t_currentTask)
+    {
+        t_currentTask = new HostTask;
+        t_currentTask->name = "hostThread";
+        registerTask(t_currentTask);
+        setCpuClock(t_currentTask);
+    }
+    return t_currentTask;
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return static_cast<TickType_t>(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->name.c_str();
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    (void)task;
+    return 0;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks()
+{
+    // The registered tasks (the threads that have used the FreeRTOS API) and the idle tasks
+    TaskList &list{taskList()};
+    const std::lock_guard<std::mutex> lock{list.mutex};
+    UBaseType_t count{portNUM_PROCESSORS};
+    for (const HostTask *const task : list.tasks)
+        if (!task->deleted)
+            count++;
+    return count;
+}
+
+BaseType_t xPortGetCoreID() { return 0; }
+
+namespace
+{
+
+    HostTask *idleTask(const UBaseType_t cpu)
+    {
+        static HostTask *const s_idleTasks[portNUM_PROCESSORS]{new HostTask, new HostTask};
+        HostTask *const task{s_idleTasks[cpu]};
+        if (task->name.empty())
+        {
+            task->name = "IDLE" + std::to_string(cpu);
+            task->core = cpu;
+        }
+        return task;
+    }
+
+    uint32_t cpuTimeUs(const HostTask *const task)
+    {
+        timespec time;
+        if (!task->hasCpuClock || clock_gettime(task->cpuClock, &time))
+            return 0;
+        return static_cast<uint32_t>(time.tv_sec * 1000000ULL + time.tv_nsec / 1000);
+    }
+
+} // namespace
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime)
+{
+    TaskList &list{taskList()};
+    const std::lock_guard<std::mutex> lock{list.mutex};
+    const uint32_t nowUs{static_cast<uint32_t>(esp_timer_get_time())};
+    uint64_t busyUs[portNUM_PROCESSORS]{};
+    // Like FreeRTOS, nothing is reported if the array can not hold every task
+    UBaseType_t taskCount{portNUM_PROCESSORS};
+    for (const HostTask *const task : list.tasks)
+        if (!task->deleted)
+            taskCount++;
+    if (arraySize < taskCount)
+        return 0;
+    UBaseType_t count{0};
+    const auto add{[&](HostTask *const task, const uint32_t runTimeUs)
+                   {
+                       TaskStatus_t &status{taskStatusArray[count++]};
+                       status.xHandle = task;
+                       status.pcTaskName = task->name.c_str();
+                       status.xTaskNumber = task->number;
+                       status.eCurrentState = task == t_currentTask ? eRunning : task->suspended ? eSuspended
+                                                                                                : eBlocked;
+                       status.uxCurrentPriority = task->priority;
+                       status.uxBasePriority = task->priority;
+                       status.ulRunTimeCounter = runTimeUs;
+                       status.pxStackBase = nullptr;
+                       status.usStackHighWaterMark = 0;
+                       status.xCoreID = task->core;
+                   }};
+    for (HostTask *const task : list.tasks)
+    {
+        if (task->deleted)
+            continue;
+        const uint32_t runTimeUs{cpuTimeUs(task)};
+        busyUs[task->core == 1 ? 1 : 0] += runTimeUs;
+        add(task, runTimeUs);
+    }
+    for (UBaseType_t cpu{0}; cpu < portNUM_PROCESSORS; cpu++)
+        add(idleTask(cpu), busyUs[cpu] < nowUs ? static_cast<uint32_t>(nowUs - busyUs[cpu]) : 0);
+    if (totalRunTime)
+        *totalRunTime = nowUs;
+    return count;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpu) { return idleTask(cpu); }
+
+namespace
+{
+
+    // Held while the interrupts are masked
+    std::recursive_mutex s_interruptMaskMutex;
+
+} // namespace
+
+UBaseType_t xPortSetInterruptMaskFromISR()
+{
+    s_interruptMaskMutex.lock();
+    return 0;
+}
+
+void vPortClearInterruptMaskFromISR(UBaseType_t state)
+{
+    (void)state;
+    s_interruptMaskMutex.unlock();
+}
+
+void vTaskSetTimeOutState(TimeOut_t *timeOut)
+{
+    timeOut->start = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *timeOut, TickType_t *ticksToWait)
+{
+    if (*ticksToWait == portMAX_DELAY)
+        return pdFALSE;
+    const TickType_t now{xTaskGetTickCount()};
+    const TickType_t elapsed{now - timeOut->start};
+    if (elapsed >= *ticksToWait)
+    {
+        *ticksToWait = 0;
+        return pdTRUE;
+    }
+    *ticksToWait -= elapsed;
+    timeOut->start = now;
+    return pdFALSE;
+}
+
+// Notifications
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    honorSuspension();
+    HostTask *const task{xTaskGetCurrentTaskHandle()};
+    std::unique_lock<std::mutex> lock{task->mutex};
+    if (!waitFor(lock, task->cv, ticksToWait, [task]()
+                 { return task->notifyValue != 0; }))
+        return 0;
+    const uint32_t value{task->notifyValue};
+    task->notifyValue = clearCountOnExit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        const std::lock_guard<std::mutex> lock{task->mutex};
+        task->notifyValue++;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken)
+        *higherPriorityTaskWoken = pdTRUE;
+}
+
+// Semaphores
+
+struct HostSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t count;
+    const uint32_t maxCount;
+
+    HostSemaphore(const uint32_t initialCount, const uint32_t maxCount)
+        : count(initialCount),
+          maxCount(maxCount) {}
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore(0, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer)
+{
+    (void)buffer;
+    return xSemaphoreCreateBinary();
+}
+// Mutexes are binary semaphores given on creation (without priority inheritance)
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new HostSemaphore(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer)
+{
+    (void)buffer;
+    return xSemaphoreCreateMutex();
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    if (ticksToWait)
+        honorSuspension();
+    std::unique_lock<std::mutex> lock{semaphore->mutex};
+    if (!waitFor(lock, semaphore->cv, ticksToWait, [semaphore]()
+                 { return semaphore->count != 0; }))
+        return pdFALSE;
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken)
+{
+    (void)higherPriorityTaskWoken;
+    const std::lock_guard<std::mutex> lock{semaphore->mutex};
+    if (!semaphore->count)
+        return pdFALSE;
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    {
+        const std::lock_guard<std::mutex> lock{semaphore->mutex};
+        if (semaphore->count == semaphore->maxCount)
+            return pdFALSE;
+        semaphore->count++;
+    }
+    // Wake up the peekers too
+    semaphore->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken)
+{
+    const BaseType_t given{xSemaphoreGive(semaphore)};
+    if (given && higherPriorityTaskWoken)
+        *higherPriorityTaskWoken = pdTRUE;
+    return given;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore)
+{
+    const std::lock_guard<std::mutex> lock{semaphore->mutex};
+    return semaphore->count;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *buffer, TickType_t ticksToWait)
+{
+    (void)buffer;
+    if (ticksToWait)
+        honorSuspension();
+    std::unique_lock<std::mutex> lock{queue->mutex};
+    return waitFor(lock, queue->cv, ticksToWait, [queue]()
+                   { return queue->count != 0; });
+}
+
+// Timers. Every service is a thread that runs the callbacks of its timers in order of expiry
+
+namespace
+{
+
+    struct TimerService;
+
+} // namespace
+
+struct HostTimer
+{
+    TimerService *service;
+    esp_timer_cb_t callback;
+    void *arg;
+    bool armed{false};
+    uint64_t expiryUs{0};
+    // Period of a periodic timer, 0 if it is a one-shot timer
+    uint64_t periodUs{0};
+};
+
+namespace
+{
+
+    struct TimerService
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<HostTimer *> timers;
+        std::once_flag started;
+        // Timer whose callback is running, and the thread that runs the callbacks
+        HostTimer *running{nullptr};
+        std::condition_variable callbackDone;
+        std::thread::id threadId;
+
+        HostTimer *create(const esp_timer_cb_t callback, void *const arg)
+        {
+            std::call_once(started, [this]()
+                           { std::thread(&TimerService::run, this).detach(); });
+            HostTimer *const timer{new HostTimer{this, callback, arg}};
+            const std::lock_guard<std::mutex> lock{mutex};
+            timers.push_back(timer);
+            return timer;
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            threadId = std::this_thread::get_id();
+            while (true)
+            {
+                HostTimer *next{nullptr};
+                for (HostTimer *const timer : timers)
+                    if (timer->armed && (!next || timer->expiryUs < next->expiryUs))
+                        next = timer;
+                if (!next)
+                {
+                    cv.wait(lock);
+                    continue;
+                }
+                const uint64_t now{static_cast<uint64_t>(esp_timer_get_time())};
+                if (next->expiryUs > now)
+                {
+                    cv.wait_for(lock, std::chrono::microseconds(next->expiryUs - now));
+                    continue;
+                }
+                if (next->periodUs)
+                    next->expiryUs += next->periodUs;
+                else
+                    next->armed = false;
+                // The callback may start or stop timers
+                running = next;
+                lock.unlock();
+                next->callback(next->arg);
+                lock.lock();
+                running = nullptr;
+                callbackDone.notify_all();
+            }
+        }
+    };
+
+    // esp_timer task, FreeRTOS timer service task and hardware timers. They are never
+    // destroyed (their threads keep waiting on them after "main()" returns) and are
+    // created on first use, so static objects of the sketch can use them
+    template <uint8_t Id>
+    TimerService &timerService()
+    {
+        static TimerService *const service{new TimerService};
+        return *service;
+    }
+    TimerService &espTimers() { return timerService<0>(); }
+    TimerService &freeRtosTimers() { return timerService<1>(); }
+    TimerService &hwTimers() { return timerService<2>(); }
+
+    esp_err_t startTimer(HostTimer *const timer, const uint64_t timeoutUs, const uint64_t periodUs)
+    {
+        {
+            const std::lock_guard<std::mutex> lock{timer->service->mutex};
+            if (timer->armed)
+                return ESP_ERR_INVALID_STATE;
+            timer->armed = true;
+            timer->expiryUs = esp_timer_get_time() + timeoutUs;
+            timer->periodUs = periodUs;
+        }
+        timer->service->cv.notify_one();
+        return ESP_OK;
+    }
+
+    void deleteTimer(HostTimer *const timer)
+    {
+        TimerService &service{*timer->service};
+        std::unique_lock<std::mutex> lock{service.mutex};
+        // A running callback completes before its timer is freed (unless the callback deletes it)
+        if (std::this_thread::get_id() != service.threadId)
+            service.callbackDone.wait(lock, [&service, timer]()
+                                      { return service.running != timer; });
+        for (auto it{service.timers.begin()}; it != service.timers.end(); it++)
+        {
+            if (*it == timer)
+            {
+                service.timers.erase(it);
+                break;
+            }
+        }
+        delete timer;
+    }
+
+} // namespace
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle)
+{
+    *handle = espTimers().create(args->callback, args->arg);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs)
+{
+    return startTimer(timer, timeoutUs, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs)
+{
+    return startTimer(timer, periodUs, periodUs);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    const std::lock_guard<std::mutex> lock{timer->service->mutex};
+    if (!timer->armed)
+        return ESP_ERR_INVALID_STATE;
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    deleteTimer(timer);
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - s_startTime).count();
+}
+
+// FreeRTOS software timers
+
+struct HostSoftwareTimer
+{
+    std::string name;
+    TickType_t period;
+    const bool autoReload;
+    void *const timerId;
+    const TimerCallbackFunction_t callback;
+    HostTimer *timer{nullptr};
+};
+
+namespace
+{
+
+    void softwareTimerCallback(void *const arg)
+    {
+        HostSoftwareTimer *const timer{static_cast<HostSoftwareTimer *>(arg)};
+        timer->callback(timer);
+    }
+
+} // namespace
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *timerId,
+                           TimerCallbackFunction_t callback)
+{
+    HostSoftwareTimer *const timer{new HostSoftwareTimer{name, period, autoReload != pdFALSE, timerId, callback}};
+    timer->timer = freeRtosTimers().create(softwareTimerCallback, timer);
+    return timer;
+}
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t autoReload, void *timerId,
+                                 TimerCallbackFunction_t callback, StaticTimer_t *buffer)
+{
+    (void)buffer;
+    return xTimerCreate(name, period, autoReload, timerId, callback);
+}
+
+// Starting an active timer restarts it
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait)
+{
+    (void)ticksToWait;
+    esp_timer_stop(timer->timer);
+    const uint64_t periodUs{timer->period * portTICK_PERIOD_MS * 1000ULL};
+    return startTimer(timer->timer, periodUs, timer->autoReload ? periodUs : 0) == ESP_OK;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait)
+{
+    (void)ticksToWait;
+    esp_timer_stop(timer->timer);
+    return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticksToWait)
+{
+    (void)ticksToWait;
+    deleteTimer(timer->timer);
+    delete timer;
+    return pdPASS;
+}
+
+// Changing the period starts the timer, as FreeRTOS does
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticksToWait)
+{
+    timer->period = period;
+    return xTimerStart(timer, ticksToWait);
+}
+
+BaseType_t xTimerChangePeriodFromISR(TimerHandle_t timer, TickType_t period, BaseType_t *higherPriorityTaskWoken)
+{
+    (void)higherPriorityTaskWoken;
+    return xTimerChangePeriod(timer, period, 0);
+}
+
+TickType_t xTimerGetPeriod(TimerHandle_t timer) { return timer->period; }
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+    const std::lock_guard<std::mutex> lock{timer->timer->service->mutex};
+    return timer->timer->armed;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer) { return timer->timerId; }
+
+// Hardware timers. The divider is ignored, the alarm value is taken as microseconds
+
+struct HostHwTimer
+{
+    void (*handler)(void){nullptr};
+    uint64_t alarmUs{0};
+    bool autoReload{false};
+    HostTimer *timer{nullptr};
+};
+
+namespace
+{
+
+    void hwTimerCallback(void *const arg)
+    {
+        HostHwTimer *const timer{static_cast<HostHwTimer *>(arg)};
+        if (timer->handler)
+            timer->handler();
+    }
+
+} // namespace
+
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp)
+{
+    (void)num;
+    (void)divider;
+    (void)countUp;
+    HostHwTimer *const timer{new HostHwTimer};
+    timer->timer = hwTimers().create(hwTimerCallback, timer);
+    return timer;
+}
+
+void timerEnd(hw_timer_t *timer)
+{
+    deleteTimer(timer->timer);
+    delete timer;
+}
+
+void timerAttachInterrupt(hw_timer_t *timer, void (*handler)(void), bool edge)
+{
+    (void)edge;
+    timer->handler = handler;
+}
+
+void timerDetachInterrupt(hw_timer_t *timer) { timer->handler = nullptr; }
+
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarmValue, bool autoReload)
+{
+    timer->alarmUs = alarmValue;
+    timer->autoReload = autoReload;
+}
+
+void timerAlarmEnable(hw_timer_t *timer)
+{
+    startTimer(timer->timer, timer->alarmUs, timer->autoReload ? timer->alarmUs : 0);
+}
+
+void timerAlarmDisable(hw_timer_t *timer) { esp_timer_stop(timer->timer); }
+
+// Heap. The ESP32 heap is simulated with the bytes allocated by the process (not the ones
+// allocated through ASan), so only its changes are meaningful
+
+namespace
+{
+
+    constexpr size_t s_SIMULATED_HEAP_SIZE{320 * 1024};
+    std::atomic<size_t> s_minimumFreeHeap{s_SIMULATED_HEAP_SIZE};
+
+} // namespace
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    const size_t used{mallinfo2().uordblks};
+    const size_t free{used < s_SIMULATED_HEAP_SIZE ? s_SIMULATED_HEAP_SIZE - used : 0};
+    size_t minimum{s_minimumFreeHeap.load()};
+    while (free < minimum && !s_minimumFreeHeap.compare_exchange_weak(minimum, free))
+        ;
+    return free;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    heap_caps_get_free_size(caps);
+    return s_minimumFreeHeap;
+}
+
+// The host heap does not tell its largest free block, the simulated one is not fragmented
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return heap_caps_get_free_size(caps); }
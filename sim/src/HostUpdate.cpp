@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include <Update.h>
+
+UpdateClass Update;
+
+namespace
+{
+
+    // First byte of an ESP32 application image
+    constexpr uint8_t s_IMAGE_MAGIC{0xE9};
+
+} // namespace
+
+bool UpdateClass::begin(size_t size, int command)
+{
+    (void)command;
+    m_image.clear();
+    m_error = UPDATE_ERROR_OK;
+    if (size == UPDATE_SIZE_UNKNOWN)
+        size = s_PARTITION_SIZE;
+    if (!size || size > s_PARTITION_SIZE)
+    {
+        m_error = UPDATE_ERROR_SIZE;
+        m_size = 0;
+        return false;
+    }
+    m_size = size;
+    m_image.reserve(size);
+    return true;
+}
+
+size_t UpdateClass::write(const uint8_t *data, size_t length)
+{
+    if (hasError() || !m_size)
+        return 0;
+    if (length > m_size - m_image.size())
+    {
+        m_error = UPDATE_ERROR_SPACE;
+        return 0;
+    }
+    if (m_image.empty() && length && data[0] != s_IMAGE_MAGIC)
+    {
+        m_error = UPDATE_ERROR_MAGIC_BYTE;
+        return 0;
+    }
+    m_image.insert(m_image.end(), data, data + length);
+    return length;
+}
+
+// Like Arduino-ESP32, give up if the stream stays empty for 10 seconds
+size_t UpdateClass::writeStream(Stream &data)
+{
+    size_t written{0};
+    uint8_t timeouts{0};
+    uint8_t buffer[1024];
+    while (!isFinished() && !hasError())
+    {
+        const size_t available{static_cast<size_t>(data.available())};
+        if (!available)
+        {
+            if (timeouts++ >= 100)
+            {
+                m_error = UPDATE_ERROR_STREAM;
+                break;
+            }
+            delay(100);
+            continue;
+        }
+        timeouts = 0;
+        const size_t toRead{std::min({available, sizeof(buffer), m_size - m_image.size()})};
+        const size_t read{data.readBytes(buffer, toRead)};
+        if (write(buffer, read) != read)
+            break;
+        written += read;
+    }
+    return written;
+}
+
+bool UpdateClass::end(bool evenIfRemaining)
+{
+    if (hasError() || !m_size)
+        return false;
+    if (!isFinished() && !evenIfRemaining)
+    {
+        m_error = UPDATE_ERROR_ABORT;
+        return false;
+    }
+    m_installed = m_image;
+    m_size = 0;
+    return true;
+}
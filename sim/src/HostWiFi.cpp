@@ -0,0 +1,265 @@
+#include <WiFi.h>
+
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "HostWiFi.h"
+
+WiFiClass WiFi;
+
+namespace
+{
+
+    // Item of the event task: an event or a connection attempt
+    struct Item
+    {
+        bool attempt;
+        arduino_event_id_t event;
+        uint8_t reason;
+        // Time at which the item is processed
+        int64_t dueUs;
+    };
+
+    struct Callback
+    {
+        wifi_event_id_t id;
+        arduino_event_id_t event;
+        WiFiEventFuncCb function;
+    };
+
+    std::mutex s_mutex;
+    // Never destroyed, the event task keeps waiting on it after "main()" returns
+    std::condition_variable &eventCv()
+    {
+        static std::condition_variable *const cv{new std::condition_variable};
+        return *cv;
+    }
+    std::deque<Item> s_items;
+    std::vector<Callback> s_callbacks;
+    wifi_event_id_t s_nextCallbackId{1};
+    TaskHandle_t s_eventTask{nullptr};
+
+    // Access point
+    std::string s_apSsid;
+    std::string s_apPassphrase;
+    bool s_apEnabled{true};
+    uint32_t s_connectDelayMs{200};
+
+    // Station
+    wifi_mode_t s_mode{WIFI_MODE_NULL};
+    bool s_autoReconnect{true};
+    std::string s_ssid;
+    std::string s_passphrase;
+    wl_status_t s_status{WL_IDLE_STATUS};
+
+    // Called with "s_mutex" taken
+    void post(const Item &item)
+    {
+        s_items.push_back(item);
+        eventCv().notify_one();
+    }
+
+    void postEvent(const arduino_event_id_t event, const uint8_t reason = 0)
+    {
+        post({false, event, reason, 0});
+    }
+
+    void postAttempt()
+    {
+        post({true, ARDUINO_EVENT_MAX, 0, esp_timer_get_time() + s_connectDelayMs * 1000LL});
+    }
+
+    // Disconnect the station and reconnect it if it was asked to. Called with "s_mutex" taken
+    void disconnectStation(const uint8_t reason, const wl_status_t status)
+    {
+        s_status = status;
+        postEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, reason);
+        if (s_autoReconnect && reason != WIFI_REASON_ASSOC_LEAVE)
+            postAttempt();
+    }
+
+    // Associate with the access point. Called with "s_mutex" taken
+    void attemptConnection()
+    {
+        if (s_mode != WIFI_MODE_STA && s_mode != WIFI_MODE_APSTA)
+            return;
+        if (s_status == WL_CONNECTED)
+            return;
+        if (!s_apEnabled || s_ssid != s_apSsid)
+        {
+            s_status = WL_NO_SSID_AVAIL;
+            postEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND);
+            return;
+        }
+        if (s_passphrase != s_apPassphrase)
+        {
+            s_status = WL_CONNECT_FAILED;
+            postEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_AUTH_FAIL);
+            return;
+        }
+        s_status = WL_CONNECTED;
+        postEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+        postEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    }
+
+    void eventTask(void *const parameters)
+    {
+        (void)parameters;
+        std::unique_lock<std::mutex> lock{s_mutex};
+        while (true)
+        {
+            eventCv().wait(lock, []()
+                        { return !s_items.empty(); });
+            const Item item{s_items.front()};
+            const int64_t waitUs{item.dueUs - esp_timer_get_time()};
+            if (waitUs > 0)
+            {
+                eventCv().wait_for(lock, std::chrono::microseconds(waitUs));
+                continue;
+            }
+            s_items.pop_front();
+            if (item.attempt)
+            {
+                attemptConnection();
+                continue;
+            }
+            arduino_event_info_t info{};
+            info.wifi_sta_disconnected.reason = item.reason;
+            // Copy the callbacks, they may register new ones
+            const std::vector<Callback> callbacks{s_callbacks};
+            lock.unlock();
+            for (const Callback &callback : callbacks)
+                if (callback.event == ARDUINO_EVENT_MAX || callback.event == item.event)
+                    callback.function(item.event, info);
+            lock.lock();
+        }
+    }
+
+    // Called with "s_mutex" taken
+    void startEventTask()
+    {
+        if (!s_eventTask)
+            xTaskCreatePinnedToCore(eventTask, "arduino_events", 4 * 1024, nullptr, 19, &s_eventTask, tskNO_AFFINITY);
+    }
+
+} // namespace
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event)
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    startEventTask();
+    s_callbacks.push_back({s_nextCallbackId, event, callback});
+    return s_nextCallbackId++;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id)
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    for (auto it{s_callbacks.begin()}; it != s_callbacks.end(); it++)
+    {
+        if (it->id == id)
+        {
+            s_callbacks.erase(it);
+            break;
+        }
+    }
+}
+
+bool WiFiClass::mode(wifi_mode_t mode)
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    startEventTask();
+    if (mode == s_mode)
+        return true;
+    if (mode == WIFI_MODE_NULL && s_status == WL_CONNECTED)
+        disconnectStation(WIFI_REASON_ASSOC_LEAVE, WL_DISCONNECTED);
+    s_mode = mode;
+    postEvent(mode == WIFI_MODE_NULL ? ARDUINO_EVENT_WIFI_STA_STOP : ARDUINO_EVENT_WIFI_STA_START);
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode()
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    return s_mode;
+}
+
+bool WiFiClass::setAutoReconnect(bool autoReconnect)
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    s_autoReconnect = autoReconnect;
+    return true;
+}
+
+bool WiFiClass::getAutoReconnect()
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    return s_autoReconnect;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase)
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    startEventTask();
+    if (s_mode == WIFI_MODE_NULL)
+        s_mode = WIFI_MODE_STA;
+    s_ssid = ssid ? ssid : "";
+    s_passphrase = passphrase ? passphrase : "";
+    if (s_status == WL_CONNECTED)
+        disconnectStation(WIFI_REASON_ASSOC_LEAVE, WL_DISCONNECTED);
+    postAttempt();
+    return s_status;
+}
+
+bool WiFiClass::disconnect(bool wifiOff)
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    if (s_status == WL_CONNECTED)
+        disconnectStation(WIFI_REASON_ASSOC_LEAVE, WL_DISCONNECTED);
+    if (wifiOff)
+        s_mode = WIFI_MODE_NULL;
+    return true;
+}
+
+wl_status_t WiFiClass::status()
+{
+    const std::lock_guard<std::mutex> lock{s_mutex};
+    return s_status;
+}
+
+bool WiFiClass::isConnected() { return status() == WL_CONNECTED; }
+
+namespace HostWiFi
+{
+
+    void setAccessPoint(const char *const ssid, const char *const passphrase)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        s_apSsid = ssid;
+        s_apPassphrase = passphrase ? passphrase : "";
+    }
+
+    void setAccessPointEnabled(const bool enabled)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        s_apEnabled = enabled;
+        if (!enabled && s_status == WL_CONNECTED)
+            disconnectStation(WIFI_REASON_BEACON_TIMEOUT, WL_CONNECTION_LOST);
+    }
+
+    void setConnectDelayMs(const uint32_t delayMs)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        s_connectDelayMs = delayMs;
+    }
+
+    void dropStation(const uint8_t reason)
+    {
+        const std::lock_guard<std::mutex> lock{s_mutex};
+        if (s_status == WL_CONNECTED)
+            disconnectStation(reason, WL_CONNECTION_LOST);
+    }
+
+} // namespace HostWiFi
@@ -0,0 +1,89 @@
+#include <NTPClient.h>
+
+namespace
+{
+
+    constexpr uint8_t s_NTP_PACKET_SIZE{48};
+    constexpr unsigned long s_SEVENTY_YEARS{2208988800UL};
+
+} // namespace
+
+NTPClient::NTPClient(WiFiUDP &udp, const char *poolServerName, long timeOffset, unsigned long updateIntervalMs)
+    : m_udp(udp),
+      m_poolServerName(poolServerName),
+      m_timeOffset(timeOffset),
+      m_updateIntervalMs(updateIntervalMs) {}
+
+void NTPClient::begin(uint16_t port)
+{
+    m_port = port;
+    m_udp.begin(m_port);
+    m_udpSetup = true;
+}
+
+void NTPClient::end()
+{
+    m_udp.stop();
+    m_udpSetup = false;
+}
+
+bool NTPClient::update()
+{
+    if (!m_lastUpdateMs || millis() - m_lastUpdateMs >= m_updateIntervalMs)
+    {
+        if (!m_udpSetup)
+            begin(m_port);
+        return forceUpdate();
+    }
+    return false;
+}
+
+// Send a request and wait up to one second for the answer, as the library does
+bool NTPClient::forceUpdate()
+{
+    // Drop the answers to older requests
+    while (m_udp.parsePacket())
+        ;
+    uint8_t packet[s_NTP_PACKET_SIZE]{};
+    packet[0] = 0xE3; // LI unsynchronized, version 4, client mode
+    packet[2] = 6;    // Polling interval
+    packet[3] = 0xEC; // Precision
+    m_udp.beginPacket(m_poolServerName, 123);
+    m_udp.write(packet, sizeof(packet));
+    m_udp.endPacket();
+    int size{0};
+    for (uint8_t tries{0}; (size = m_udp.parsePacket()) == 0; tries++)
+    {
+        if (tries > 100)
+            return false;
+        delay(10);
+    }
+    if (size < s_NTP_PACKET_SIZE)
+        return false;
+    m_udp.read(packet, sizeof(packet));
+    // Transmit timestamp (seconds since 1900)
+    const unsigned long secondsSince1900{static_cast<unsigned long>(packet[40]) << 24 |
+                                         static_cast<unsigned long>(packet[41]) << 16 |
+                                         static_cast<unsigned long>(packet[42]) << 8 |
+                                         packet[43]};
+    m_lastUpdateMs = millis();
+    m_currentEpoch = secondsSince1900 - s_SEVENTY_YEARS;
+    return true;
+}
+
+unsigned long NTPClient::getEpochTime() const
+{
+    return m_timeOffset + m_currentEpoch + (millis() - m_lastUpdateMs) / 1000;
+}
+
+int NTPClient::getDay() const { return ((getEpochTime() / 86400L) + 4) % 7; }
+int NTPClient::getHours() const { return (getEpochTime() % 86400L) / 3600; }
+int NTPClient::getMinutes() const { return (getEpochTime() % 3600) / 60; }
+int NTPClient::getSeconds() const { return getEpochTime() % 60; }
+
+String NTPClient::getFormattedTime() const
+{
+    char text[9];
+    std::snprintf(text, sizeof(text), "%02d:%02d:%02d", getHours(), getMinutes(), getSeconds());
+    return String(text);
+}
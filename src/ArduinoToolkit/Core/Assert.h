@@ -3,18 +3,20 @@
 #include "ArduinoToolkit/Core/Base.h"
 
 #ifdef DEBUG
+// Failures are logged on behalf of Core, so the inline functions of the headers can assert too
+
 // Macro that disables scheduler and enters an infinite loop if the given condition 'x' is not met
-#define ASSERT(x)                                 \
-    if (!(x))                                     \
-    {                                             \
-        AT_LOG_E("ASSERT not fulfilled: %s", #x); \
+#define ASSERT(x)                                                  \
+    if (!(x))                                                      \
+    {                                                              \
+        AT_LOG_MODULE_AT(Core, 1, "ASSERT not fulfilled: %s", #x); \
     }
 
 // Macro that disables scheduler and enters an infinite loop if the given condition 'x' is not met
-#define DEBUG_ASSERT(x)                                 \
-    if (!(x))                                           \
-    {                                                   \
-        AT_LOG_E("DEBUG_ASSERT not fulfilled: %s", #x); \
+#define DEBUG_ASSERT(x)                                                  \
+    if (!(x))                                                            \
+    {                                                                    \
+        AT_LOG_MODULE_AT(Core, 1, "DEBUG_ASSERT not fulfilled: %s", #x); \
     }
 #else
 #define ASSERT(x) // Show warning or error here
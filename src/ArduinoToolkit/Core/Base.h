@@ -3,4 +3,5 @@
 #include <Arduino.h>
 
 // Globals
-static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+// Declared inline so every translation unit shares the same spinlock
+inline portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <memory>
+#include <atomic>
+#include <new>
+#include <utility>
 
 #include "ArduinoToolkit/Core/Base.h"
 #include "ArduinoToolkit/Core/Log.h"
@@ -8,51 +10,105 @@
 namespace AT
 {
 
+    enum class DaemonState : uint8_t
+    {
+        Stopped,
+        Starting,
+        Running,
+        Suspending,
+        Suspended,
+        Resuming,
+        Stopping
+    };
+
+    /**
+     * @brief Base of the singleton daemons, e.g. "class WiFiDaemon : public Daemon<WiFiDaemon>".
+     * The daemon is built in static storage by the first call to "instance()" (only one of the
+     * tasks that race for it builds it, the others wait) and never destroyed, so no heap is used
+     * and later calls are a single load.
+     * "start()", "stop()", "suspend()" and "resume()" move it between the states and call the
+     * hooks of CRTP, run by the task that makes the transition:
+     *  - "bool onStart(Args...)": take the arguments of "start()". Return false to stay stopped.
+     *  - "void onStop()", "void onSuspend()" and "void onResume()" (optional).
+     * A transition only starts from its valid states, so a call that finds another transition
+     * in progress (or the daemon already in the requested state) fails and returns false.
+     * CRTP keeps its constructor private and befriends Daemon<CRTP>.
+     */
     template <typename CRTP>
     class Daemon
     {
     public:
+        // The daemon, built the first time with "args"
         template <typename... Args>
-        static std::shared_ptr<CRTP> instance(Args &&...args)
+        static CRTP &instance(Args &&...args)
         {
-            std::shared_ptr<CRTP> sharedInstance;
-            if (isInstanced())
-            {
-                sharedInstance = s_instance.lock();
-                AT_LOG_W("Daemon already created");
-            }
-            else
-            {
-                // Thanks to Robert Puskas for this temporary subclass that allows
-                // to use std::make_unique and std::make_shared with private constructors
-                struct MkShrdEnablr : public CRTP
-                {
-                    MkShrdEnablr(Args &&...args)
-                        : CRTP(std::forward<Args>(args)...){};
-                };
-                sharedInstance = std::make_shared<MkShrdEnablr>(std::forward<Args>(args)...);
-                s_instance = sharedInstance;
-            }
-            return sharedInstance;
+            CRTP *const daemon{s_instance.load(std::memory_order_acquire)};
+            if (daemon)
+                return *daemon;
+            return construct(std::forward<Args>(args)...);
         }
 
-        inline static bool isInstanced() { return s_instance.expired() ? false : true; }
+        inline static bool isInstanced() { return s_instance.load(std::memory_order_acquire); }
 
         static void assertIsInstanced()
         {
             if (!isInstanced())
             {
-                AT_LOG_E("Daemon not created");
+                AT_LOG_MODULE_AT(Core, 1, "Daemon not created");
                 ESP_ERROR_CHECK(ESP_ERR_INVALID_STATE);
             }
         }
 
+        template <typename... Args>
+        bool start(Args &&...args)
+        {
+            if (!beginTransition(DaemonState::Starting))
+                return false;
+            const bool started{static_cast<CRTP *>(this)->onStart(std::forward<Args>(args)...)};
+            m_state.store(started ? DaemonState::Running : DaemonState::Stopped, std::memory_order_release);
+            return started;
+        }
+
+        bool stop()
+        {
+            if (!beginTransition(DaemonState::Stopping))
+                return false;
+            static_cast<CRTP *>(this)->onStop();
+            m_state.store(DaemonState::Stopped, std::memory_order_release);
+            return true;
+        }
+
+        bool suspend()
+        {
+            if (!beginTransition(DaemonState::Suspending))
+                return false;
+            static_cast<CRTP *>(this)->onSuspend();
+            m_state.store(DaemonState::Suspended, std::memory_order_release);
+            return true;
+        }
+
+        bool resume()
+        {
+            if (!beginTransition(DaemonState::Resuming))
+                return false;
+            static_cast<CRTP *>(this)->onResume();
+            m_state.store(DaemonState::Running, std::memory_order_release);
+            return true;
+        }
+
+        inline DaemonState getState() const { return m_state.load(std::memory_order_acquire); }
+        inline bool isRunning() const { return getState() == DaemonState::Running; }
+
     protected:
         // Constructor, default implementation
         Daemon() = default;
         // Destructor, default implementation
         ~Daemon() = default;
 
+        // Default hooks, hidden by the ones of CRTP
+        inline void onSuspend() {}
+        inline void onResume() {}
+
     private:
         // Copy constructor, deleted to prevent unintentional copies
         Daemon(const Daemon &) = delete;
@@ -63,11 +119,68 @@ namespace AT
         // Move assignment operator, deleted to prevent unintentional assignments
         Daemon &operator=(Daemon &&) = delete;
 
+        template <typename... Args>
+        static CRTP &construct(Args &&...args)
+        {
+            // Only zero initialized, so it is ready before any constructor runs
+            alignas(CRTP) static uint8_t s_storage[sizeof(CRTP)];
+            uint8_t expected{s_UNINITIALIZED};
+            if (s_onceState.compare_exchange_strong(expected, s_CONSTRUCTING, std::memory_order_acquire))
+            {
+                CRTP *const daemon{new (s_storage) CRTP(std::forward<Args>(args)...)};
+                s_instance.store(daemon, std::memory_order_release);
+                s_onceState.store(s_CONSTRUCTED, std::memory_order_release);
+                return *daemon;
+            }
+            // Another task is building it
+            while (s_onceState.load(std::memory_order_acquire) != s_CONSTRUCTED)
+                vTaskDelay(1);
+            return *s_instance.load(std::memory_order_acquire);
+        }
+
+        // States a transition can begin from
+        static constexpr bool canBegin(const DaemonState from, const DaemonState transition)
+        {
+            switch (transition)
+            {
+            case DaemonState::Starting:
+                return from == DaemonState::Stopped;
+            case DaemonState::Stopping:
+                return from == DaemonState::Running || from == DaemonState::Suspended;
+            case DaemonState::Suspending:
+                return from == DaemonState::Running;
+            case DaemonState::Resuming:
+                return from == DaemonState::Suspended;
+            default:
+                return false;
+            }
+        }
+
+        bool beginTransition(const DaemonState transition)
+        {
+            DaemonState state{m_state.load(std::memory_order_acquire)};
+            do
+            {
+                if (!canBegin(state, transition))
+                {
+                    AT_LOG_MODULE_AT(Core, 2, "Daemon can not begin transition %u from state %u",
+                                     static_cast<uint8_t>(transition), static_cast<uint8_t>(state));
+                    return false;
+                }
+            } while (!m_state.compare_exchange_weak(state, transition, std::memory_order_acq_rel));
+            return true;
+        }
+
     private:
-        static std::weak_ptr<CRTP> s_instance;
-    }; // class Daemon
+        static constexpr uint8_t s_UNINITIALIZED{0};
+        static constexpr uint8_t s_CONSTRUCTING{1};
+        static constexpr uint8_t s_CONSTRUCTED{2};
 
-    template <typename CRTP>
-    std::weak_ptr<CRTP> Daemon<CRTP>::s_instance;
+        // Declared inline so the singleton does not need a definition per daemon
+        static inline std::atomic<uint8_t> s_onceState{s_UNINITIALIZED};
+        static inline std::atomic<CRTP *> s_instance{nullptr};
+
+        std::atomic<DaemonState> m_state{DaemonState::Stopped};
+    }; // class Daemon
 
 } // namespace AT
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AT
+{
+
+    class DeadlineQueue;
+
+    // Intrusive node of a DeadlineQueue. The owner keeps it alive while it is registered
+    class Deadline
+    {
+    public:
+        using Callback = void (*)(void *const arg);
+
+        Deadline(const Callback callback, void *const arg)
+            : m_callback(callback),
+              m_arg(arg) {}
+
+        inline bool isScheduled() const { return m_heapIndex != s_NOT_SCHEDULED; }
+        inline bool isRegistered() const { return m_registered; }
+        inline uint64_t getTimeUs() const { return m_timeUs; }
+        inline void run() const { m_callback(m_arg); }
+
+    private:
+        static constexpr size_t s_NOT_SCHEDULED{SIZE_MAX};
+
+    private:
+        const Callback m_callback;
+        void *const m_arg;
+        uint64_t m_timeUs{0};
+        uint64_t m_periodUs{0};
+        size_t m_heapIndex{s_NOT_SCHEDULED};
+        bool m_registered{false};
+
+        friend class DeadlineQueue;
+    }; // class Deadline
+
+    /**
+     * @brief Binary min-heap of deadlines ordered by expiration time.
+     * Time is passed explicitly (in microseconds) so it can be driven by a virtual clock.
+     * Deadlines must be registered before they are scheduled so the heap storage is reserved
+     * up front and scheduling never allocates (it can be done inside a critical section).
+     * Scheduling a deadline that is not registered does nothing.
+     * The owned storage is grown by the caller with "growCapacity()" and "replaceStorage()", so
+     * it can allocate outside its critical section. With the storage supplied by the owner at
+     * most "capacity" deadlines can be registered.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class DeadlineQueue
+    {
+    public:
+        static constexpr uint64_t s_NEVER{UINT64_MAX};
+
+        DeadlineQueue() = default;
+        constexpr DeadlineQueue(Deadline **const storage, const size_t capacity)
+            : m_heap(storage),
+              m_capacity(capacity) {}
+
+        // Reserve room for a deadline. Return false if the storage is full (see "growCapacity()")
+        bool registerDeadline(Deadline &deadline)
+        {
+            if (m_registered == m_capacity)
+                return false;
+            deadline.m_registered = true;
+            m_registered++;
+            return true;
+        }
+        // Release the room of a deadline, cancelling it
+        void unregisterDeadline(Deadline &deadline)
+        {
+            if (!deadline.m_registered)
+                return;
+            cancel(deadline);
+            deadline.m_registered = false;
+            m_registered--;
+        }
+
+        // Capacity to grow the storage to before registering one more deadline,
+        // 0 if there is room or the storage supplied by the owner is full
+        size_t growCapacity() const
+        {
+            if (m_registered < m_capacity || (m_heap && !m_ownedStorage))
+                return 0;
+            return m_capacity ? 2 * m_capacity : 4;
+        }
+
+        // Move the heap to "storage", of at least "growCapacity()" entries.
+        // Return the previous storage so the caller frees it (e.g. outside its critical section)
+        std::unique_ptr<Deadline *[]> replaceStorage(std::unique_ptr<Deadline *[]> storage, const size_t capacity)
+        {
+            for (size_t i{0}; i < m_size; i++)
+                storage[i] = m_heap[i];
+            m_heap = storage.get();
+            m_capacity = capacity;
+            m_ownedStorage.swap(storage);
+            return storage;
+        }
+
+        // Schedule (or reschedule) a deadline at "timeUs". If "periodUs" is not 0 it is
+        // scheduled again "periodUs" after every expiration
+        void schedule(Deadline &deadline, const uint64_t timeUs, const uint64_t periodUs = 0)
+        {
+            if (!deadline.m_registered)
+                return;
+            deadline.m_timeUs = timeUs;
+            deadline.m_periodUs = periodUs;
+            if (deadline.isScheduled())
+            {
+                // The new time may be earlier or later than the previous one
+                siftUp(deadline.m_heapIndex);
+                siftDown(deadline.m_heapIndex);
+            }
+            else
+            {
+                m_heap[m_size] = &deadline;
+                deadline.m_heapIndex = m_size++;
+                siftUp(deadline.m_heapIndex);
+            }
+        }
+
+        void cancel(Deadline &deadline)
+        {
+            if (!deadline.isScheduled())
+                return;
+            const size_t index{deadline.m_heapIndex};
+            Deadline *const last{m_heap[--m_size]};
+            deadline.m_heapIndex = Deadline::s_NOT_SCHEDULED;
+            if (last != &deadline)
+            {
+                place(last, index);
+                siftUp(index);
+                siftDown(last->m_heapIndex);
+            }
+        }
+
+        // Time of the earliest deadline or s_NEVER if there is none
+        inline uint64_t nextTimeUs() const { return m_size ? m_heap[0]->m_timeUs : s_NEVER; }
+        inline size_t size() const { return m_size; }
+
+        /**
+         * @brief Remove the earliest deadline if it has expired.
+         * Periodic deadlines are scheduled again instead of removed.
+         *
+         * @param nowUs Current time.
+         * @return The expired deadline (to be run by the caller) or nullptr if there is none.
+         */
+        Deadline *popExpired(const uint64_t nowUs)
+        {
+            if (!m_size || m_heap[0]->m_timeUs > nowUs)
+                return nullptr;
+            Deadline *const deadline{m_heap[0]};
+            if (deadline->m_periodUs)
+            {
+                // Do not try to catch up with the periods that have been missed
+                const uint64_t nextTimeUs{deadline->m_timeUs + deadline->m_periodUs};
+                schedule(*deadline,
+                         nextTimeUs > nowUs ? nextTimeUs : nowUs + deadline->m_periodUs,
+                         deadline->m_periodUs);
+            }
+            else
+                cancel(*deadline);
+            return deadline;
+        }
+
+    private:
+        inline void place(Deadline *const deadline, const size_t index)
+        {
+            m_heap[index] = deadline;
+            deadline->m_heapIndex = index;
+        }
+
+        void siftUp(size_t index)
+        {
+            Deadline *const deadline{m_heap[index]};
+            while (index)
+            {
+                const size_t parent{(index - 1) / 2};
+                if (m_heap[parent]->m_timeUs <= deadline->m_timeUs)
+                    break;
+                place(m_heap[parent], index);
+                index = parent;
+            }
+            place(deadline, index);
+        }
+
+        void siftDown(size_t index)
+        {
+            Deadline *const deadline{m_heap[index]};
+            const size_t size{m_size};
+            while (true)
+            {
+                size_t child{2 * index + 1};
+                if (child >= size)
+                    break;
+                if (child + 1 < size && m_heap[child + 1]->m_timeUs < m_heap[child]->m_timeUs)
+                    child++;
+                if (deadline->m_timeUs <= m_heap[child]->m_timeUs)
+                    break;
+                place(m_heap[child], index);
+                index = child;
+            }
+            place(deadline, index);
+        }
+
+    private:
+        Deadline **m_heap{nullptr};
+        std::unique_ptr<Deadline *[]> m_ownedStorage;
+        size_t m_size{0};
+        size_t m_capacity{0};
+        size_t m_registered{0};
+    }; // class DeadlineQueue
+
+} // namespace AT
@@ -0,0 +1,169 @@
+#include "ArduinoToolkit/Core/DeadlineScheduler.h"
+
+#include <new>
+
+namespace AT
+{
+
+    // Static class members
+    std::atomic<esp_timer_handle_t> DeadlineScheduler::s_timer{nullptr};
+    portMUX_TYPE DeadlineScheduler::s_spinlock = portMUX_INITIALIZER_UNLOCKED;
+#ifdef AT_STATIC_ALLOCATION
+    Deadline *DeadlineScheduler::s_queueStorage[AT_MAX_DEADLINES];
+    DeadlineQueue DeadlineScheduler::s_queue{s_queueStorage, AT_MAX_DEADLINES};
+#else
+    DeadlineQueue DeadlineScheduler::s_queue;
+#endif
+    const Deadline *DeadlineScheduler::s_running{nullptr};
+    TaskHandle_t DeadlineScheduler::s_runningTask{nullptr};
+
+    // Run the expired deadlines and arm the timer for the next one
+    void DeadlineScheduler::timerCallback(void *const arg)
+    {
+        (void)arg;
+        const TaskHandle_t task{xTaskGetCurrentTaskHandle()};
+        while (true)
+        {
+            portENTER_CRITICAL(&s_spinlock);
+            const Deadline *const deadline{s_queue.popExpired(nowUs())};
+            // "remove()" waits while the deadline is running
+            s_running = deadline;
+            s_runningTask = task;
+            if (!deadline)
+            {
+                arm();
+                portEXIT_CRITICAL(&s_spinlock);
+                return;
+            }
+            portEXIT_CRITICAL(&s_spinlock);
+            // Run the callback outside the critical section so it can reschedule deadlines
+            deadline->run();
+        }
+    }
+
+    // Must be called inside the critical section
+    void DeadlineScheduler::arm()
+    {
+        const esp_timer_handle_t timer{s_timer.load(std::memory_order_acquire)};
+        esp_timer_stop(timer);
+        const uint64_t nextTimeUs{s_queue.nextTimeUs()};
+        if (nextTimeUs == DeadlineQueue::s_NEVER)
+            return;
+        const uint64_t now{nowUs()};
+        esp_timer_start_once(timer, nextTimeUs > now ? nextTimeUs - now : 0);
+    }
+
+    // Register a deadline. It must be removed before it is destroyed
+    void DeadlineScheduler::add(Deadline &deadline)
+    {
+        ASSERT(!deadline.isRegistered());
+        if (!s_timer.load(std::memory_order_acquire))
+        {
+            const esp_timer_create_args_t timerArgs{.callback = timerCallback,
+                                                    .arg = nullptr,
+                                                    .dispatch_method = ESP_TIMER_TASK,
+                                                    .name = "DeadlineScheduler",
+                                                    .skip_unhandled_events = true};
+            esp_timer_handle_t timer{nullptr};
+            ESP_ERROR_CHECK(esp_timer_create(&timerArgs, &timer));
+            // Another task may have created it meanwhile
+            esp_timer_handle_t expected{nullptr};
+            if (s_timer.compare_exchange_strong(expected, timer, std::memory_order_acq_rel))
+                AT_LOG_V("DeadlineScheduler timer created");
+            else
+                esp_timer_delete(timer);
+        }
+        while (true)
+        {
+            // The storage is replaced inside the critical section and freed outside of it
+            std::unique_ptr<Deadline *[]> storage;
+            portENTER_CRITICAL(&s_spinlock);
+            const bool registered{s_queue.registerDeadline(deadline)};
+            const size_t capacity{registered ? 0 : s_queue.growCapacity()};
+            portEXIT_CRITICAL(&s_spinlock);
+            if (registered)
+                return;
+            if (capacity)
+                storage.reset(new (std::nothrow) Deadline *[capacity]);
+            // The deadline stays unregistered, scheduling it does nothing.
+            // With AT_STATIC_ALLOCATION increase AT_MAX_DEADLINES if this fails
+            if (!storage)
+            {
+                AT_LOG_E("Could not register the deadline");
+                ASSERT(storage);
+                return;
+            }
+            portENTER_CRITICAL(&s_spinlock);
+            // Another task may have grown it meanwhile
+            if (s_queue.growCapacity() == capacity)
+                storage = s_queue.replaceStorage(std::move(storage), capacity);
+            portEXIT_CRITICAL(&s_spinlock);
+        }
+    }
+
+    // Unregister a deadline. Once it returns its callback is not running and will not run again
+    void DeadlineScheduler::remove(Deadline &deadline)
+    {
+        const TaskHandle_t task{xTaskGetCurrentTaskHandle()};
+        while (true)
+        {
+            portENTER_CRITICAL(&s_spinlock);
+            // A callback can remove its own deadline
+            if (s_running != &deadline || s_runningTask == task)
+            {
+                const uint64_t previousNextTimeUs{s_queue.nextTimeUs()};
+                s_queue.unregisterDeadline(deadline);
+                if (s_queue.nextTimeUs() != previousNextTimeUs)
+                    arm();
+                portEXIT_CRITICAL(&s_spinlock);
+                return;
+            }
+            portEXIT_CRITICAL(&s_spinlock);
+            vTaskDelay(1);
+        }
+    }
+
+    /**
+     * @brief Schedule (or reschedule) a registered deadline.
+     *
+     * @param deadline Deadline to schedule.
+     * @param delayUs Time from now until its callback is run.
+     * @param periodUs If not 0, the callback is run again every "periodUs".
+     */
+    void DeadlineScheduler::schedule(Deadline &deadline, const uint64_t delayUs, const uint64_t periodUs)
+    {
+        portENTER_CRITICAL(&s_spinlock);
+        scheduleLocked(deadline, delayUs, periodUs);
+        portEXIT_CRITICAL(&s_spinlock);
+    }
+
+    // Same as "schedule()", also from an ISR (or code that runs both in an ISR and in a task).
+    // It is not in IRAM, the ISR must not run while the flash cache is disabled
+    void DeadlineScheduler::scheduleFromISR(Deadline &deadline, const uint64_t delayUs, const uint64_t periodUs)
+    {
+        portENTER_CRITICAL_SAFE(&s_spinlock);
+        scheduleLocked(deadline, delayUs, periodUs);
+        portEXIT_CRITICAL_SAFE(&s_spinlock);
+    }
+
+    // Must be called inside the critical section
+    void DeadlineScheduler::scheduleLocked(Deadline &deadline, const uint64_t delayUs, const uint64_t periodUs)
+    {
+        const uint64_t previousNextTimeUs{s_queue.nextTimeUs()};
+        s_queue.schedule(deadline, nowUs() + delayUs, periodUs);
+        // Only re-arm the timer if the earliest deadline has changed
+        if (s_queue.nextTimeUs() != previousNextTimeUs)
+            arm();
+    }
+
+    void DeadlineScheduler::cancel(Deadline &deadline)
+    {
+        portENTER_CRITICAL(&s_spinlock);
+        const uint64_t previousNextTimeUs{s_queue.nextTimeUs()};
+        s_queue.cancel(deadline);
+        if (s_queue.nextTimeUs() != previousNextTimeUs)
+            arm();
+        portEXIT_CRITICAL(&s_spinlock);
+    }
+
+} // namespace AT
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+
+#include "ArduinoToolkit/Core/Assert.h"
+#include "ArduinoToolkit/Core/Log.h"
+#include "ArduinoToolkit/Core/DeadlineQueue.h"
+
+// Maximum number of deadlines registered at once when built with AT_STATIC_ALLOCATION
+#ifndef AT_MAX_DEADLINES
+#define AT_MAX_DEADLINES 64
+#endif
+
+namespace AT
+{
+
+    /**
+     * @brief Shared microsecond resolution scheduler built on a single esp_timer.
+     * Every deadline of the toolkit is kept in one min-heap and the esp_timer is armed
+     * for the earliest one, so there are no FreeRTOS software timers (nor timer service
+     * queue commands) involved. Callbacks run in the esp_timer task and must be short.
+     * "remove()" waits until the callback of the deadline is not running, so the owner can be
+     * destroyed right after it.
+     * With AT_STATIC_ALLOCATION the heap of deadlines has a fixed capacity of AT_MAX_DEADLINES,
+     * the only allocation is the esp_timer, created when the first deadline is registered.
+     */
+    class DeadlineScheduler
+    {
+    public:
+        static void add(Deadline &deadline);
+        static void remove(Deadline &deadline);
+
+        static void schedule(Deadline &deadline, const uint64_t delayUs, const uint64_t periodUs = 0);
+        static void scheduleFromISR(Deadline &deadline, const uint64_t delayUs, const uint64_t periodUs = 0);
+        static void cancel(Deadline &deadline);
+
+        static inline uint64_t nowUs() { return esp_timer_get_time(); }
+
+    private:
+        static void timerCallback(void *const arg);
+        static void arm();
+        static void scheduleLocked(Deadline &deadline, const uint64_t delayUs, const uint64_t periodUs);
+
+    private:
+        static std::atomic<esp_timer_handle_t> s_timer;
+        static portMUX_TYPE s_spinlock;
+        static DeadlineQueue s_queue;
+        // Deadline whose callback is running and task that runs it, protected by "s_spinlock"
+        static const Deadline *s_running;
+        static TaskHandle_t s_runningTask;
+#ifdef AT_STATIC_ALLOCATION
+        static Deadline *s_queueStorage[AT_MAX_DEADLINES];
+#endif
+    }; // class DeadlineScheduler
+
+} // namespace AT
@@ -0,0 +1,174 @@
+#include "ArduinoToolkit/Core/DeferredLog.h"
+
+#include "ArduinoToolkit/Core.h"
+
+namespace AT
+{
+
+    static_assert(!(AT_DEFERRED_LOG_BUFFER_WORDS & (AT_DEFERRED_LOG_BUFFER_WORDS - 1)),
+                  "AT_DEFERRED_LOG_BUFFER_WORDS must be a power of two");
+    static_assert(AT_DEFERRED_LOG_MAX_SITES <= UINT16_MAX, "The id of a log site is 16 bits long");
+
+    // Static class members
+    DeferredLog::Config DeferredLog::s_config;
+    TaskHandle_t DeferredLog::s_taskHandle{nullptr};
+    uint32_t DeferredLog::s_storage[portNUM_PROCESSORS][AT_DEFERRED_LOG_BUFFER_WORDS];
+    // Assigned at compile time so records can be logged before "begin()" (even by static constructors)
+    SPSCRingBuffer<uint32_t> DeferredLog::s_buffers[portNUM_PROCESSORS]{
+        {s_storage[0], AT_DEFERRED_LOG_BUFFER_WORDS},
+#if portNUM_PROCESSORS > 1
+        {s_storage[1], AT_DEFERRED_LOG_BUFFER_WORDS},
+#endif
+    };
+    LogSite *DeferredLog::s_sites[AT_DEFERRED_LOG_MAX_SITES];
+    std::atomic<uint16_t> DeferredLog::s_siteCount{0};
+    uint32_t DeferredLog::s_sentSites[(AT_DEFERRED_LOG_MAX_SITES + 31) / 32];
+    SemaphoreHandle_t DeferredLog::s_drainMutex{nullptr};
+#ifdef AT_STATIC_ALLOCATION
+    StaticSemaphore_t DeferredLog::s_drainMutexBuffer;
+    StackType_t DeferredLog::s_taskStack[s_TASK_STACK_SIZE];
+    StaticTask_t DeferredLog::s_taskBuffer;
+#endif
+
+    // Give an id to a site. Return 0 if there are no ids left
+    uint16_t IRAM_ATTR DeferredLog::registerSite(LogSite &site)
+    {
+        const uint16_t id{static_cast<uint16_t>(s_siteCount.fetch_add(1, std::memory_order_relaxed) + 1)};
+        if (id >= AT_DEFERRED_LOG_MAX_SITES)
+        {
+            s_siteCount.store(AT_DEFERRED_LOG_MAX_SITES, std::memory_order_relaxed);
+            return 0;
+        }
+        // The site is stored before its id is published (by its first record)
+        s_sites[id] = &site;
+        // Two contexts may register the same site at once, the id of the first one is kept
+        uint16_t expected{0};
+        if (!site.id.compare_exchange_strong(expected, id, std::memory_order_acq_rel))
+            return expected;
+        return id;
+    }
+
+    // Copy a record into the buffer of the current core
+    void IRAM_ATTR DeferredLog::push(const uint32_t *const words, const size_t count)
+    {
+        // Masking the interrupts of this core makes its writers take turns. The core is read
+        // inside, so the task can not be moved to the other one meanwhile
+        const UBaseType_t interruptState{portSET_INTERRUPT_MASK_FROM_ISR()};
+        s_buffers[xPortGetCoreID()].push(words, count);
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(interruptState);
+    }
+
+    void DeferredLog::writeRecord(const uint32_t *const words, const size_t count)
+    {
+        Print &out{*s_config.out};
+        const uint16_t id{LogFormat::headerId(words[0])};
+        const LogSite *const site{s_sites[id]};
+        if (s_config.binary)
+        {
+            // Describe the site before its first record
+            if (!(s_sentSites[id / 32] & 1UL << (id % 32)))
+            {
+                const size_t formatLength{std::strlen(site->format)};
+                const uint8_t frame[]{LogFormat::s_FRAME_SYNC, LogFormat::s_FRAME_SITE,
+                                      static_cast<uint8_t>(id), static_cast<uint8_t>(id >> 8), site->level,
+                                      static_cast<uint8_t>(formatLength), static_cast<uint8_t>(formatLength >> 8)};
+                out.write(frame, sizeof(frame));
+                out.write(reinterpret_cast<const uint8_t *>(site->format), formatLength);
+                s_sentSites[id / 32] |= 1UL << (id % 32);
+            }
+            // Both the ESP32 and the hosts are little endian
+            const uint8_t frame[]{LogFormat::s_FRAME_SYNC, LogFormat::s_FRAME_RECORD};
+            out.write(frame, sizeof(frame));
+            out.write(reinterpret_cast<const uint8_t *>(words), count * sizeof(uint32_t));
+            return;
+        }
+        static char text[256];
+        LogFormat::formatRecord(text, sizeof(text), site->format, words, count);
+        out.printf("[%c] %s\n", LogFormat::levelLetter(site->level), text);
+    }
+
+    // Write the pending records of every core. Return false if there were none
+    bool DeferredLog::drain()
+    {
+        static uint32_t s_droppedReported{0};
+        static uint32_t words[UINT8_MAX];
+        bool drained{false};
+        for (SPSCRingBuffer<uint32_t> &buffer : s_buffers)
+        {
+            // Records are pushed whole, so the rest of the words are there once the header is
+            while (buffer.pop(words, 1))
+            {
+                const size_t count{LogFormat::headerWords(words[0])};
+                buffer.pop(&words[1], count - 1);
+                writeRecord(words, count);
+                drained = true;
+            }
+        }
+        const uint32_t dropped{getDroppedCount()};
+        if (dropped != s_droppedReported && !s_config.binary)
+            s_config.out->printf("[W] %u deferred log records dropped\n", dropped - s_droppedReported);
+        s_droppedReported = dropped;
+        return drained;
+    }
+
+    void DeferredLog::drainTask(void *const parameters)
+    {
+        (void)parameters;
+        while (true)
+        {
+            xSemaphoreTake(s_drainMutex, portMAX_DELAY);
+            const bool drained{drain()};
+            xSemaphoreGive(s_drainMutex);
+            // Keep draining while there are records, otherwise wait for more
+            if (!drained)
+                vTaskDelay(pdMS_TO_TICKS(s_config.drainPeriodMs));
+        }
+    }
+
+    /**
+     * @brief Start the drain task.
+     *
+     * @param config Output and drain task configuration.
+     * @return true if the task has been started, false if it was already running.
+     */
+    bool DeferredLog::begin(const Config &config)
+    {
+        if (s_taskHandle)
+            return false;
+        ASSERT(config.out);
+        s_config = config;
+#ifdef AT_STATIC_ALLOCATION
+        ASSERT(s_config.stackSize <= s_TASK_STACK_SIZE);
+        s_drainMutex = xSemaphoreCreateMutexStatic(&s_drainMutexBuffer);
+        s_taskHandle = xTaskCreateStaticPinnedToCore(drainTask, "deferredLogTask", s_config.stackSize, nullptr,
+                                                     s_config.priority, s_taskStack, &s_taskBuffer, s_config.core);
+        ASSERT(s_taskHandle);
+#else
+        s_drainMutex = xSemaphoreCreateMutex();
+        ASSERT(s_drainMutex);
+        const BaseType_t ret{xTaskCreatePinnedToCore(drainTask, "deferredLogTask", s_config.stackSize, nullptr,
+                                                     s_config.priority, &s_taskHandle, s_config.core)};
+        ASSERT(ret);
+#endif
+        return true;
+    }
+
+    void DeferredLog::flush()
+    {
+        if (s_drainMutex)
+            xSemaphoreTake(s_drainMutex, portMAX_DELAY);
+        while (drain())
+            ;
+        if (s_drainMutex)
+            xSemaphoreGive(s_drainMutex);
+    }
+
+    uint32_t DeferredLog::getDroppedCount()
+    {
+        uint32_t dropped{0};
+        for (const SPSCRingBuffer<uint32_t> &buffer : s_buffers)
+            dropped += buffer.getOverflowCount();
+        return dropped;
+    }
+
+} // namespace AT
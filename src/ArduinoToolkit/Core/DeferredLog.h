@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+
+#include "ArduinoToolkit/Core/Base.h"
+#include "ArduinoToolkit/Core/LogFormat.h"
+#include "ArduinoToolkit/Core/RingBuffer.h"
+
+// Words of the ring buffer of each core (a power of two)
+#ifndef AT_DEFERRED_LOG_BUFFER_WORDS
+#define AT_DEFERRED_LOG_BUFFER_WORDS 1024
+#endif
+
+// Maximum number of log call sites
+#ifndef AT_DEFERRED_LOG_MAX_SITES
+#define AT_DEFERRED_LOG_MAX_SITES 256
+#endif
+
+// Stack size (in bytes) of the drain task
+#ifndef AT_DEFERRED_LOG_TASK_STACK_SIZE
+#define AT_DEFERRED_LOG_TASK_STACK_SIZE (3 * 1024)
+#endif
+
+namespace AT
+{
+
+    // Call site of a deferred log. Its id is assigned the first time it logs
+    struct LogSite
+    {
+        constexpr LogSite(const uint8_t level, const char *const format)
+            : level(level),
+              format(format) {}
+
+        const uint8_t level;
+        const char *const format;
+        std::atomic<uint16_t> id{0};
+    };
+
+    /**
+     * @brief Logger that defers the formatting and the output to a low priority task.
+     * With AT_DEFERRED_LOG the log macros of Log.h only copy the id of their call site and
+     * their raw arguments (strings are copied, up to AT_DEFERRED_LOG_MAX_STRING characters)
+     * into the ring buffer of the current core, with the interrupts of that core masked while
+     * the record is written. It takes a few dozen cycles and can be done from ISRs.
+     * The drain task formats the records as text, or sends them in binary (see LogFormat.h)
+     * to be rebuilt on the host by tools/log_decoder. Records that do not fit are dropped
+     * and counted. The buffers are static, records logged before "begin()" are kept.
+     */
+    class DeferredLog
+    {
+    public:
+        struct Config
+        {
+            // Where the records are written
+            Print *out{&Serial};
+            // Send binary frames instead of text
+            bool binary{false};
+            // Period of the drain task while the buffers are empty
+            uint32_t drainPeriodMs{20};
+            UBaseType_t priority{1};
+            BaseType_t core{tskNO_AFFINITY};
+            uint32_t stackSize{AT_DEFERRED_LOG_TASK_STACK_SIZE};
+        };
+
+        static bool begin(const Config &config);
+        // Write the pending records now (e.g. before restarting)
+        static void flush();
+
+        // Records dropped because the buffer of their core was full
+        static uint32_t getDroppedCount();
+
+        template <typename... Args>
+        static __attribute__((always_inline)) inline void write(LogSite &site, const Args... args)
+        {
+            // Acquire pairs with the release of "registerSite()", so "s_sites[id]" is seen set
+            uint16_t id{site.id.load(std::memory_order_acquire)};
+            // Register the site the first time. Records of sites that do not fit are dropped
+            if (!id && !(id = registerSite(site)))
+                return;
+            uint32_t words[LogFormat::maxRecordWords<Args...>()];
+            size_t count{2};
+            ((count += LogFormat::encodeArg(&words[count], args)), ...);
+            words[0] = LogFormat::header(id, static_cast<uint8_t>(count), site.level);
+            words[1] = LogFormat::types<Args...>();
+            push(words, count);
+        }
+
+        // Checks the arguments of the log macros against their format, it is never called
+        __attribute__((format(printf, 1, 2))) static void checkFormat(const char *const, ...) {}
+
+    public:
+        static constexpr uint32_t s_TASK_STACK_SIZE{AT_DEFERRED_LOG_TASK_STACK_SIZE};
+
+    private:
+        static uint16_t IRAM_ATTR registerSite(LogSite &site);
+        static void IRAM_ATTR push(const uint32_t *const words, const size_t count);
+        static void drainTask(void *const parameters);
+        static bool drain();
+        static void writeRecord(const uint32_t *const words, const size_t count);
+
+    private:
+        static Config s_config;
+        static TaskHandle_t s_taskHandle;
+        static SPSCRingBuffer<uint32_t> s_buffers[portNUM_PROCESSORS];
+        static uint32_t s_storage[portNUM_PROCESSORS][AT_DEFERRED_LOG_BUFFER_WORDS];
+        // Call sites by id (id 0 is not used)
+        static LogSite *s_sites[AT_DEFERRED_LOG_MAX_SITES];
+        static std::atomic<uint16_t> s_siteCount;
+        // Sites already described on the binary output
+        static uint32_t s_sentSites[(AT_DEFERRED_LOG_MAX_SITES + 31) / 32];
+        // Taken by the task that writes the records (the drain task or "flush()")
+        static SemaphoreHandle_t s_drainMutex;
+#ifdef AT_STATIC_ALLOCATION
+        static StaticSemaphore_t s_drainMutexBuffer;
+        static StackType_t s_taskStack[s_TASK_STACK_SIZE];
+        static StaticTask_t s_taskBuffer;
+#endif
+    }; // class DeferredLog
+
+} // namespace AT
+
+// Log through the DeferredLog. "format" must be a string literal
+#define AT_DEFERRED_LOG_WRITE(level, format, ...)                          \
+    do                                                                     \
+    {                                                                      \
+        static ::AT::LogSite s_atLogSite{level, format};                   \
+        if (false)                                                         \
+            ::AT::DeferredLog::checkFormat(format, ##__VA_ARGS__);         \
+        ::AT::DeferredLog::write(s_atLogSite, ##__VA_ARGS__);              \
+    } while (0)
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace AT
+{
+
+    /**
+     * @brief Histogram of latencies with fixed log2 buckets.
+     * Bucket i counts the values whose bit width is i, that is [2^(i-1), 2^i - 1] (bucket 0
+     * only counts 0). Recording is lock-free so it can be done from ISRs on any core.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr uint8_t s_NUM_BUCKETS{33};
+
+        __attribute__((always_inline)) inline void record(const uint32_t value)
+        {
+            m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            uint32_t min{m_min.load(std::memory_order_relaxed)};
+            while (value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+                ;
+            uint32_t max{m_max.load(std::memory_order_relaxed)};
+            while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+                ;
+        }
+
+        void reset()
+        {
+            for (std::atomic<uint32_t> &bucket : m_buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            m_count.store(0, std::memory_order_relaxed);
+            m_min.store(UINT32_MAX, std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+        inline uint32_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+        inline uint32_t getMin() const { return getCount() ? m_min.load(std::memory_order_relaxed) : 0; }
+        inline uint32_t getMax() const { return m_max.load(std::memory_order_relaxed); }
+        inline uint32_t getBucket(const uint8_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Upper bound of the bucket that holds the given percentile, the maximum recorded
+         * value if it is lower.
+         *
+         * @param percentile Percentile in [0, 100].
+         * @return The upper bound (0 if the histogram is empty).
+         */
+        uint32_t getPercentileUpperBound(const float percentile) const
+        {
+            const uint32_t count{getCount()};
+            if (!count)
+                return 0;
+            const uint64_t target{static_cast<uint64_t>(count * percentile / 100.0f)};
+            uint64_t accumulated{0};
+            for (uint8_t bucket{0}; bucket < s_NUM_BUCKETS; bucket++)
+            {
+                accumulated += getBucket(bucket);
+                if (accumulated && accumulated >= target)
+                    return bucketUpperBound(bucket) < getMax() ? bucketUpperBound(bucket) : getMax();
+            }
+            return getMax();
+        }
+
+        static constexpr uint8_t bucketOf(const uint32_t value)
+        {
+            return value ? 32 - __builtin_clz(value) : 0;
+        }
+        static constexpr uint32_t bucketLowerBound(const uint8_t bucket)
+        {
+            return bucket ? 1UL << (bucket - 1) : 0;
+        }
+        static constexpr uint32_t bucketUpperBound(const uint8_t bucket)
+        {
+            return bucket >= 32 ? UINT32_MAX : (1UL << bucket) - 1;
+        }
+
+    private:
+        std::atomic<uint32_t> m_buckets[s_NUM_BUCKETS]{};
+        std::atomic<uint32_t> m_count{0};
+        std::atomic<uint32_t> m_min{UINT32_MAX};
+        std::atomic<uint32_t> m_max{0};
+    }; // class LatencyHistogram
+
+} // namespace AT
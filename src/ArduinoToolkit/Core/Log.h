@@ -1,34 +1,201 @@
 #pragma once
 
+#include <atomic>
+
 #include "ArduinoToolkit/Core/Base.h"
 
+/**
+ * Log levels, the same values as CORE_DEBUG_LEVEL: 0 none, 1 error, 2 warning, 3 info, 4 debug, 5 verbose.
+ * Every file logs on behalf of a module, set with "#define AT_LOG_MODULE <module>" before its
+ * includes (Core if it is not set). The calls above the maximum level of their module are
+ * removed at compile time, arguments included. The maximum level is AT_LOG_MAX_LEVEL_<MODULE>,
+ * or AT_LOG_MAX_LEVEL for all of them (verbose with DEBUG, none without it), e.g.
+ * "-D AT_LOG_MAX_LEVEL=2 -D AT_LOG_MAX_LEVEL_NTP=1" keeps the warnings and errors in a release build
+ * but only the errors of the NTP client. The Arduino log functions also need CORE_DEBUG_LEVEL,
+ * unless AT_DEFERRED_LOG is defined.
+ * The levels of the modules can be lowered at runtime with "Log::setLevel()".
+ * AT_LOG_<L>_LIMITED(periodMs, format, ...) logs at most once every "periodMs" from the same
+ * call site, telling how many messages have been suppressed since the previous one.
+ * Headers log with AT_LOG_MODULE_AT(module, level, format, ...) instead: an inline function
+ * must log on behalf of the same module in every file that includes it.
+ */
+
+#ifndef AT_LOG_MODULE
+#define AT_LOG_MODULE Core
+#endif
+
+#ifndef AT_LOG_MAX_LEVEL
 #ifdef DEBUG
-#define AT_LOG_V(...) log_v(__VA_ARGS__)
-#define AT_LOG_D(...) log_d(__VA_ARGS__)
-#define AT_LOG_I(...) log_i(__VA_ARGS__)
-#define AT_LOG_W(...) log_w(__VA_ARGS__)
-#define AT_LOG_E(...) log_e(__VA_ARGS__)
-#define LOG_V(...) log_v(__VA_ARGS__)
-#define LOG_D(...) log_d(__VA_ARGS__)
-#define LOG_I(...) log_i(__VA_ARGS__)
-#define LOG_W(...) log_w(__VA_ARGS__)
-#define LOG_E(...) log_e(__VA_ARGS__)
-#define PRINT_TASK_INFO(xTask)                                       \
-    LOG_D("Task: %s", pcTaskGetName(xTask));                         \
-    LOG_D("\tPriority:\t%u", uxTaskPriorityGet(xTask));              \
-    LOG_D("\tRunning Core:\t%d", xPortGetCoreID());                  \
-    LOG_D("\tFree Memory:\t%u", uxTaskGetStackHighWaterMark(xTask)); \
-    LOG_D("\tRunning Tasks:\t%u\n", uxTaskGetNumberOfTasks())
+#define AT_LOG_MAX_LEVEL 5
+#else
+#define AT_LOG_MAX_LEVEL 0
+#endif
+#endif
+#ifndef AT_LOG_MAX_LEVEL_CORE
+#define AT_LOG_MAX_LEVEL_CORE AT_LOG_MAX_LEVEL
+#endif
+#ifndef AT_LOG_MAX_LEVEL_INTERRUPT
+#define AT_LOG_MAX_LEVEL_INTERRUPT AT_LOG_MAX_LEVEL
+#endif
+#ifndef AT_LOG_MAX_LEVEL_WIFI
+#define AT_LOG_MAX_LEVEL_WIFI AT_LOG_MAX_LEVEL
+#endif
+#ifndef AT_LOG_MAX_LEVEL_NTP
+#define AT_LOG_MAX_LEVEL_NTP AT_LOG_MAX_LEVEL
+#endif
+#ifndef AT_LOG_MAX_LEVEL_OTA
+#define AT_LOG_MAX_LEVEL_OTA AT_LOG_MAX_LEVEL
+#endif
+
+namespace AT
+{
+
+    enum class LogModule : uint8_t
+    {
+        Core,
+        Interrupt,
+        WiFi,
+        NTP,
+        OTA,
+        Count
+    };
+
+    class Log
+    {
+    public:
+        // Level compiled in for a module
+        static constexpr uint8_t getMaxLevel(const LogModule module)
+        {
+            return s_MAX_LEVELS[static_cast<uint8_t>(module)];
+        }
+
+        // Level of a module at runtime. It can not go above the one compiled in
+        static inline uint8_t getLevel(const LogModule module)
+        {
+            return s_levels[static_cast<uint8_t>(module)].load(std::memory_order_relaxed);
+        }
+
+        static inline void setLevel(const LogModule module, const uint8_t level)
+        {
+            s_levels[static_cast<uint8_t>(module)].store(level, std::memory_order_relaxed);
+        }
+
+        static inline void setLevel(const uint8_t level)
+        {
+            for (std::atomic<uint8_t> &moduleLevel : s_levels)
+                moduleLevel.store(level, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr uint8_t s_MAX_LEVELS[static_cast<uint8_t>(LogModule::Count)]{
+            AT_LOG_MAX_LEVEL_CORE,
+            AT_LOG_MAX_LEVEL_INTERRUPT,
+            AT_LOG_MAX_LEVEL_WIFI,
+            AT_LOG_MAX_LEVEL_NTP,
+            AT_LOG_MAX_LEVEL_OTA};
+        // Declared inline so every translation unit shares the same levels
+        static inline std::atomic<uint8_t> s_levels[static_cast<uint8_t>(LogModule::Count)]{
+            AT_LOG_MAX_LEVEL_CORE,
+            AT_LOG_MAX_LEVEL_INTERRUPT,
+            AT_LOG_MAX_LEVEL_WIFI,
+            AT_LOG_MAX_LEVEL_NTP,
+            AT_LOG_MAX_LEVEL_OTA};
+    }; // class Log
+
+    // State of a rate limited call site. It can be used from ISRs
+    class LogRateLimit
+    {
+    public:
+        // Return true if the call site can log now, with the number of messages suppressed since it last did
+        inline bool allow(const uint32_t periodMs, unsigned &suppressed)
+        {
+            const uint32_t nowMs{static_cast<uint32_t>(millis())};
+            uint32_t lastMs{m_lastMs.load(std::memory_order_relaxed)};
+            // Only one of the callers that find the period over takes it
+            if ((m_logged.load(std::memory_order_relaxed) && nowMs - lastMs < periodMs) ||
+                !m_lastMs.compare_exchange_strong(lastMs, nowMs, std::memory_order_relaxed))
+            {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_logged.store(true, std::memory_order_relaxed);
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        std::atomic<uint32_t> m_lastMs{0};
+        std::atomic<unsigned> m_suppressed{0};
+        std::atomic<bool> m_logged{false};
+    }; // class LogRateLimit
+
+} // namespace AT
+
+// Output of the enabled calls
+#ifdef AT_DEFERRED_LOG
+// Only the call site and the arguments are recorded, see DeferredLog
+#include "ArduinoToolkit/Core/DeferredLog.h"
+#define AT_LOG_OUTPUT_1(...) AT_DEFERRED_LOG_WRITE(1, __VA_ARGS__)
+#define AT_LOG_OUTPUT_2(...) AT_DEFERRED_LOG_WRITE(2, __VA_ARGS__)
+#define AT_LOG_OUTPUT_3(...) AT_DEFERRED_LOG_WRITE(3, __VA_ARGS__)
+#define AT_LOG_OUTPUT_4(...) AT_DEFERRED_LOG_WRITE(4, __VA_ARGS__)
+#define AT_LOG_OUTPUT_5(...) AT_DEFERRED_LOG_WRITE(5, __VA_ARGS__)
 #else
-#define AT_LOG_V(...)
-#define AT_LOG_D(...)
-#define AT_LOG_I(...)
-#define AT_LOG_W(...)
-#define AT_LOG_E(...)
-#define LOG_V(...)
-#define LOG_D(...)
-#define LOG_I(...)
-#define LOG_W(...)
-#define LOG_E(...)
-#define PRINT_TASK_INFO(xTask)
+#define AT_LOG_OUTPUT_1(...) log_e(__VA_ARGS__)
+#define AT_LOG_OUTPUT_2(...) log_w(__VA_ARGS__)
+#define AT_LOG_OUTPUT_3(...) log_i(__VA_ARGS__)
+#define AT_LOG_OUTPUT_4(...) log_d(__VA_ARGS__)
+#define AT_LOG_OUTPUT_5(...) log_v(__VA_ARGS__)
 #endif
+
+// Log at "level" (a literal from 1 to 5) if it is enabled for "module"
+#define AT_LOG_MODULE_AT(module, level, ...)                                                       \
+    do                                                                                             \
+    {                                                                                              \
+        if constexpr (level <= ::AT::Log::getMaxLevel(::AT::LogModule::module))                    \
+        {                                                                                          \
+            if (level <= ::AT::Log::getLevel(::AT::LogModule::module))                             \
+                AT_LOG_OUTPUT_##level(__VA_ARGS__);                                                \
+        }                                                                                          \
+    } while (0)
+
+// Log at "level" at most once every "periodMs" from this call site
+#define AT_LOG_MODULE_LIMITED_AT(module, level, periodMs, format, ...)                             \
+    do                                                                                             \
+    {                                                                                              \
+        if constexpr (level <= ::AT::Log::getMaxLevel(::AT::LogModule::module))                    \
+        {                                                                                          \
+            static ::AT::LogRateLimit s_atLogRateLimit;                                            \
+            unsigned atLogSuppressed;                                                              \
+            if (level <= ::AT::Log::getLevel(::AT::LogModule::module) &&                           \
+                s_atLogRateLimit.allow(periodMs, atLogSuppressed))                                 \
+            {                                                                                      \
+                if (atLogSuppressed)                                                               \
+                    AT_LOG_OUTPUT_##level(format " (%u suppressed)",                               \
+                                          ##__VA_ARGS__, atLogSuppressed);                         \
+                else                                                                               \
+                    AT_LOG_OUTPUT_##level(format, ##__VA_ARGS__);                                  \
+            }                                                                                      \
+        }                                                                                          \
+    } while (0)
+
+// The same on behalf of the module of the file
+#define AT_LOG_AT(level, ...) AT_LOG_MODULE_AT(AT_LOG_MODULE, level, __VA_ARGS__)
+#define AT_LOG_LIMITED_AT(level, periodMs, ...) AT_LOG_MODULE_LIMITED_AT(AT_LOG_MODULE, level, periodMs, __VA_ARGS__)
+
+#define AT_LOG_V(...) AT_LOG_AT(5, __VA_ARGS__)
+#define AT_LOG_D(...) AT_LOG_AT(4, __VA_ARGS__)
+#define AT_LOG_I(...) AT_LOG_AT(3, __VA_ARGS__)
+#define AT_LOG_W(...) AT_LOG_AT(2, __VA_ARGS__)
+#define AT_LOG_E(...) AT_LOG_AT(1, __VA_ARGS__)
+#define LOG_V(...) AT_LOG_V(__VA_ARGS__)
+#define LOG_D(...) AT_LOG_D(__VA_ARGS__)
+#define LOG_I(...) AT_LOG_I(__VA_ARGS__)
+#define LOG_W(...) AT_LOG_W(__VA_ARGS__)
+#define LOG_E(...) AT_LOG_E(__VA_ARGS__)
+
+#define AT_LOG_V_LIMITED(periodMs, ...) AT_LOG_LIMITED_AT(5, periodMs, __VA_ARGS__)
+#define AT_LOG_D_LIMITED(periodMs, ...) AT_LOG_LIMITED_AT(4, periodMs, __VA_ARGS__)
+#define AT_LOG_I_LIMITED(periodMs, ...) AT_LOG_LIMITED_AT(3, periodMs, __VA_ARGS__)
+#define AT_LOG_W_LIMITED(periodMs, ...) AT_LOG_LIMITED_AT(2, periodMs, __VA_ARGS__)
+#define AT_LOG_E_LIMITED(periodMs, ...) AT_LOG_LIMITED_AT(1, periodMs, __VA_ARGS__)
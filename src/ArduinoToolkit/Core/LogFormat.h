@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+// Longest string argument copied into a deferred log record (longer ones are truncated)
+#ifndef AT_DEFERRED_LOG_MAX_STRING
+#define AT_DEFERRED_LOG_MAX_STRING 32
+#endif
+
+namespace AT
+{
+
+    /**
+     * @brief Binary encoding of the deferred log records and their formatting.
+     * A record is a sequence of 32-bit words:
+     *  - Header: bits [15:0] id of the call site, [23:16] number of words of the record, [31:24] level.
+     *  - Types: 4 bits per argument (LogArgType), first argument in the lowest bits.
+     *  - Arguments: 1 word per 32-bit value, 2 (low first) per 64-bit integer or double, and
+     *    strings as a length word followed by their bytes (padded to whole words).
+     * Every argument carries its type, so a record is rebuilt correctly on a machine whose
+     * "long" or pointers have another size (e.g. by the host decoder).
+     * On the wire (binary output) a call site is described once before its first record:
+     *  - Site frame: s_FRAME_SYNC, s_FRAME_SITE, id (2 bytes), level, format length (2 bytes), format.
+     *  - Record frame: s_FRAME_SYNC, s_FRAME_RECORD, words of the record (4 bytes each).
+     * Multi-byte fields are little endian.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    namespace LogFormat
+    {
+
+        enum class LogArgType : uint8_t
+        {
+            None,
+            Int32,
+            Uint32,
+            Int64,
+            Uint64,
+            Double,
+            String,
+            Pointer32,
+            Pointer64
+        };
+
+        static constexpr size_t s_MAX_ARGS{8};
+        static constexpr size_t s_STRING_WORDS{1 + (AT_DEFERRED_LOG_MAX_STRING + 3) / 4};
+        static constexpr uint8_t s_FRAME_SYNC{0xA5};
+        static constexpr uint8_t s_FRAME_SITE{'S'};
+        static constexpr uint8_t s_FRAME_RECORD{'R'};
+
+        constexpr uint32_t header(const uint16_t id, const uint8_t words, const uint8_t level)
+        {
+            return id | static_cast<uint32_t>(words) << 16 | static_cast<uint32_t>(level) << 24;
+        }
+        constexpr uint16_t headerId(const uint32_t header) { return header & 0xFFFF; }
+        constexpr uint8_t headerWords(const uint32_t header) { return (header >> 16) & 0xFF; }
+        constexpr uint8_t headerLevel(const uint32_t header) { return header >> 24; }
+
+        // Letter of a level (1 error to 5 verbose, as the Arduino log levels)
+        constexpr char levelLetter(const uint8_t level)
+        {
+            return level >= 1 && level <= 5 ? "EWIDV"[level - 1] : '?';
+        }
+
+        // Type and number of words of an argument, known at compile time
+        template <typename T>
+        constexpr LogArgType argType()
+        {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, char *> || std::is_same_v<U, const char *>)
+                return LogArgType::String;
+            else if constexpr (std::is_pointer_v<U>)
+                return sizeof(U) == 8 ? LogArgType::Pointer64 : LogArgType::Pointer32;
+            else if constexpr (std::is_floating_point_v<U>)
+                return LogArgType::Double;
+            else if constexpr (std::is_enum_v<U>)
+                return argType<std::underlying_type_t<U>>();
+            else
+            {
+                static_assert(std::is_integral_v<U>, "Deferred log arguments must be numbers, pointers or C strings");
+                if constexpr (sizeof(U) == 8)
+                    return std::is_signed_v<U> ? LogArgType::Int64 : LogArgType::Uint64;
+                else
+                    return std::is_signed_v<U> ? LogArgType::Int32 : LogArgType::Uint32;
+            }
+        }
+
+        template <typename T>
+        constexpr size_t argWords()
+        {
+            switch (argType<T>())
+            {
+            case LogArgType::String:
+                return s_STRING_WORDS;
+            case LogArgType::Int64:
+            case LogArgType::Uint64:
+            case LogArgType::Double:
+            case LogArgType::Pointer64:
+                return 2;
+            default:
+                return 1;
+            }
+        }
+
+        // Append an argument at "words". Return the number of words used
+        template <typename T>
+        __attribute__((always_inline)) inline size_t encodeArg(uint32_t *const words, const T value)
+        {
+            constexpr LogArgType type{argType<T>()};
+            if constexpr (type == LogArgType::String)
+            {
+                size_t length{0};
+                if (value)
+                    while (length < AT_DEFERRED_LOG_MAX_STRING && value[length])
+                        length++;
+                words[0] = length;
+                if (length)
+                    std::memcpy(&words[1], value, length);
+                return 1 + (length + 3) / 4;
+            }
+            else if constexpr (type == LogArgType::Double)
+            {
+                const double number{static_cast<double>(value)};
+                std::memcpy(words, &number, 8);
+                return 2;
+            }
+            else if constexpr (type == LogArgType::Pointer32 || type == LogArgType::Pointer64)
+            {
+                const uint64_t address{reinterpret_cast<uintptr_t>(value)};
+                words[0] = static_cast<uint32_t>(address);
+                if constexpr (type == LogArgType::Pointer64)
+                    words[1] = static_cast<uint32_t>(address >> 32);
+                return type == LogArgType::Pointer64 ? 2 : 1;
+            }
+            else if constexpr (type == LogArgType::Int64 || type == LogArgType::Uint64)
+            {
+                const uint64_t number{static_cast<uint64_t>(value)};
+                words[0] = static_cast<uint32_t>(number);
+                words[1] = static_cast<uint32_t>(number >> 32);
+                return 2;
+            }
+            else
+            {
+                words[0] = static_cast<uint32_t>(value);
+                return 1;
+            }
+        }
+
+        // Type word of the arguments
+        template <typename... Args>
+        constexpr uint32_t types()
+        {
+            static_assert(sizeof...(Args) <= s_MAX_ARGS, "Too many deferred log arguments");
+            uint32_t word{0};
+            size_t shift{0};
+            ((word |= static_cast<uint32_t>(argType<Args>()) << shift, shift += 4), ...);
+            return word;
+        }
+
+        // Maximum number of words of a record with these arguments
+        template <typename... Args>
+        constexpr size_t maxRecordWords() { return 2 + (0 + ... + argWords<Args>()); }
+
+        // Write into "out" the text of a record of "format". Return the length of the text
+        inline size_t formatRecord(char *const out,
+                                   const size_t size,
+                                   const char *format,
+                                   const uint32_t *const words,
+                                   const size_t wordCount)
+        {
+            if (!size)
+                return 0;
+            size_t length{0};
+            const auto append{[&](const int written)
+                              {
+                                  if (written > 0)
+                                      length += static_cast<size_t>(written);
+                                  if (length >= size)
+                                      length = size - 1;
+                              }};
+            uint32_t typeWord{wordCount > 1 ? words[1] : 0};
+            size_t next{2};
+            out[0] = '\0';
+            while (*format && length < size - 1)
+            {
+                // Copy the text up to the next conversion
+                if (*format != '%')
+                {
+                    out[length++] = *format++;
+                    out[length] = '\0';
+                    continue;
+                }
+                if (format[1] == '%')
+                {
+                    out[length++] = '%';
+                    out[length] = '\0';
+                    format += 2;
+                    continue;
+                }
+                // Isolate the conversion, it is formatted on its own
+                char spec[16];
+                size_t specLength{0};
+                bool isLong{false};
+                bool isLongLong{false};
+                do
+                {
+                    if (*format == 'l')
+                    {
+                        isLongLong = isLong;
+                        isLong = true;
+                    }
+                    else if (*format == 'j' || *format == 'z' || *format == 't')
+                        isLongLong = true;
+                    if (specLength < sizeof(spec) - 1)
+                        spec[specLength++] = *format;
+                    format++;
+                } while (*format && !std::strchr("diouxXcsfFeEgGaAp", *format));
+                if (!*format)
+                    break;
+                spec[specLength++] = *format++;
+                spec[specLength] = '\0';
+                // Take the next argument with its own type
+                const LogArgType type{static_cast<LogArgType>(typeWord & 0xF)};
+                typeWord >>= 4;
+                const uint32_t low{next < wordCount ? words[next] : 0};
+                const uint32_t high{next + 1 < wordCount ? words[next + 1] : 0};
+                const uint64_t wide{low | static_cast<uint64_t>(high) << 32};
+                switch (type)
+                {
+                case LogArgType::String:
+                {
+                    char text[AT_DEFERRED_LOG_MAX_STRING + 1];
+                    const size_t textLength{low < AT_DEFERRED_LOG_MAX_STRING ? low : AT_DEFERRED_LOG_MAX_STRING};
+                    if (next + 1 + (textLength + 3) / 4 <= wordCount)
+                        std::memcpy(text, &words[next + 1], textLength);
+                    text[textLength] = '\0';
+                    append(std::snprintf(out + length, size - length, spec, text));
+                    next += 1 + (textLength + 3) / 4;
+                    break;
+                }
+                case LogArgType::Double:
+                {
+                    double number;
+                    std::memcpy(&number, &wide, 8);
+                    append(std::snprintf(out + length, size - length, spec, number));
+                    next += 2;
+                    break;
+                }
+                case LogArgType::None:
+                    append(std::snprintf(out + length, size - length, "<?>"));
+                    break;
+                default:
+                {
+                    const bool isWide{type == LogArgType::Int64 || type == LogArgType::Uint64 || type == LogArgType::Pointer64};
+                    const bool isSigned{type == LogArgType::Int32 || type == LogArgType::Int64};
+                    // Sign extend 32-bit values, then pass the value as the conversion expects it here
+                    const uint64_t value{isWide ? wide : isSigned ? static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(low))) : low};
+                    if (spec[specLength - 1] == 'p')
+                        append(std::snprintf(out + length, size - length, spec, reinterpret_cast<void *>(static_cast<uintptr_t>(value))));
+                    else if (isLongLong)
+                        append(std::snprintf(out + length, size - length, spec, static_cast<long long>(value)));
+                    else if (isLong)
+                        append(std::snprintf(out + length, size - length, spec, static_cast<long>(value)));
+                    else
+                        append(std::snprintf(out + length, size - length, spec, static_cast<int>(value)));
+                    next += isWide ? 2 : 1;
+                    break;
+                }
+                }
+            }
+            return length;
+        }
+
+    } // namespace LogFormat
+
+} // namespace AT
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+
+namespace AT
+{
+
+    // Node of an MPSCQueue. Objects are queued by inheriting from it
+    struct MPSCQueueNode
+    {
+        std::atomic<MPSCQueueNode *> next{nullptr};
+    };
+
+    /**
+     * @brief Intrusive lock-free multiple-producer/single-consumer queue (Vyukov's algorithm).
+     * Pushing is wait-free so it can be done from ISRs on any core. A node must not be
+     * pushed again until it has been popped. "pop()" may return nullptr while a producer is
+     * in the middle of a push, the consumer gets that node on its next call.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class MPSCQueue
+    {
+    public:
+        constexpr MPSCQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+        // Producer side. Safe to call from an ISR
+        __attribute__((always_inline)) inline void push(MPSCQueueNode *const node)
+        {
+            node->next.store(nullptr, std::memory_order_relaxed);
+            MPSCQueueNode *const prev{m_head.exchange(node, std::memory_order_acq_rel)};
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        // Consumer side. Return the oldest node or nullptr if there is none available
+        MPSCQueueNode *pop()
+        {
+            MPSCQueueNode *tail{m_tail};
+            MPSCQueueNode *next{tail->next.load(std::memory_order_acquire)};
+            // Skip the stub node
+            if (tail == &m_stub)
+            {
+                if (!next)
+                    return nullptr;
+                m_tail = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (next)
+            {
+                m_tail = next;
+                return tail;
+            }
+            // "tail" is the last node unless a producer has not linked its node yet
+            if (tail != m_head.load(std::memory_order_acquire))
+                return nullptr;
+            // Push the stub back so "tail" can be detached
+            push(&m_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (next)
+            {
+                m_tail = next;
+                return tail;
+            }
+            return nullptr;
+        }
+
+    private:
+        MPSCQueueNode m_stub;
+        std::atomic<MPSCQueueNode *> m_head;
+        MPSCQueueNode *m_tail;
+    }; // class MPSCQueue
+
+} // namespace AT
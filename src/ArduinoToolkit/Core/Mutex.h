@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ArduinoToolkit/Core/Assert.h"
+
+#if defined(AT_STATIC_ALLOCATION) && !configSUPPORT_STATIC_ALLOCATION
+#error "AT_STATIC_ALLOCATION requires configSUPPORT_STATIC_ALLOCATION"
+#endif
+
+namespace AT
+{
+
+    /**
+     * @brief Owner of a FreeRTOS mutex.
+     * With AT_STATIC_ALLOCATION the mutex is created inside the object,
+     * otherwise it is allocated from the heap.
+     */
+    class Mutex
+    {
+    public:
+        Mutex()
+        {
+#ifdef AT_STATIC_ALLOCATION
+            m_handle = xSemaphoreCreateMutexStatic(&m_buffer);
+#else
+            m_handle = xSemaphoreCreateMutex();
+#endif
+            ASSERT(m_handle);
+        }
+        ~Mutex() { vSemaphoreDelete(m_handle); }
+
+        Mutex(const Mutex &) = delete;
+        Mutex &operator=(const Mutex &) = delete;
+
+        inline operator SemaphoreHandle_t() const { return m_handle; }
+
+        // Bytes taken from the heap by each object
+#ifdef AT_STATIC_ALLOCATION
+        static constexpr size_t s_HEAP_SIZE{0};
+#else
+        static constexpr size_t s_HEAP_SIZE{sizeof(StaticSemaphore_t)};
+#endif
+
+    private:
+        SemaphoreHandle_t m_handle{nullptr};
+#ifdef AT_STATIC_ALLOCATION
+        StaticSemaphore_t m_buffer;
+#endif
+    }; // class Mutex
+
+} // namespace AT
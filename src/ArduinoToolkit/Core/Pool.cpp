@@ -0,0 +1,116 @@
+#include "ArduinoToolkit/Core/Pool.h"
+
+#include "ArduinoToolkit/Core.h"
+
+namespace AT
+{
+
+    // Static class members
+    Pool::Block<32> Pool::s_blocks32[AT_POOL_BLOCKS_32 ? AT_POOL_BLOCKS_32 : 1];
+    Pool::Block<64> Pool::s_blocks64[AT_POOL_BLOCKS_64 ? AT_POOL_BLOCKS_64 : 1];
+    Pool::Block<128> Pool::s_blocks128[AT_POOL_BLOCKS_128 ? AT_POOL_BLOCKS_128 : 1];
+    Pool::Block<256> Pool::s_blocks256[AT_POOL_BLOCKS_256 ? AT_POOL_BLOCKS_256 : 1];
+    Pool::SizeClass Pool::s_sizeClasses[s_NUM_SIZE_CLASSES]{
+        {s_blocks32[0].data, nullptr, 0, {.blocks = AT_POOL_BLOCKS_32, .blockSize = 32}},
+        {s_blocks64[0].data, nullptr, 0, {.blocks = AT_POOL_BLOCKS_64, .blockSize = 64}},
+        {s_blocks128[0].data, nullptr, 0, {.blocks = AT_POOL_BLOCKS_128, .blockSize = 128}},
+        {s_blocks256[0].data, nullptr, 0, {.blocks = AT_POOL_BLOCKS_256, .blockSize = 256}}};
+    uint32_t Pool::s_oversized{0};
+    portMUX_TYPE Pool::s_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Take a block of "sizeClass", nullptr if it is exhausted. Called inside the critical section
+    void *Pool::allocateFrom(SizeClass &sizeClass)
+    {
+        PoolStats &stats{sizeClass.stats};
+        void *block{sizeClass.freeList};
+        if (block)
+            sizeClass.freeList = *static_cast<void **>(block);
+        else if (sizeClass.used < stats.blocks)
+            block = sizeClass.storage + sizeClass.used++ * stats.blockSize;
+        else
+        {
+            stats.failures++;
+            return nullptr;
+        }
+        stats.allocations++;
+        if (++stats.inUse > stats.peak)
+            stats.peak = stats.inUse;
+        return block;
+    }
+
+    /**
+     * @brief Allocate "size" bytes from the smallest size class they fit in.
+     * The heap is used when that class is exhausted or the size does not fit in any class.
+     *
+     * @return The allocated memory (aligned for any type), nullptr if the heap is exhausted too.
+     */
+    void *Pool::allocate(const size_t size)
+    {
+        for (SizeClass &sizeClass : s_sizeClasses)
+        {
+            if (size > sizeClass.stats.blockSize || !sizeClass.stats.blocks)
+                continue;
+            portENTER_CRITICAL(&s_spinlock);
+            void *const block{allocateFrom(sizeClass)};
+            portEXIT_CRITICAL(&s_spinlock);
+            if (block)
+                return block;
+            return malloc(size);
+        }
+        portENTER_CRITICAL(&s_spinlock);
+        s_oversized++;
+        portEXIT_CRITICAL(&s_spinlock);
+        return malloc(size);
+    }
+
+    // Give back memory returned by "allocate()"
+    void Pool::deallocate(void *const ptr)
+    {
+        if (!ptr)
+            return;
+        for (SizeClass &sizeClass : s_sizeClasses)
+        {
+            const PoolStats &stats{sizeClass.stats};
+            uint8_t *const block{static_cast<uint8_t *>(ptr)};
+            if (block < sizeClass.storage || block >= sizeClass.storage + stats.blocks * stats.blockSize)
+                continue;
+            portENTER_CRITICAL(&s_spinlock);
+            *static_cast<void **>(ptr) = sizeClass.freeList;
+            sizeClass.freeList = ptr;
+            sizeClass.stats.inUse--;
+            portEXIT_CRITICAL(&s_spinlock);
+            return;
+        }
+        free(ptr);
+    }
+
+    PoolStats Pool::getStats(const size_t sizeClass)
+    {
+        ASSERT(sizeClass < s_NUM_SIZE_CLASSES);
+        portENTER_CRITICAL(&s_spinlock);
+        const PoolStats stats{s_sizeClasses[sizeClass].stats};
+        portEXIT_CRITICAL(&s_spinlock);
+        return stats;
+    }
+
+    uint32_t Pool::getOversizedCount()
+    {
+        portENTER_CRITICAL(&s_spinlock);
+        const uint32_t oversized{s_oversized};
+        portEXIT_CRITICAL(&s_spinlock);
+        return oversized;
+    }
+
+    void Pool::print(Print &out)
+    {
+        for (size_t i{0}; i < s_NUM_SIZE_CLASSES; i++)
+        {
+            const PoolStats stats{getStats(i)};
+            out.printf("Pool %3u B: %u/%u in use, %u peak, %u allocations, %u failures\n",
+                       stats.blockSize, stats.inUse, stats.blocks, stats.peak,
+                       static_cast<unsigned>(stats.allocations), static_cast<unsigned>(stats.failures));
+        }
+        out.printf("Pool oversized: %u\n", static_cast<unsigned>(getOversizedCount()));
+    }
+
+} // namespace AT
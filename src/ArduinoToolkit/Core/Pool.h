@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ArduinoToolkit/Core/Base.h"
+
+// Blocks of each size class of the Pool, 0 to disable the class
+#ifndef AT_POOL_BLOCKS_32
+#define AT_POOL_BLOCKS_32 16
+#endif
+#ifndef AT_POOL_BLOCKS_64
+#define AT_POOL_BLOCKS_64 16
+#endif
+#ifndef AT_POOL_BLOCKS_128
+#define AT_POOL_BLOCKS_128 8
+#endif
+#ifndef AT_POOL_BLOCKS_256
+#define AT_POOL_BLOCKS_256 4
+#endif
+
+namespace AT
+{
+
+    struct PoolStats
+    {
+        // Blocks of the size class and bytes per block
+        uint16_t blocks{0};
+        uint16_t blockSize{0};
+        uint16_t inUse{0};
+        // Maximum blocks in use at the same time
+        uint16_t peak{0};
+        uint32_t allocations{0};
+        // Requests of this size class that did not find a free block (served by the heap)
+        uint32_t failures{0};
+    };
+
+    /**
+     * @brief Fixed-block allocator used by the toolkit internals.
+     * The blocks of each size class live in static storage. Allocating pops a free block
+     * (or takes the next one never used) and freeing pushes it back, both O(1) in a short
+     * critical section, so the toolkit does not fragment the heap however long it runs.
+     * Requests bigger than the largest class, or that find their class exhausted, fall back
+     * to the heap and are counted as failures. Size the classes with AT_POOL_BLOCKS_<size>
+     * from the peaks reported by "getStats()".
+     * The storage is only zero initialized, so it can be used by static constructors.
+     */
+    class Pool
+    {
+    public:
+        static constexpr size_t s_NUM_SIZE_CLASSES{4};
+
+        static void *allocate(const size_t size);
+        static void deallocate(void *const ptr);
+
+        // Statistics of a size class, in increasing block size order
+        static PoolStats getStats(const size_t sizeClass);
+        // Requests bigger than the largest block
+        static uint32_t getOversizedCount();
+        static void print(Print &out);
+
+    private:
+        // A free block holds the link to the next free one in its first bytes
+        template <size_t SIZE>
+        struct alignas(std::max_align_t) Block
+        {
+            uint8_t data[SIZE];
+        };
+
+        struct SizeClass
+        {
+            uint8_t *const storage;
+            // Freed blocks. The blocks from "used" onwards have never been allocated
+            void *freeList;
+            uint16_t used;
+            PoolStats stats;
+        };
+
+        static void *allocateFrom(SizeClass &sizeClass);
+
+    private:
+        static Block<32> s_blocks32[AT_POOL_BLOCKS_32 ? AT_POOL_BLOCKS_32 : 1];
+        static Block<64> s_blocks64[AT_POOL_BLOCKS_64 ? AT_POOL_BLOCKS_64 : 1];
+        static Block<128> s_blocks128[AT_POOL_BLOCKS_128 ? AT_POOL_BLOCKS_128 : 1];
+        static Block<256> s_blocks256[AT_POOL_BLOCKS_256 ? AT_POOL_BLOCKS_256 : 1];
+        static SizeClass s_sizeClasses[s_NUM_SIZE_CLASSES];
+        static uint32_t s_oversized;
+        static portMUX_TYPE s_spinlock;
+    }; // class Pool
+
+    /**
+     * @brief Standard allocator over the Pool, e.g. "std::vector<T, PoolAllocator<T>>".
+     */
+    template <typename T>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        PoolAllocator() = default;
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U> &) {}
+
+        inline T *allocate(const size_t n) { return static_cast<T *>(Pool::allocate(n * sizeof(T))); }
+        inline void deallocate(T *const ptr, const size_t) { Pool::deallocate(ptr); }
+
+        template <typename U>
+        inline bool operator==(const PoolAllocator<U> &) const { return true; }
+        template <typename U>
+        inline bool operator!=(const PoolAllocator<U> &) const { return false; }
+    }; // class PoolAllocator
+
+    using PoolString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+    template <typename T>
+    using PoolVector = std::vector<T, PoolAllocator<T>>;
+
+} // namespace AT
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace AT
+{
+
+    /**
+     * @brief Lock-free single-producer/single-consumer ring buffer.
+     * The storage is supplied by the owner through "assign()" and its capacity must be
+     * a power of two. Only one context may push and only one context may pop at a time.
+     * When the buffer is full new elements are dropped and counted as overflows.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    template <typename T>
+    class SPSCRingBuffer
+    {
+    public:
+        SPSCRingBuffer() = default;
+        // Buffer with its storage assigned at compile time. The capacity must be a power of two
+        constexpr SPSCRingBuffer(T *const buffer, const size_t capacity)
+            : m_buffer(buffer),
+              m_mask(capacity - 1) {}
+
+        // Set the storage of the buffer. Must be called before the producer starts pushing
+        bool assign(T *const buffer, const size_t capacity)
+        {
+            // The capacity must be a non zero power of two so indices can be masked
+            if (!buffer || !capacity || (capacity & (capacity - 1)))
+                return false;
+            m_buffer = buffer;
+            m_mask = capacity - 1;
+            m_head.store(0, std::memory_order_relaxed);
+            m_tail.store(0, std::memory_order_relaxed);
+            m_overflowCount.store(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        inline bool isAssigned() const { return m_buffer; }
+        inline size_t capacity() const { return m_buffer ? m_mask + 1 : 0; }
+        inline uint32_t getOverflowCount() const { return m_overflowCount.load(std::memory_order_relaxed); }
+
+        inline size_t size() const
+        {
+            return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+        }
+
+        // Producer side. Safe to call from an ISR
+        __attribute__((always_inline)) inline bool push(const T &item)
+        {
+            const size_t head{m_head.load(std::memory_order_relaxed)};
+            if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+            {
+                m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_buffer[head & m_mask] = item;
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Producer side. Push all the "count" elements or none of them. Safe to call from an ISR
+        __attribute__((always_inline)) inline bool push(const T *const items, const size_t count)
+        {
+            const size_t head{m_head.load(std::memory_order_relaxed)};
+            if (head - m_tail.load(std::memory_order_acquire) + count > m_mask + 1)
+            {
+                m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            for (size_t i{0}; i < count; i++)
+                m_buffer[(head + i) & m_mask] = items[i];
+            m_head.store(head + count, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Copy up to "maxItems" elements into "out" and return how many were copied
+        size_t pop(T *const out, const size_t maxItems)
+        {
+            const size_t tail{m_tail.load(std::memory_order_relaxed)};
+            const size_t available{m_head.load(std::memory_order_acquire) - tail};
+            const size_t count{available < maxItems ? available : maxItems};
+            for (size_t i{0}; i < count; i++)
+                out[i] = m_buffer[(tail + i) & m_mask];
+            m_tail.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+    private:
+        T *m_buffer{nullptr};
+        size_t m_mask{0};
+        std::atomic<size_t> m_head{0};
+        std::atomic<size_t> m_tail{0};
+        std::atomic<uint32_t> m_overflowCount{0};
+    }; // class SPSCRingBuffer
+
+} // namespace AT
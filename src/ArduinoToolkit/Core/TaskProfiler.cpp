@@ -0,0 +1,338 @@
+#include "ArduinoToolkit/Core/TaskProfiler.h"
+
+#include <cstring>
+#include <new>
+
+#include <esp_heap_caps.h>
+
+#include "ArduinoToolkit/Core.h"
+
+void IRAM_ATTR atTaskProfilerSwitchedIn(void)
+{
+    AT::TaskProfiler::countContextSwitch();
+}
+
+namespace AT
+{
+
+    // Static class members
+    TaskProfiler::Config TaskProfiler::s_config;
+    TaskHandle_t TaskProfiler::s_taskHandle{nullptr};
+    SemaphoreHandle_t TaskProfiler::s_mutex{nullptr};
+    TaskProfiler::Sample TaskProfiler::s_samples[AT_TASK_PROFILER_SAMPLES];
+    size_t TaskProfiler::s_sampleCount{0};
+    size_t TaskProfiler::s_nextSample{0};
+#ifdef AT_STATIC_ALLOCATION
+    TaskStatus_t TaskProfiler::s_statusStorage[AT_TASK_PROFILER_MAX_TASKS];
+    TaskProfiler::RunTime TaskProfiler::s_previousStorage[AT_TASK_PROFILER_MAX_TASKS];
+    TaskProfiler::RunTime TaskProfiler::s_currentStorage[AT_TASK_PROFILER_MAX_TASKS];
+    TaskStatus_t *TaskProfiler::s_status{s_statusStorage};
+    TaskProfiler::RunTime *TaskProfiler::s_previous{s_previousStorage};
+    TaskProfiler::RunTime *TaskProfiler::s_current{s_currentStorage};
+    size_t TaskProfiler::s_statusCapacity{AT_TASK_PROFILER_MAX_TASKS};
+#else
+    TaskStatus_t *TaskProfiler::s_status{nullptr};
+    TaskProfiler::RunTime *TaskProfiler::s_previous{nullptr};
+    TaskProfiler::RunTime *TaskProfiler::s_current{nullptr};
+    size_t TaskProfiler::s_statusCapacity{0};
+#endif
+    size_t TaskProfiler::s_previousCount{0};
+    uint32_t TaskProfiler::s_previousTotalRunTime{0};
+    uint32_t TaskProfiler::s_previousContextSwitches[portNUM_PROCESSORS];
+    char TaskProfiler::s_command[32];
+    size_t TaskProfiler::s_commandLength{0};
+    std::atomic<uint32_t> TaskProfiler::s_contextSwitches[portNUM_PROCESSORS];
+    std::atomic<uint32_t> TaskProfiler::s_skippedCount{0};
+    SemaphoreHandle_t TaskProfiler::s_printMutex{nullptr};
+    TaskProfiler::Sample TaskProfiler::s_printSample;
+#ifdef AT_STATIC_ALLOCATION
+    StaticSemaphore_t TaskProfiler::s_printMutexBuffer;
+    StaticSemaphore_t TaskProfiler::s_mutexBuffer;
+    StackType_t TaskProfiler::s_taskStack[s_TASK_STACK_SIZE];
+    StaticTask_t TaskProfiler::s_taskBuffer;
+#endif
+
+#if AT_TASK_PROFILER_SUPPORTED
+
+    static uint16_t permille(const uint32_t part, const uint32_t total)
+    {
+        if (!total)
+            return 0;
+        const uint64_t value{part * 1000ULL / total};
+        return value < 1000 ? value : 1000;
+    }
+
+    // Make room in the status arrays for "taskCount" tasks, with some headroom for the tasks created
+    // before "uxTaskGetSystemState()" runs (it reports nothing if the array is too small)
+    bool TaskProfiler::reserveStatus(const UBaseType_t taskCount)
+    {
+        if (taskCount <= s_statusCapacity)
+            return true;
+#ifdef AT_STATIC_ALLOCATION
+        return false;
+#else
+        const size_t capacity{taskCount + s_STATUS_HEADROOM};
+        TaskStatus_t *const status{new (std::nothrow) TaskStatus_t[capacity]};
+        RunTime *const previous{new (std::nothrow) RunTime[capacity]};
+        RunTime *const current{new (std::nothrow) RunTime[capacity]};
+        if (!status || !previous || !current)
+        {
+            delete[] status;
+            delete[] previous;
+            delete[] current;
+            return false;
+        }
+        std::memcpy(previous, s_previous, s_previousCount * sizeof(RunTime));
+        delete[] s_status;
+        delete[] s_previous;
+        delete[] s_current;
+        s_status = status;
+        s_previous = previous;
+        s_current = current;
+        s_statusCapacity = capacity;
+        return true;
+#endif
+    }
+
+    void TaskProfiler::takeSample()
+    {
+        UBaseType_t statusCount{0};
+        uint32_t totalRunTime{0};
+        if (reserveStatus(uxTaskGetNumberOfTasks()))
+            statusCount = uxTaskGetSystemState(s_status, s_statusCapacity, &totalRunTime);
+        if (!statusCount)
+        {
+            s_skippedCount.fetch_add(1, std::memory_order_relaxed);
+            AT_LOG_W_LIMITED(60 * 1000, "TaskProfiler can not hold %u tasks, increase AT_TASK_PROFILER_MAX_TASKS",
+                             static_cast<unsigned>(uxTaskGetNumberOfTasks()));
+            return;
+        }
+
+        const int64_t startUs{esp_timer_get_time()};
+        // The sample is built in place, the slot is not readable meanwhile
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        Sample &sample{s_samples[s_nextSample]};
+        if (s_sampleCount == AT_TASK_PROFILER_SAMPLES)
+            s_sampleCount--;
+        xSemaphoreGive(s_mutex);
+
+        sample.timestampMs = millis();
+        sample.taskCount = statusCount;
+        // Run time counters wrap around, the intervals are far shorter than that
+        sample.intervalUs = totalRunTime - s_previousTotalRunTime;
+        s_previousTotalRunTime = totalRunTime;
+
+        // CPU share of every task since the previous sample (new tasks since they were created)
+        uint32_t idleRunTime[portNUM_PROCESSORS]{};
+        for (UBaseType_t i{0}; i < statusCount; i++)
+        {
+            const TaskStatus_t &status{s_status[i]};
+            uint32_t runTime{status.ulRunTimeCounter};
+            for (size_t j{0}; j < s_previousCount; j++)
+            {
+                if (s_previous[j].handle == status.xHandle && s_previous[j].number == status.xTaskNumber)
+                {
+                    runTime = status.ulRunTimeCounter - s_previous[j].counter;
+                    break;
+                }
+            }
+            s_current[i] = {status.xHandle, status.xTaskNumber, status.ulRunTimeCounter};
+            for (UBaseType_t core{0}; core < portNUM_PROCESSORS; core++)
+                if (status.xHandle == xTaskGetIdleTaskHandleForCPU(core))
+                    idleRunTime[core] = runTime;
+            if (i >= AT_TASK_PROFILER_MAX_TASKS)
+                continue;
+
+            TaskSample &task{sample.tasks[i]};
+            std::strncpy(task.name, status.pcTaskName, sizeof(task.name) - 1);
+            task.name[sizeof(task.name) - 1] = '\0';
+            task.handle = status.xHandle;
+            task.priority = status.uxCurrentPriority;
+            task.state = status.eCurrentState;
+#if configTASKLIST_INCLUDE_COREID
+            task.core = status.xCoreID;
+#else
+            task.core = tskNO_AFFINITY;
+#endif
+            task.cpuPermille = permille(runTime, sample.intervalUs);
+            task.stackHighWaterMark = status.usStackHighWaterMark;
+        }
+        RunTime *const previous{s_previous};
+        s_previous = s_current;
+        s_current = previous;
+        s_previousCount = statusCount;
+
+        // A core is busy while its idle task does not run
+        for (UBaseType_t core{0}; core < portNUM_PROCESSORS; core++)
+        {
+            sample.corePermille[core] = 1000 - permille(idleRunTime[core], sample.intervalUs);
+            const uint32_t contextSwitches{s_contextSwitches[core].load(std::memory_order_relaxed)};
+            sample.contextSwitches[core] = contextSwitches - s_previousContextSwitches[core];
+            s_previousContextSwitches[core] = contextSwitches;
+        }
+
+        sample.heapFree = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        sample.heapMinimumFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+        sample.heapLargestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        sample.heapFragmentation = sample.heapFree ? 100 - sample.heapLargestBlock * 100ULL / sample.heapFree : 0;
+        sample.costUs = esp_timer_get_time() - startUs;
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_nextSample = (s_nextSample + 1) % AT_TASK_PROFILER_SAMPLES;
+        s_sampleCount++;
+        xSemaphoreGive(s_mutex);
+    }
+
+    // Read the pending characters of the command stream, run the command once its line is complete
+    void TaskProfiler::pollCommand()
+    {
+        Stream &stream{*s_config.commandStream};
+        while (stream.available() > 0)
+        {
+            const int character{stream.read()};
+            if (character < 0)
+                break;
+            if (character != '\n' && character != '\r')
+            {
+                if (s_commandLength < sizeof(s_command) - 1)
+                    s_command[s_commandLength++] = character;
+                continue;
+            }
+            s_command[s_commandLength] = '\0';
+            s_commandLength = 0;
+            unsigned age{0};
+            if (!std::strcmp(s_command, "profile") || std::sscanf(s_command, "profile %u", &age) == 1)
+                print(stream, age);
+        }
+    }
+
+    void TaskProfiler::profilerTask(void *const parameters)
+    {
+        (void)parameters;
+        // Commands are polled at most every s_MIN_INTERVAL_MS between the samples
+        const TickType_t sliceTicks{pdMS_TO_TICKS(s_config.commandStream ? s_MIN_INTERVAL_MS : s_config.intervalMs)};
+        TickType_t nextSampleTicks{xTaskGetTickCount()};
+        while (true)
+        {
+            if (static_cast<int32_t>(xTaskGetTickCount() - nextSampleTicks) >= 0)
+            {
+                takeSample();
+                nextSampleTicks += pdMS_TO_TICKS(s_config.intervalMs);
+            }
+            if (s_config.commandStream)
+                pollCommand();
+            const TickType_t remainingTicks{nextSampleTicks - xTaskGetTickCount()};
+            vTaskDelay(static_cast<int32_t>(remainingTicks) <= 0 ? 1 : remainingTicks < sliceTicks ? remainingTicks
+                                                                                                     : sliceTicks);
+        }
+    }
+
+#endif
+
+    /**
+     * @brief Start the profiler task. The first sample is taken right away.
+     *
+     * @param config Sampling interval, command stream and profiler task configuration.
+     * @return true if the task has been started, false if it was already running or the
+     *         FreeRTOS run time stats are not enabled (see AT_TASK_PROFILER_SUPPORTED).
+     */
+    bool TaskProfiler::begin(const Config &config)
+    {
+#if !AT_TASK_PROFILER_SUPPORTED
+        (void)config;
+        AT_LOG_E("TaskProfiler needs configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS");
+        return false;
+#else
+        if (s_taskHandle)
+            return false;
+        s_config = config;
+        if (s_config.intervalMs < s_MIN_INTERVAL_MS)
+            s_config.intervalMs = s_MIN_INTERVAL_MS;
+#ifdef AT_STATIC_ALLOCATION
+        ASSERT(s_config.stackSize <= s_TASK_STACK_SIZE);
+        s_mutex = xSemaphoreCreateMutexStatic(&s_mutexBuffer);
+        s_printMutex = xSemaphoreCreateMutexStatic(&s_printMutexBuffer);
+        s_taskHandle = xTaskCreateStaticPinnedToCore(profilerTask, "taskProfiler", s_config.stackSize, nullptr,
+                                                     s_config.priority, s_taskStack, &s_taskBuffer, s_config.core);
+        ASSERT(s_taskHandle);
+#else
+        s_mutex = xSemaphoreCreateMutex();
+        s_printMutex = xSemaphoreCreateMutex();
+        ASSERT(s_mutex && s_printMutex);
+        const BaseType_t ret{xTaskCreatePinnedToCore(profilerTask, "taskProfiler", s_config.stackSize, nullptr,
+                                                     s_config.priority, &s_taskHandle, s_config.core)};
+        ASSERT(ret);
+#endif
+        AT_LOG_I("TaskProfiler sampling every %u ms", s_config.intervalMs);
+        return true;
+#endif
+    }
+
+    size_t TaskProfiler::getSampleCount()
+    {
+        if (!s_mutex)
+            return 0;
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        const size_t count{s_sampleCount};
+        xSemaphoreGive(s_mutex);
+        return count;
+    }
+
+    bool TaskProfiler::getSample(Sample &sample, const size_t age)
+    {
+        if (!s_mutex)
+            return false;
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        const bool exists{age < s_sampleCount};
+        if (exists)
+            sample = s_samples[(s_nextSample + AT_TASK_PROFILER_SAMPLES - 1 - age) % AT_TASK_PROFILER_SAMPLES];
+        xSemaphoreGive(s_mutex);
+        return exists;
+    }
+
+    void TaskProfiler::print(Print &out, const size_t age)
+    {
+        if (!s_printMutex)
+        {
+            out.printf("TaskProfiler not started\n");
+            return;
+        }
+        // The sample is too big for the stack of most tasks
+        xSemaphoreTake(s_printMutex, portMAX_DELAY);
+        Sample &sample{s_printSample};
+        if (!getSample(sample, age))
+        {
+            out.printf("No profile sample %u\n", static_cast<unsigned>(age));
+            xSemaphoreGive(s_printMutex);
+            return;
+        }
+        static constexpr char STATES[]{"XRBSD?"};
+        out.printf("Profile at %u ms, interval %u us, sample cost %u us\n",
+                   static_cast<unsigned>(sample.timestampMs), static_cast<unsigned>(sample.intervalUs),
+                   static_cast<unsigned>(sample.costUs));
+        for (UBaseType_t core{0}; core < portNUM_PROCESSORS; core++)
+            out.printf("Core %u: %3u.%u%% CPU, %u context switches\n", core, sample.corePermille[core] / 10,
+                       sample.corePermille[core] % 10, static_cast<unsigned>(sample.contextSwitches[core]));
+        out.printf("Heap: %u free, %u minimum free, %u largest block, %u%% fragmentation\n",
+                   static_cast<unsigned>(sample.heapFree), static_cast<unsigned>(sample.heapMinimumFree),
+                   static_cast<unsigned>(sample.heapLargestBlock), sample.heapFragmentation);
+        out.printf("%-*s Prio State Core   CPU  Stack\n", configMAX_TASK_NAME_LEN, "Task");
+        const uint16_t recordedCount{sample.taskCount < AT_TASK_PROFILER_MAX_TASKS ? sample.taskCount
+                                                                                   : static_cast<uint16_t>(AT_TASK_PROFILER_MAX_TASKS)};
+        for (uint16_t i{0}; i < recordedCount; i++)
+        {
+            const TaskSample &task{sample.tasks[i]};
+            char core[12]{"-"};
+            if (task.core != tskNO_AFFINITY)
+                std::snprintf(core, sizeof(core), "%d", static_cast<int>(task.core));
+            out.printf("%-*s %4u     %c %4s %3u.%u%% %6u\n", configMAX_TASK_NAME_LEN, task.name,
+                       static_cast<unsigned>(task.priority), STATES[task.state < eInvalid ? task.state : eInvalid],
+                       core, task.cpuPermille / 10, task.cpuPermille % 10,
+                       static_cast<unsigned>(task.stackHighWaterMark));
+        }
+        if (recordedCount < sample.taskCount)
+            out.printf("%u more tasks not recorded\n", static_cast<unsigned>(sample.taskCount - recordedCount));
+        xSemaphoreGive(s_printMutex);
+    }
+
+} // namespace AT
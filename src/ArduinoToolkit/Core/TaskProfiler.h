@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+
+#include "ArduinoToolkit/Core/Base.h"
+
+// The profiler needs the FreeRTOS run time stats, without them it is compiled out ("begin()" returns false)
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+#define AT_TASK_PROFILER_SUPPORTED 1
+#else
+#define AT_TASK_PROFILER_SUPPORTED 0
+#endif
+
+// Samples kept in the ring buffer
+#ifndef AT_TASK_PROFILER_SAMPLES
+#define AT_TASK_PROFILER_SAMPLES 8
+#endif
+
+// Tasks recorded per sample (the rest are only counted). With AT_STATIC_ALLOCATION it is also
+// the maximum number of tasks that can be profiled, there are no samples with more tasks
+#ifndef AT_TASK_PROFILER_MAX_TASKS
+#define AT_TASK_PROFILER_MAX_TASKS 24
+#endif
+
+// Stack size (in bytes) of the profiler task
+#ifndef AT_TASK_PROFILER_TASK_STACK_SIZE
+#define AT_TASK_PROFILER_TASK_STACK_SIZE (3 * 1024)
+#endif
+
+// Count the context switches of each core. FreeRTOS does not count them, call it from
+// "traceTASK_SWITCHED_IN()" when FreeRTOS can be configured (e.g. Arduino as an ESP-IDF component)
+extern "C" void atTaskProfilerSwitchedIn(void);
+
+namespace AT
+{
+
+    /**
+     * @brief Profiler that periodically samples every FreeRTOS task from a low priority task.
+     * A sample holds the CPU share of each task and core over the last interval (from the
+     * FreeRTOS run time counters), the stack high water marks, the context switches of each
+     * core (see atTaskProfilerSwitchedIn) and the state of the heap.
+     * The last AT_TASK_PROFILER_SAMPLES samples are kept in a static ring buffer, read them with
+     * "getSample()", "print()" or the "profile [age]" command on "Config::commandStream".
+     * A sample takes "uxTaskGetSystemState()" (scheduler suspended for a few microseconds per
+     * task) and O(tasks^2) comparisons, its cost is reported in "Sample::costUs".
+     * The task status array grows with the number of tasks. With AT_STATIC_ALLOCATION it holds
+     * AT_TASK_PROFILER_MAX_TASKS, the samples taken with more tasks are skipped and counted
+     * (see "getSkippedCount()").
+     */
+    class TaskProfiler
+    {
+    public:
+        struct Config
+        {
+            // Sampling interval, at least s_MIN_INTERVAL_MS
+            uint32_t intervalMs{1000};
+            UBaseType_t priority{1};
+            BaseType_t core{tskNO_AFFINITY};
+            uint32_t stackSize{AT_TASK_PROFILER_TASK_STACK_SIZE};
+            // Where the commands are read from (and the answers written), nullptr for none
+            Stream *commandStream{nullptr};
+        };
+
+        struct TaskSample
+        {
+            char name[configMAX_TASK_NAME_LEN];
+            TaskHandle_t handle;
+            UBaseType_t priority;
+            eTaskState state;
+            // Core it is pinned to, tskNO_AFFINITY if none (or unknown)
+            BaseType_t core;
+            // Share of one core used during the interval (per mille)
+            uint16_t cpuPermille;
+            // Minimum free stack ever (bytes on the ESP32)
+            uint32_t stackHighWaterMark;
+        };
+
+        struct Sample
+        {
+            // Time at which the sample was taken
+            uint32_t timestampMs;
+            // Run time elapsed since the previous sample (us)
+            uint32_t intervalUs;
+            // Time taken to make this sample (us)
+            uint32_t costUs;
+            // Share of each core used during the interval (per mille)
+            uint16_t corePermille[portNUM_PROCESSORS];
+            uint32_t contextSwitches[portNUM_PROCESSORS];
+            uint32_t heapFree;
+            uint32_t heapMinimumFree;
+            uint32_t heapLargestBlock;
+            // Free heap that is not in the largest block (percent)
+            uint8_t heapFragmentation;
+            // Tasks that exist, only the first AT_TASK_PROFILER_MAX_TASKS are in "tasks"
+            uint16_t taskCount;
+            TaskSample tasks[AT_TASK_PROFILER_MAX_TASKS];
+        };
+
+        static bool begin(const Config &config);
+
+        // Number of samples in the buffer
+        static size_t getSampleCount();
+        // Samples not taken because there were more tasks than the status array could hold
+        static inline uint32_t getSkippedCount() { return s_skippedCount.load(std::memory_order_relaxed); }
+        // Copy a sample, "age" 0 is the last one. Return false if there is no such sample
+        static bool getSample(Sample &sample, const size_t age = 0);
+        static void print(Print &out, const size_t age = 0);
+
+        static inline void countContextSwitch() { s_contextSwitches[xPortGetCoreID()].fetch_add(1, std::memory_order_relaxed); }
+
+    public:
+        static constexpr uint32_t s_MIN_INTERVAL_MS{100};
+        static constexpr uint32_t s_TASK_STACK_SIZE{AT_TASK_PROFILER_TASK_STACK_SIZE};
+        // Extra room of the task status array, for the tasks created while it is being filled
+        static constexpr size_t s_STATUS_HEADROOM{4};
+
+    private:
+        static void profilerTask(void *const parameters);
+        static bool reserveStatus(const UBaseType_t taskCount);
+        static void takeSample();
+        static void pollCommand();
+
+    private:
+        // Run time of a task in the previous sample
+        struct RunTime
+        {
+            TaskHandle_t handle;
+            UBaseType_t number;
+            uint32_t counter;
+        };
+
+        static Config s_config;
+        static TaskHandle_t s_taskHandle;
+        // Taken while the ring buffer is accessed
+        static SemaphoreHandle_t s_mutex;
+        static Sample s_samples[AT_TASK_PROFILER_SAMPLES];
+        static size_t s_sampleCount;
+        static size_t s_nextSample;
+        // Used only by the profiler task. "s_previous" and "s_current" are swapped after each sample
+        static TaskStatus_t *s_status;
+        static RunTime *s_previous;
+        static RunTime *s_current;
+        static size_t s_statusCapacity;
+        static size_t s_previousCount;
+        static uint32_t s_previousTotalRunTime;
+        static uint32_t s_previousContextSwitches[portNUM_PROCESSORS];
+        static char s_command[32];
+        static size_t s_commandLength;
+        static std::atomic<uint32_t> s_contextSwitches[portNUM_PROCESSORS];
+        static std::atomic<uint32_t> s_skippedCount;
+        // Taken by "print()", which formats the sample from a static copy
+        static SemaphoreHandle_t s_printMutex;
+        static Sample s_printSample;
+#ifdef AT_STATIC_ALLOCATION
+        static TaskStatus_t s_statusStorage[AT_TASK_PROFILER_MAX_TASKS];
+        static RunTime s_previousStorage[AT_TASK_PROFILER_MAX_TASKS];
+        static RunTime s_currentStorage[AT_TASK_PROFILER_MAX_TASKS];
+        static StaticSemaphore_t s_printMutexBuffer;
+        static StaticSemaphore_t s_mutexBuffer;
+        static StackType_t s_taskStack[s_TASK_STACK_SIZE];
+        static StaticTask_t s_taskBuffer;
+#endif
+    }; // class TaskProfiler
+
+} // namespace AT
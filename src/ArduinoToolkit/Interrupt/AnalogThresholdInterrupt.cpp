@@ -0,0 +1,268 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/AnalogThresholdInterrupt.h"
+
+namespace AT
+{
+
+    // Static class members
+    AnalogThresholdInterrupt::SamplerConfig AnalogThresholdInterrupt::s_samplerConfig;
+    AnalogThresholdInterrupt *AnalogThresholdInterrupt::s_instances[s_MAX_CHANNELS]{nullptr};
+    size_t AnalogThresholdInterrupt::s_instanceCount{0};
+    Mutex AnalogThresholdInterrupt::s_mutex;
+    TaskHandle_t AnalogThresholdInterrupt::s_taskHandle{nullptr};
+    bool AnalogThresholdInterrupt::s_samplerRunning{false};
+    std::atomic<uint32_t> AnalogThresholdInterrupt::s_overflowCount{0};
+    uint8_t AnalogThresholdInterrupt::s_rawBlock[AT_ANALOG_BLOCK_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES];
+    uint16_t AnalogThresholdInterrupt::s_channelSamples[AT_ANALOG_BLOCK_SAMPLES];
+#ifdef AT_STATIC_ALLOCATION
+    StackType_t AnalogThresholdInterrupt::s_taskStack[AT_ANALOG_INTERRUPT_TASK_STACK_SIZE];
+    StaticTask_t AnalogThresholdInterrupt::s_taskBuffer;
+#endif
+    ReadySet AnalogThresholdInterrupt::s_readySet;
+
+    // Record the crossings of a block of samples of this object
+    void AnalogThresholdInterrupt::processSamples(const uint16_t *const samples, const size_t count)
+    {
+        if (!count)
+            return;
+        bool changed{false};
+        if (m_firstSample)
+        {
+            // The first sample sets the state directly
+            m_high = m_scanner.initialState(samples[0]);
+            changed = m_edges.update(static_cast<PinState>(m_high != m_reverseLogic));
+            m_firstSample = false;
+        }
+        bool high{m_high};
+        const uint32_t crossings{m_scanner.scan(samples, count, high)};
+        // Crossings alternate, so every one of them is an edge
+        for (uint32_t i{0}; i < crossings; i++)
+        {
+            m_high = !m_high;
+            changed |= m_edges.update(static_cast<PinState>(m_high != m_reverseLogic));
+        }
+        if (!changed)
+            return;
+        // Wake up the receivers of this object and the task waiting for the ready mask
+        xSemaphoreGive(m_interruptBinarySemaphore);
+        s_readySet.mark(m_readySlot);
+    }
+
+    // Split a DMA block by channel and scan the samples of every object. Called with "s_mutex" taken
+    void AnalogThresholdInterrupt::scanBlock(const size_t count)
+    {
+        const adc_digi_output_data_t *const results{reinterpret_cast<const adc_digi_output_data_t *>(s_rawBlock)};
+        for (AnalogThresholdInterrupt *const intPtr : s_instances)
+        {
+            if (!intPtr)
+                continue;
+            size_t samples{0};
+            for (size_t i{0}; i < count; i++)
+                if (results[i].type1.channel == intPtr->m_channel)
+                    s_channelSamples[samples++] = results[i].type1.data;
+            intPtr->processSamples(s_channelSamples, samples);
+        }
+    }
+
+    // Read the DMA blocks and scan them for crossings
+    void AnalogThresholdInterrupt::samplerTask(void *const parameters)
+    {
+        (void)parameters;
+        while (true)
+        {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            uint32_t length{0};
+            // Do not block for long with the mutex taken, the objects may want to reconfigure the ADC
+            const esp_err_t ret{adc_digi_read_bytes(s_rawBlock, sizeof(s_rawBlock), &length, pdMS_TO_TICKS(10))};
+            // ESP_ERR_INVALID_STATE means the driver buffer was full, the block read is still valid
+            if (ret == ESP_ERR_INVALID_STATE)
+                s_overflowCount.fetch_add(1, std::memory_order_relaxed);
+            if (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE)
+                scanBlock(length / SOC_ADC_DIGI_RESULT_BYTES);
+            xSemaphoreGive(s_mutex);
+            // Let the objects take the mutex if the ADC is not running
+            if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE && ret != ESP_ERR_TIMEOUT)
+                vTaskDelay(1);
+        }
+    }
+
+    // Configure the ADC with the channels of every object. Called with "s_mutex" taken
+    void AnalogThresholdInterrupt::restartSampler()
+    {
+        if (s_samplerRunning)
+        {
+            adc_digi_stop();
+            adc_digi_deinitialize();
+            s_samplerRunning = false;
+        }
+        adc_digi_pattern_config_t patterns[s_MAX_CHANNELS];
+        uint32_t channelMask{0};
+        uint32_t patternCount{0};
+        for (uint8_t channel{0}; channel < s_MAX_CHANNELS; channel++)
+        {
+            if (!s_instances[channel])
+                continue;
+            channelMask |= 1UL << channel;
+            adc_digi_pattern_config_t &pattern{patterns[patternCount++]};
+            pattern.atten = s_samplerConfig.atten;
+            pattern.channel = channel;
+            pattern.unit = 0; // ADC1
+            pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        }
+        if (!patternCount)
+            return;
+        adc_digi_init_config_t initConfig{};
+        initConfig.max_store_buf_size = 4 * sizeof(s_rawBlock);
+        initConfig.conv_num_each_intr = sizeof(s_rawBlock);
+        initConfig.adc1_chan_mask = channelMask;
+        initConfig.adc2_chan_mask = 0;
+        ESP_ERROR_CHECK(adc_digi_initialize(&initConfig));
+        adc_digi_configuration_t digiConfig{};
+        // The ESP32 requires the conversion limit to be enabled
+        digiConfig.conv_limit_en = true;
+        digiConfig.conv_limit_num = 250;
+        digiConfig.pattern_num = patternCount;
+        digiConfig.adc_pattern = patterns;
+        digiConfig.sample_freq_hz = s_samplerConfig.sampleFreqHz;
+        digiConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        digiConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+        ESP_ERROR_CHECK(adc_digi_controller_configure(&digiConfig));
+        ESP_ERROR_CHECK(adc_digi_start());
+        s_samplerRunning = true;
+        AT_LOG_V("ADC continuous mode started with channel mask 0x%02x", channelMask);
+    }
+
+    /**
+     * @brief Construct an AnalogThresholdInterrupt.
+     *
+     * @param pin Pin of the input. It must be an ADC1 pin (GPIO 32 to 39).
+     * @param lowThreshold Raw ADC value (12 bits) at or below which the state goes low.
+     * @param highThreshold Raw ADC value (12 bits) at or above which the state goes high.
+     * @param reverseLogic Invert the logic of the input.
+     */
+    AnalogThresholdInterrupt::AnalogThresholdInterrupt(const uint8_t pin,
+                                                       const uint16_t lowThreshold,
+                                                       const uint16_t highThreshold,
+                                                       const bool reverseLogic)
+        : m_pin(pin),
+          m_channel(digitalPinToAnalogChannel(pin)),
+          m_reverseLogic(reverseLogic),
+          m_scanner(lowThreshold, highThreshold),
+          m_readySlot(s_readySet.allocateSlot())
+    {
+        ASSERT(lowThreshold < highThreshold);
+        // Only the ADC1 can be used in continuous mode (the ADC2 is shared with the WiFi)
+        ASSERT(m_channel >= 0 && m_channel < s_MAX_CHANNELS);
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        ASSERT(!s_instances[m_channel]);
+        s_instances[m_channel] = this;
+        s_instanceCount++;
+        restartSampler();
+        xSemaphoreGive(s_mutex);
+        // Check if the sampler task needs to be created
+        if (!s_taskHandle)
+        {
+#ifdef AT_STATIC_ALLOCATION
+            // The stack is statically allocated with AT_ANALOG_INTERRUPT_TASK_STACK_SIZE bytes
+            ASSERT(s_samplerConfig.stackSize <= AT_ANALOG_INTERRUPT_TASK_STACK_SIZE);
+            s_taskHandle = xTaskCreateStaticPinnedToCore(samplerTask,
+                                                         "analogInterruptTask",
+                                                         s_samplerConfig.stackSize,
+                                                         nullptr,
+                                                         s_samplerConfig.priority,
+                                                         s_taskStack,
+                                                         &s_taskBuffer,
+                                                         s_samplerConfig.core);
+            ASSERT(s_taskHandle);
+#else
+            const BaseType_t ret{xTaskCreatePinnedToCore(samplerTask,
+                                                         "analogInterruptTask",
+                                                         s_samplerConfig.stackSize,
+                                                         nullptr,
+                                                         s_samplerConfig.priority,
+                                                         &s_taskHandle,
+                                                         s_samplerConfig.core)};
+            ASSERT(ret);
+#endif
+            AT_LOG_D("AnalogThresholdInterrupt sampler task created");
+        }
+        AT_LOG_I("AnalogThresholdInterrupt enabled on pin %u", m_pin);
+    }
+
+    AnalogThresholdInterrupt::~AnalogThresholdInterrupt()
+    {
+        // The sampler task is not using this object while the mutex is taken
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_instances[m_channel] = nullptr;
+        restartSampler();
+        // Delete the sampler task if there are no objects left
+        if (!--s_instanceCount)
+        {
+            vTaskDelete(s_taskHandle);
+            s_taskHandle = nullptr;
+            AT_LOG_V("AnalogThresholdInterrupt task deleted");
+        }
+        xSemaphoreGive(s_mutex);
+        // Free the bit of this object in the ready mask
+        s_readySet.releaseSlot(m_readySlot);
+        AT_LOG_D("AnalogThresholdInterrupt disabled on pin %u", m_pin);
+    }
+
+    PinState AnalogThresholdInterrupt::receiveInterrupt(const TickType_t xTicksToWait) const
+    {
+        return receive(ReceiveMode::Next, xTicksToWait);
+    }
+
+    PinState AnalogThresholdInterrupt::receiveInterruptDiscardIntermediate(const TickType_t xTicksToWait) const
+    {
+        return receive(ReceiveMode::DiscardIntermediate, xTicksToWait);
+    }
+
+    PinState AnalogThresholdInterrupt::receiveLastInterrupt(const TickType_t xTicksToWait) const
+    {
+        return receive(ReceiveMode::Last, xTicksToWait);
+    }
+
+    PinState AnalogThresholdInterrupt::receive(const ReceiveMode mode, const TickType_t xTicksToWait) const
+    {
+        return s_readySet.receive(m_edges, m_interruptBinarySemaphore, m_readySlot, mode, xTicksToWait);
+    }
+
+    /**
+     * @brief Configure the ADC sampling and the task that scans the samples.
+     * It must be called before constructing any object.
+     *
+     * @param config New configuration of the sampler.
+     * @return true if the configuration has been applied, false if there are objects alive.
+     */
+    bool AnalogThresholdInterrupt::setSamplerConfig(const SamplerConfig &config)
+    {
+        if (s_instanceCount)
+        {
+            AT_LOG_W("The AnalogThresholdInterrupt sampler can not be configured while there are objects");
+            return false;
+        }
+        s_samplerConfig = config;
+        return true;
+    }
+
+    bool AnalogThresholdInterrupt::waitUntilAnyInterrupt(const TickType_t xTicksToWait)
+    {
+        return s_readySet.waitAny(xTicksToWait);
+    }
+
+    /**
+     * @brief Block until any object has pending crossings.
+     * Only one task can wait for the interrupts of the class at a time.
+     *
+     * @param xTicksToWait The maximum time to wait for an interrupt.
+     * @return The mask of the objects with pending interrupts (see "getInterruptMask()"),
+     *         or 0 if no interrupt was received within the specified timeout.
+     */
+    uint32_t AnalogThresholdInterrupt::waitForInterruptMask(const TickType_t xTicksToWait)
+    {
+        return s_readySet.wait(xTicksToWait);
+    }
+
+} // namespace AT
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+
+#include <driver/adc.h>
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/BinarySemaphore.h"
+#include "ArduinoToolkit/Core/Mutex.h"
+#include "ArduinoToolkit/Interrupt/PendingEdges.h"
+#include "ArduinoToolkit/Interrupt/PinState.h"
+#include "ArduinoToolkit/Interrupt/ReadySet.h"
+#include "ArduinoToolkit/Interrupt/ThresholdScanner.h"
+
+// Conversions read from the ADC in every DMA block (shared by all the channels)
+#ifndef AT_ANALOG_BLOCK_SAMPLES
+#define AT_ANALOG_BLOCK_SAMPLES 256
+#endif
+
+// Stack size (in bytes) of the sampler task. With AT_STATIC_ALLOCATION
+// it is the size of its static stack and the maximum that can be configured
+#ifndef AT_ANALOG_INTERRUPT_TASK_STACK_SIZE
+#define AT_ANALOG_INTERRUPT_TASK_STACK_SIZE (3 * 1024)
+#endif
+
+namespace AT
+{
+
+    /**
+     * @brief Interrupt on the threshold crossings of an analog input.
+     * The ADC1 channels of every object are sampled by the ADC continuous (DMA) mode and a
+     * single task scans each DMA block with a ThresholdScanner, so the CPU is woken up once
+     * per block instead of once per sample. The state goes high when the input reaches the
+     * high threshold and low when it drops to the low threshold.
+     * The crossings are received with the same API as BasicInterrupt.
+     * The ADC1 is owned by this class while there are objects, "analogRead()" must not be
+     * used on its channels meanwhile.
+     */
+    class AnalogThresholdInterrupt
+    {
+    public:
+        // Configuration of the ADC and of the task that scans the samples
+        struct SamplerConfig
+        {
+            // Conversions per second, shared by all the channels (611 Hz to 83333 Hz)
+            uint32_t sampleFreqHz{20000};
+            adc_atten_t atten{ADC_ATTEN_DB_11};
+            BaseType_t core{ARDUINO_RUNNING_CORE};
+            UBaseType_t priority{2};
+            uint32_t stackSize{AT_ANALOG_INTERRUPT_TASK_STACK_SIZE};
+        };
+
+        AnalogThresholdInterrupt(const uint8_t pin,
+                                 const uint16_t lowThreshold,
+                                 const uint16_t highThreshold,
+                                 const bool reverseLogic = false);
+        ~AnalogThresholdInterrupt();
+
+        inline uint8_t getPin() const { return m_pin; }
+        inline PinState getState() const { return m_edges.getState(); }
+        inline uint16_t getLowThreshold() const { return m_scanner.getLowThreshold(); }
+        inline uint16_t getHighThreshold() const { return m_scanner.getHighThreshold(); }
+        // Bit of this object in the mask returned by "waitForInterruptMask()"
+        inline uint32_t getInterruptMask() const { return ReadySet::slotMask(m_readySlot); }
+
+        PinState receiveInterrupt(const TickType_t xTicksToWait = portMAX_DELAY) const;
+        PinState receiveInterruptDiscardIntermediate(const TickType_t xTicksToWait = portMAX_DELAY) const;
+        PinState receiveLastInterrupt(const TickType_t xTicksToWait = portMAX_DELAY) const;
+
+    public:
+        static bool waitUntilAnyInterrupt(const TickType_t xTicksToWait = portMAX_DELAY);
+        static uint32_t waitForInterruptMask(const TickType_t xTicksToWait = portMAX_DELAY);
+        // Ready mask of the class, for dispatchers that wait on several classes at once
+        static inline ReadySet &getReadySet() { return s_readySet; }
+
+        static bool setSamplerConfig(const SamplerConfig &config);
+        static inline const SamplerConfig &getSamplerConfig() { return s_samplerConfig; }
+        // Blocks the DMA produced before the task could read them (their samples are lost)
+        static inline uint32_t getOverflowCount() { return s_overflowCount.load(std::memory_order_relaxed); }
+
+    public:
+        static constexpr uint8_t s_MAX_CHANNELS{8};
+
+    private:
+        static void samplerTask(void *const parameters);
+        static void restartSampler();
+        static void scanBlock(const size_t count);
+        void processSamples(const uint16_t *const samples, const size_t count);
+        PinState receive(const ReceiveMode mode, const TickType_t xTicksToWait) const;
+
+    private:
+        const uint8_t m_pin;
+        const int8_t m_channel;
+        const bool m_reverseLogic;
+        const ThresholdScanner m_scanner;
+        // Threshold state before reverse logic. Only accessed by the sampler task
+        bool m_high{false};
+        bool m_firstSample{true};
+        // Current state and number of edges not yet received
+        mutable PendingEdges m_edges;
+        // Given on every crossing to wake up the receivers of this object
+        BinarySemaphore m_interruptBinarySemaphore;
+        // Bit of this object in "s_readySet"
+        const int8_t m_readySlot;
+
+    private:
+        static SamplerConfig s_samplerConfig;
+        // Objects indexed by their ADC1 channel, protected by "s_mutex"
+        static AnalogThresholdInterrupt *s_instances[s_MAX_CHANNELS];
+        static size_t s_instanceCount;
+        // Held by the sampler task while it reads and scans a block
+        static Mutex s_mutex;
+        static TaskHandle_t s_taskHandle;
+        static bool s_samplerRunning;
+        static std::atomic<uint32_t> s_overflowCount;
+        // Raw DMA block and the samples of one channel extracted from it
+        static uint8_t s_rawBlock[AT_ANALOG_BLOCK_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES];
+        static uint16_t s_channelSamples[AT_ANALOG_BLOCK_SAMPLES];
+#ifdef AT_STATIC_ALLOCATION
+        static StackType_t s_taskStack[AT_ANALOG_INTERRUPT_TASK_STACK_SIZE];
+        static StaticTask_t s_taskBuffer;
+#endif
+        // Objects with pending crossings
+        static ReadySet s_readySet;
+    }; // class AnalogThresholdInterrupt
+
+} // namespace AT
@@ -0,0 +1,143 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/BankDebouncer.h"
+
+namespace AT
+{
+
+    // Static class members
+    std::atomic<BankDebouncer *> BankDebouncer::s_instances[s_NUM_TIMERS]{};
+    std::atomic<bool> BankDebouncer::s_sampling[s_NUM_TIMERS]{};
+
+    // Timer ISR. Sample the bank and debounce all its pins at once
+    void IRAM_ATTR BankDebouncer::sample()
+    {
+        const uint32_t rawBank{REG_READ(m_bank == Bank::Gpio0To31 ? GPIO_IN_REG : GPIO_IN1_REG)};
+        // Invert the logic if needed and ignore the pins that are not debounced
+        const uint32_t rawPins{(rawBank ^ m_reverseLogicMask) & m_pinMask};
+        uint32_t changedPins;
+        if (m_firstSample)
+        {
+            // The first sample sets the state of every pin directly
+            m_counter.reset(rawPins);
+            changedPins = m_pinMask;
+            m_firstSample = false;
+        }
+        else
+        {
+            changedPins = m_counter.update(rawPins);
+            if (!changedPins)
+                return;
+        }
+        // Record the new state of the pins that have changed
+        const uint32_t state{m_counter.getState()};
+        for (uint32_t pending{changedPins}; pending; pending &= pending - 1)
+        {
+            const uint8_t bit{static_cast<uint8_t>(__builtin_ctz(pending))};
+            m_edges[bit].update(((state >> bit) & 1) ? PinState::High : PinState::Low);
+        }
+        // Wake up the receivers
+        BaseType_t xHigherPriorityTaskWoken{pdFALSE};
+        xSemaphoreGiveFromISR(m_interruptBinarySemaphore, &xHigherPriorityTaskWoken);
+        m_readySet.markMaskFromISR(changedPins, &xHigherPriorityTaskWoken);
+        // Did this action unblock a higher priority task?
+        if (xHigherPriorityTaskWoken)
+            portYIELD_FROM_ISR();
+    }
+
+    /**
+     * @brief Construct a BankDebouncer.
+     *
+     * @param pinMask Pins of the bank to debounce (bit i is the i-th pin of the bank).
+     * @param mode Mode set to every pin in "pinMask".
+     * @param samplePeriodUs Period of the sampling timer. A pin is debounced in
+     *                       s_SAMPLES_TO_TOGGLE * samplePeriodUs microseconds.
+     * @param reverseLogicMask Pins whose logic is inverted.
+     * @param bank GPIO bank the pins belong to.
+     * @param timerNum Hardware timer used for the sampling (from 0 to s_NUM_TIMERS - 1).
+     */
+    BankDebouncer::BankDebouncer(const uint32_t pinMask,
+                                 const uint8_t mode,
+                                 const uint32_t samplePeriodUs,
+                                 const uint32_t reverseLogicMask,
+                                 const Bank bank,
+                                 const uint8_t timerNum)
+        : m_pinMask(pinMask),
+          m_reverseLogicMask(reverseLogicMask),
+          m_bank(bank),
+          m_timerNum(timerNum)
+    {
+        ASSERT(m_timerNum < s_NUM_TIMERS && !s_instances[m_timerNum]);
+        // Set up the mode of the pins
+        for (uint32_t pending{m_pinMask}; pending; pending &= pending - 1)
+            pinMode(bankFirstPin() + __builtin_ctz(pending), mode);
+        // Set up the sampling timer with a resolution of 1us (80MHz APB clock / 80)
+        static constexpr void (*const sampleISRs[s_NUM_TIMERS])(){sampleISR<0>, sampleISR<1>, sampleISR<2>, sampleISR<3>};
+        s_instances[m_timerNum] = this;
+        m_timer = timerBegin(m_timerNum, 80, true);
+        ASSERT(m_timer);
+        timerAttachInterrupt(m_timer, sampleISRs[m_timerNum], true);
+        timerAlarmWrite(m_timer, samplePeriodUs, true);
+        timerAlarmEnable(m_timer);
+        AT_LOG_I("BankDebouncer enabled on pin mask 0x%08x", m_pinMask);
+    }
+
+    BankDebouncer::~BankDebouncer()
+    {
+        // Stop the sampling timer
+        timerAlarmDisable(m_timer);
+        timerDetachInterrupt(m_timer);
+        timerEnd(m_timer);
+        // Wait for a sample that was already running
+        s_instances[m_timerNum].store(nullptr);
+        while (s_sampling[m_timerNum].load())
+            vTaskDelay(1);
+        AT_LOG_D("BankDebouncer disabled on pin mask 0x%08x", m_pinMask);
+    }
+
+    PinState BankDebouncer::getState(const uint8_t pin) const
+    {
+        if (!(getInterruptMask(pin) & m_pinMask))
+            return PinState::Unknown;
+        return m_edges[pin - bankFirstPin()].getState();
+    }
+
+    PinState BankDebouncer::receive(const uint8_t pin, const ReceiveMode mode, const TickType_t xTicksToWait) const
+    {
+        if (!(getInterruptMask(pin) & m_pinMask))
+        {
+            AT_LOG_E("Pin %u is not debounced by this BankDebouncer", pin);
+            return PinState::Unknown;
+        }
+        const uint8_t bit{static_cast<uint8_t>(pin - bankFirstPin())};
+        return m_readySet.receive(m_edges[bit], m_interruptBinarySemaphore, bit, mode, xTicksToWait);
+    }
+
+    PinState BankDebouncer::receiveInterrupt(const uint8_t pin, const TickType_t xTicksToWait) const
+    {
+        return receive(pin, ReceiveMode::Next, xTicksToWait);
+    }
+
+    PinState BankDebouncer::receiveInterruptDiscardIntermediate(const uint8_t pin, const TickType_t xTicksToWait) const
+    {
+        return receive(pin, ReceiveMode::DiscardIntermediate, xTicksToWait);
+    }
+
+    PinState BankDebouncer::receiveLastInterrupt(const uint8_t pin, const TickType_t xTicksToWait) const
+    {
+        return receive(pin, ReceiveMode::Last, xTicksToWait);
+    }
+
+    /**
+     * @brief Block until any pin has pending interrupts.
+     *
+     * @param xTicksToWait The maximum time to wait for an interrupt.
+     * @return The mask of the pins with pending interrupts (see "getInterruptMask()"),
+     *         or 0 if no interrupt was received within the specified timeout.
+     */
+    uint32_t BankDebouncer::waitForInterruptMask(const TickType_t xTicksToWait) const
+    {
+        return m_readySet.wait(xTicksToWait);
+    }
+
+} // namespace AT
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/BinarySemaphore.h"
+#include "ArduinoToolkit/Interrupt/PendingEdges.h"
+#include "ArduinoToolkit/Interrupt/PinState.h"
+#include "ArduinoToolkit/Interrupt/ReadySet.h"
+#include "ArduinoToolkit/Interrupt/VerticalCounter.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Debouncer of a whole GPIO bank driven by one hardware timer.
+     * The GPIO input register is sampled at a fixed rate from the timer ISR and all the pins
+     * in "pinMask" are debounced at once with vertical counters, so a single register read
+     * and a few word-wide operations handle up to 32 pins per sample. A pin changes its state
+     * after s_SAMPLES_TO_TOGGLE consecutive samples at the new level.
+     * The changes are received with the same API as BasicInterrupt, passing the pin number.
+     * Bit i of the masks corresponds to the i-th pin of the bank.
+     * Only one task should receive the interrupts of a BankDebouncer.
+     */
+    class BankDebouncer
+    {
+    public:
+        enum class Bank : uint8_t
+        {
+            Gpio0To31,
+            Gpio32To39
+        };
+
+        BankDebouncer(const uint32_t pinMask,
+                      const uint8_t mode,
+                      const uint32_t samplePeriodUs,
+                      const uint32_t reverseLogicMask = 0,
+                      const Bank bank = Bank::Gpio0To31,
+                      const uint8_t timerNum = 0);
+        ~BankDebouncer();
+
+        inline uint32_t getPinMask() const { return m_pinMask; }
+        PinState getState(const uint8_t pin) const;
+        // Bit of "pin" in the mask returned by "waitForInterruptMask()", 0 if the pin is not in the bank
+        inline uint32_t getInterruptMask(const uint8_t pin) const
+        {
+            if (pin < bankFirstPin() || pin - bankFirstPin() >= 32)
+                return 0;
+            return 1UL << (pin - bankFirstPin());
+        }
+
+        PinState receiveInterrupt(const uint8_t pin, const TickType_t xTicksToWait = portMAX_DELAY) const;
+        PinState receiveInterruptDiscardIntermediate(const uint8_t pin, const TickType_t xTicksToWait = portMAX_DELAY) const;
+        PinState receiveLastInterrupt(const uint8_t pin, const TickType_t xTicksToWait = portMAX_DELAY) const;
+
+        uint32_t waitForInterruptMask(const TickType_t xTicksToWait = portMAX_DELAY) const;
+
+    public:
+        static constexpr uint8_t s_COUNTER_BITS{2};
+        static constexpr uint32_t s_SAMPLES_TO_TOGGLE{VerticalCounter<s_COUNTER_BITS>::s_SAMPLES_TO_TOGGLE};
+        static constexpr uint8_t s_NUM_TIMERS{4};
+
+    private:
+        template <uint8_t TimerNum>
+        static void IRAM_ATTR sampleISR()
+        {
+            // The destructor waits while the flag is set, so the instance outlives the sample
+            s_sampling[TimerNum].store(true);
+            BankDebouncer *const instance{s_instances[TimerNum].load()};
+            if (instance)
+                instance->sample();
+            s_sampling[TimerNum].store(false);
+        }
+        void IRAM_ATTR sample();
+
+        inline uint8_t bankFirstPin() const { return m_bank == Bank::Gpio0To31 ? 0 : 32; }
+        PinState receive(const uint8_t pin, const ReceiveMode mode, const TickType_t xTicksToWait) const;
+
+    private:
+        const uint32_t m_pinMask;
+        const uint32_t m_reverseLogicMask;
+        const Bank m_bank;
+        const uint8_t m_timerNum;
+        hw_timer_t *m_timer{nullptr};
+        VerticalCounter<s_COUNTER_BITS> m_counter;
+        bool m_firstSample{true};
+        // Debounced state and number of edges not yet received of every pin of the bank
+        mutable PendingEdges m_edges[32];
+        // Given on every sample with changes to wake up the receivers
+        BinarySemaphore m_interruptBinarySemaphore;
+        mutable ReadySet m_readySet;
+
+    private:
+        static std::atomic<BankDebouncer *> s_instances[s_NUM_TIMERS];
+        // Set while the timer ISR is sampling, it may run on the other core
+        static std::atomic<bool> s_sampling[s_NUM_TIMERS];
+    };
+
+} // namespace AT
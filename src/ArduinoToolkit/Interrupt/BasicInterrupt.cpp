@@ -1,92 +1,162 @@
+#define AT_LOG_MODULE Interrupt
+
 #include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
 
+#include <driver/gpio.h>
+#include <esp_ipc.h>
+
 namespace AT
 {
 
     // Static class members
-    SemaphoreHandle_t BasicInterrupt::s_interruptCountingSepmaphore{nullptr};
+    ReadySet BasicInterrupt::s_readySet;
 
     // Interrupt service routine (ISR) function
     void IRAM_ATTR BasicInterrupt::intISR(void *const voidPtrInt)
     {
         BasicInterrupt *const &intPtr{static_cast<BasicInterrupt *>(voidPtrInt)};
+        // Timestamp the edge as soon as possible
+        const uint32_t cycles{ESP.getCycleCount()};
         // Read the current state of the sensor pin
-        const bool rawPinValue{digitalRead(intPtr->m_pin)};
+        const bool rawPinValue{static_cast<bool>(digitalRead(intPtr->m_pin))};
         // Invert the logic if needed (Logic XOR between rawPinValue and intPtr->m_reverseLogic)
-        const PinState newState{static_cast<PinState>(rawPinValue != intPtr->m_reverseLogic)};
-        BaseType_t xHigherPriorityTaskWoken{pdFALSE};
-        // Start the PeriodicCallToISR timer the first time the ISR is called
-        if (intPtr->m_state == PinState::Unknown)
-        {
-            if (!xTimerResetFromISR(intPtr->m_periodicCallToISRtimer, &xHigherPriorityTaskWoken))
-                return;
-        }
-        // Check if the sensor state has changed
-        if (newState != intPtr->m_state)
+        intPtr->processEdge(static_cast<PinState>(rawPinValue != intPtr->m_reverseLogic), cycles);
+    }
+
+    // Called by the MissedEdgeSweeper. Return true if the ISR found a state change that had been missed
+    bool BasicInterrupt::sweepCallback(void *const voidPtrInt)
+    {
+        BasicInterrupt *const &intPtr{static_cast<BasicInterrupt *>(voidPtrInt)};
+        // Do not call the ISR until the first interrupt has happened
+        const PinState previousState{intPtr->m_edges.getState()};
+        if (previousState == PinState::Unknown)
+            return false;
+        intPtr->m_interruptHandler(voidPtrInt);
+        return intPtr->m_edges.getState() != previousState;
+    }
+
+    // Called by the ISR call that starts a storm (or by the sweep, in the esp_timer task).
+    // Disable the interrupt of the pin and poll it instead. Not in IRAM, it runs once per storm
+    // and the GPIO interrupt of "attachInterruptArg()" is only an IRAM interrupt (that runs while
+    // the flash cache is disabled) with CONFIG_ARDUINO_ISR_IRAM, which the storm guard does not support
+    void BasicInterrupt::startStormPolling()
+    {
+        gpio_intr_disable(static_cast<gpio_num_t>(m_pin));
+        DeadlineScheduler::scheduleFromISR(m_stormPollDeadline, m_stormPollPeriodMs * 1000ULL);
+    }
+
+    // Poll the pin during a storm and enable its interrupt again once it is quiet
+    void BasicInterrupt::stormPollCallback(void *const voidPtrInt)
+    {
+        BasicInterrupt *const &intPtr{static_cast<BasicInterrupt *>(voidPtrInt)};
+        const uint64_t nowUs{DeadlineScheduler::nowUs()};
+        if (!intPtr->m_stormStartUs)
         {
-            // Update the current state of the pin
-            intPtr->m_state = newState;
-            // Increment the object interrupt semaphore counter
-            xSemaphoreGiveFromISR(intPtr->m_interruptCountingSepmaphore, &xHigherPriorityTaskWoken);
-            // Increment the class interrupt semaphore counter
-            xSemaphoreGiveFromISR(s_interruptCountingSepmaphore, &xHigherPriorityTaskWoken);
+            intPtr->m_stormStartUs = nowUs;
+            AT_LOG_W("Edge storm on pin %u, polling it every %u ms", intPtr->m_pin, intPtr->m_stormPollPeriodMs);
         }
-        // Did this action unblock a higher priority task?
-        if (xHigherPriorityTaskWoken)
-            portYIELD_FROM_ISR();
+        // Read the pin as the ISR does, so at most one edge is delivered per poll
+        intPtr->m_interruptHandler(voidPtrInt);
+        portENTER_CRITICAL(&intPtr->m_isrSpinlock);
+        const bool stormOver{intPtr->m_stormGuard.poll(intPtr->m_edges.getState(), static_cast<uint32_t>(nowUs))};
+        const bool attached{intPtr->m_attached};
+        // Keep polling. It is scheduled inside the critical section so "detach()" can not miss it
+        if (attached && !stormOver)
+            DeadlineScheduler::schedule(intPtr->m_stormPollDeadline, intPtr->m_stormPollPeriodMs * 1000ULL);
+        portEXIT_CRITICAL(&intPtr->m_isrSpinlock);
+        if (!attached || !stormOver)
+            return;
+        const uint32_t durationMs{static_cast<uint32_t>((nowUs - intPtr->m_stormStartUs) / 1000)};
+        intPtr->m_stormStartUs = 0;
+        // Read the pin once more after enabling the interrupt, it may have changed meanwhile
+        gpio_intr_enable(static_cast<gpio_num_t>(intPtr->m_pin));
+        intPtr->m_interruptHandler(voidPtrInt);
+        AT_LOG_I("Edge storm on pin %u over after %u ms, back to interrupt mode", intPtr->m_pin, durationMs);
+    }
+
+    // Attach the ISR to the pin. The interrupt is allocated on the core that calls it
+    void BasicInterrupt::attachOnCurrentCore(void *const voidPtrInt)
+    {
+        BasicInterrupt *const &intPtr{static_cast<BasicInterrupt *>(voidPtrInt)};
+        attachInterruptArg(intPtr->m_pin, intPtr->m_interruptHandler, voidPtrInt, CHANGE);
     }
 
-    void BasicInterrupt::timerNoActivityCallback(const TimerHandle_t xTimer)
+    // Default edge notifier. Set the bit of the object in the ready mask of the class
+    void IRAM_ATTR BasicInterrupt::notifyReadySetFromISR(BasicInterrupt *const intPtr,
+                                                         BaseType_t *const pxHigherPriorityTaskWoken)
     {
-        intISR(pvTimerGetTimerID(xTimer));
+        s_readySet.markFromISR(intPtr->m_readySlot, pxHigherPriorityTaskWoken);
     }
 
     BasicInterrupt::BasicInterrupt(const uint8_t pin,
                                    const uint8_t mode,
                                    const bool reverseLogic,
                                    const uint32_t periodicCallToISRms)
+        : BasicInterrupt(pin, mode, reverseLogic, periodicCallToISRms, notifyReadySetFromISR)
+    {
+    }
+
+    BasicInterrupt::BasicInterrupt(const uint8_t pin,
+                                   const uint8_t mode,
+                                   const bool reverseLogic,
+                                   const uint32_t periodicCallToISRms,
+                                   const EdgeNotifier edgeNotifier,
+                                   const BaseType_t isrCore,
+                                   const InterruptHandler interruptHandler)
         : m_pin(pin),
           m_mode(mode),
-          m_reverseLogic(reverseLogic)
+          m_reverseLogic(reverseLogic),
+          m_edgeNotifier(edgeNotifier),
+          m_interruptHandler(interruptHandler),
+          m_readySlot(edgeNotifier == notifyReadySetFromISR ? s_readySet.allocateSlot() : ReadySet::s_NO_SLOT)
     {
-        // Create a semaphore to count the number of interrupts that happens on this object
-        m_interruptCountingSepmaphore = xSemaphoreCreateCounting(-1, 0);
-        ASSERT(m_interruptCountingSepmaphore);
-        // Create a semaphore to count the number of interrupts that happens for all objects
-        if (!s_interruptCountingSepmaphore)
-        {
-            s_interruptCountingSepmaphore = xSemaphoreCreateCounting(-1, 0);
-            ASSERT(s_interruptCountingSepmaphore);
-        }
+        // Only ReadySet::s_MAX_SLOTS objects are reported in the ready mask, the rest still work
+        if (m_edgeNotifier == notifyReadySetFromISR && m_readySlot == ReadySet::s_NO_SLOT)
+            AT_LOG_W("BasicInterrupt on pin %u is not in the ready mask", m_pin);
         // Set up the pin mode and attach the interrupt
         pinMode(m_pin, m_mode);
-        attachInterruptArg(m_pin, intISR, static_cast<void *>(this), CHANGE);
-        // Create a timer to call the ISR (to catch missing interrupts)
-        m_periodicCallToISRtimer = xTimerCreate("PeriodicCallToISR",
-                                                pdMS_TO_TICKS(periodicCallToISRms),
-                                                pdTRUE,
-                                                static_cast<void *>(this),
-                                                timerNoActivityCallback);
-        ASSERT(m_periodicCallToISRtimer);
+        if (isrCore == tskNO_AFFINITY || isrCore == xPortGetCoreID())
+            attachOnCurrentCore(static_cast<void *>(this));
+        else
+            ESP_ERROR_CHECK(esp_ipc_call_blocking(isrCore, attachOnCurrentCore, static_cast<void *>(this)));
+        // Call the ISR from the shared sweep (to catch missing interrupts). While the inputs are
+        // quiet the sweep backs off, "periodicCallToISRms" is its period while this one is active
+        ASSERT(periodicCallToISRms);
+        MissedEdgeSweeper::add(m_sweepTarget, periodicCallToISRms);
+        m_attached = true;
         AT_LOG_I("BasicInterrupt enabled on pin %u", m_pin);
     }
 
     BasicInterrupt::~BasicInterrupt()
     {
+        detach();
+        // Free the bit of this object in the ready mask
+        s_readySet.releaseSlot(m_readySlot);
+        AT_LOG_D("BasicInterrupt disabled on pin %u", m_pin);
+    }
+
+    // Stop producing edges. Derived classes call it before tearing themselves down
+    void BasicInterrupt::detach()
+    {
+        if (!m_attached)
+            return;
         // Dettach the interrupt from the pin
         detachInterrupt(m_pin);
-        // Delete the timer
-        xTimerDelete(m_periodicCallToISRtimer, portMAX_DELAY);
-        // Delete the interrupt counting semaphore
-        vSemaphoreDelete(m_interruptCountingSepmaphore);
-        AT_LOG_D("BasicInterrupt disabled on pin %u", m_pin);
+        // Stop calling the ISR from the sweep
+        MissedEdgeSweeper::remove(m_sweepTarget);
+        portENTER_CRITICAL(&m_isrSpinlock);
+        m_attached = false;
+        portEXIT_CRITICAL(&m_isrSpinlock);
+        // Stop polling the pin if there is a storm
+        if (m_stormGuard.isEnabled())
+            DeadlineScheduler::remove(m_stormPollDeadline);
     }
 
     /**
-     * @brief Receive an interrupt from the ISR using a semaphore.
+     * @brief Receive the oldest pending interrupt from the ISR.
      * This function blocks until an interrupt is received or the specified timeout elapses.
-     * It then determines the state of the past interrupts by examining the semaphore counter
-     * and the current interrupt state.
+     * The state of the received interrupt is determined from the number of edges that remain
+     * pending and the current interrupt state.
      *
      * @param xTicksToWait The maximum time to wait for an interrupt.
      * @return PinState::Low if the interrupt state is low, PinState::High if the interrupt state is high,
@@ -94,58 +164,27 @@ namespace AT
      */
     PinState BasicInterrupt::receiveInterrupt(const TickType_t xTicksToWait) const
     {
-        // Block until an interrupt arrives from the ISR
-        if (xSemaphoreTake(m_interruptCountingSepmaphore, xTicksToWait))
-        {
-            // Take also the class semaphore
-            xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            // Disable interrupts so m_state or the semaphore count is not updated
-            // from the ISR if an interrupt happens here.
-            portENTER_CRITICAL(&spinlock);
-            const UBaseType_t interruptsLeft{uxSemaphoreGetCount(m_interruptCountingSepmaphore)};
-            const bool interruptState{static_cast<bool>(m_state)};
-            portEXIT_CRITICAL(&spinlock);
-            // Depending on the semaphore counter (interrupts that remain to be processed)
-            // and the current state of the interrupt, determine which state the past interrupts
-            // correspond to (by doing an XOR operation).
-            return ((interruptsLeft % 2) != interruptState) ? PinState::High : PinState::Low;
-        }
-        return PinState::Unknown;
+        return receive(ReceiveMode::Next, xTicksToWait);
     }
 
+    /**
+     * @brief Receive an interrupt from the ISR discarding the intermediate ones.
+     * Pending interrupts are discarded in pairs so at most one remains pending,
+     * which keeps the alternation of the received states.
+     *
+     * @param xTicksToWait The maximum time to wait for an interrupt.
+     * @return The state of the received interrupt, or PinState::Unknown if no interrupt
+     *         was received within the specified timeout.
+     */
     PinState BasicInterrupt::receiveInterruptDiscardIntermediate(const TickType_t xTicksToWait) const
     {
-        if (xSemaphoreTake(m_interruptCountingSepmaphore, xTicksToWait))
-        {
-            // Take also the class semaphore
-            xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            // Disable interrupts so m_state or the semaphore count is not updated
-            // from the ISR if an interrupt happens here.
-            portENTER_CRITICAL(&spinlock);
-            UBaseType_t interruptsLeft{uxSemaphoreGetCount(m_interruptCountingSepmaphore)};
-            const bool interruptState{static_cast<bool>(m_state)};
-            portEXIT_CRITICAL(&spinlock);
-            // Discard the intermediate interrupts
-            const UBaseType_t aux{interruptsLeft % 2};
-            for (; interruptsLeft > aux; interruptsLeft--)
-            {
-                xSemaphoreTake(m_interruptCountingSepmaphore, portMAX_DELAY);
-                // Take also the class semaphore
-                xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            }
-            // Depending on the semaphore counter (interrupts that remain to be processed)
-            // and the current state of the interrupt, determine which state the past interrupts
-            // correspond to (by doing an XOR operation).
-            return (static_cast<bool>(aux) != interruptState) ? PinState::High : PinState::Low;
-        }
-        return PinState::Unknown;
+        return receive(ReceiveMode::DiscardIntermediate, xTicksToWait);
     }
 
     /**
-     * @brief Receive the last pending interrupt from the ISR using a semaphore.
+     * @brief Receive the last pending interrupt from the ISR.
      * This function blocks until an interrupt is received or the specified timeout elapses.
-     * It then processes all remaining pending interrupts in the semaphore, effectively
-     * resetting the semaphore count to 0, and returns the state of the last interrupt.
+     * It then consumes all remaining pending interrupts and returns the state of the last one.
      *
      * @param xTicksToWait The maximum time to wait for an interrupt.
      * @return The state of the last received interrupt (PinState::Low or PinState::High)
@@ -154,24 +193,154 @@ namespace AT
      */
     PinState BasicInterrupt::receiveLastInterrupt(const TickType_t xTicksToWait) const
     {
-        if (xSemaphoreTake(m_interruptCountingSepmaphore, xTicksToWait))
+        return receive(ReceiveMode::Last, xTicksToWait);
+    }
+
+    // Receive the raw edges. The time since the latest edge (not the one received) is recorded as "stage"
+    PinState BasicInterrupt::receive(const ReceiveMode mode,
+                                     const TickType_t xTicksToWait,
+                                     const LatencyStage stage) const
+    {
+        const PinState state{s_readySet.receive(m_edges, m_interruptBinarySemaphore, m_readySlot,
+                                                mode, xTicksToWait)};
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        if (state != PinState::Unknown)
+            m_latencyStats.record(stage, LatencyStats::nowUs() - m_lastEdgeTimeUs.load(std::memory_order_relaxed));
+#else
+        (void)stage;
+#endif
+        return state;
+    }
+
+    /**
+     * @brief Enable the edge event buffer of this object.
+     * Once enabled, the ISR records every state change with its CPU cycle counter timestamp
+     * so the consumer can read the full edge history in batches with "drainEvents()".
+     * The event buffer is independent from the "receiveInterrupt" family of functions.
+     *
+     * @param capacity Number of events the buffer can hold. It is rounded up to a power of two.
+     * @return true if the buffer has been enabled, false otherwise.
+     */
+#ifndef AT_STATIC_ALLOCATION
+    bool BasicInterrupt::enableEventBuffer(const size_t capacity)
+    {
+        if (m_events.isAssigned())
         {
-            // Take also the class semaphore
-            xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            while (uxSemaphoreGetCount(m_interruptCountingSepmaphore))
-            {
-                xSemaphoreTake(m_interruptCountingSepmaphore, portMAX_DELAY);
-                // Take also the class semaphore
-                xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            }
-            return m_state;
+            AT_LOG_W("Event buffer already enabled on pin %u", m_pin);
+            return false;
         }
-        return PinState::Unknown;
+        size_t roundedCapacity{1};
+        while (roundedCapacity < capacity)
+            roundedCapacity <<= 1;
+        m_eventStorage.reset(new (std::nothrow) EdgeEvent[roundedCapacity]);
+        if (!m_eventStorage)
+        {
+            AT_LOG_E("Could not allocate the event buffer on pin %u", m_pin);
+            return false;
+        }
+        return enableEventBuffer(m_eventStorage.get(), roundedCapacity);
+    }
+#endif
+
+    /**
+     * @brief Enable the edge event buffer of this object with storage supplied by the caller.
+     * Same as "enableEventBuffer(capacity)" but it does not allocate, so it is the only
+     * version available with AT_STATIC_ALLOCATION.
+     *
+     * @param storage Array of "capacity" events. It must outlive this object.
+     * @param capacity Number of events of "storage". It must be a power of two.
+     * @return true if the buffer has been enabled, false otherwise.
+     */
+    bool BasicInterrupt::enableEventBuffer(EdgeEvent *const storage, const size_t capacity)
+    {
+        if (m_events.isAssigned())
+        {
+            AT_LOG_W("Event buffer already enabled on pin %u", m_pin);
+            return false;
+        }
+        // Prevent the ISR from pushing while the buffer is being assigned
+        portENTER_CRITICAL(&m_isrSpinlock);
+        const bool assigned{m_events.assign(storage, capacity)};
+        portEXIT_CRITICAL(&m_isrSpinlock);
+        if (!assigned)
+        {
+            AT_LOG_E("Invalid event buffer on pin %u (the capacity must be a power of two)", m_pin);
+            return false;
+        }
+        AT_LOG_D("Event buffer of %u events enabled on pin %u", static_cast<unsigned>(capacity), m_pin);
+        return true;
+    }
+
+    /**
+     * @brief Copy the pending edge events recorded by the ISR into "events".
+     * This function does not block. Only one task may drain the events of an object.
+     *
+     * @param events Destination array.
+     * @param maxEvents Maximum number of events to copy.
+     * @return The number of events copied (0 if the event buffer is not enabled).
+     */
+    size_t BasicInterrupt::drainEvents(EdgeEvent *const events, const size_t maxEvents)
+    {
+        if (!m_events.isAssigned())
+            return 0;
+        return m_events.pop(events, maxEvents);
+    }
+
+    /**
+     * @brief Limit the interrupt rate of the pin.
+     * A faulty sensor or EMI can fire the ISR at tens of kHz and starve every other task.
+     * With the guard enabled, more ISR calls than "maxInterrupts" in "windowMs" start a storm:
+     * the interrupt of the pin is disabled and the pin is polled every "pollPeriodMs" instead,
+     * so at most one edge is delivered per poll. Once the state has been stable for "quietMs"
+     * the interrupt is enabled again, the settled state is always delivered.
+     * Storms can be monitored with "isStorming()" and "getStormCount()".
+     *
+     * @param config Limit of the interrupt rate and polling of the storms.
+     * @return true if the guard has been enabled, false if it was already enabled.
+     */
+    bool BasicInterrupt::enableStormGuard(const StormConfig &config)
+    {
+        if (m_stormGuard.isEnabled())
+        {
+            AT_LOG_W("Storm guard already enabled on pin %u", m_pin);
+            return false;
+        }
+#ifdef CONFIG_ARDUINO_ISR_IRAM
+        // The start of a storm runs code in flash from the ISR, see "startStormPolling()"
+        AT_LOG_E("The storm guard is not supported with CONFIG_ARDUINO_ISR_IRAM");
+        return false;
+#endif
+        ASSERT(config.maxInterrupts && config.windowMs && config.pollPeriodMs);
+        // The window is measured with the cycle counter, which wraps every few seconds
+        ASSERT(config.windowMs < 10 * 1000);
+        // Register the poll deadline outside the critical section as it may allocate
+        DeadlineScheduler::add(m_stormPollDeadline);
+        m_stormPollPeriodMs = config.pollPeriodMs;
+        portENTER_CRITICAL(&m_isrSpinlock);
+        m_stormGuard.configure(config.maxInterrupts,
+                               config.windowMs * 1000 * ESP.getCpuFreqMHz(),
+                               config.quietMs * 1000);
+        portEXIT_CRITICAL(&m_isrSpinlock);
+        AT_LOG_D("Storm guard enabled on pin %u (%u interrupts in %u ms)", m_pin, config.maxInterrupts, config.windowMs);
+        return true;
     }
 
     bool BasicInterrupt::waitUntilAnyInterrupt(const TickType_t xTicksToWait)
     {
-        return xQueuePeek(s_interruptCountingSepmaphore, nullptr, xTicksToWait);
+        return s_readySet.waitAny(xTicksToWait);
+    }
+
+    /**
+     * @brief Block until any object has pending interrupts.
+     * Only one task can wait for the interrupts of the class at a time.
+     *
+     * @param xTicksToWait The maximum time to wait for an interrupt.
+     * @return The mask of the objects with pending interrupts (see "getInterruptMask()"),
+     *         or 0 if no interrupt was received within the specified timeout.
+     */
+    uint32_t BasicInterrupt::waitForInterruptMask(const TickType_t xTicksToWait)
+    {
+        return s_readySet.wait(xTicksToWait);
     }
 
 } // namespace AT
\ No newline at end of file
@@ -1,20 +1,45 @@
 #pragma once
 
+#include <memory>
+
 #include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/BinarySemaphore.h"
+#include "ArduinoToolkit/Core/DeadlineScheduler.h"
+#include "ArduinoToolkit/Core/RingBuffer.h"
+#include "ArduinoToolkit/Interrupt/EdgeCoroutine.h"
+#include "ArduinoToolkit/Interrupt/EdgeReceiver.h"
+#include "ArduinoToolkit/Interrupt/LatencyStats.h"
+#include "ArduinoToolkit/Interrupt/MissedEdgeSweeper.h"
+#include "ArduinoToolkit/Interrupt/PendingEdges.h"
+#include "ArduinoToolkit/Interrupt/PinState.h"
+#include "ArduinoToolkit/Interrupt/ReadySet.h"
+#include "ArduinoToolkit/Interrupt/StormGuard.h"
 
 namespace AT
 {
 
-    enum class PinState : int8_t
+    // Edge recorded by the ISR when the event buffer is enabled
+    struct EdgeEvent
     {
-        Unknown = -1,
-        Low = 0,
-        High = 1
+        uint32_t cycles; // CPU cycle counter when the edge was processed
+        PinState state;  // New state of the pin
     };
 
     class BasicInterrupt
     {
     public:
+        // Limit of the interrupt rate of the pin, see "enableStormGuard()"
+        struct StormConfig
+        {
+            // More ISR calls than "maxInterrupts" in "windowMs" start a storm
+            uint32_t maxInterrupts{100};
+            uint32_t windowMs{10};
+            // Period of the polls during a storm
+            uint32_t pollPeriodMs{10};
+            // Time the pin must be stable to end the storm
+            uint32_t quietMs{100};
+        };
+
         BasicInterrupt(const uint8_t pin,
                        const uint8_t mode,
                        const bool reverseLogic = false,
@@ -23,32 +48,157 @@ namespace AT
 
         inline uint8_t getPin() const { return m_pin; }
         inline uint8_t getMode() const { return m_mode; }
-        inline PinState getState() const { return m_state; }
+        inline PinState getState() const { return m_edges.getState(); }
+        // Bit of this object in the mask returned by "waitForInterruptMask()", 0 past ReadySet::s_MAX_SLOTS objects
+        inline uint32_t getInterruptMask() const { return ReadySet::slotMask(m_readySlot); }
 
         PinState receiveInterrupt(const TickType_t xTicksToWait = portMAX_DELAY) const;
         PinState receiveInterruptDiscardIntermediate(const TickType_t xTicksToWait = portMAX_DELAY) const;
         PinState receiveLastInterrupt(const TickType_t xTicksToWait = portMAX_DELAY) const;
 
+#ifdef AT_COROUTINES
+        // Awaitable of the next edge for an EdgeCoroutine ("co_await input.nextEdge()")
+        inline EdgeAwaitable nextEdge(const TickType_t xTicksToWait = portMAX_DELAY,
+                                      const ReceiveMode mode = ReceiveMode::Next) const
+        {
+            return {this, receiveEdge<BasicInterrupt>, s_readySet, getInterruptMask(), mode, xTicksToWait};
+        }
+#endif
+
+#ifndef AT_STATIC_ALLOCATION
+        bool enableEventBuffer(const size_t capacity);
+#endif
+        bool enableEventBuffer(EdgeEvent *const storage, const size_t capacity);
+        size_t drainEvents(EdgeEvent *const events, const size_t maxEvents);
+        inline uint32_t getEventOverflowCount() const { return m_events.getOverflowCount(); }
+
+        bool enableStormGuard(const StormConfig &config);
+        // Whether the pin is being polled because of an edge storm
+        inline bool isStorming() const { return m_stormGuard.isStorming(); }
+        inline uint32_t getStormCount() const { return m_stormGuard.getStormCount(); }
+
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        inline const LatencyStats &getLatencyStats() const { return m_latencyStats; }
+        inline void resetLatencyStats() { m_latencyStats.reset(); }
+        inline void printLatencyStats(Print &out = Serial) const { m_latencyStats.print(out, m_pin); }
+#endif
+
     public:
         static bool waitUntilAnyInterrupt(const TickType_t xTicksToWait = portMAX_DELAY);
+        static uint32_t waitForInterruptMask(const TickType_t xTicksToWait = portMAX_DELAY);
+        // Ready mask of the class, for dispatchers that wait on several classes at once
+        static inline ReadySet &getReadySet() { return s_readySet; }
 
     public:
         static constexpr uint32_t s_DEFAULT_PERIODIC_CALL_ISR_MS{100};
 
+    protected:
+        // Function called (from the ISR) every time the object gets a new edge
+        using EdgeNotifier = void (*)(BasicInterrupt *const intPtr, BaseType_t *const pxHigherPriorityTaskWoken);
+        // ISR attached to the pin. It reads the pin and calls "processEdge()"
+        using InterruptHandler = void (*)(void *const voidPtrInt);
+
+        BasicInterrupt(const uint8_t pin,
+                       const uint8_t mode,
+                       const bool reverseLogic,
+                       const uint32_t periodicCallToISRms,
+                       const EdgeNotifier edgeNotifier,
+                       const BaseType_t isrCore = tskNO_AFFINITY,
+                       const InterruptHandler interruptHandler = intISR);
+
+        void detach();
+
+        PinState receive(const ReceiveMode mode,
+                         const TickType_t xTicksToWait,
+                         const LatencyStage stage = LatencyStage::Receive) const;
+
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        // Derived classes record their own stages in the stats of the object
+        inline void recordLatency(const LatencyStage stage, const uint32_t value) const { m_latencyStats.record(stage, value); }
+#endif
+
+        static void IRAM_ATTR notifyReadySetFromISR(BasicInterrupt *const intPtr,
+                                                    BaseType_t *const pxHigherPriorityTaskWoken);
+
+        // Record the state read by the ISR and wake up the receivers if it has changed
+        __attribute__((always_inline)) inline void processEdge(const PinState newState, const uint32_t cycles)
+        {
+            BaseType_t xHigherPriorityTaskWoken{pdFALSE};
+            // Check if the sensor state has changed. The ISR and the periodic timer callback
+            // may run at the same time on different cores, so the update is serialized.
+            portENTER_CRITICAL_ISR(&m_isrSpinlock);
+            const bool stateChanged{m_edges.update(newState)};
+            // Record the edge if the event buffer is enabled
+            if (stateChanged && m_events.isAssigned())
+                m_events.push({cycles, newState});
+            // Switch to polling if the interrupt rate is above the limit of the storm guard
+            const bool stormStarted{m_stormGuard.countInterrupt(cycles)};
+            portEXIT_CRITICAL_ISR(&m_isrSpinlock);
+            if (stormStarted)
+                startStormPolling();
+            if (stateChanged)
+            {
+                // Keep the missed-edge sweep on its shortest period while there is activity
+                MissedEdgeSweeper::notifyActivity();
+#ifdef AT_INTERRUPT_LATENCY_STATS
+                m_lastEdgeTimeUs.store(LatencyStats::nowUs(), std::memory_order_relaxed);
+#endif
+                // Wake up the receivers of this object and notify the new edge
+                xSemaphoreGiveFromISR(m_interruptBinarySemaphore, &xHigherPriorityTaskWoken);
+                m_edgeNotifier(this, &xHigherPriorityTaskWoken);
+#ifdef AT_INTERRUPT_LATENCY_STATS
+                m_latencyStats.record(LatencyStage::Isr, ESP.getCycleCount() - cycles);
+#endif
+            }
+            // Did this action unblock a higher priority task?
+            if (xHigherPriorityTaskWoken)
+                portYIELD_FROM_ISR();
+        }
+
     private:
         static void IRAM_ATTR intISR(void *const voidPtrInt);
-        static void timerNoActivityCallback(const TimerHandle_t xTimer);
+        static bool sweepCallback(void *const voidPtrInt);
+        static void stormPollCallback(void *const voidPtrInt);
+        void startStormPolling();
+        static void attachOnCurrentCore(void *const voidPtrInt);
 
     private:
         const uint8_t m_pin;
         const uint8_t m_mode;
         const bool m_reverseLogic;
-        PinState m_state{PinState::Unknown};
-        SemaphoreHandle_t m_interruptCountingSepmaphore{nullptr};
-        TimerHandle_t m_periodicCallToISRtimer{nullptr};
+        // Current state and number of edges not yet received
+        mutable PendingEdges m_edges;
+        // Given on every edge to wake up the receivers of this object
+        BinarySemaphore m_interruptBinarySemaphore;
+        // Calls the ISR from the missed-edge sweep (to catch missing interrupts)
+        SweepTarget m_sweepTarget{sweepCallback, this};
+        bool m_attached{false};
+        const EdgeNotifier m_edgeNotifier;
+        const InterruptHandler m_interruptHandler;
+        // Bit of this object in "s_readySet" (only if it reports to it)
+        const int8_t m_readySlot;
+        // Serializes the ISR and the periodic timer so edges are recorded in order
+        portMUX_TYPE m_isrSpinlock = portMUX_INITIALIZER_UNLOCKED;
+#ifndef AT_STATIC_ALLOCATION
+        std::unique_ptr<EdgeEvent[]> m_eventStorage;
+#endif
+        SPSCRingBuffer<EdgeEvent> m_events;
+        // Interrupt rate limit, protected by "m_isrSpinlock"
+        StormGuard m_stormGuard;
+        // Polls the pin during a storm. Registered by "enableStormGuard()"
+        Deadline m_stormPollDeadline{stormPollCallback, this};
+        uint32_t m_stormPollPeriodMs{0};
+        // Start of the current storm (0 until the first poll logs it)
+        uint64_t m_stormStartUs{0};
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        mutable LatencyStats m_latencyStats;
+        // Time of the last edge (truncated to 32 bits)
+        std::atomic<uint32_t> m_lastEdgeTimeUs{0};
+#endif
 
     private:
-        static SemaphoreHandle_t s_interruptCountingSepmaphore;
+        // Objects of the class with pending edges
+        static ReadySet s_readySet;
     };
 
 } // namespace AT
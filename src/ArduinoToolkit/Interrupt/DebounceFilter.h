@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ArduinoToolkit/Interrupt/PinState.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Decision logic of the FilteredInterrupt filter.
+     * A raw state different from the filtered one starts (or restarts) a timer of the filter
+     * time of that state, a raw state equal to it stops the timer. If the timer expires the
+     * raw state becomes the filtered state. The first raw state is taken directly.
+     * The owner keeps the states and the timer, so the same logic runs on the hardware
+     * (FilteredInterrupt) and under a virtual clock (EdgeTraceReplay).
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class DebounceFilter
+    {
+    public:
+        enum class Action : uint8_t
+        {
+            Commit,     // Take the raw state as the filtered state now
+            StartTimer, // (Re)start the timer with "filterTimeUs(raw)"
+            StopTimer   // Cancel the timer
+        };
+
+        constexpr DebounceFilter(const uint64_t lowToHighTimeUs, const uint64_t highToLowTimeUs)
+            : m_lowToHighTimeUs(lowToHighTimeUs),
+              m_highToLowTimeUs(highToLowTimeUs) {}
+
+        // What to do with a new raw state
+        static constexpr Action onRawState(const PinState filtered, const PinState raw)
+        {
+            if (filtered == PinState::Unknown)
+                return Action::Commit;
+            return raw == filtered ? Action::StopTimer : Action::StartTimer;
+        }
+
+        // Whether the raw state becomes the filtered state once the timer has expired
+        static constexpr bool onTimerExpired(const PinState filtered, const PinState raw)
+        {
+            return raw != filtered;
+        }
+
+        // Time the raw state must be stable to become the filtered state
+        constexpr uint64_t filterTimeUs(const PinState raw) const
+        {
+            return raw == PinState::High ? m_lowToHighTimeUs : m_highToLowTimeUs;
+        }
+
+    private:
+        uint64_t m_lowToHighTimeUs;
+        uint64_t m_highToLowTimeUs;
+    }; // class DebounceFilter
+
+} // namespace AT
@@ -0,0 +1,200 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/EdgeCoroutine.h"
+
+#ifdef AT_COROUTINES
+
+#include <algorithm>
+
+#include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
+#include "ArduinoToolkit/Interrupt/FilteredInterrupt.h"
+
+namespace AT
+{
+
+    // Called when the edge is not pending yet. The executor resumes the coroutine later
+    void EdgeAwaitable::await_suspend(const EdgeCoroutine::Handle handle)
+    {
+        m_handle = handle;
+        m_startTicks = xTaskGetTickCount();
+        handle.promise().executor->suspend(*this);
+    }
+
+    CoroutineExecutor::CoroutineExecutor(const Config &config)
+        : m_config(config)
+    {
+    }
+
+    CoroutineExecutor::~CoroutineExecutor()
+    {
+        if (m_taskHandle)
+        {
+            BasicInterrupt::getReadySet().setWaiterTask(nullptr);
+            FilteredInterrupt::getReadySet().setWaiterTask(nullptr);
+            vTaskDelete(m_taskHandle);
+            AT_LOG_V("CoroutineExecutor task deleted");
+        }
+        // Coroutines not finished yet are destroyed at their suspension point
+        while (m_spawned)
+        {
+            EdgeCoroutine::promise_type *const next{m_spawned->nextSpawned};
+            EdgeCoroutine::Handle::from_promise(*m_spawned).destroy();
+            m_spawned = next;
+        }
+        for (const EdgeCoroutine::Handle handle : m_coroutines)
+            handle.destroy();
+    }
+
+    /**
+     * @brief Give a coroutine to the executor.
+     * It can be called before or after the executor is started, from any task.
+     * The coroutine starts running on the executor task.
+     *
+     * @param coroutine Coroutine to run. The executor owns it from now on.
+     */
+    void CoroutineExecutor::spawn(EdgeCoroutine &&coroutine)
+    {
+        const EdgeCoroutine::Handle handle{coroutine.release()};
+        if (!handle)
+        {
+            AT_LOG_E("Coroutine without frame spawned (its allocation failed)");
+            return;
+        }
+        handle.promise().executor = this;
+        portENTER_CRITICAL(&m_spinlock);
+        handle.promise().nextSpawned = m_spawned;
+        m_spawned = &handle.promise();
+        portEXIT_CRITICAL(&m_spinlock);
+        if (m_taskHandle)
+            xTaskNotifyGive(m_taskHandle);
+    }
+
+    /**
+     * @brief Create the executor task.
+     *
+     * @return true if the task has been created.
+     */
+    bool CoroutineExecutor::start()
+    {
+        if (m_taskHandle)
+            return false;
+#ifdef AT_STATIC_ALLOCATION
+        // The stack is statically allocated with AT_COROUTINE_EXECUTOR_TASK_STACK_SIZE bytes
+        ASSERT(m_config.stackSize <= AT_COROUTINE_EXECUTOR_TASK_STACK_SIZE);
+        m_taskHandle = xTaskCreateStaticPinnedToCore(executorTask,
+                                                     "coroutineExecutor",
+                                                     m_config.stackSize,
+                                                     this,
+                                                     m_config.priority,
+                                                     m_taskStack,
+                                                     &m_taskBuffer,
+                                                     m_config.core);
+#else
+        xTaskCreatePinnedToCore(executorTask,
+                                "coroutineExecutor",
+                                m_config.stackSize,
+                                this,
+                                m_config.priority,
+                                &m_taskHandle,
+                                m_config.core);
+#endif
+        if (!m_taskHandle)
+        {
+            AT_LOG_E("Could not create the CoroutineExecutor task");
+            return false;
+        }
+        AT_LOG_D("CoroutineExecutor task created");
+        return true;
+    }
+
+    // Only called from the executor task, while a coroutine is running
+    void CoroutineExecutor::suspend(EdgeAwaitable &awaitable)
+    {
+        awaitable.m_next = m_waiters;
+        m_waiters = &awaitable;
+    }
+
+    // Run a coroutine until its next suspension point and destroy it if it has returned
+    void CoroutineExecutor::resume(const EdgeCoroutine::Handle handle)
+    {
+        handle.resume();
+        if (!handle.done())
+            return;
+        m_coroutines.erase(std::find(m_coroutines.begin(), m_coroutines.end(), handle));
+        handle.destroy();
+    }
+
+    // Resume the awaitables that got an edge or timed out. Return the ticks until the next timeout
+    TickType_t CoroutineExecutor::resumeWaiters()
+    {
+        // Resumed coroutines may suspend again, so they are linked to a new list
+        EdgeAwaitable *awaitable{m_waiters};
+        m_waiters = nullptr;
+        while (awaitable)
+        {
+            // The awaitable lives in the coroutine frame, it is gone once resumed
+            EdgeAwaitable *const next{awaitable->m_next};
+            // Objects without a bit in the ready mask are polled on every round
+            if (!awaitable->m_mask || awaitable->m_readySet.getMask() & awaitable->m_mask)
+                awaitable->m_state = awaitable->m_receiver(awaitable->m_object, awaitable->m_mode);
+            if (awaitable->m_state != PinState::Unknown ||
+                (awaitable->m_xTicksToWait != portMAX_DELAY &&
+                 xTaskGetTickCount() - awaitable->m_startTicks >= awaitable->m_xTicksToWait))
+                resume(awaitable->m_handle);
+            else
+                suspend(*awaitable);
+            awaitable = next;
+        }
+        // Closest timeout, including the awaitables suspended meanwhile
+        TickType_t ticksToWait{portMAX_DELAY};
+        const TickType_t now{xTaskGetTickCount()};
+        for (const EdgeAwaitable *waiter{m_waiters}; waiter; waiter = waiter->m_next)
+        {
+            if (waiter->m_xTicksToWait == portMAX_DELAY)
+                continue;
+            const TickType_t elapsed{now - waiter->m_startTicks};
+            const TickType_t left{elapsed < waiter->m_xTicksToWait ? waiter->m_xTicksToWait - elapsed : 0};
+            ticksToWait = std::min(ticksToWait, left);
+        }
+        return ticksToWait;
+    }
+
+    void CoroutineExecutor::executorTask(void *const parameters)
+    {
+        CoroutineExecutor *const &executor{static_cast<CoroutineExecutor *>(parameters)};
+        // Register before reading the masks so no notification is missed
+        BasicInterrupt::getReadySet().setWaiterTask(xTaskGetCurrentTaskHandle());
+        FilteredInterrupt::getReadySet().setWaiterTask(xTaskGetCurrentTaskHandle());
+        while (true)
+        {
+            // Take the coroutines spawned since the last round
+            portENTER_CRITICAL(&executor->m_spinlock);
+            EdgeCoroutine::promise_type *newest{executor->m_spawned};
+            executor->m_spawned = nullptr;
+            portEXIT_CRITICAL(&executor->m_spinlock);
+            // Reverse the list to start them in the order they were spawned
+            EdgeCoroutine::promise_type *oldest{nullptr};
+            while (newest)
+            {
+                EdgeCoroutine::promise_type *const next{newest->nextSpawned};
+                newest->nextSpawned = oldest;
+                oldest = newest;
+                newest = next;
+            }
+            while (oldest)
+            {
+                const EdgeCoroutine::Handle handle{EdgeCoroutine::Handle::from_promise(*oldest)};
+                oldest = oldest->nextSpawned;
+                executor->m_coroutines.push_back(handle);
+                executor->resume(handle);
+            }
+            // Sleep until any object gets new edges, a coroutine is spawned or an await times out
+            const TickType_t ticksToWait{executor->resumeWaiters()};
+            if (ticksToWait)
+                ulTaskNotifyTake(pdTRUE, ticksToWait);
+        }
+    }
+
+} // namespace AT
+
+#endif
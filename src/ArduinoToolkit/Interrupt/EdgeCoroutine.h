@@ -0,0 +1,185 @@
+#pragma once
+
+// Coroutines need a compiler with C++20 coroutine support (GCC 10 or newer with -fcoroutines)
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define AT_COROUTINES
+#endif
+
+#ifdef AT_COROUTINES
+
+#include <coroutine>
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/Pool.h"
+#include "ArduinoToolkit/Interrupt/EdgeReceiver.h"
+#include "ArduinoToolkit/Interrupt/ReadySet.h"
+
+// Stack size (in bytes) of the executor task. With AT_STATIC_ALLOCATION
+// it is the size of its static stack and the maximum that can be configured
+#ifndef AT_COROUTINE_EXECUTOR_TASK_STACK_SIZE
+#define AT_COROUTINE_EXECUTOR_TASK_STACK_SIZE (4 * 1024)
+#endif
+
+namespace AT
+{
+
+    class CoroutineExecutor;
+
+    /**
+     * @brief Coroutine run by a CoroutineExecutor.
+     * It starts suspended and runs once it is spawned on an executor, which destroys it when
+     * it returns. Coroutines of an executor share its task stack, only their frames
+     * (allocated from the Pool when they are created) take memory on their own.
+     */
+    class EdgeCoroutine
+    {
+    public:
+        struct promise_type
+        {
+            CoroutineExecutor *executor{nullptr};
+            // Link in the list of coroutines spawned and not started yet
+            promise_type *nextSpawned{nullptr};
+
+            EdgeCoroutine get_return_object() { return EdgeCoroutine{Handle::from_promise(*this)}; }
+            static EdgeCoroutine get_return_object_on_allocation_failure() { return EdgeCoroutine{Handle{}}; }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { abort(); }
+
+            // A coroutine whose frame can not be allocated is returned empty and never runs
+            static void *operator new(const size_t size) noexcept { return Pool::allocate(size); }
+            static void operator delete(void *const ptr) { Pool::deallocate(ptr); }
+        };
+        using Handle = std::coroutine_handle<promise_type>;
+
+        EdgeCoroutine(EdgeCoroutine &&other) : m_handle(other.m_handle) { other.m_handle = nullptr; }
+        ~EdgeCoroutine()
+        {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        EdgeCoroutine(const EdgeCoroutine &) = delete;
+        EdgeCoroutine &operator=(const EdgeCoroutine &) = delete;
+
+        // False if the frame could not be allocated (or the coroutine has been spawned)
+        inline bool isValid() const { return static_cast<bool>(m_handle); }
+
+    private:
+        explicit EdgeCoroutine(const Handle handle) : m_handle(handle) {}
+
+        // Give the ownership of the coroutine to the executor
+        inline Handle release()
+        {
+            const Handle handle{m_handle};
+            m_handle = nullptr;
+            return handle;
+        }
+
+    private:
+        Handle m_handle;
+
+        friend class CoroutineExecutor;
+    }; // class EdgeCoroutine
+
+    /**
+     * @brief Awaitable of the next edge of an interrupt object ("co_await input.nextEdge()").
+     * It resumes the coroutine with the state of the edge, or PinState::Unknown if the
+     * timeout elapses first. It can only be awaited from an EdgeCoroutine.
+     */
+    class EdgeAwaitable
+    {
+    public:
+        EdgeAwaitable(const void *const object,
+                      const EdgeReceiver receiver,
+                      ReadySet &readySet,
+                      const uint32_t mask,
+                      const ReceiveMode mode,
+                      const TickType_t xTicksToWait)
+            : m_object(object),
+              m_receiver(receiver),
+              m_readySet(readySet),
+              m_mask(mask),
+              m_mode(mode),
+              m_xTicksToWait(xTicksToWait) {}
+
+        // Do not suspend if there is a pending edge already (or if it must not wait)
+        bool await_ready()
+        {
+            m_state = m_receiver(m_object, m_mode);
+            return m_state != PinState::Unknown || !m_xTicksToWait;
+        }
+        void await_suspend(const EdgeCoroutine::Handle handle);
+        inline PinState await_resume() const { return m_state; }
+
+    private:
+        const void *const m_object;
+        const EdgeReceiver m_receiver;
+        ReadySet &m_readySet;
+        const uint32_t m_mask;
+        const ReceiveMode m_mode;
+        const TickType_t m_xTicksToWait;
+        PinState m_state{PinState::Unknown};
+        // Set while the awaitable is in the waiting list of the executor
+        EdgeCoroutine::Handle m_handle;
+        TickType_t m_startTicks{0};
+        EdgeAwaitable *m_next{nullptr};
+
+        friend class CoroutineExecutor;
+    }; // class EdgeAwaitable
+
+    /**
+     * @brief Single task that runs many EdgeCoroutines.
+     * The task sleeps until any awaited object gets an edge or an await times out, then it
+     * resumes the coroutines that can go on. It becomes the waiter of the ready masks of the
+     * awaited classes, so their "waitForInterruptMask()" (and an InterruptDispatcher) must not
+     * be used at the same time.
+     */
+    class CoroutineExecutor
+    {
+    public:
+        struct Config
+        {
+            BaseType_t core{ARDUINO_RUNNING_CORE};
+            UBaseType_t priority{2};
+            uint32_t stackSize{AT_COROUTINE_EXECUTOR_TASK_STACK_SIZE};
+        };
+
+        CoroutineExecutor() : CoroutineExecutor(Config{}) {}
+        explicit CoroutineExecutor(const Config &config);
+        ~CoroutineExecutor();
+
+        CoroutineExecutor(const CoroutineExecutor &) = delete;
+        CoroutineExecutor &operator=(const CoroutineExecutor &) = delete;
+
+        void spawn(EdgeCoroutine &&coroutine);
+        bool start();
+
+    private:
+        void suspend(EdgeAwaitable &awaitable);
+        void resume(const EdgeCoroutine::Handle handle);
+        TickType_t resumeWaiters();
+        static void executorTask(void *const parameters);
+
+    private:
+        const Config m_config;
+        TaskHandle_t m_taskHandle{nullptr};
+        // Coroutines spawned and not started yet (newest first), protected by "m_spinlock"
+        EdgeCoroutine::promise_type *m_spawned{nullptr};
+        portMUX_TYPE m_spinlock = portMUX_INITIALIZER_UNLOCKED;
+        // Suspended awaitables. Only accessed by the executor task
+        EdgeAwaitable *m_waiters{nullptr};
+        // Coroutines alive, destroyed with the executor
+        PoolVector<EdgeCoroutine::Handle> m_coroutines;
+#ifdef AT_STATIC_ALLOCATION
+        StackType_t m_taskStack[AT_COROUTINE_EXECUTOR_TASK_STACK_SIZE];
+        StaticTask_t m_taskBuffer;
+#endif
+
+        friend class EdgeAwaitable;
+    }; // class CoroutineExecutor
+
+} // namespace AT
+
+#endif
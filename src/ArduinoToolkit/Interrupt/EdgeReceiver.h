@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ArduinoToolkit/Interrupt/PendingEdges.h"
+
+namespace AT
+{
+
+    // Receive an edge of a type-erased interrupt object without blocking
+    using EdgeReceiver = PinState (*)(const void *const object, const ReceiveMode mode);
+
+    // EdgeReceiver of any class with the "receiveInterrupt" family of functions
+    template <typename Interrupt>
+    PinState receiveEdge(const void *const object, const ReceiveMode mode)
+    {
+        const Interrupt *const intPtr{static_cast<const Interrupt *>(object)};
+        switch (mode)
+        {
+        case ReceiveMode::DiscardIntermediate:
+            return intPtr->receiveInterruptDiscardIntermediate(0);
+        case ReceiveMode::Last:
+            return intPtr->receiveLastInterrupt(0);
+        default:
+            return intPtr->receiveInterrupt(0);
+        }
+    }
+
+} // namespace AT
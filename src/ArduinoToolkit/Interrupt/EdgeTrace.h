@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ArduinoToolkit/Interrupt/PinState.h"
+
+namespace AT
+{
+
+    // Edge of a trace. The time is in microseconds since the start of the trace
+    struct EdgeTraceRecord
+    {
+        uint8_t pin;
+        uint64_t timeUs;
+        PinState state;
+    };
+
+    /**
+     * @brief Binary format of the edge traces.
+     * A trace is a header ("ATET" and the version byte, followed by 3 reserved bytes) and a
+     * sequence of records. Each record is the pin (1 byte) and an unsigned LEB128 varint of
+     * (delta << 1 | state), where "delta" is the time in microseconds since the previous edge
+     * of the same pin (or since the start of the trace for its first edge) and "state" is 1
+     * for PinState::High. Records of a pin are in chronological order, records of different
+     * pins may be interleaved in any order.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    struct EdgeTrace
+    {
+        static constexpr uint8_t s_MAGIC[4]{'A', 'T', 'E', 'T'};
+        static constexpr uint8_t s_VERSION{1};
+        static constexpr size_t s_HEADER_SIZE{8};
+        // Pins are numbered from 0 to s_MAX_PINS - 1
+        static constexpr uint8_t s_MAX_PINS{64};
+        // A record takes at most the pin and a 10 byte varint
+        static constexpr size_t s_MAX_RECORD_SIZE{11};
+    }; // struct EdgeTrace
+
+    // Encode edges into a trace in a buffer supplied by the owner
+    class EdgeTraceWriter
+    {
+    public:
+        EdgeTraceWriter(uint8_t *const buffer, const size_t capacity)
+            : m_buffer(buffer),
+              m_capacity(capacity)
+        {
+            if (m_capacity < EdgeTrace::s_HEADER_SIZE)
+                return;
+            for (uint8_t i{0}; i < sizeof(EdgeTrace::s_MAGIC); i++)
+                m_buffer[i] = EdgeTrace::s_MAGIC[i];
+            m_buffer[4] = EdgeTrace::s_VERSION;
+            m_buffer[5] = m_buffer[6] = m_buffer[7] = 0;
+            m_size = EdgeTrace::s_HEADER_SIZE;
+        }
+
+        /**
+         * @brief Append an edge.
+         *
+         * @param pin Pin of the edge (less than EdgeTrace::s_MAX_PINS).
+         * @param timeUs Time of the edge. Not earlier than the previous edge of the pin.
+         * @param state New state of the pin (PinState::Low or PinState::High).
+         * @return false if the edge could not be written (the buffer is full or it is invalid).
+         */
+        bool write(const uint8_t pin, const uint64_t timeUs, const PinState state)
+        {
+            if (!m_size || pin >= EdgeTrace::s_MAX_PINS || timeUs < m_lastTimeUs[pin] ||
+                state == PinState::Unknown || m_capacity - m_size < EdgeTrace::s_MAX_RECORD_SIZE)
+            {
+                m_droppedCount++;
+                return false;
+            }
+            // Deltas are below 2^63 us, so the shifted value does not overflow
+            uint64_t value{((timeUs - m_lastTimeUs[pin]) << 1) | (state == PinState::High)};
+            m_lastTimeUs[pin] = timeUs;
+            m_buffer[m_size++] = pin;
+            do
+            {
+                const uint8_t byte{static_cast<uint8_t>(value & 0x7F)};
+                value >>= 7;
+                m_buffer[m_size++] = value ? byte | 0x80 : byte;
+            } while (value);
+            return true;
+        }
+
+        inline const uint8_t *data() const { return m_buffer; }
+        inline size_t size() const { return m_size; }
+        inline bool isFull() const { return m_capacity - m_size < EdgeTrace::s_MAX_RECORD_SIZE; }
+        inline uint32_t getDroppedCount() const { return m_droppedCount; }
+
+    private:
+        uint8_t *const m_buffer;
+        const size_t m_capacity;
+        size_t m_size{0};
+        uint32_t m_droppedCount{0};
+        uint64_t m_lastTimeUs[EdgeTrace::s_MAX_PINS]{};
+    }; // class EdgeTraceWriter
+
+    // Decode the records of a trace
+    class EdgeTraceReader
+    {
+    public:
+        EdgeTraceReader(const uint8_t *const data, const size_t size)
+            : m_data(data),
+              m_size(size)
+        {
+            m_valid = m_size >= EdgeTrace::s_HEADER_SIZE && m_data[4] == EdgeTrace::s_VERSION;
+            for (uint8_t i{0}; m_valid && i < sizeof(EdgeTrace::s_MAGIC); i++)
+                m_valid = m_data[i] == EdgeTrace::s_MAGIC[i];
+            m_position = EdgeTrace::s_HEADER_SIZE;
+        }
+
+        inline bool isValid() const { return m_valid; }
+
+        // Read the next record. Return false at the end of the trace (or if it is corrupt)
+        bool next(EdgeTraceRecord &record)
+        {
+            if (!m_valid || m_position >= m_size)
+                return false;
+            const uint8_t pin{m_data[m_position++]};
+            uint64_t value{0};
+            uint8_t shift{0};
+            while (true)
+            {
+                if (m_position >= m_size || shift > 63 || pin >= EdgeTrace::s_MAX_PINS)
+                {
+                    m_valid = false;
+                    return false;
+                }
+                const uint8_t byte{m_data[m_position++]};
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    break;
+                shift += 7;
+            }
+            m_lastTimeUs[pin] += value >> 1;
+            record.pin = pin;
+            record.timeUs = m_lastTimeUs[pin];
+            record.state = value & 1 ? PinState::High : PinState::Low;
+            return true;
+        }
+
+        // Read the trace again from its first record
+        void rewind()
+        {
+            m_position = EdgeTrace::s_HEADER_SIZE;
+            for (uint64_t &timeUs : m_lastTimeUs)
+                timeUs = 0;
+        }
+
+    private:
+        const uint8_t *const m_data;
+        const size_t m_size;
+        size_t m_position;
+        bool m_valid;
+        uint64_t m_lastTimeUs[EdgeTrace::s_MAX_PINS]{};
+    }; // class EdgeTraceReader
+
+} // namespace AT
@@ -0,0 +1,95 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/EdgeTraceRecorder.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Construct an EdgeTraceRecorder. The trace starts now.
+     *
+     * @param buffer Storage of the trace. It must outlive the recorder.
+     * @param capacity Size of "buffer" in bytes.
+     */
+    EdgeTraceRecorder::EdgeTraceRecorder(uint8_t *const buffer, const size_t capacity)
+        : m_writer(buffer, capacity),
+          m_startUs(esp_timer_get_time()),
+          m_cyclesPerUs(ESP.getCpuFreqMHz())
+    {
+    }
+
+    bool EdgeTraceRecorder::addSource(void *const object,
+                                      const uint8_t pin,
+                                      const Drainer drain,
+                                      const OverflowCounter overflows)
+    {
+        if (m_numSources == s_MAX_SOURCES || pin >= EdgeTrace::s_MAX_PINS)
+        {
+            AT_LOG_E("Could not record pin %u", pin);
+            return false;
+        }
+        m_sources[m_numSources++] = {object, drain, overflows, pin, false, 0, 0, 0, 0};
+        return true;
+    }
+
+    // Time of an edge since the start of the trace
+    uint64_t EdgeTraceRecorder::toTraceTimeUs(Source &source, const uint32_t cycles, const uint64_t pollUs) const
+    {
+        uint64_t timeUs{pollUs};
+        if (source.started)
+        {
+            // The ISR of an object always runs on the same core, so its cycle counts are comparable
+            uint64_t deltaCycles{static_cast<uint32_t>(cycles - source.lastCycles)};
+            // Add the wraps of the cycle counter that fit in the time elapsed between the polls
+            const uint64_t elapsedCycles{(pollUs - source.lastPollUs) * m_cyclesPerUs};
+            if (elapsedCycles > deltaCycles)
+                deltaCycles += (elapsedCycles - deltaCycles + (1ULL << 31)) >> 32 << 32;
+            // Carry the cycles of the previous edges that did not make a whole microsecond, so
+            // the truncation does not add up over the edges
+            deltaCycles += source.remainderCycles;
+            timeUs = source.lastTimeUs + deltaCycles / m_cyclesPerUs;
+            source.remainderCycles = deltaCycles % m_cyclesPerUs;
+        }
+        source.started = true;
+        source.lastCycles = cycles;
+        source.lastTimeUs = timeUs;
+        source.lastPollUs = pollUs;
+        return timeUs;
+    }
+
+    /**
+     * @brief Move the edges recorded by the ISRs into the trace.
+     *
+     * @return The number of edges added to the trace.
+     */
+    size_t EdgeTraceRecorder::poll()
+    {
+        const uint64_t pollUs{esp_timer_get_time() - m_startUs};
+        size_t recorded{0};
+        EdgeEvent events[16];
+        for (uint8_t i{0}; i < m_numSources; i++)
+        {
+            Source &source{m_sources[i]};
+            size_t count;
+            while ((count = source.drain(source.object, events, sizeof(events) / sizeof(events[0]))))
+            {
+                for (size_t j{0}; j < count; j++)
+                {
+                    if (m_writer.write(source.pin, toTraceTimeUs(source, events[j].cycles, pollUs), events[j].state))
+                        recorded++;
+                }
+            }
+        }
+        return recorded;
+    }
+
+    // Edges lost because an event buffer overflowed or the trace was full
+    uint32_t EdgeTraceRecorder::getLostEventCount() const
+    {
+        uint32_t lost{m_writer.getDroppedCount()};
+        for (uint8_t i{0}; i < m_numSources; i++)
+            lost += m_sources[i].overflows(m_sources[i].object);
+        return lost;
+    }
+
+} // namespace AT
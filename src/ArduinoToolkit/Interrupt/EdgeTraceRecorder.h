@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
+#include "ArduinoToolkit/Interrupt/EdgeTrace.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Record the raw edges of interrupt objects into an EdgeTrace.
+     * The edges are taken from the event buffers of the objects, so the only work done in
+     * the ISR is pushing the event (cycle counter and state). "poll()" converts the cycle
+     * counts to microseconds and encodes them, it must be called at least every few seconds
+     * (less than half the wrap period of the cycle counter, about 8 s at 240 MHz) so the
+     * deltas can be unwrapped. The time of the first edge of every object is the time of the
+     * poll that gets it, the following ones are as precise as the cycle counter.
+     * Works with BasicInterrupt (and StaticBasicInterrupt) and with the raw edges of FilteredInterrupt.
+     */
+    class EdgeTraceRecorder
+    {
+    public:
+        static constexpr uint8_t s_MAX_SOURCES{16};
+
+        EdgeTraceRecorder(uint8_t *const buffer, const size_t capacity);
+
+#ifndef AT_STATIC_ALLOCATION
+        // Enable the event buffer of the object with "eventCapacity" events and record it
+        template <typename Interrupt>
+        bool add(Interrupt &interrupt, const size_t eventCapacity = 64)
+        {
+            return interrupt.enableEventBuffer(eventCapacity) &&
+                   addSource(&interrupt, interrupt.getPin(), drain<Interrupt>, overflows<Interrupt>);
+        }
+#endif
+        // Same as above with the storage of the event buffer supplied by the caller
+        template <typename Interrupt>
+        bool add(Interrupt &interrupt, EdgeEvent *const storage, const size_t eventCapacity)
+        {
+            return interrupt.enableEventBuffer(storage, eventCapacity) &&
+                   addSource(&interrupt, interrupt.getPin(), drain<Interrupt>, overflows<Interrupt>);
+        }
+
+        size_t poll();
+
+        inline const uint8_t *data() const { return m_writer.data(); }
+        inline size_t size() const { return m_writer.size(); }
+        inline bool isFull() const { return m_writer.isFull(); }
+        uint32_t getLostEventCount() const;
+
+    private:
+        using Drainer = size_t (*)(void *const object, EdgeEvent *const events, const size_t maxEvents);
+        using OverflowCounter = uint32_t (*)(const void *const object);
+
+        struct Source
+        {
+            void *object;
+            Drainer drain;
+            OverflowCounter overflows;
+            uint8_t pin;
+            bool started;
+            uint32_t lastCycles;
+            // Cycles after "lastTimeUs" up to "lastCycles", less than a microsecond
+            uint32_t remainderCycles;
+            uint64_t lastTimeUs;
+            uint64_t lastPollUs;
+        };
+
+        template <typename Interrupt>
+        static size_t drain(void *const object, EdgeEvent *const events, const size_t maxEvents)
+        {
+            return static_cast<Interrupt *>(object)->drainEvents(events, maxEvents);
+        }
+        template <typename Interrupt>
+        static uint32_t overflows(const void *const object)
+        {
+            return static_cast<const Interrupt *>(object)->getEventOverflowCount();
+        }
+
+        bool addSource(void *const object, const uint8_t pin, const Drainer drain, const OverflowCounter overflows);
+        uint64_t toTraceTimeUs(Source &source, const uint32_t cycles, const uint64_t pollUs) const;
+
+    private:
+        EdgeTraceWriter m_writer;
+        const uint64_t m_startUs;
+        const uint32_t m_cyclesPerUs;
+        Source m_sources[s_MAX_SOURCES];
+        uint8_t m_numSources{0};
+    }; // class EdgeTraceRecorder
+
+} // namespace AT
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "ArduinoToolkit/Interrupt/DebounceFilter.h"
+#include "ArduinoToolkit/Interrupt/EdgeTrace.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Run the raw edges of a trace through the FilteredInterrupt filter under a virtual clock.
+     * Every pin has its own DebounceFilter and timer, and time only advances with the records,
+     * so a trace is replayed as fast as it can be decoded and the result is deterministic.
+     * The pins are independent, so each one is replayed on the time of its own records and
+     * the filtered edges of different pins may be reported out of order.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class EdgeTraceReplay
+    {
+    public:
+        // Called with every filtered edge
+        using Callback = void (*)(void *const context, const EdgeTraceRecord &filtered);
+
+        explicit EdgeTraceReplay(const Callback callback = nullptr, void *const context = nullptr)
+            : m_callback(callback),
+              m_context(context) {}
+
+        // Filter the edges of "pin" as a FilteredInterrupt with the given times would do
+        bool addFilter(const uint8_t pin, const uint32_t lowToHighTimeMs, const uint32_t highToLowTimeMs)
+        {
+            if (pin >= EdgeTrace::s_MAX_PINS)
+                return false;
+            m_channels[pin] = Channel{};
+            m_channels[pin].filter = DebounceFilter{lowToHighTimeMs * 1000ULL, highToLowTimeMs * 1000ULL};
+            m_channels[pin].enabled = true;
+            return true;
+        }
+
+        /**
+         * @brief Replay every record of a trace. The edges of pins without a filter are ignored.
+         * The timers still running at the end of the trace are expired (as if the last state
+         * of every pin had been held long enough).
+         *
+         * @param reader Trace to replay, from its current position.
+         * @return The number of raw edges replayed.
+         */
+        size_t run(EdgeTraceReader &reader)
+        {
+            size_t replayed{0};
+            EdgeTraceRecord record;
+            while (reader.next(record))
+            {
+                Channel &channel{m_channels[record.pin]};
+                if (!channel.enabled)
+                    continue;
+                expireTimer(record.pin, record.timeUs);
+                processRawState(record.pin, record.timeUs, record.state);
+                replayed++;
+            }
+            for (uint8_t pin{0}; pin < EdgeTrace::s_MAX_PINS; pin++)
+                expireTimer(pin, s_NEVER);
+            return replayed;
+        }
+
+        inline PinState getFilteredState(const uint8_t pin) const { return m_channels[pin].filtered; }
+        inline uint32_t getFilteredEdgeCount() const { return m_filteredEdgeCount; }
+
+    private:
+        static constexpr uint64_t s_NEVER{UINT64_MAX};
+
+        struct Channel
+        {
+            DebounceFilter filter{0, 0};
+            bool enabled{false};
+            PinState raw{PinState::Unknown};
+            PinState filtered{PinState::Unknown};
+            // Expiration of the timer or s_NEVER if it is stopped
+            uint64_t timerUs{s_NEVER};
+        };
+
+        // Run the timer of "pin" if it expires before "nowUs"
+        void expireTimer(const uint8_t pin, const uint64_t nowUs)
+        {
+            Channel &channel{m_channels[pin]};
+            if (channel.timerUs == s_NEVER || channel.timerUs > nowUs)
+                return;
+            const uint64_t timerUs{channel.timerUs};
+            channel.timerUs = s_NEVER;
+            if (DebounceFilter::onTimerExpired(channel.filtered, channel.raw))
+                commit(pin, timerUs, channel.raw);
+        }
+
+        void processRawState(const uint8_t pin, const uint64_t nowUs, const PinState raw)
+        {
+            Channel &channel{m_channels[pin]};
+            channel.raw = raw;
+            switch (DebounceFilter::onRawState(channel.filtered, raw))
+            {
+            case DebounceFilter::Action::Commit:
+                commit(pin, nowUs, raw);
+                break;
+            case DebounceFilter::Action::StartTimer:
+                channel.timerUs = nowUs + channel.filter.filterTimeUs(raw);
+                break;
+            default:
+                channel.timerUs = s_NEVER;
+                break;
+            }
+        }
+
+        void commit(const uint8_t pin, const uint64_t nowUs, const PinState state)
+        {
+            m_channels[pin].filtered = state;
+            m_filteredEdgeCount++;
+            if (m_callback)
+                m_callback(m_context, {pin, nowUs, state});
+        }
+
+    private:
+        const Callback m_callback;
+        void *const m_context;
+        uint32_t m_filteredEdgeCount{0};
+        Channel m_channels[EdgeTrace::s_MAX_PINS];
+    }; // class EdgeTraceReplay
+
+} // namespace AT
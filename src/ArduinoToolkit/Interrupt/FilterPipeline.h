@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "ArduinoToolkit/Core/DeadlineQueue.h"
+#include "ArduinoToolkit/Interrupt/PinState.h"
+
+namespace AT
+{
+
+    /**
+     * Stages of a FilterPipeline. A stage is a state machine with two functions:
+     *  - "PinState update(const PinState in, const uint64_t nowUs)": take the input state at
+     *    "nowUs" (the same one again if it has not changed) and return the output state.
+     *  - "uint64_t nextUpdateUs() const": time at which the output may change with the same
+     *    input, so "update()" must be called again (DeadlineQueue::s_NEVER if it can not).
+     * Times are passed explicitly so the stages run the same under a virtual clock.
+     * The first known input is taken directly by every stage.
+     */
+
+    // Take a new state once it has been stable for its hold time (the FilteredInterrupt filter)
+    template <uint32_t LowToHighMs, uint32_t HighToLowMs = LowToHighMs>
+    class Debounce
+    {
+    public:
+        PinState update(const PinState in, const uint64_t nowUs)
+        {
+            if (in == PinState::Unknown)
+                return m_out;
+            // A change of the input (re)starts the hold time, going back to the output stops it
+            if (in != m_in)
+            {
+                m_in = in;
+                m_dueUs = in == m_out ? DeadlineQueue::s_NEVER : nowUs + holdUs(in);
+            }
+            if (m_out == PinState::Unknown || nowUs >= m_dueUs)
+            {
+                m_out = in;
+                m_dueUs = DeadlineQueue::s_NEVER;
+            }
+            return m_out;
+        }
+
+        inline uint64_t nextUpdateUs() const { return m_dueUs; }
+
+    private:
+        static constexpr uint64_t holdUs(const PinState state)
+        {
+            return (state == PinState::High ? LowToHighMs : HighToLowMs) * 1000ULL;
+        }
+
+    private:
+        PinState m_in{PinState::Unknown};
+        PinState m_out{PinState::Unknown};
+        uint64_t m_dueUs{DeadlineQueue::s_NEVER};
+    }; // class Debounce
+
+    // Follow the input right away but keep every output state for at least "Ms" (minimum pulse width)
+    template <uint32_t Ms>
+    class MinHold
+    {
+    public:
+        PinState update(const PinState in, const uint64_t nowUs)
+        {
+            if (in == PinState::Unknown)
+                return m_out;
+            m_in = in;
+            if (in != m_out && (m_out == PinState::Unknown || nowUs >= m_changeUs + s_HOLD_US))
+            {
+                m_out = in;
+                m_changeUs = nowUs;
+            }
+            return m_out;
+        }
+
+        inline uint64_t nextUpdateUs() const
+        {
+            return m_in != m_out ? m_changeUs + s_HOLD_US : DeadlineQueue::s_NEVER;
+        }
+
+    private:
+        static constexpr uint64_t s_HOLD_US{Ms * 1000ULL};
+
+    private:
+        PinState m_in{PinState::Unknown};
+        PinState m_out{PinState::Unknown};
+        uint64_t m_changeUs{0};
+    }; // class MinHold
+
+    // Sample the input every "SamplePeriodMs" and output the state of most of the last "N" samples
+    template <uint8_t N, uint32_t SamplePeriodMs>
+    class Majority
+    {
+        static_assert(N % 2 && N <= 31, "The number of samples must be odd and at most 31");
+
+    public:
+        PinState update(const PinState in, const uint64_t nowUs)
+        {
+            if (m_in == PinState::Unknown)
+            {
+                if (in == PinState::Unknown)
+                    return PinState::Unknown;
+                m_samples = in == PinState::High ? s_WINDOW_MASK : 0;
+                m_nextSampleUs = nowUs + s_PERIOD_US;
+            }
+            else
+            {
+                // Take the samples due until now with the state held before this update.
+                // After N of them the window is full of it, the rest would change nothing
+                for (uint8_t i{0}; i < N && m_nextSampleUs <= nowUs; i++)
+                {
+                    m_samples = ((m_samples << 1) | (m_in == PinState::High)) & s_WINDOW_MASK;
+                    m_nextSampleUs += s_PERIOD_US;
+                }
+                if (m_nextSampleUs <= nowUs)
+                    m_nextSampleUs = nowUs + s_PERIOD_US;
+            }
+            if (in != PinState::Unknown)
+                m_in = in;
+            return __builtin_popcount(m_samples) > N / 2 ? PinState::High : PinState::Low;
+        }
+
+        inline uint64_t nextUpdateUs() const
+        {
+            // Nothing changes once every sample is the current input
+            const uint32_t settled{m_in == PinState::High ? s_WINDOW_MASK : 0};
+            return m_in == PinState::Unknown || m_samples == settled ? DeadlineQueue::s_NEVER : m_nextSampleUs;
+        }
+
+    private:
+        static constexpr uint32_t s_WINDOW_MASK{(1UL << N) - 1};
+        static constexpr uint64_t s_PERIOD_US{SamplePeriodMs * 1000ULL};
+
+    private:
+        PinState m_in{PinState::Unknown};
+        // Last samples, bit 0 is the newest (1 is High)
+        uint32_t m_samples{0};
+        uint64_t m_nextSampleUs{0};
+    }; // class Majority
+
+    // Let through at most "MaxEdges" output edges every "WindowMs" (token bucket of "MaxEdges" edges)
+    template <uint32_t MaxEdges, uint32_t WindowMs = 1000>
+    class RateLimit
+    {
+        static_assert(MaxEdges, "At least one edge must be allowed");
+
+    public:
+        PinState update(const PinState in, const uint64_t nowUs)
+        {
+            if (in == PinState::Unknown)
+                return m_out;
+            m_in = in;
+            if (m_out == PinState::Unknown)
+            {
+                m_out = in;
+                m_creditUs = s_WINDOW_US;
+                m_lastUs = nowUs;
+                return m_out;
+            }
+            // Refill the bucket with the time elapsed since the last update
+            const uint64_t creditUs{m_creditUs + (nowUs - m_lastUs)};
+            m_creditUs = creditUs < s_WINDOW_US ? creditUs : s_WINDOW_US;
+            m_lastUs = nowUs;
+            if (in != m_out && m_creditUs >= s_EDGE_COST_US)
+            {
+                m_out = in;
+                m_creditUs -= s_EDGE_COST_US;
+            }
+            return m_out;
+        }
+
+        inline uint64_t nextUpdateUs() const
+        {
+            return m_in != m_out ? m_lastUs + (s_EDGE_COST_US - m_creditUs) : DeadlineQueue::s_NEVER;
+        }
+
+    private:
+        static constexpr uint64_t s_WINDOW_US{WindowMs * 1000ULL};
+        static constexpr uint64_t s_EDGE_COST_US{s_WINDOW_US / MaxEdges};
+
+    private:
+        PinState m_in{PinState::Unknown};
+        PinState m_out{PinState::Unknown};
+        uint64_t m_creditUs{0};
+        uint64_t m_lastUs{0};
+    }; // class RateLimit
+
+    /**
+     * @brief Chain of filter stages known at compile time, e.g.
+     * "FilterPipeline<Debounce<5>, MinHold<200>, RateLimit<10>>".
+     * Every update runs the raw state through the stages in order, all of them inlined into
+     * one function with no virtual calls. The owner only needs one timer, for the earliest
+     * "nextUpdateUs()" of the stages, so a stage whose output changes on a timer feeds the
+     * next ones on the same update.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    template <typename... Stages>
+    class FilterPipeline
+    {
+        static_assert(sizeof...(Stages), "A pipeline needs at least one stage");
+
+    public:
+        inline PinState update(const PinState raw, const uint64_t nowUs) { return updateFrom<0>(raw, nowUs); }
+
+        uint64_t nextUpdateUs() const
+        {
+            uint64_t nextUs{DeadlineQueue::s_NEVER};
+            std::apply([&nextUs](const Stages &...stages)
+                       { ((nextUs = stages.nextUpdateUs() < nextUs ? stages.nextUpdateUs() : nextUs), ...); },
+                       m_stages);
+            return nextUs;
+        }
+
+        // Stage "I" of the pipeline (e.g. to inspect it on the host)
+        template <size_t I>
+        inline const auto &getStage() const { return std::get<I>(m_stages); }
+
+    private:
+        template <size_t I>
+        __attribute__((always_inline)) inline PinState updateFrom(const PinState state, const uint64_t nowUs)
+        {
+            if constexpr (I == sizeof...(Stages))
+                return state;
+            else
+                return updateFrom<I + 1>(std::get<I>(m_stages).update(state, nowUs), nowUs);
+        }
+
+    private:
+        std::tuple<Stages...> m_stages;
+    }; // class FilterPipeline
+
+} // namespace AT
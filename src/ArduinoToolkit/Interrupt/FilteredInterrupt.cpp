@@ -1,232 +1,370 @@
+#define AT_LOG_MODULE Interrupt
+
 #include "ArduinoToolkit/Interrupt/FilteredInterrupt.h"
 
 namespace AT
 {
 
     // Static class members
-    UBaseType_t FilteredInterrupt::s_taskPriority{2};
-    TaskHandle_t FilteredInterrupt::s_deferredInterruptTaskHandle{nullptr};
-    std::vector<FilteredInterrupt *> FilteredInterrupt::s_instances;
-    SemaphoreHandle_t FilteredInterrupt::s_interruptCountingSepmaphore{nullptr};
+    FilteredInterrupt::WorkerConfig FilteredInterrupt::s_workerConfig;
+    FilteredInterrupt::Worker FilteredInterrupt::s_workers[portNUM_PROCESSORS];
+    ReadySet FilteredInterrupt::s_readySet;
 
-    void FilteredInterrupt::filteredStateChangeTimerCallback(const TimerHandle_t xTimer)
+    void FilteredInterrupt::commitFilteredState(FilteredInterrupt *const intPtr, const PinState newState)
     {
-        FilteredInterrupt *const &intPtr{static_cast<FilteredInterrupt *>(pvTimerGetTimerID(xTimer))};
-        if (intPtr->m_state == PinState::Low)
-        {
-            intPtr->m_state = PinState::High;
+        if (!intPtr->m_filteredEdges.update(newState))
+            return;
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        intPtr->m_commitTimeUs.store(LatencyStats::nowUs(), std::memory_order_relaxed);
+#endif
+        // Wake up the receivers of this object and the task waiting for the ready mask
+        xSemaphoreGive(intPtr->m_interruptBinarySemaphore);
+        s_readySet.mark(intPtr->m_filteredReadySlot);
+    }
+
+    // Runs in the esp_timer task once the raw state has been stable for the filter time
+    void FilteredInterrupt::filteredStateChangeTimerCallback(void *const voidPtrInt)
+    {
+        FilteredInterrupt *const &intPtr{static_cast<FilteredInterrupt *>(voidPtrInt)};
+        // The deferred task may have seen the raw state going back right before the deadline
+        // expired, in which case the raw and filtered states are equal and nothing changes
+        const PinState rawState{intPtr->BasicInterrupt::getState()};
+        if (!DebounceFilter::onTimerExpired(intPtr->m_filteredEdges.getState(), rawState))
+            return;
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        // Time the callback has run after the deadline
+        intPtr->recordLatency(LatencyStage::Commit,
+                              DeadlineScheduler::nowUs() - intPtr->m_changeFilteredStateDeadline.getTimeUs());
+#endif
+        commitFilteredState(intPtr, rawState);
+        if (rawState == PinState::High)
             AT_LOG_D("Filtered state changed to HIGH");
-        }
         else
-        {
-            intPtr->m_state = PinState::Low;
             AT_LOG_D("Filtered state changed to LOW");
-        }
-        // Increment the interrupt semaphore counter
-        xSemaphoreGive(intPtr->m_interruptCountingSepmaphore);
-        // Increment the class interrupt semaphore counter
-        xSemaphoreGive(s_interruptCountingSepmaphore);
     }
 
-    void FilteredInterrupt::processInterrupt(FilteredInterrupt *const intPtr)
+    // Runs in the esp_timer task when the filter function is due. It only runs in the deferred task,
+    // so the object is queued to it
+    void FilteredInterrupt::filterDueCallback(void *const voidPtrInt)
+    {
+        FilteredInterrupt *const &intPtr{static_cast<FilteredInterrupt *>(voidPtrInt)};
+        intPtr->m_filterDue.store(true, std::memory_order_release);
+        if (intPtr->queued.exchange(true, std::memory_order_acq_rel))
+            return;
+        Worker &worker{s_workers[intPtr->worker]};
+        worker.readyQueue.push(static_cast<DeferredQueueNode *>(intPtr));
+        if (worker.taskHandle)
+            xTaskNotifyGive(worker.taskHandle);
+    }
+
+    // Edge notifier of the BasicInterrupt part. Queue the object to be processed by the deferred task
+    void IRAM_ATTR FilteredInterrupt::enqueueFromISR(BasicInterrupt *const basicIntPtr,
+                                                     BaseType_t *const pxHigherPriorityTaskWoken)
     {
-        const PinState basicInterruptState{intPtr->BasicInterrupt::receiveInterruptDiscardIntermediate(0)};
+        FilteredInterrupt *const intPtr{static_cast<FilteredInterrupt *>(basicIntPtr)};
+        // Queue the object only once until the deferred task takes it
+        if (intPtr->queued.exchange(true, std::memory_order_acq_rel))
+            return;
+        Worker &worker{s_workers[intPtr->worker]};
+        worker.readyQueue.push(static_cast<DeferredQueueNode *>(intPtr));
+        // The first edges may arrive before the deferred task is created
+        if (worker.taskHandle)
+            vTaskNotifyGiveFromISR(worker.taskHandle, pxHigherPriorityTaskWoken);
+    }
+
+    // Return false if the object had no pending raw interrupts
+    bool FilteredInterrupt::processInterrupt(FilteredInterrupt *const intPtr)
+    {
+        if (intPtr->m_filterFunction)
+            return runFilterFunction(intPtr);
+        const PinState basicInterruptState{intPtr->BasicInterrupt::receive(ReceiveMode::DiscardIntermediate, 0, LatencyStage::Deferred)};
         // Check if the interrupt happened in this object
         if (basicInterruptState == PinState::Unknown)
-            return;
-        // Do things depending on the current state
-        switch (intPtr->m_state)
-        {
-        case PinState::Low:
+            return false;
+        // Do things depending on the current filtered state
+        switch (DebounceFilter::onRawState(intPtr->m_filteredEdges.getState(), basicInterruptState))
         {
-            if (basicInterruptState == PinState::Low)
-            {
-                AT_LOG_V("Got same state -> Stop timer on pin %u", intPtr->getPin());
-                xTimerStop(intPtr->m_changeFilteredStateTimer, portMAX_DELAY);
-            }
-            else
-            {
-                AT_LOG_V("Got different state -> Start timer on pin %u", intPtr->getPin());
-                xTimerChangePeriod(intPtr->m_changeFilteredStateTimer,
-                                   pdMS_TO_TICKS(intPtr->m_lowToHighTimeMs),
-                                   portMAX_DELAY);
-            }
-        }
-        break;
-        case PinState::High:
-        {
-            if (basicInterruptState == PinState::Low)
-            {
-                AT_LOG_V("Got different state -> Start timer on pin %u", intPtr->getPin());
-                xTimerChangePeriod(intPtr->m_changeFilteredStateTimer,
-                                   pdMS_TO_TICKS(intPtr->m_highToLowTimeMs),
-                                   portMAX_DELAY);
-            }
-            else
-            {
-                AT_LOG_V("Got same state -> Stop timer on pin %u", intPtr->getPin());
-                xTimerStop(intPtr->m_changeFilteredStateTimer, portMAX_DELAY);
-            }
-        }
-        break;
+        case DebounceFilter::Action::StartTimer:
+            AT_LOG_V("Got different state -> Start timer on pin %u", intPtr->getPin());
+            DeadlineScheduler::schedule(intPtr->m_changeFilteredStateDeadline,
+                                        intPtr->m_filter.filterTimeUs(basicInterruptState));
+            break;
+        case DebounceFilter::Action::StopTimer:
+            AT_LOG_V("Got same state -> Stop timer on pin %u", intPtr->getPin());
+            DeadlineScheduler::cancel(intPtr->m_changeFilteredStateDeadline);
+            break;
         default:
             // If the current filtered state is "PinState::Unknown" update the state directly
-            intPtr->m_state = basicInterruptState;
+            commitFilteredState(intPtr, basicInterruptState);
             if (basicInterruptState == PinState::Low)
                 AT_LOG_D("Filtered state changed to LOW on pin %u", intPtr->getPin());
             else
                 AT_LOG_D("Filtered state changed to HIGH on pin %u", intPtr->getPin());
-            // Increment the interrupt semaphore counter
-            xSemaphoreGive(intPtr->m_interruptCountingSepmaphore);
-            // Increment the class interrupt semaphore counter
-            xSemaphoreGive(s_interruptCountingSepmaphore);
             break;
         }
+        return true;
     }
 
-    // Deferred interrupt handler function
+    // Run the filter function with the next raw edge, or with the current raw state if it is due.
+    // Return false if there was nothing to run it with
+    bool FilteredInterrupt::runFilterFunction(FilteredInterrupt *const intPtr)
+    {
+        // The filter sees every raw edge (some stages count them)
+        PinState rawState{intPtr->BasicInterrupt::receive(ReceiveMode::Next, 0, LatencyStage::Deferred)};
+        const uint64_t nowUs{DeadlineScheduler::nowUs()};
+        if (rawState == PinState::Unknown)
+        {
+            if (!intPtr->m_filterDue.exchange(false, std::memory_order_acq_rel))
+                return false;
+            rawState = intPtr->BasicInterrupt::getState();
+#ifdef AT_INTERRUPT_LATENCY_STATS
+            // Time the filter has run after it was due
+            intPtr->recordLatency(LatencyStage::Commit, nowUs - intPtr->m_changeFilteredStateDeadline.getTimeUs());
+#endif
+        }
+        uint64_t nextUs{DeadlineQueue::s_NEVER};
+        const PinState filteredState{intPtr->m_filterFunction(intPtr, rawState, nowUs, nextUs)};
+        if (nextUs == DeadlineQueue::s_NEVER)
+            DeadlineScheduler::cancel(intPtr->m_changeFilteredStateDeadline);
+        else
+            DeadlineScheduler::schedule(intPtr->m_changeFilteredStateDeadline, nextUs > nowUs ? nextUs - nowUs : 0);
+        if (filteredState != PinState::Unknown && filteredState != intPtr->m_filteredEdges.getState())
+        {
+            commitFilteredState(intPtr, filteredState);
+            if (filteredState == PinState::High)
+                AT_LOG_D("Filtered state changed to HIGH on pin %u", intPtr->getPin());
+            else
+                AT_LOG_D("Filtered state changed to LOW on pin %u", intPtr->getPin());
+        }
+        return true;
+    }
+
+    // Deferred interrupt handler function. There is one task per worker
     void FilteredInterrupt::deferredInterruptTask(void *const parameters)
     {
+        Worker &worker{*static_cast<Worker *>(parameters)};
         while (true)
         {
-            BasicInterrupt::waitUntilAnyInterrupt();
-            for (FilteredInterrupt *const intPtr : s_instances)
-                processInterrupt(intPtr);
+            // Only the objects that got raw edges are in the queue
+            while (MPSCQueueNode *const node{worker.readyQueue.pop()})
+            {
+                FilteredInterrupt *const intPtr{static_cast<FilteredInterrupt *>(static_cast<DeferredQueueNode *>(node))};
+                // The destructor waits while the object is queued or busy, so it is marked busy first
+                worker.busy.store(intPtr, std::memory_order_release);
+                // Allow the ISR to queue the object again before its edges are consumed
+                intPtr->queued.store(false, std::memory_order_release);
+                // A pair of edges may be left after discarding the intermediate ones
+                while (processInterrupt(intPtr))
+                    ;
+                worker.busy.store(nullptr, std::memory_order_release);
+            }
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         }
     }
 
+    // Pick the worker of a new object and count the object in it
+    uint8_t FilteredInterrupt::selectWorker(const BaseType_t core)
+    {
+        uint8_t worker{0};
+        if (s_workerConfig.perCore)
+        {
+            if (core != tskNO_AFFINITY)
+            {
+                ASSERT(core >= 0 && core < portNUM_PROCESSORS);
+                worker = static_cast<uint8_t>(core);
+            }
+            else
+            {
+                // Split the objects evenly across the cores
+                for (uint8_t i{1}; i < portNUM_PROCESSORS; i++)
+                    if (s_workers[i].instanceCount < s_workers[worker].instanceCount)
+                        worker = i;
+            }
+        }
+        s_workers[worker].instanceCount++;
+        return worker;
+    }
+
+    BaseType_t FilteredInterrupt::workerCore(const uint8_t worker)
+    {
+        return s_workerConfig.perCore ? static_cast<BaseType_t>(worker) : s_workerConfig.core;
+    }
+
+    void FilteredInterrupt::startWorker(const uint8_t worker)
+    {
+        Worker &workerRef{s_workers[worker]};
+        static constexpr const char *taskNames[]{"deferredInterruptTask0", "deferredInterruptTask1"};
+        const char *const taskName{s_workerConfig.perCore ? taskNames[worker] : "deferredInterruptTask"};
+#ifdef AT_STATIC_ALLOCATION
+        // The stack is statically allocated with s_TASK_STACK_SIZE bytes
+        ASSERT(s_workerConfig.stackSize <= s_TASK_STACK_SIZE);
+        workerRef.taskHandle = xTaskCreateStaticPinnedToCore(deferredInterruptTask,
+                                                             taskName,
+                                                             s_workerConfig.stackSize,
+                                                             &workerRef,
+                                                             s_workerConfig.priority,
+                                                             workerRef.taskStack,
+                                                             &workerRef.taskBuffer,
+                                                             workerCore(worker));
+        ASSERT(workerRef.taskHandle);
+#else
+        const BaseType_t ret{xTaskCreatePinnedToCore(deferredInterruptTask,
+                                                     taskName,
+                                                     s_workerConfig.stackSize,
+                                                     &workerRef,
+                                                     s_workerConfig.priority,
+                                                     &workerRef.taskHandle,
+                                                     workerCore(worker))};
+        ASSERT(ret);
+#endif
+        AT_LOG_V("FilteredInterrupt deferred task %u created", worker);
+    }
+
+    /**
+     * @brief Construct a FilteredInterrupt.
+     *
+     * @param pin Pin of the interrupt.
+     * @param mode Mode of the pin.
+     * @param lowToHighTimeMs Time the raw state must be high to change the filtered state to high.
+     * @param highToLowTimeMs Time the raw state must be low to change the filtered state to low.
+     * @param reverseLogic Invert the logic of the pin.
+     * @param periodicCallToISRms Period of the missed-edge sweep while this input is active.
+     * @param core With "WorkerConfig::perCore", core of the worker that filters this object
+     *             (tskNO_AFFINITY to pick the one with less objects). Ignored otherwise.
+     *             The ISR of the pin is installed from the core of the worker.
+     */
     FilteredInterrupt::FilteredInterrupt(const uint8_t pin,
                                          const uint8_t mode,
                                          const uint32_t lowToHighTimeMs,
                                          const uint32_t highToLowTimeMs,
                                          const bool reverseLogic,
-                                         const uint32_t periodicCallToISRms)
-        : BasicInterrupt(pin, mode, reverseLogic, periodicCallToISRms),
-          m_lowToHighTimeMs(lowToHighTimeMs),
-          m_highToLowTimeMs(highToLowTimeMs)
-    {
-        // Create a semaphore to count the number of interrupts that happens
-        m_interruptCountingSepmaphore = xSemaphoreCreateCounting(-1, 0);
-        ASSERT(m_interruptCountingSepmaphore);
-        // Create a timer to change the state of the filtered interrupt
-        m_changeFilteredStateTimer = xTimerCreate("FilteredStateChangeTimer",
-                                                  1, // Will be changed later (any unsigned > 0 is OK)
-                                                  pdFALSE,
-                                                  static_cast<void *>(this),
-                                                  filteredStateChangeTimerCallback);
-        ASSERT(m_changeFilteredStateTimer);
-        // Check if the "deferredInterruptTask" needs to be created
-        if (s_instances.empty())
-        {
-            // Create a semaphore to count the number of interrupts that happens for all objects
-            s_interruptCountingSepmaphore = xSemaphoreCreateCounting(-1, 0);
-            ASSERT(s_interruptCountingSepmaphore);
-            // Set up the deferredInterruptTask
-            const BaseType_t ret{xTaskCreatePinnedToCore(deferredInterruptTask,
-                                                         "deferredInterruptTask",
-                                                         3 * 1024,
-                                                         nullptr,
-                                                         s_taskPriority,
-                                                         &s_deferredInterruptTaskHandle,
-                                                         ARDUINO_RUNNING_CORE)};
-            ASSERT(ret);
-            AT_LOG_V("FilteredInterrupt deferred task created");
-        }
-        // Log some info from the task
-        PRINT_TASK_INFO(s_deferredInterruptTaskHandle);
-        // Add this object to the list of instances
-        s_instances.push_back(this);
+                                         const uint32_t periodicCallToISRms,
+                                         const BaseType_t core)
+        : DeferredQueueNode(selectWorker(core)),
+          BasicInterrupt(pin, mode, reverseLogic, periodicCallToISRms, enqueueFromISR, workerCore(worker)),
+          m_filter(lowToHighTimeMs * 1000ULL, highToLowTimeMs * 1000ULL),
+          m_filteredReadySlot(s_readySet.allocateSlot())
+    {
+        // Only ReadySet::s_MAX_SLOTS objects are reported in the ready mask, the rest still work
+        if (m_filteredReadySlot == ReadySet::s_NO_SLOT)
+            AT_LOG_W("FilteredInterrupt on pin %u is not in the ready mask", getPin());
+        // Register the deadline that changes the state of the filtered interrupt
+        DeadlineScheduler::add(m_changeFilteredStateDeadline);
+        // Check if the "deferredInterruptTask" of the worker needs to be created
+        if (!s_workers[worker].taskHandle)
+            startWorker(worker);
+        AT_LOG_D("FilteredInterrupt constructed");
+    }
+
+    // Construct a FilteredInterrupt whose raw edges go through "filterFunction" instead of the hold times
+    FilteredInterrupt::FilteredInterrupt(const uint8_t pin,
+                                         const uint8_t mode,
+                                         const FilterFunction filterFunction,
+                                         const bool reverseLogic,
+                                         const uint32_t periodicCallToISRms,
+                                         const BaseType_t core)
+        : DeferredQueueNode(selectWorker(core)),
+          BasicInterrupt(pin, mode, reverseLogic, periodicCallToISRms, enqueueFromISR, workerCore(worker)),
+          m_filter(0, 0),
+          m_filterFunction(filterFunction),
+          m_changeFilteredStateDeadline(filterDueCallback, this),
+          m_filteredReadySlot(s_readySet.allocateSlot())
+    {
+        ASSERT(m_filterFunction);
+        // Only ReadySet::s_MAX_SLOTS objects are reported in the ready mask, the rest still work
+        if (m_filteredReadySlot == ReadySet::s_NO_SLOT)
+            AT_LOG_W("FilteredInterrupt on pin %u is not in the ready mask", getPin());
+        DeadlineScheduler::add(m_changeFilteredStateDeadline);
+        if (!s_workers[worker].taskHandle)
+            startWorker(worker);
         AT_LOG_D("FilteredInterrupt constructed");
     }
 
     FilteredInterrupt::~FilteredInterrupt()
     {
-        // Remove this object from the list of instances
-        s_instances.erase(std::remove(s_instances.begin(), s_instances.end(), this), s_instances.end());
-        // Delete the task if there are no objects left
-        if (s_instances.empty())
+        // Stop the ISR and unregister the filter deadline, which waits for its callback (it queues
+        // the object with a filter function) and keeps the deferred task from scheduling it again.
+        // Then wait until the deferred task is done with this object
+        BasicInterrupt::detach();
+        DeadlineScheduler::remove(m_changeFilteredStateDeadline);
+        Worker &workerRef{s_workers[worker]};
+        while (queued.load(std::memory_order_acquire) || workerRef.busy.load(std::memory_order_acquire) == this)
+            vTaskDelay(1);
+        // Delete the task of the worker if there are no objects left on it
+        if (!--workerRef.instanceCount)
         {
-            vTaskDelete(s_deferredInterruptTaskHandle);
-            AT_LOG_V("FilteredInterrupt deferred task deleted");
-            vSemaphoreDelete(s_interruptCountingSepmaphore);
+            vTaskDelete(workerRef.taskHandle);
+            workerRef.taskHandle = nullptr;
+            AT_LOG_V("FilteredInterrupt deferred task %u deleted", worker);
         }
+        // Free the bit of this object in the ready mask
+        s_readySet.releaseSlot(m_filteredReadySlot);
         AT_LOG_D("FilteredInterrupt destructed");
     }
 
     PinState FilteredInterrupt::receiveInterrupt(const TickType_t xTicksToWait) const
     {
-        // Block until an interrupt arrives from the ISR
-        if (xSemaphoreTake(m_interruptCountingSepmaphore, xTicksToWait))
-        {
-            // Take also the class semaphore
-            xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-
-            const UBaseType_t interruptsLeft{uxSemaphoreGetCount(m_interruptCountingSepmaphore)};
-            const bool interruptState{static_cast<bool>(m_state)};
-            // Depending on the semaphore counter (interrupts that remain to be processed)
-            // and the current state of the interrupt, determine which state the past interrupts
-            // correspond to (by doing an XOR operation).
-            return (!(interruptsLeft % 2) != interruptState) ? PinState::Low : PinState::High;
-        }
-        return PinState::Unknown;
+        return receive(ReceiveMode::Next, xTicksToWait);
     }
 
     PinState FilteredInterrupt::receiveInterruptDiscardIntermediate(const TickType_t xTicksToWait) const
     {
-        if (xSemaphoreTake(m_interruptCountingSepmaphore, xTicksToWait))
-        {
-            // Take also the class semaphore
-            xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-
-            UBaseType_t interruptsLeft{uxSemaphoreGetCount(m_interruptCountingSepmaphore)};
-            const bool interruptState{static_cast<bool>(m_state)};
-            // Discard the intermediate interrupts
-            const UBaseType_t aux{interruptsLeft % 2};
-            for (; interruptsLeft > aux; interruptsLeft--)
-            {
-                xSemaphoreTake(m_interruptCountingSepmaphore, portMAX_DELAY);
-                // Take also the class semaphore
-                xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            }
-            // Depending on the semaphore counter (interrupts that remain to be processed)
-            // and the current state of the interrupt, determine which state the past interrupts
-            // correspond to (by doing an XOR operation).
-            return (static_cast<bool>(aux) != interruptState) ? PinState::High : PinState::Low;
-        }
-        return PinState::Unknown;
+        return receive(ReceiveMode::DiscardIntermediate, xTicksToWait);
+    }
+
+    PinState FilteredInterrupt::receiveLastInterrupt(const TickType_t xTicksToWait) const
+    {
+        return receive(ReceiveMode::Last, xTicksToWait);
+    }
+
+    PinState FilteredInterrupt::receive(const ReceiveMode mode, const TickType_t xTicksToWait) const
+    {
+        const PinState state{s_readySet.receive(m_filteredEdges, m_interruptBinarySemaphore, m_filteredReadySlot,
+                                                mode, xTicksToWait)};
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        if (state != PinState::Unknown)
+            recordLatency(LatencyStage::Receive, LatencyStats::nowUs() - m_commitTimeUs.load(std::memory_order_relaxed));
+#endif
+        return state;
     }
 
     /**
-     * @brief Receive the last pending interrupt from the ISR using a semaphore.
-     * This function blocks until an interrupt is received or the specified timeout elapses.
-     * It then processes all remaining pending interrupts in the semaphore, effectively
-     * resetting the semaphore count to 0, and returns the state of the last interrupt.
+     * @brief Configure the deferred tasks that filter the raw edges.
+     * It must be called before constructing any object.
      *
-     * @param xTicksToWait The maximum time to wait for an interrupt.
-     * @return The state of the last received interrupt (PinState::Low or PinState::High)
-     *         if any interrupt was received within the specified timeout,
-     *         or PinState::Unknown if no interrupt was received.
+     * @param config New configuration of the workers.
+     * @return true if the configuration has been applied, false if there are objects alive.
      */
-    PinState FilteredInterrupt::receiveLastInterrupt(const TickType_t xTicksToWait) const
+    bool FilteredInterrupt::setWorkerConfig(const WorkerConfig &config)
     {
-        if (xSemaphoreTake(m_interruptCountingSepmaphore, xTicksToWait))
+        for (const Worker &worker : s_workers)
         {
-            // Take also the class semaphore
-            xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
-            while (uxSemaphoreGetCount(m_interruptCountingSepmaphore))
+            if (worker.instanceCount)
             {
-                xSemaphoreTake(m_interruptCountingSepmaphore, portMAX_DELAY);
-                // Take also the class semaphore
-                xSemaphoreTake(s_interruptCountingSepmaphore, portMAX_DELAY);
+                AT_LOG_W("FilteredInterrupt workers can not be configured while there are objects");
+                return false;
             }
-            return m_state;
         }
-        return PinState::Unknown;
+        s_workerConfig = config;
+        return true;
     }
 
     bool FilteredInterrupt::waitUntilAnyInterrupt(const TickType_t xTicksToWait)
     {
-        return xQueuePeek(s_interruptCountingSepmaphore, nullptr, xTicksToWait);
+        return s_readySet.waitAny(xTicksToWait);
+    }
+
+    /**
+     * @brief Block until any object has pending filtered interrupts.
+     * Only one task can wait for the interrupts of the class at a time.
+     *
+     * @param xTicksToWait The maximum time to wait for an interrupt.
+     * @return The mask of the objects with pending interrupts (see "getInterruptMask()"),
+     *         or 0 if no interrupt was received within the specified timeout.
+     */
+    uint32_t FilteredInterrupt::waitForInterruptMask(const TickType_t xTicksToWait)
+    {
+        return s_readySet.wait(xTicksToWait);
     }
 
 } // namespace AT
@@ -1,52 +1,179 @@
 #pragma once
 
-#include <vector>
-
 #include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/BinarySemaphore.h"
+#include "ArduinoToolkit/Core/DeadlineScheduler.h"
+#include "ArduinoToolkit/Core/MPSCQueue.h"
 #include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
+#include "ArduinoToolkit/Interrupt/DebounceFilter.h"
+
+// Stack size (in bytes) of the deferred interrupt tasks. With AT_STATIC_ALLOCATION
+// it is the size of their static stacks and the maximum that can be configured
+#ifndef AT_FILTERED_INTERRUPT_TASK_STACK_SIZE
+#define AT_FILTERED_INTERRUPT_TASK_STACK_SIZE (3 * 1024)
+#endif
 
 namespace AT
 {
 
-    class FilteredInterrupt : private BasicInterrupt
+    // Link of a FilteredInterrupt in the ready queue of its worker. It is a base of FilteredInterrupt
+    // (before BasicInterrupt) so it is initialized before the ISR is attached
+    struct DeferredQueueNode : MPSCQueueNode
+    {
+        explicit DeferredQueueNode(const uint8_t worker) : worker(worker) {}
+
+        // Index of the worker that filters the object
+        const uint8_t worker;
+        // Set while the object is in the ready queue of its worker
+        std::atomic<bool> queued{false};
+    };
+
+    class FilteredInterrupt : private DeferredQueueNode, private BasicInterrupt
     {
     public:
+        // Configuration of the tasks that filter the raw edges
+        struct WorkerConfig
+        {
+            // Core of the worker (tskNO_AFFINITY to let the scheduler choose). Ignored if "perCore"
+            BaseType_t core{ARDUINO_RUNNING_CORE};
+            UBaseType_t priority{2};
+            uint32_t stackSize{AT_FILTERED_INTERRUPT_TASK_STACK_SIZE};
+            // Run one worker pinned to each core and split the objects across them
+            bool perCore{false};
+        };
+
         FilteredInterrupt(const uint8_t pin,
                           const uint8_t mode,
                           const uint32_t lowToHighTimeMs,
                           const uint32_t highToLowTimeMs,
                           const bool reverseLogic = false,
-                          const uint32_t periodicCallToISRms = BasicInterrupt::s_DEFAULT_PERIODIC_CALL_ISR_MS);
+                          const uint32_t periodicCallToISRms = BasicInterrupt::s_DEFAULT_PERIODIC_CALL_ISR_MS,
+                          const BaseType_t core = tskNO_AFFINITY);
         ~FilteredInterrupt();
 
         inline uint8_t getPin() const { return BasicInterrupt::getPin(); }
         inline uint8_t getMode() const { return BasicInterrupt::getMode(); }
         inline PinState getState() const { return BasicInterrupt::getState(); }
+        // Bit of this object in the mask returned by "waitForInterruptMask()", 0 past ReadySet::s_MAX_SLOTS objects
+        inline uint32_t getInterruptMask() const { return ReadySet::slotMask(m_filteredReadySlot); }
 
         PinState receiveInterrupt(const TickType_t xTicksToWait = portMAX_DELAY) const;
         PinState receiveInterruptDiscardIntermediate(const TickType_t xTicksToWait = portMAX_DELAY) const;
         PinState receiveLastInterrupt(const TickType_t xTicksToWait = portMAX_DELAY) const;
 
+#ifdef AT_COROUTINES
+        // Awaitable of the next filtered edge for an EdgeCoroutine ("co_await input.nextEdge()")
+        inline EdgeAwaitable nextEdge(const TickType_t xTicksToWait = portMAX_DELAY,
+                                      const ReceiveMode mode = ReceiveMode::Next) const
+        {
+            return {this, receiveEdge<FilteredInterrupt>, s_readySet, getInterruptMask(), mode, xTicksToWait};
+        }
+#endif
+
+        // Event buffer of the raw edges (e.g. to record them with an EdgeTraceRecorder)
+        using BasicInterrupt::enableEventBuffer;
+        using BasicInterrupt::drainEvents;
+        using BasicInterrupt::getEventOverflowCount;
+
+        // Interrupt rate limit of the pin. During a storm the raw edges come from the polls
+        using BasicInterrupt::StormConfig;
+        using BasicInterrupt::enableStormGuard;
+        using BasicInterrupt::getStormCount;
+        using BasicInterrupt::isStorming;
+
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        using BasicInterrupt::getLatencyStats;
+        using BasicInterrupt::printLatencyStats;
+        using BasicInterrupt::resetLatencyStats;
+#endif
+
+        // Core of the worker that filters this object (tskNO_AFFINITY if it is not pinned)
+        inline BaseType_t getWorkerCore() const { return workerCore(worker); }
+
     public:
         static bool waitUntilAnyInterrupt(const TickType_t xTicksToWait = portMAX_DELAY);
+        static uint32_t waitForInterruptMask(const TickType_t xTicksToWait = portMAX_DELAY);
+        // Ready mask of the class, for dispatchers that wait on several classes at once
+        static inline ReadySet &getReadySet() { return s_readySet; }
+
+        static bool setWorkerConfig(const WorkerConfig &config);
+        static inline const WorkerConfig &getWorkerConfig() { return s_workerConfig; }
+
+    public:
+        static constexpr uint32_t s_TASK_STACK_SIZE{AT_FILTERED_INTERRUPT_TASK_STACK_SIZE};
+
+    protected:
+        // Filter that replaces the hold times (see PipelineInterrupt). It is run by the worker with
+        // every raw edge, and with the current raw state once "nextUs" is reached. It returns the
+        // filtered state and sets "nextUs" (DeadlineQueue::s_NEVER if it does not need to run again)
+        using FilterFunction = PinState (*)(FilteredInterrupt *const intPtr,
+                                            const PinState raw,
+                                            const uint64_t nowUs,
+                                            uint64_t &nextUs);
+
+        FilteredInterrupt(const uint8_t pin,
+                          const uint8_t mode,
+                          const FilterFunction filterFunction,
+                          const bool reverseLogic,
+                          const uint32_t periodicCallToISRms,
+                          const BaseType_t core);
+
+    private:
+        // Deferred task with the queue of the objects it filters
+        struct Worker
+        {
+            TaskHandle_t taskHandle{nullptr};
+            size_t instanceCount{0};
+            // Objects with pending raw edges, consumed by the task
+            MPSCQueue readyQueue;
+            // Object being processed by the task, set before it leaves the queue
+            std::atomic<FilteredInterrupt *> busy{nullptr};
+#ifdef AT_STATIC_ALLOCATION
+            StackType_t taskStack[s_TASK_STACK_SIZE];
+            StaticTask_t taskBuffer;
+#endif
+        };
+
+        static uint8_t selectWorker(const BaseType_t core);
+        static BaseType_t workerCore(const uint8_t worker);
+        static void startWorker(const uint8_t worker);
 
     private:
-        static void filteredStateChangeTimerCallback(const TimerHandle_t xTimer);
+        static void filteredStateChangeTimerCallback(void *const voidPtrInt);
+        static void filterDueCallback(void *const voidPtrInt);
+        static void IRAM_ATTR enqueueFromISR(BasicInterrupt *const basicIntPtr,
+                                             BaseType_t *const pxHigherPriorityTaskWoken);
         static void deferredInterruptTask(void *const parameters);
-        static void processInterrupt(FilteredInterrupt *const intPtr);
+        static bool processInterrupt(FilteredInterrupt *const intPtr);
+        static bool runFilterFunction(FilteredInterrupt *const intPtr);
+        static void commitFilteredState(FilteredInterrupt *const intPtr, const PinState newState);
+        PinState receive(const ReceiveMode mode, const TickType_t xTicksToWait) const;
 
     private:
-        const uint32_t m_lowToHighTimeMs;
-        const uint32_t m_highToLowTimeMs;
-        PinState m_state{PinState::Unknown};
-        SemaphoreHandle_t m_interruptCountingSepmaphore{nullptr};
-        TimerHandle_t m_changeFilteredStateTimer{nullptr};
+        const DebounceFilter m_filter;
+        // Replaces "m_filter" if set
+        const FilterFunction m_filterFunction{nullptr};
+        // Set when "m_filterFunction" has to run again with the current raw state
+        std::atomic<bool> m_filterDue{false};
+        // Filtered state and number of filtered edges not yet received
+        mutable PendingEdges m_filteredEdges;
+        // Given on every filtered edge to wake up the receivers of this object
+        BinarySemaphore m_interruptBinarySemaphore;
+        // Expires once the raw state has been stable for the filter time (or "m_filterFunction" is due)
+        Deadline m_changeFilteredStateDeadline{filteredStateChangeTimerCallback, this};
+#ifdef AT_INTERRUPT_LATENCY_STATS
+        // Time of the last filtered edge (truncated to 32 bits)
+        std::atomic<uint32_t> m_commitTimeUs{0};
+#endif
+        // Bit of this object in "s_readySet"
+        const int8_t m_filteredReadySlot;
 
     private:
-        static UBaseType_t s_taskPriority;
-        static TaskHandle_t s_deferredInterruptTaskHandle;
-        static std::vector<FilteredInterrupt *> s_instances;
-        static SemaphoreHandle_t s_interruptCountingSepmaphore;
+        static WorkerConfig s_workerConfig;
+        // Only the first one is used unless "WorkerConfig::perCore" is set
+        static Worker s_workers[portNUM_PROCESSORS];
+        // Objects with pending filtered edges
+        static ReadySet s_readySet;
     };
 
 } // namespace AT
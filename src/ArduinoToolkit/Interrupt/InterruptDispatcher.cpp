@@ -0,0 +1,188 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/InterruptDispatcher.h"
+
+namespace AT
+{
+
+    InterruptDispatcher::InterruptDispatcher(const Config &config)
+        : m_config(config),
+          m_sources{{&BasicInterrupt::getReadySet(), {}, {}},
+                    {&FilteredInterrupt::getReadySet(), {}, {}}}
+    {
+        ASSERT(m_config.batchSize);
+    }
+
+    InterruptDispatcher::~InterruptDispatcher()
+    {
+        if (!m_taskHandle)
+            return;
+        for (Source &source : m_sources)
+            source.readySet->setWaiterTask(nullptr);
+        vTaskDelete(m_taskHandle);
+        AT_LOG_V("InterruptDispatcher task deleted");
+    }
+
+    /**
+     * @brief Register the handler of a BasicInterrupt (or StaticBasicInterrupt).
+     * Handlers must be added before the dispatcher is started.
+     *
+     * @param interrupt Object to dispatch. It must outlive the dispatcher.
+     * @param handler Function called with every received edge.
+     * @param context Passed to the handler.
+     * @param lane Priority of the handler, from 0 (highest) to s_NUM_LANES - 1.
+     * @param mode How the edges are received.
+     * @return true if the handler has been added.
+     */
+    bool InterruptDispatcher::add(BasicInterrupt &interrupt,
+                                  const Handler handler,
+                                  void *const context,
+                                  const uint8_t lane,
+                                  const ReceiveMode mode)
+    {
+        return add(s_BASIC_SOURCE, interrupt.getInterruptMask(), &interrupt, receiveEdge<BasicInterrupt>,
+                   handler, context, lane, mode);
+    }
+
+    // Same as the BasicInterrupt version, the handler gets the filtered edges
+    bool InterruptDispatcher::add(FilteredInterrupt &interrupt,
+                                  const Handler handler,
+                                  void *const context,
+                                  const uint8_t lane,
+                                  const ReceiveMode mode)
+    {
+        return add(s_FILTERED_SOURCE, interrupt.getInterruptMask(), &interrupt, receiveEdge<FilteredInterrupt>,
+                   handler, context, lane, mode);
+    }
+
+    bool InterruptDispatcher::add(const uint8_t source,
+                                  const uint32_t mask,
+                                  const void *const object,
+                                  const EdgeReceiver receiver,
+                                  const Handler handler,
+                                  void *const context,
+                                  const uint8_t lane,
+                                  const ReceiveMode mode)
+    {
+        if (m_taskHandle)
+        {
+            AT_LOG_E("Handlers can not be added once the InterruptDispatcher is running");
+            return false;
+        }
+        if (!mask)
+        {
+            AT_LOG_E("Only objects in the ready mask (see \"getInterruptMask()\") can be dispatched");
+            return false;
+        }
+        if (!handler || lane >= s_NUM_LANES)
+        {
+            AT_LOG_E("Invalid InterruptDispatcher handler");
+            return false;
+        }
+        Source &sourceRef{m_sources[source]};
+        const uint8_t slot{static_cast<uint8_t>(__builtin_ctz(mask))};
+        // Move the object to the new lane if it was already registered
+        for (uint32_t &laneMask : sourceRef.laneMasks)
+            laneMask &= ~mask;
+        sourceRef.laneMasks[lane] |= mask;
+        sourceRef.entries[slot] = {object, receiver, handler, context, mode};
+        return true;
+    }
+
+    /**
+     * @brief Create the dispatch task.
+     *
+     * @return true if the task has been created.
+     */
+    bool InterruptDispatcher::start()
+    {
+        if (m_taskHandle)
+            return false;
+#ifdef AT_STATIC_ALLOCATION
+        // The stack is statically allocated with AT_INTERRUPT_DISPATCHER_TASK_STACK_SIZE bytes
+        ASSERT(m_config.stackSize <= AT_INTERRUPT_DISPATCHER_TASK_STACK_SIZE);
+        m_taskHandle = xTaskCreateStaticPinnedToCore(dispatchTask,
+                                                     "interruptDispatcher",
+                                                     m_config.stackSize,
+                                                     this,
+                                                     m_config.priority,
+                                                     m_taskStack,
+                                                     &m_taskBuffer,
+                                                     m_config.core);
+#else
+        xTaskCreatePinnedToCore(dispatchTask,
+                                "interruptDispatcher",
+                                m_config.stackSize,
+                                this,
+                                m_config.priority,
+                                &m_taskHandle,
+                                m_config.core);
+#endif
+        if (!m_taskHandle)
+        {
+            AT_LOG_E("Could not create the InterruptDispatcher task");
+            return false;
+        }
+        AT_LOG_D("InterruptDispatcher task created");
+        return true;
+    }
+
+    // Registered objects of a source with pending edges in the lanes [firstLane, lastLane]
+    uint32_t InterruptDispatcher::pendingMask(const uint8_t source, const uint8_t firstLane, const uint8_t lastLane) const
+    {
+        const Source &sourceRef{m_sources[source]};
+        uint32_t lanesMask{0};
+        for (uint8_t lane{firstLane}; lane <= lastLane; lane++)
+            lanesMask |= sourceRef.laneMasks[lane];
+        return sourceRef.readySet->getMask() & lanesMask;
+    }
+
+    // Serve every object of a lane with pending edges. Return false if there was none
+    bool InterruptDispatcher::dispatchLane(const uint8_t lane)
+    {
+        bool dispatched{false};
+        for (uint8_t source{0}; source < s_NUM_SOURCES; source++)
+        {
+            const Entry *const entries{m_sources[source].entries};
+            for (uint32_t pending{pendingMask(source, lane, lane)}; pending; pending &= pending - 1)
+            {
+                const Entry &entry{entries[__builtin_ctz(pending)]};
+                for (uint8_t i{0}; i < m_config.batchSize; i++)
+                {
+                    const PinState state{entry.receiver(entry.object, entry.mode)};
+                    if (state == PinState::Unknown)
+                        break;
+                    entry.handler(entry.context, state);
+                    dispatched = true;
+                }
+            }
+        }
+        return dispatched;
+    }
+
+    void InterruptDispatcher::dispatchTask(void *const parameters)
+    {
+        InterruptDispatcher *const &dispatcher{static_cast<InterruptDispatcher *>(parameters)};
+        // Register before reading the masks so no notification is missed
+        for (Source &source : dispatcher->m_sources)
+            source.readySet->setWaiterTask(xTaskGetCurrentTaskHandle());
+        while (true)
+        {
+            bool dispatched{false};
+            uint8_t lane{0};
+            while (lane < s_NUM_LANES)
+            {
+                // Go back to the first lane if a higher one has pending edges
+                if (lane &&
+                    (dispatcher->pendingMask(s_BASIC_SOURCE, 0, lane - 1) ||
+                     dispatcher->pendingMask(s_FILTERED_SOURCE, 0, lane - 1)))
+                    lane = 0;
+                dispatched |= dispatcher->dispatchLane(lane++);
+            }
+            // Sleep until any object gets new edges
+            if (!dispatched)
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+
+} // namespace AT
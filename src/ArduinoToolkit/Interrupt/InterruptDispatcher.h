@@ -0,0 +1,112 @@
+#pragma once
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
+#include "ArduinoToolkit/Interrupt/EdgeReceiver.h"
+#include "ArduinoToolkit/Interrupt/FilteredInterrupt.h"
+
+// Stack size (in bytes) of the dispatch task. With AT_STATIC_ALLOCATION
+// it is the size of its static stack and the maximum that can be configured
+#ifndef AT_INTERRUPT_DISPATCHER_TASK_STACK_SIZE
+#define AT_INTERRUPT_DISPATCHER_TASK_STACK_SIZE (3 * 1024)
+#endif
+
+namespace AT
+{
+
+    /**
+     * @brief Run handlers for the interrupt objects with pending edges from a single task.
+     * It replaces the loop on "waitForInterruptMask()" with one handler per object. Only the
+     * handlers of the objects with pending edges are called.
+     * Each round serves the lanes in order (lane 0 first) and calls a handler at most
+     * "batchSize" times, so a busy input can not starve the others. A round restarts from
+     * lane 0 as soon as a higher lane gets new edges.
+     * The dispatch task is the waiter of the ready masks of BasicInterrupt and FilteredInterrupt,
+     * so "waitForInterruptMask()" of those classes must not be used while it is running.
+     */
+    class InterruptDispatcher
+    {
+    public:
+        // Called with the context given on registration and the state of every received edge
+        using Handler = void (*)(void *const context, const PinState state);
+
+        struct Config
+        {
+            BaseType_t core{ARDUINO_RUNNING_CORE};
+            UBaseType_t priority{2};
+            uint32_t stackSize{AT_INTERRUPT_DISPATCHER_TASK_STACK_SIZE};
+            // Maximum edges received from an object before serving the next one
+            uint8_t batchSize{4};
+        };
+
+        InterruptDispatcher() : InterruptDispatcher(Config{}) {}
+        explicit InterruptDispatcher(const Config &config);
+        ~InterruptDispatcher();
+
+        InterruptDispatcher(const InterruptDispatcher &) = delete;
+        InterruptDispatcher &operator=(const InterruptDispatcher &) = delete;
+
+        bool add(BasicInterrupt &interrupt,
+                 const Handler handler,
+                 void *const context = nullptr,
+                 const uint8_t lane = 0,
+                 const ReceiveMode mode = ReceiveMode::Next);
+        bool add(FilteredInterrupt &interrupt,
+                 const Handler handler,
+                 void *const context = nullptr,
+                 const uint8_t lane = 0,
+                 const ReceiveMode mode = ReceiveMode::Next);
+
+        bool start();
+
+    public:
+        static constexpr uint8_t s_NUM_LANES{4};
+
+    private:
+        struct Entry
+        {
+            const void *object{nullptr};
+            EdgeReceiver receiver{nullptr};
+            Handler handler{nullptr};
+            void *context{nullptr};
+            ReceiveMode mode{ReceiveMode::Next};
+        };
+
+        // Objects of one class, indexed by their bit in the ready mask of the class
+        struct Source
+        {
+            ReadySet *readySet;
+            Entry entries[ReadySet::s_MAX_SLOTS];
+            uint32_t laneMasks[s_NUM_LANES];
+        };
+
+        enum SourceIndex : uint8_t
+        {
+            s_BASIC_SOURCE,
+            s_FILTERED_SOURCE,
+            s_NUM_SOURCES
+        };
+
+        bool add(const uint8_t source,
+                 const uint32_t mask,
+                 const void *const object,
+                 const EdgeReceiver receiver,
+                 const Handler handler,
+                 void *const context,
+                 const uint8_t lane,
+                 const ReceiveMode mode);
+        uint32_t pendingMask(const uint8_t source, const uint8_t firstLane, const uint8_t lastLane) const;
+        bool dispatchLane(const uint8_t lane);
+        static void dispatchTask(void *const parameters);
+
+    private:
+        const Config m_config;
+        Source m_sources[s_NUM_SOURCES];
+        TaskHandle_t m_taskHandle{nullptr};
+#ifdef AT_STATIC_ALLOCATION
+        StackType_t m_taskStack[AT_INTERRUPT_DISPATCHER_TASK_STACK_SIZE];
+        StaticTask_t m_taskBuffer;
+#endif
+    }; // class InterruptDispatcher
+
+} // namespace AT
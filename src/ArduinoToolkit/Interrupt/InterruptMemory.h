@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ArduinoToolkit/Interrupt/BankDebouncer.h"
+#include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
+#include "ArduinoToolkit/Interrupt/FilteredInterrupt.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Compile-time report of the RAM taken by the interrupt classes (in bytes).
+     * Per instance values include the object itself and the kernel objects it allocates
+     * (none with AT_STATIC_ALLOCATION). Heap allocator overhead is not included.
+     * Define AT_INTERRUPT_RAM_BUDGET to fail the build if any instance takes more RAM.
+     */
+    struct InterruptMemory
+    {
+#ifdef AT_STATIC_ALLOCATION
+        // The room of the deadlines is in the static storage of DeadlineScheduler
+        static constexpr size_t s_DEADLINE_HEAP_SIZE{0};
+        static constexpr size_t s_SHARED_DEADLINE_STORAGE{AT_MAX_DEADLINES * sizeof(Deadline *)};
+        static constexpr size_t s_SHARED_TASK_HEAP_SIZE{0};
+#else
+        static constexpr size_t s_DEADLINE_HEAP_SIZE{sizeof(Deadline *)};
+        static constexpr size_t s_SHARED_DEADLINE_STORAGE{0};
+        static constexpr size_t s_SHARED_TASK_HEAP_SIZE{FilteredInterrupt::s_TASK_STACK_SIZE + sizeof(StaticTask_t)};
+#endif
+
+        // The missed-edge sweep of BasicInterrupt is a single deadline shared by every object
+        static constexpr size_t s_BASIC_INTERRUPT{sizeof(BasicInterrupt) +
+                                                  BinarySemaphore::s_HEAP_SIZE};
+        static constexpr size_t s_FILTERED_INTERRUPT{sizeof(FilteredInterrupt) +
+                                                     2 * BinarySemaphore::s_HEAP_SIZE +
+                                                     s_DEADLINE_HEAP_SIZE};
+        static constexpr size_t s_BANK_DEBOUNCER{sizeof(BankDebouncer) + BinarySemaphore::s_HEAP_SIZE};
+
+        // Taken by each FilteredInterrupt worker task (one, or one per core with "WorkerConfig::perCore")
+        // when the default stack size is used
+        static constexpr size_t s_FILTERED_INTERRUPT_SHARED{s_SHARED_TASK_HEAP_SIZE};
+    }; // struct InterruptMemory
+
+#ifdef AT_INTERRUPT_RAM_BUDGET
+    static_assert(InterruptMemory::s_BASIC_INTERRUPT <= AT_INTERRUPT_RAM_BUDGET, "BasicInterrupt exceeds AT_INTERRUPT_RAM_BUDGET");
+    static_assert(InterruptMemory::s_FILTERED_INTERRUPT <= AT_INTERRUPT_RAM_BUDGET, "FilteredInterrupt exceeds AT_INTERRUPT_RAM_BUDGET");
+    static_assert(InterruptMemory::s_BANK_DEBOUNCER <= AT_INTERRUPT_RAM_BUDGET, "BankDebouncer exceeds AT_INTERRUPT_RAM_BUDGET");
+#endif
+
+} // namespace AT
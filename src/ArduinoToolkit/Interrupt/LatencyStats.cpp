@@ -0,0 +1,45 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/LatencyStats.h"
+
+#ifdef AT_INTERRUPT_LATENCY_STATS
+
+namespace AT
+{
+
+    void LatencyStats::reset()
+    {
+        for (LatencyHistogram &histogram : m_histograms)
+            histogram.reset();
+    }
+
+    // Dump the non empty histograms in a human readable form
+    void LatencyStats::print(Print &out, const uint8_t pin) const
+    {
+        static constexpr const char *stageNames[]{"ISR (cycles)",
+                                                  "Deferred (us)",
+                                                  "Commit (us)",
+                                                  "Receive (us)"};
+        out.printf("Latency of pin %u\n", pin);
+        for (uint8_t stage{0}; stage < static_cast<uint8_t>(LatencyStage::Count); stage++)
+        {
+            const LatencyHistogram &histogram{m_histograms[stage]};
+            if (!histogram.getCount())
+                continue;
+            out.printf("  %s: count %u, min %u, max %u, p50 <= %u, p99 <= %u\n",
+                       stageNames[stage], histogram.getCount(), histogram.getMin(), histogram.getMax(),
+                       histogram.getPercentileUpperBound(50), histogram.getPercentileUpperBound(99));
+            for (uint8_t bucket{0}; bucket < LatencyHistogram::s_NUM_BUCKETS; bucket++)
+            {
+                if (histogram.getBucket(bucket))
+                    out.printf("    [%u, %u]: %u\n",
+                               LatencyHistogram::bucketLowerBound(bucket),
+                               LatencyHistogram::bucketUpperBound(bucket),
+                               histogram.getBucket(bucket));
+            }
+        }
+    }
+
+} // namespace AT
+
+#endif
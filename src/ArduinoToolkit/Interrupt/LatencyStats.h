@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/LatencyHistogram.h"
+
+namespace AT
+{
+
+    // Stages of the path of an edge from the ISR to its consumer
+    enum class LatencyStage : uint8_t
+    {
+        Isr,      // ISR entry to exit (CPU cycles)
+        Deferred, // ISR to the deferred task taking the raw edge (us)
+        Commit,   // Lateness of the filter deadline callback past the filter time (us)
+        Receive,  // ISR (or filter commit) to the consumer returning from "receive" (us)
+        Count
+    };
+    // The edges only keep their count, not their times, so Deferred and Receive are measured from
+    // the latest edge (or commit) of the object. With several edges pending the older ones waited
+    // longer than recorded, use the event buffer to get the time of every edge.
+
+#ifdef AT_INTERRUPT_LATENCY_STATS
+    /**
+     * @brief Latency histograms of every stage of an interrupt object.
+     * Only compiled with AT_INTERRUPT_LATENCY_STATS, otherwise the interrupt classes
+     * take no timestamps at all.
+     * The ISR duration is measured in CPU cycles (it starts and ends on the same core),
+     * the other stages in microseconds as the cycle counters of the cores are not in sync.
+     */
+    class LatencyStats
+    {
+    public:
+        __attribute__((always_inline)) inline void record(const LatencyStage stage, const uint32_t value)
+        {
+            m_histograms[static_cast<uint8_t>(stage)].record(value);
+        }
+
+        inline const LatencyHistogram &get(const LatencyStage stage) const
+        {
+            return m_histograms[static_cast<uint8_t>(stage)];
+        }
+
+        void reset();
+        void print(Print &out, const uint8_t pin) const;
+
+        // Timestamp of the cross-stage latencies
+        static inline uint32_t nowUs() { return static_cast<uint32_t>(esp_timer_get_time()); }
+
+    private:
+        LatencyHistogram m_histograms[static_cast<uint8_t>(LatencyStage::Count)];
+    }; // class LatencyStats
+#endif
+
+} // namespace AT
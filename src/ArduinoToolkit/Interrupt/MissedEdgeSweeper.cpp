@@ -0,0 +1,125 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/MissedEdgeSweeper.h"
+
+namespace AT
+{
+
+    // Static class members
+    Deadline MissedEdgeSweeper::s_deadline{sweepCallback, nullptr};
+    std::atomic<uint8_t> MissedEdgeSweeper::s_registration{s_UNREGISTERED};
+    portMUX_TYPE MissedEdgeSweeper::s_spinlock = portMUX_INITIALIZER_UNLOCKED;
+    SweepTarget *MissedEdgeSweeper::s_targets{nullptr};
+    SweepTarget *MissedEdgeSweeper::s_sweeping{nullptr};
+    uint32_t MissedEdgeSweeper::s_minPeriodMs{0};
+    uint32_t MissedEdgeSweeper::s_periodMs{0};
+    std::atomic<bool> MissedEdgeSweeper::s_activity{false};
+    std::atomic<uint32_t> MissedEdgeSweeper::s_correctionCount{0};
+    std::atomic<uint32_t> MissedEdgeSweeper::s_sweepCount{0};
+
+    // Must be called inside the critical section
+    void MissedEdgeSweeper::updateMinPeriod()
+    {
+        s_minPeriodMs = AT_MISSED_EDGE_SWEEP_MAX_MS;
+        for (const SweepTarget *target{s_targets}; target; target = target->m_next)
+            if (target->m_minPeriodMs < s_minPeriodMs)
+                s_minPeriodMs = target->m_minPeriodMs;
+    }
+
+    /**
+     * @brief Add an input to the sweep.
+     *
+     * @param target Node of the input. It must be removed before it is destroyed.
+     * @param minPeriodMs Shortest period of the sweep while this input is active.
+     */
+    void MissedEdgeSweeper::add(SweepTarget &target, const uint32_t minPeriodMs)
+    {
+        ASSERT(minPeriodMs);
+        // The deadline is registered once and kept for the lifetime of the program. The inputs
+        // added meanwhile by other tasks wait for it, it could not be scheduled before
+        uint8_t expected{s_UNREGISTERED};
+        if (s_registration.compare_exchange_strong(expected, s_REGISTERING, std::memory_order_acquire))
+        {
+            DeadlineScheduler::add(s_deadline);
+            s_registration.store(s_REGISTERED, std::memory_order_release);
+        }
+        while (s_registration.load(std::memory_order_acquire) != s_REGISTERED)
+            vTaskDelay(1);
+        target.m_minPeriodMs = minPeriodMs;
+        portENTER_CRITICAL(&s_spinlock);
+        const bool first{!s_targets};
+        target.m_next = s_targets;
+        s_targets = &target;
+        updateMinPeriod();
+        // Start sweeping with the first target
+        if (first)
+        {
+            s_periodMs = s_minPeriodMs;
+            DeadlineScheduler::schedule(s_deadline, s_periodMs * 1000ULL);
+        }
+        portEXIT_CRITICAL(&s_spinlock);
+    }
+
+    void MissedEdgeSweeper::remove(SweepTarget &target)
+    {
+        while (true)
+        {
+            portENTER_CRITICAL(&s_spinlock);
+            // Wait until the sweep is done with the target
+            if (s_sweeping != &target)
+            {
+                for (SweepTarget **link{&s_targets}; *link; link = &(*link)->m_next)
+                {
+                    if (*link == &target)
+                    {
+                        *link = target.m_next;
+                        break;
+                    }
+                }
+                updateMinPeriod();
+                // Stop sweeping with the last target
+                if (!s_targets)
+                    DeadlineScheduler::cancel(s_deadline);
+                portEXIT_CRITICAL(&s_spinlock);
+                return;
+            }
+            portEXIT_CRITICAL(&s_spinlock);
+            vTaskDelay(1);
+        }
+    }
+
+    // Read every target once and adapt the period to the activity seen since the last sweep
+    void MissedEdgeSweeper::sweepCallback(void *const arg)
+    {
+        (void)arg;
+        uint32_t corrections{0};
+        portENTER_CRITICAL(&s_spinlock);
+        s_sweeping = s_targets;
+        while (s_sweeping)
+        {
+            SweepTarget *const target{s_sweeping};
+            portEXIT_CRITICAL(&s_spinlock);
+            // The target can not be removed while it is being read
+            if (target->m_callback(target->m_arg))
+                corrections++;
+            portENTER_CRITICAL(&s_spinlock);
+            s_sweeping = target->m_next;
+        }
+        // A correction also counts as activity (it goes through the same edge path)
+        if (s_activity.exchange(false, std::memory_order_relaxed))
+            s_periodMs = s_minPeriodMs;
+        else if (s_periodMs < AT_MISSED_EDGE_SWEEP_MAX_MS)
+            s_periodMs = s_periodMs * 2 < AT_MISSED_EDGE_SWEEP_MAX_MS ? s_periodMs * 2 : AT_MISSED_EDGE_SWEEP_MAX_MS;
+        // The last target may have been removed during the sweep
+        if (s_targets)
+            DeadlineScheduler::schedule(s_deadline, s_periodMs * 1000ULL);
+        portEXIT_CRITICAL(&s_spinlock);
+        s_sweepCount.fetch_add(1, std::memory_order_relaxed);
+        if (corrections)
+        {
+            s_correctionCount.fetch_add(corrections, std::memory_order_relaxed);
+            AT_LOG_D("MissedEdgeSweeper corrected %u missed edges", corrections);
+        }
+    }
+
+} // namespace AT
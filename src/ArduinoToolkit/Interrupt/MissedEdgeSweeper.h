@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/DeadlineScheduler.h"
+
+// Slowest period (in ms) of the sweep while every input is quiet
+#ifndef AT_MISSED_EDGE_SWEEP_MAX_MS
+#define AT_MISSED_EDGE_SWEEP_MAX_MS 6400
+#endif
+
+namespace AT
+{
+
+    class MissedEdgeSweeper;
+
+    // Intrusive node of the MissedEdgeSweeper. The owner keeps it alive while it is added
+    class SweepTarget
+    {
+    public:
+        // Read the input again. Return true if its state was wrong (an edge had been missed)
+        using Callback = bool (*)(void *const arg);
+
+        SweepTarget(const Callback callback, void *const arg)
+            : m_callback(callback),
+              m_arg(arg) {}
+
+    private:
+        const Callback m_callback;
+        void *const m_arg;
+        uint32_t m_minPeriodMs{0};
+        SweepTarget *m_next{nullptr};
+
+        friend class MissedEdgeSweeper;
+    }; // class SweepTarget
+
+    /**
+     * @brief Single deadline that reads every registered input to catch missed interrupts.
+     * The period doubles after every sweep with no activity, up to AT_MISSED_EDGE_SWEEP_MAX_MS,
+     * and goes back to the shortest period requested by the targets as soon as any of them
+     * gets an edge (or a missed edge is corrected), which is noticed on the next sweep.
+     * Quiet inputs therefore cost one wakeup every AT_MISSED_EDGE_SWEEP_MAX_MS in total.
+     * Callbacks run in the esp_timer task.
+     */
+    class MissedEdgeSweeper
+    {
+    public:
+        static void add(SweepTarget &target, const uint32_t minPeriodMs);
+        static void remove(SweepTarget &target);
+
+        // Called (also from ISRs) every time a target gets an edge
+        static __attribute__((always_inline)) inline void notifyActivity()
+        {
+            s_activity.store(true, std::memory_order_relaxed);
+        }
+
+        // Number of missed edges corrected by the sweeps
+        static inline uint32_t getCorrectionCount() { return s_correctionCount.load(std::memory_order_relaxed); }
+        static inline uint32_t getSweepCount() { return s_sweepCount.load(std::memory_order_relaxed); }
+        // Current period of the sweep
+        static inline uint32_t getPeriodMs() { return s_periodMs; }
+
+    private:
+        static void sweepCallback(void *const arg);
+        static void updateMinPeriod();
+
+    private:
+        // Registration of "s_deadline", done once by the first "add()"
+        static constexpr uint8_t s_UNREGISTERED{0};
+        static constexpr uint8_t s_REGISTERING{1};
+        static constexpr uint8_t s_REGISTERED{2};
+
+        static Deadline s_deadline;
+        static std::atomic<uint8_t> s_registration;
+        static portMUX_TYPE s_spinlock;
+        // Targets, protected by "s_spinlock"
+        static SweepTarget *s_targets;
+        // Target being read by the sweep, it can not be removed meanwhile
+        static SweepTarget *s_sweeping;
+        // Shortest period of the targets and current period, protected by "s_spinlock"
+        static uint32_t s_minPeriodMs;
+        static uint32_t s_periodMs;
+        static std::atomic<bool> s_activity;
+        static std::atomic<uint32_t> s_correctionCount;
+        static std::atomic<uint32_t> s_sweepCount;
+    }; // class MissedEdgeSweeper
+
+} // namespace AT
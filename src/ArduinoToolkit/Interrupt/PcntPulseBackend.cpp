@@ -0,0 +1,182 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/PcntPulseBackend.h"
+
+namespace AT
+{
+
+    // Static class members
+    uint8_t PcntPulseBackend::s_usedUnits{0};
+
+    // Runs every time a counter reaches s_COUNTER_LIMIT (and is reset to 0)
+    void IRAM_ATTR PcntPulseBackend::overflowISR(void *const voidPtrCounter)
+    {
+        static_cast<Counter *>(voidPtrCounter)->overflows.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool PcntPulseBackend::startCounter(Counter &counter, const pcnt_config_t &config, const uint16_t glitchFilterCycles)
+    {
+        // Take the first free unit
+        portENTER_CRITICAL(&spinlock);
+        for (uint8_t unit{0}; unit < PCNT_UNIT_MAX; unit++)
+        {
+            if (!(s_usedUnits & (1U << unit)))
+            {
+                s_usedUnits |= 1U << unit;
+                counter.unit = static_cast<pcnt_unit_t>(unit);
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&spinlock);
+        if (counter.unit == PCNT_UNIT_MAX)
+        {
+            AT_LOG_E("There are no PCNT units left");
+            return false;
+        }
+        pcnt_config_t unitConfig{config};
+        unitConfig.unit = counter.unit;
+        ESP_ERROR_CHECK(pcnt_unit_config(&unitConfig));
+        // The glitch filter ignores pulses shorter than the given APB clock cycles (max 1023)
+        if (glitchFilterCycles)
+        {
+            ESP_ERROR_CHECK(pcnt_set_filter_value(counter.unit, glitchFilterCycles));
+            ESP_ERROR_CHECK(pcnt_filter_enable(counter.unit));
+        }
+        else
+            ESP_ERROR_CHECK(pcnt_filter_disable(counter.unit));
+        // Count the overflows of the counter
+        ESP_ERROR_CHECK(pcnt_event_enable(counter.unit, PCNT_EVT_H_LIM));
+        // The ISR service is shared by all the units, it may be already installed
+        const esp_err_t ret{pcnt_isr_service_install(0)};
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+            ESP_ERROR_CHECK(ret);
+        ESP_ERROR_CHECK(pcnt_isr_handler_add(counter.unit, overflowISR, &counter));
+        ESP_ERROR_CHECK(pcnt_counter_pause(counter.unit));
+        ESP_ERROR_CHECK(pcnt_counter_clear(counter.unit));
+        ESP_ERROR_CHECK(pcnt_counter_resume(counter.unit));
+        return true;
+    }
+
+    void PcntPulseBackend::stopCounter(Counter &counter)
+    {
+        if (counter.unit == PCNT_UNIT_MAX)
+            return;
+        pcnt_counter_pause(counter.unit);
+        pcnt_isr_handler_remove(counter.unit);
+        portENTER_CRITICAL(&spinlock);
+        s_usedUnits &= ~(1U << counter.unit);
+        portEXIT_CRITICAL(&spinlock);
+        counter.unit = PCNT_UNIT_MAX;
+    }
+
+    uint64_t PcntPulseBackend::readCounter(Counter &counter)
+    {
+        // Read the counter between two equal overflow counts, so no overflow ISR has run in between
+        // (a fast reference clock overflows every few tens of milliseconds)
+        uint32_t overflows{counter.overflows.load(std::memory_order_acquire)};
+        int16_t raw{0};
+        while (true)
+        {
+            pcnt_get_counter_value(counter.unit, &raw);
+            const uint32_t overflowsAfter{counter.overflows.load(std::memory_order_acquire)};
+            if (overflowsAfter == overflows)
+                break;
+            overflows = overflowsAfter;
+        }
+        return counter.extended.extend(overflows, static_cast<uint32_t>(raw));
+    }
+
+    /**
+     * @brief Construct a PcntPulseBackend.
+     *
+     * @param pin Pin of the pulses.
+     * @param mode Mode of the pin.
+     * @param reverseLogic Count the falling edges (and the low time) instead.
+     * @param glitchFilterCycles Ignore pulses shorter than this number of APB clock cycles
+     *                           (12.5ns each, up to 1023). 0 disables the filter.
+     * @param referencePin Pin where the reference clock is generated to measure the high time,
+     *                     or s_NO_REFERENCE_PIN to not measure it.
+     * @param referenceLedcChannel LEDC channel that generates the reference clock.
+     * @param referenceFrequencyHz Frequency of the reference clock. It sets the resolution
+     *                             of the high time.
+     */
+    PcntPulseBackend::PcntPulseBackend(const uint8_t pin,
+                                       const uint8_t mode,
+                                       const bool reverseLogic,
+                                       const uint16_t glitchFilterCycles,
+                                       const int8_t referencePin,
+                                       const uint8_t referenceLedcChannel,
+                                       const uint32_t referenceFrequencyHz)
+        : m_pin(pin),
+          m_reverseLogic(reverseLogic),
+          m_referencePin(referencePin),
+          m_referenceLedcChannel(referenceLedcChannel)
+    {
+        pinMode(m_pin, mode);
+        // Count one edge of every pulse of the pin
+        const pcnt_config_t pulseConfig{.pulse_gpio_num = m_pin,
+                                        .ctrl_gpio_num = PCNT_PIN_NOT_USED,
+                                        .lctrl_mode = PCNT_MODE_KEEP,
+                                        .hctrl_mode = PCNT_MODE_KEEP,
+                                        .pos_mode = m_reverseLogic ? PCNT_COUNT_DIS : PCNT_COUNT_INC,
+                                        .neg_mode = m_reverseLogic ? PCNT_COUNT_INC : PCNT_COUNT_DIS,
+                                        .counter_h_lim = s_COUNTER_LIMIT,
+                                        .counter_l_lim = 0,
+                                        .unit = PCNT_UNIT_MAX,
+                                        .channel = PCNT_CHANNEL_0};
+        const bool started{startCounter(m_pulseCounter, pulseConfig, glitchFilterCycles)};
+        ASSERT(started);
+        if (m_referencePin != s_NO_REFERENCE_PIN)
+        {
+            // Count the reference clock only while the input is high (low with reverse logic)
+            const pcnt_config_t referenceConfig{.pulse_gpio_num = m_referencePin,
+                                                .ctrl_gpio_num = m_pin,
+                                                .lctrl_mode = m_reverseLogic ? PCNT_MODE_KEEP : PCNT_MODE_DISABLE,
+                                                .hctrl_mode = m_reverseLogic ? PCNT_MODE_DISABLE : PCNT_MODE_KEEP,
+                                                .pos_mode = PCNT_COUNT_INC,
+                                                .neg_mode = PCNT_COUNT_DIS,
+                                                .counter_h_lim = s_COUNTER_LIMIT,
+                                                .counter_l_lim = 0,
+                                                .unit = PCNT_UNIT_MAX,
+                                                .channel = PCNT_CHANNEL_0};
+            if (startCounter(m_referenceCounter, referenceConfig, 0))
+            {
+                // Square wave on the reference pin (1 bit resolution at 50% duty)
+                m_referenceFrequencyHz = ledcSetup(m_referenceLedcChannel, referenceFrequencyHz, 1);
+                ASSERT(m_referenceFrequencyHz);
+                ledcAttachPin(m_referencePin, m_referenceLedcChannel);
+                ledcWrite(m_referenceLedcChannel, 1);
+                // Keep the input of the pin enabled so the PCNT unit can read the clock
+                gpio_set_direction(static_cast<gpio_num_t>(m_referencePin), GPIO_MODE_INPUT_OUTPUT);
+            }
+        }
+        AT_LOG_I("PcntPulseBackend enabled on pin %u", m_pin);
+    }
+
+    PcntPulseBackend::~PcntPulseBackend()
+    {
+        if (hasHighTime())
+            ledcDetachPin(m_referencePin);
+        stopCounter(m_referenceCounter);
+        stopCounter(m_pulseCounter);
+        AT_LOG_D("PcntPulseBackend disabled on pin %u", m_pin);
+    }
+
+    PinState PcntPulseBackend::getState() const
+    {
+        return static_cast<PinState>(static_cast<bool>(digitalRead(m_pin)) != m_reverseLogic);
+    }
+
+    uint64_t PcntPulseBackend::readCount()
+    {
+        return readCounter(m_pulseCounter);
+    }
+
+    uint64_t PcntPulseBackend::readHighTimeUs()
+    {
+        if (!hasHighTime())
+            return 0;
+        return static_cast<uint64_t>(readCounter(m_referenceCounter) * 1e6 / m_referenceFrequencyHz);
+    }
+
+} // namespace AT
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+
+#include <driver/pcnt.h>
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Interrupt/PulseBackend.h"
+#include "ArduinoToolkit/Interrupt/PulseWindow.h"
+
+namespace AT
+{
+
+    /**
+     * @brief PulseBackend on the ESP32 pulse counter (PCNT) peripheral.
+     * The rising edges of the pin are counted by a PCNT unit, the CPU only takes an interrupt
+     * every s_COUNTER_LIMIT pulses to extend the 16 bit hardware counter.
+     * If a reference pin is given, the high time of the input is measured too: a LEDC channel
+     * outputs a reference clock on that pin and a second PCNT unit counts it while the input
+     * is high. The reference pin must be a free output capable GPIO.
+     */
+    class PcntPulseBackend : public PulseBackend
+    {
+    public:
+        PcntPulseBackend(const uint8_t pin,
+                         const uint8_t mode,
+                         const bool reverseLogic = false,
+                         const uint16_t glitchFilterCycles = 0,
+                         const int8_t referencePin = s_NO_REFERENCE_PIN,
+                         const uint8_t referenceLedcChannel = 0,
+                         const uint32_t referenceFrequencyHz = s_DEFAULT_REFERENCE_FREQUENCY_HZ);
+        ~PcntPulseBackend();
+
+        uint8_t getPin() const override { return m_pin; }
+        PinState getState() const override;
+
+        uint64_t readCount() override;
+        bool hasHighTime() const override { return m_referenceCounter.unit != PCNT_UNIT_MAX; }
+        uint64_t readHighTimeUs() override;
+
+    public:
+        static constexpr int8_t s_NO_REFERENCE_PIN{-1};
+        static constexpr uint32_t s_DEFAULT_REFERENCE_FREQUENCY_HZ{1000000};
+        // The hardware counter is reset when it reaches this value
+        static constexpr int16_t s_COUNTER_LIMIT{INT16_MAX};
+
+    private:
+        // PCNT unit extended with the count of its overflows
+        struct Counter
+        {
+            pcnt_unit_t unit{PCNT_UNIT_MAX};
+            std::atomic<uint32_t> overflows{0};
+            WrappingCounter extended{s_COUNTER_LIMIT};
+        };
+
+        static void IRAM_ATTR overflowISR(void *const voidPtrCounter);
+        static bool startCounter(Counter &counter, const pcnt_config_t &config, const uint16_t glitchFilterCycles);
+        static void stopCounter(Counter &counter);
+        static uint64_t readCounter(Counter &counter);
+
+    private:
+        const uint8_t m_pin;
+        const bool m_reverseLogic;
+        const int8_t m_referencePin;
+        const uint8_t m_referenceLedcChannel;
+        double m_referenceFrequencyHz{0};
+        Counter m_pulseCounter;
+        Counter m_referenceCounter;
+
+    private:
+        // Units in use by any object
+        static uint8_t s_usedUnits;
+    }; // class PcntPulseBackend
+
+} // namespace AT
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ArduinoToolkit/Interrupt/PinState.h"
+
+namespace AT
+{
+
+    // How many pending edges a receive operation consumes
+    enum class ReceiveMode : uint8_t
+    {
+        Next,                // Consume the oldest pending edge
+        DiscardIntermediate, // Consume edges in pairs so only the parity is kept
+        Last                 // Consume every pending edge and return the current state
+    };
+
+    /**
+     * @brief Current state of an input and number of edges not yet received, packed in one atomic word.
+     * Bits [1:0] hold the state (0 Unknown, 1 Low, 2 High) and bits [31:2] the pending edge count.
+     * Producers record new states with "update()" and consumers drain edges with "take()", each of
+     * them being a single compare-and-swap (retried only under contention), so every receive mode
+     * runs in constant time regardless of how many edges are pending.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class PendingEdges
+    {
+    public:
+        // Record a new state. Return true (and add a pending edge) if the state has changed
+        __attribute__((always_inline)) inline bool update(const PinState newState)
+        {
+            const uint32_t newCode{encode(newState)};
+            uint32_t word{m_word.load(std::memory_order_relaxed)};
+            do
+            {
+                if ((word & s_STATE_MASK) == newCode)
+                    return false;
+            } while (!m_word.compare_exchange_weak(word,
+                                                   ((word & ~s_STATE_MASK) + s_PENDING_ONE) | newCode,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed));
+            return true;
+        }
+
+        /**
+         * @brief Consume pending edges.
+         *
+         * @param mode How many edges to consume.
+         * @param taken Output, number of edges consumed (0 if there were none pending).
+         * @return The state the consumed edge corresponds to, or PinState::Unknown if there were
+         *         no pending edges.
+         */
+        inline PinState take(const ReceiveMode mode, uint32_t &taken)
+        {
+            uint32_t word{m_word.load(std::memory_order_acquire)};
+            uint32_t left;
+            do
+            {
+                const uint32_t pending{word >> s_PENDING_SHIFT};
+                if (!pending)
+                {
+                    taken = 0;
+                    return PinState::Unknown;
+                }
+                switch (mode)
+                {
+                case ReceiveMode::Next:
+                    left = pending - 1;
+                    break;
+                case ReceiveMode::DiscardIntermediate:
+                    left = (pending - 1) % 2;
+                    break;
+                default:
+                    left = 0;
+                    break;
+                }
+                taken = pending - left;
+            } while (!m_word.compare_exchange_weak(word,
+                                                   (left << s_PENDING_SHIFT) | (word & s_STATE_MASK),
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
+            // Edges alternate, so the state of the consumed edge is the current state
+            // inverted once per edge that remains pending (XOR with the parity)
+            const bool currentState{decode(word) == PinState::High};
+            return ((left % 2) != currentState) ? PinState::High : PinState::Low;
+        }
+
+        inline PinState getState() const { return decode(m_word.load(std::memory_order_acquire)); }
+        inline uint32_t getPending() const { return m_word.load(std::memory_order_acquire) >> s_PENDING_SHIFT; }
+
+    private:
+        static constexpr uint32_t encode(const PinState state) { return static_cast<uint32_t>(static_cast<int8_t>(state) + 1); }
+        static constexpr PinState decode(const uint32_t word) { return static_cast<PinState>(static_cast<int8_t>(word & s_STATE_MASK) - 1); }
+
+    private:
+        static constexpr uint32_t s_STATE_MASK{0b11};
+        static constexpr uint32_t s_PENDING_SHIFT{2};
+        static constexpr uint32_t s_PENDING_ONE{1 << s_PENDING_SHIFT};
+
+    private:
+        std::atomic<uint32_t> m_word{encode(PinState::Unknown)};
+    }; // class PendingEdges
+
+} // namespace AT
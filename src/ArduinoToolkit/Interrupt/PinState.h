@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AT
+{
+
+    enum class PinState : int8_t
+    {
+        Unknown = -1,
+        Low = 0,
+        High = 1
+    };
+
+} // namespace AT
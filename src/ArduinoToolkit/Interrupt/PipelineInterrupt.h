@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ArduinoToolkit/Interrupt/FilterPipeline.h"
+#include "ArduinoToolkit/Interrupt/FilteredInterrupt.h"
+
+namespace AT
+{
+
+    // Storage of the pipeline. It is a base of PipelineInterrupt (before FilteredInterrupt)
+    // so it is initialized before the ISR is attached
+    template <typename Pipeline>
+    struct PipelineStorage
+    {
+        Pipeline pipeline;
+    };
+
+    /**
+     * @brief FilteredInterrupt whose raw edges go through a FilterPipeline instead of the hold times, e.g.
+     * "PipelineInterrupt<FilterPipeline<Debounce<5>, MinHold<200>, RateLimit<10>>> input(pin, INPUT_PULLUP)".
+     * The pipeline runs in the deferred task with every raw edge, and with the current raw state
+     * when a stage is due, using the single deadline of the object.
+     * The receive API is the same as FilteredInterrupt.
+     */
+    template <typename Pipeline>
+    class PipelineInterrupt : private PipelineStorage<Pipeline>, public FilteredInterrupt
+    {
+    public:
+        explicit PipelineInterrupt(const uint8_t pin,
+                                   const uint8_t mode,
+                                   const bool reverseLogic = false,
+                                   const uint32_t periodicCallToISRms = AT::BasicInterrupt::s_DEFAULT_PERIODIC_CALL_ISR_MS,
+                                   const BaseType_t core = tskNO_AFFINITY)
+            : FilteredInterrupt(pin, mode, filter, reverseLogic, periodicCallToISRms, core) {}
+
+        // Only the deferred task updates the pipeline, read it from elsewhere for debugging only
+        inline const Pipeline &getPipeline() const { return PipelineStorage<Pipeline>::pipeline; }
+
+    private:
+        static PinState filter(FilteredInterrupt *const intPtr,
+                               const PinState raw,
+                               const uint64_t nowUs,
+                               uint64_t &nextUs)
+        {
+            Pipeline &pipeline{static_cast<PipelineInterrupt *>(intPtr)->PipelineStorage<Pipeline>::pipeline};
+            const PinState filtered{pipeline.update(raw, nowUs)};
+            nextUs = pipeline.nextUpdateUs();
+            return filtered;
+        }
+    }; // class PipelineInterrupt
+
+} // namespace AT
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ArduinoToolkit/Interrupt/PinState.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Hardware layer of a PulseInput.
+     * Implementations count the pulses of a pin without per-edge CPU work
+     * (e.g. PcntPulseBackend) and can be replaced by fakes on the host.
+     */
+    class PulseBackend
+    {
+    public:
+        virtual ~PulseBackend() = default;
+
+        virtual uint8_t getPin() const = 0;
+        virtual PinState getState() const = 0;
+
+        // Pulses since the backend was started
+        virtual uint64_t readCount() = 0;
+        // Whether "readHighTimeUs()" is supported
+        virtual bool hasHighTime() const { return false; }
+        // Time the input has been high since the backend was started
+        virtual uint64_t readHighTimeUs() { return 0; }
+    }; // class PulseBackend
+
+} // namespace AT
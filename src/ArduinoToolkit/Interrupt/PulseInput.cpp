@@ -0,0 +1,74 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/PulseInput.h"
+
+namespace AT
+{
+
+    // Runs in the esp_timer task at the end of every window
+    void PulseInput::windowCallback(void *const voidPtrInput)
+    {
+        PulseInput *const &inputPtr{static_cast<PulseInput *>(voidPtrInput)};
+        PulseBackend &backend{inputPtr->m_backend};
+        const PulseSample sample{.timeUs = DeadlineScheduler::nowUs(),
+                                 .count = backend.readCount(),
+                                 .highTimeUs = backend.readHighTimeUs(),
+                                 .hasHighTime = backend.hasHighTime()};
+        PulseMeasurement measurement;
+        if (!inputPtr->m_window.update(sample, measurement))
+            return;
+        portENTER_CRITICAL(&inputPtr->m_spinlock);
+        inputPtr->m_measurement = measurement;
+        portEXIT_CRITICAL(&inputPtr->m_spinlock);
+        xSemaphoreGive(inputPtr->m_measurementBinarySemaphore);
+    }
+
+    /**
+     * @brief Construct a PulseInput.
+     *
+     * @param backend Hardware that counts the pulses. It must outlive this object.
+     * @param windowMs Duration of the measurement windows.
+     */
+    PulseInput::PulseInput(PulseBackend &backend, const uint32_t windowMs)
+        : m_backend(backend)
+    {
+        ASSERT(windowMs);
+        const uint64_t windowUs{windowMs * 1000ULL};
+        // Open the first window now
+        windowCallback(this);
+        DeadlineScheduler::add(m_windowDeadline);
+        DeadlineScheduler::schedule(m_windowDeadline, windowUs, windowUs);
+        AT_LOG_I("PulseInput enabled on pin %u", getPin());
+    }
+
+    PulseInput::~PulseInput()
+    {
+        DeadlineScheduler::remove(m_windowDeadline);
+        AT_LOG_D("PulseInput disabled on pin %u", getPin());
+    }
+
+    // Last complete window (all zeros until the first window has been closed)
+    PulseMeasurement PulseInput::getMeasurement() const
+    {
+        portENTER_CRITICAL(&m_spinlock);
+        const PulseMeasurement measurement{m_measurement};
+        portEXIT_CRITICAL(&m_spinlock);
+        return measurement;
+    }
+
+    /**
+     * @brief Wait for the next measurement window to be closed.
+     *
+     * @param measurement Measurement of the window.
+     * @param xTicksToWait The maximum time to wait for the window.
+     * @return true if a new measurement has been received, false on timeout.
+     */
+    bool PulseInput::receiveMeasurement(PulseMeasurement &measurement, const TickType_t xTicksToWait) const
+    {
+        if (xSemaphoreTake(m_measurementBinarySemaphore, xTicksToWait) != pdTRUE)
+            return false;
+        measurement = getMeasurement();
+        return true;
+    }
+
+} // namespace AT
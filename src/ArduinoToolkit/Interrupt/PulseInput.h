@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/BinarySemaphore.h"
+#include "ArduinoToolkit/Core/DeadlineScheduler.h"
+#include "ArduinoToolkit/Interrupt/PulseBackend.h"
+#include "ArduinoToolkit/Interrupt/PulseWindow.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Pulse count, frequency and duty cycle of a pin measured over fixed windows.
+     * The pulses are counted by a PulseBackend (e.g. PcntPulseBackend) without per-edge CPU
+     * work, the backend is only read once per window. Meant for high rate inputs such as
+     * flow meters and tachometers, where a BasicInterrupt would take an interrupt per edge.
+     */
+    class PulseInput
+    {
+    public:
+        PulseInput(PulseBackend &backend, const uint32_t windowMs);
+        ~PulseInput();
+
+        inline uint8_t getPin() const { return m_backend.getPin(); }
+        inline PinState getState() const { return m_backend.getState(); }
+
+        PulseMeasurement getMeasurement() const;
+        inline uint64_t getCount() const { return getMeasurement().totalCount; }
+        inline float getFrequency() const { return getMeasurement().frequencyHz; }
+        inline float getDutyCycle() const { return getMeasurement().dutyCycle; }
+
+        bool receiveMeasurement(PulseMeasurement &measurement, const TickType_t xTicksToWait = portMAX_DELAY) const;
+
+    private:
+        static void windowCallback(void *const voidPtrInput);
+
+    private:
+        PulseBackend &m_backend;
+        // Only accessed from the window callback
+        PulseWindow m_window;
+        // Last measurement, protected by "m_spinlock"
+        PulseMeasurement m_measurement{};
+        mutable portMUX_TYPE m_spinlock = portMUX_INITIALIZER_UNLOCKED;
+        // Given on every new measurement
+        BinarySemaphore m_measurementBinarySemaphore;
+        // Closes a window periodically
+        Deadline m_windowDeadline{windowCallback, this};
+    }; // class PulseInput
+
+} // namespace AT
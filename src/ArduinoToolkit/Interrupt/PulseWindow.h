@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AT
+{
+
+    /**
+     * @brief Extend a hardware counter that wraps at "modulus" to 64 bits.
+     * The overflows of the counter are counted in software (e.g. by its overflow ISR).
+     * Read the raw counter between two reads of the overflow count and retry until both are
+     * equal, otherwise an overflow in between is off by a whole modulus. A raw value lower than
+     * the previous total is still corrected here, it happens when the counter has wrapped and
+     * its overflow ISR has not run yet.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class WrappingCounter
+    {
+    public:
+        explicit constexpr WrappingCounter(const uint32_t modulus) : m_modulus(modulus) {}
+
+        /**
+         * @brief Get the extended value of the counter.
+         *
+         * @param overflows Number of overflows counted so far (the same before and after "raw").
+         * @param raw Current value of the hardware counter, in [0, modulus).
+         * @return The total count since the counter was started.
+         */
+        uint64_t extend(const uint32_t overflows, const uint32_t raw)
+        {
+            // The 32 bit overflow count may wrap too
+            m_overflows += static_cast<uint32_t>(overflows - m_lastOverflows);
+            m_lastOverflows = overflows;
+            uint64_t total{static_cast<uint64_t>(m_overflows) * m_modulus + raw};
+            // The counter overflowed after the overflow count was read
+            if (total < m_lastTotal)
+                total += m_modulus;
+            m_lastTotal = total;
+            return total;
+        }
+
+        inline uint32_t getModulus() const { return m_modulus; }
+
+    private:
+        const uint32_t m_modulus;
+        uint32_t m_lastOverflows{0};
+        uint64_t m_overflows{0};
+        uint64_t m_lastTotal{0};
+    }; // class WrappingCounter
+
+    // Totals read from a pulse backend at a given time
+    struct PulseSample
+    {
+        uint64_t timeUs;     // Time of the sample
+        uint64_t count;      // Pulses since the backend was started
+        uint64_t highTimeUs; // Time the input has been high since the backend was started
+        bool hasHighTime;    // False if the backend can not measure the high time
+    };
+
+    // Result of a measurement window
+    struct PulseMeasurement
+    {
+        uint64_t totalCount; // Pulses since the backend was started
+        uint32_t count;      // Pulses in the window
+        uint64_t windowUs;   // Duration of the window
+        float frequencyHz;   // Pulses per second in the window
+        float dutyCycle;     // Fraction of the window the input was high, or -1 if not available
+    };
+
+    /**
+     * @brief Turn consecutive pulse samples into window measurements.
+     * Every sample closes the window opened by the previous one.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class PulseWindow
+    {
+    public:
+        /**
+         * @brief Close the current window and open the next one.
+         *
+         * @param sample Totals read at the end of the window.
+         * @param measurement Measurement of the window (only written if true is returned).
+         * @return false for the first sample (it only opens a window) or an empty window.
+         */
+        bool update(const PulseSample &sample, PulseMeasurement &measurement)
+        {
+            const bool hasWindow{m_started && sample.timeUs > m_last.timeUs};
+            if (hasWindow)
+            {
+                const uint64_t windowUs{sample.timeUs - m_last.timeUs};
+                const uint64_t count{sample.count - m_last.count};
+                measurement.totalCount = sample.count;
+                measurement.count = static_cast<uint32_t>(count);
+                measurement.windowUs = windowUs;
+                measurement.frequencyHz = static_cast<float>(count * 1e6 / windowUs);
+                if (sample.hasHighTime)
+                {
+                    const float dutyCycle{static_cast<float>(sample.highTimeUs - m_last.highTimeUs) / windowUs};
+                    // The high time and the window are not sampled at exactly the same time
+                    measurement.dutyCycle = dutyCycle > 1.0f ? 1.0f : dutyCycle;
+                }
+                else
+                    measurement.dutyCycle = -1.0f;
+            }
+            m_last = sample;
+            m_started = true;
+            return hasWindow;
+        }
+
+    private:
+        PulseSample m_last{};
+        bool m_started{false};
+    }; // class PulseWindow
+
+} // namespace AT
@@ -0,0 +1,164 @@
+#define AT_LOG_MODULE Interrupt
+
+#include "ArduinoToolkit/Interrupt/ReadySet.h"
+
+namespace AT
+{
+
+    // Reserve a free bit of the mask. Return s_NO_SLOT if all of them are in use
+    int8_t ReadySet::allocateSlot()
+    {
+        uint32_t allocated{m_allocatedSlots.load(std::memory_order_relaxed)};
+        int8_t slot;
+        do
+        {
+            if (allocated == UINT32_MAX)
+                return s_NO_SLOT;
+            slot = __builtin_ctz(~allocated);
+        } while (!m_allocatedSlots.compare_exchange_weak(allocated, allocated | slotMask(slot)));
+        return slot;
+    }
+
+    void ReadySet::releaseSlot(const int8_t slot)
+    {
+        clear(slot);
+        m_allocatedSlots.fetch_and(~slotMask(slot));
+    }
+
+    void IRAM_ATTR ReadySet::markFromISR(const int8_t slot, BaseType_t *const pxHigherPriorityTaskWoken)
+    {
+        if (slot == s_NO_SLOT)
+            m_unslottedEdges.store(true, std::memory_order_release);
+        markMaskFromISR(slotMask(slot), pxHigherPriorityTaskWoken);
+    }
+
+    // Set several bits at once with a single notification
+    void IRAM_ATTR ReadySet::markMaskFromISR(const uint32_t mask, BaseType_t *const pxHigherPriorityTaskWoken)
+    {
+        m_mask.fetch_or(mask, std::memory_order_release);
+        const TaskHandle_t waiterTask{m_waiterTask.load(std::memory_order_acquire)};
+        if (waiterTask)
+            vTaskNotifyGiveFromISR(waiterTask, pxHigherPriorityTaskWoken);
+    }
+
+    void ReadySet::mark(const int8_t slot)
+    {
+        if (slot == s_NO_SLOT)
+            m_unslottedEdges.store(true, std::memory_order_release);
+        m_mask.fetch_or(slotMask(slot), std::memory_order_release);
+        const TaskHandle_t waiterTask{m_waiterTask.load(std::memory_order_acquire)};
+        if (waiterTask)
+            xTaskNotifyGive(waiterTask);
+    }
+
+    void ReadySet::clear(const int8_t slot)
+    {
+        m_mask.fetch_and(~slotMask(slot), std::memory_order_acq_rel);
+    }
+
+    // Leave the ready mask once drained. Check again after clearing
+    // the bit in case the producer has recorded a new edge meanwhile.
+    void ReadySet::settle(const PendingEdges &edges, const int8_t slot)
+    {
+        if (slot == s_NO_SLOT || edges.getPending())
+            return;
+        clear(slot);
+        if (edges.getPending())
+            mark(slot);
+    }
+
+    /**
+     * @brief Consume pending edges, blocking until there is one or the timeout elapses.
+     * The pending edges are consumed with a single atomic operation whatever the mode is,
+     * the binary semaphore is only used to sleep while there is nothing pending.
+     *
+     * @param edges State and pending edges of the object.
+     * @param binarySemaphore Semaphore given by the producer on every edge of the object.
+     * @param slot Bit of the object in the mask.
+     * @param mode How many edges to consume.
+     * @param xTicksToWait The maximum time to wait for an interrupt.
+     * @return The state of the received interrupt, or PinState::Unknown if no interrupt
+     *         was received within the specified timeout.
+     */
+    PinState ReadySet::receive(PendingEdges &edges,
+                               const SemaphoreHandle_t binarySemaphore,
+                               const int8_t slot,
+                               const ReceiveMode mode,
+                               TickType_t xTicksToWait)
+    {
+        TimeOut_t timeOut;
+        vTaskSetTimeOutState(&timeOut);
+        while (true)
+        {
+            uint32_t taken;
+            const PinState state{edges.take(mode, taken)};
+            if (taken)
+            {
+                settle(edges, slot);
+                return state;
+            }
+            // Nothing pending, sleep until the producer signals a new edge
+            if (xTaskCheckForTimeOut(&timeOut, &xTicksToWait) ||
+                !xSemaphoreTake(binarySemaphore, xTicksToWait))
+            {
+                // The producer may have set the bit after its edge was already taken
+                settle(edges, slot);
+                return PinState::Unknown;
+            }
+        }
+    }
+
+    // Block the calling task until "ready()" returns true or the timeout elapses
+    template <typename Ready>
+    bool ReadySet::block(TickType_t xTicksToWait, const Ready ready)
+    {
+        // Register the task before checking so no notification is missed
+        const TaskHandle_t task{xTaskGetCurrentTaskHandle()};
+        setWaiterTask(task);
+        TimeOut_t timeOut;
+        vTaskSetTimeOutState(&timeOut);
+        bool isReady;
+        while (!(isReady = ready()))
+        {
+            if (xTaskCheckForTimeOut(&timeOut, &xTicksToWait) ||
+                !ulTaskNotifyTake(pdTRUE, xTicksToWait))
+                break;
+        }
+        // Unregister unless another task has taken over, the task may be deleted later
+        TaskHandle_t expected{task};
+        m_waiterTask.compare_exchange_strong(expected, nullptr);
+        return isReady;
+    }
+
+    /**
+     * @brief Block the calling task until any object has pending interrupts.
+     * The mask is not cleared, the bits are cleared by the receive functions of each object
+     * once all its pending interrupts have been received.
+     * It uses the notification value (index 0) of the calling task.
+     *
+     * @param xTicksToWait The maximum time to wait.
+     * @return The mask of the objects with pending interrupts (0 if the timeout elapsed).
+     */
+    uint32_t ReadySet::wait(TickType_t xTicksToWait)
+    {
+        uint32_t mask{0};
+        block(xTicksToWait, [this, &mask]()
+              { return (mask = getMask()) != 0; });
+        return mask;
+    }
+
+    /**
+     * @brief Same as "wait()", also woken up by the objects without a slot.
+     * Those are reported once per call, so after it returns the caller must receive from all
+     * of them before waiting again.
+     *
+     * @param xTicksToWait The maximum time to wait.
+     * @return true if any object has (or objects without a slot may have) pending interrupts.
+     */
+    bool ReadySet::waitAny(TickType_t xTicksToWait)
+    {
+        return block(xTicksToWait, [this]()
+                     { return getMask() || m_unslottedEdges.exchange(false, std::memory_order_acq_rel); });
+    }
+
+} // namespace AT
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+
+#include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Interrupt/PendingEdges.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Bitmask of the objects that have pending interrupts.
+     * Each object owns a slot (bit) of the mask. Producers set the bit of an object when
+     * it gets a new edge and wake up the waiting task with a direct-to-task notification,
+     * consumers clear it once the object has no pending edges left.
+     * Objects created once the s_MAX_SLOTS bits are taken get s_NO_SLOT: they are not in the
+     * mask but their edges still wake up the waiting task, and "waitAny()" reports them.
+     * Only one task can wait on a ReadySet at a time. "wait()" registers the calling task
+     * while it blocks, "setWaiterTask()" registers a task until it sets nullptr again.
+     */
+    class ReadySet
+    {
+    public:
+        static constexpr int8_t s_NO_SLOT{-1};
+        static constexpr uint8_t s_MAX_SLOTS{32};
+
+        int8_t allocateSlot();
+        void releaseSlot(const int8_t slot);
+
+        void IRAM_ATTR markFromISR(const int8_t slot, BaseType_t *const pxHigherPriorityTaskWoken);
+        void IRAM_ATTR markMaskFromISR(const uint32_t mask, BaseType_t *const pxHigherPriorityTaskWoken);
+        void mark(const int8_t slot);
+        void clear(const int8_t slot);
+
+        PinState receive(PendingEdges &edges,
+                         const SemaphoreHandle_t binarySemaphore,
+                         const int8_t slot,
+                         const ReceiveMode mode,
+                         TickType_t xTicksToWait);
+
+        uint32_t wait(TickType_t xTicksToWait);
+        bool waitAny(TickType_t xTicksToWait);
+        // Register the task notified on new edges without blocking (e.g. to wait on several sets)
+        inline void setWaiterTask(const TaskHandle_t task) { m_waiterTask.store(task, std::memory_order_release); }
+        inline uint32_t getMask() const { return m_mask.load(std::memory_order_acquire); }
+
+        static constexpr uint32_t slotMask(const int8_t slot) { return slot == s_NO_SLOT ? 0 : 1UL << slot; }
+
+    private:
+        void settle(const PendingEdges &edges, const int8_t slot);
+        template <typename Ready>
+        bool block(TickType_t xTicksToWait, const Ready ready);
+
+    private:
+        std::atomic<uint32_t> m_mask{0};
+        std::atomic<uint32_t> m_allocatedSlots{0};
+        std::atomic<TaskHandle_t> m_waiterTask{nullptr};
+        // Set by the edges of the objects without a slot, cleared by "waitAny()"
+        std::atomic<bool> m_unslottedEdges{false};
+    }; // class ReadySet
+
+} // namespace AT
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <driver/gpio.h>
+
+#include "ArduinoToolkit/Interrupt/BasicInterrupt.h"
+
+namespace AT
+{
+
+    /**
+     * @brief BasicInterrupt whose pin, mode and logic are known at compile time.
+     * Its ISR reads the GPIO input register directly with a precomputed mask and the logic
+     * inversion is folded in at compile time, so it avoids the call to "digitalRead()" and
+     * the accesses to the runtime configuration of the object on every edge.
+     * The receive API is the same as BasicInterrupt.
+     */
+    template <uint8_t Pin, uint8_t Mode, bool ReverseLogic = false>
+    class StaticBasicInterrupt : public BasicInterrupt
+    {
+        // Valid for every chip (e.g. GPIOs 0-23, 25-27 and 32-39 on the ESP32, 0-21 and 26-48 on the ESP32-S3)
+        static_assert(Pin < SOC_GPIO_PIN_COUNT && GPIO_IS_VALID_GPIO(static_cast<int>(Pin)), "Pin is not a GPIO of this chip");
+
+    public:
+        explicit StaticBasicInterrupt(const uint32_t periodicCallToISRms = s_DEFAULT_PERIODIC_CALL_ISR_MS)
+            : BasicInterrupt(Pin, Mode, ReverseLogic, periodicCallToISRms, notifyReadySetFromISR, tskNO_AFFINITY, intISR) {}
+
+        // Read the logic state of the pin as the ISR does
+        static __attribute__((always_inline)) inline PinState readPin()
+        {
+            // GPIOs from 32 start at bit 0 of the second input register
+            return (REG_READ(s_INPUT_REGISTER) ^ s_REVERSE_MASK) & s_PIN_MASK ? PinState::High : PinState::Low;
+        }
+
+    private:
+        static void IRAM_ATTR intISR(void *const voidPtrInt)
+        {
+            // Timestamp the edge as soon as possible
+            const uint32_t cycles{ESP.getCycleCount()};
+            static_cast<StaticBasicInterrupt *>(voidPtrInt)->processEdge(readPin(), cycles);
+        }
+
+    private:
+        static constexpr uint32_t s_INPUT_REGISTER{Pin < 32 ? GPIO_IN_REG : GPIO_IN1_REG};
+        static constexpr uint32_t s_PIN_MASK{1UL << (Pin % 32)};
+        static constexpr uint32_t s_REVERSE_MASK{ReverseLogic ? s_PIN_MASK : 0};
+    }; // class StaticBasicInterrupt
+
+} // namespace AT
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ArduinoToolkit/Interrupt/PinState.h"
+
+namespace AT
+{
+
+    /**
+     * @brief Interrupt rate guard of an input, in the spirit of Linux NAPI.
+     * The ISR counts its calls in fixed windows with "countInterrupt()". If more than
+     * "maxInterrupts" calls land in one window a storm starts: the owner disables the interrupt
+     * and polls the input, passing every state read to "poll()" until it has been stable for
+     * the quiet time. Then the storm is over and the owner enables the interrupt again.
+     * Times are ticks of free-running 32-bit counters (the ISR and the poll may use different
+     * ones), compared with wrap-around safe differences.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class StormGuard
+    {
+    public:
+        StormGuard() = default;
+
+        // A guard with "maxInterrupts" 0 is disabled
+        void configure(const uint32_t maxInterrupts, const uint32_t windowTicks, const uint32_t quietTicks)
+        {
+            m_maxInterrupts = maxInterrupts;
+            m_windowTicks = windowTicks;
+            m_quietTicks = quietTicks;
+            m_count = 0;
+        }
+
+        inline bool isEnabled() const { return m_maxInterrupts; }
+        inline bool isStorming() const { return m_storming.load(std::memory_order_relaxed); }
+        // Number of storms so far
+        inline uint32_t getStormCount() const { return m_stormCount.load(std::memory_order_relaxed); }
+
+        // Count a call of the ISR. Return true if it starts a storm
+        __attribute__((always_inline)) inline bool countInterrupt(const uint32_t nowTicks)
+        {
+            if (!m_maxInterrupts || m_storming.load(std::memory_order_relaxed))
+                return false;
+            if (nowTicks - m_windowStartTicks >= m_windowTicks)
+            {
+                m_windowStartTicks = nowTicks;
+                m_count = 0;
+            }
+            if (++m_count <= m_maxInterrupts)
+                return false;
+            m_lastState = PinState::Unknown;
+            m_stormCount.fetch_add(1, std::memory_order_relaxed);
+            m_storming.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Pass the state read by a poll. Return true if the storm is over
+        bool poll(const PinState state, const uint32_t nowTicks)
+        {
+            if (state != m_lastState)
+            {
+                m_lastState = state;
+                m_stableSinceTicks = nowTicks;
+                return false;
+            }
+            if (nowTicks - m_stableSinceTicks < m_quietTicks)
+                return false;
+            // The interrupts start counting in a new window
+            m_count = 0;
+            m_storming.store(false, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        uint32_t m_maxInterrupts{0};
+        uint32_t m_windowTicks{0};
+        uint32_t m_quietTicks{0};
+        // Interrupt counting
+        uint32_t m_windowStartTicks{0};
+        uint32_t m_count{0};
+        // Polling
+        PinState m_lastState{PinState::Unknown};
+        uint32_t m_stableSinceTicks{0};
+        std::atomic<bool> m_storming{false};
+        std::atomic<uint32_t> m_stormCount{0};
+    }; // class StormGuard
+
+} // namespace AT
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AT
+{
+
+    /**
+     * @brief Threshold detector with hysteresis over blocks of samples.
+     * The state goes high when a sample reaches "highThreshold" and low when a sample
+     * drops to "lowThreshold", samples in between keep the current state.
+     * The block is scanned in chunks of s_CHUNK samples: the minimum (or maximum) of a chunk
+     * is compared to the threshold, and only the chunks that contain a crossing are walked
+     * sample by sample, so a quiet block costs a few operations per chunk. The min/max
+     * reduction has no branches and is vectorized at -O2, where an OR of the comparisons is not.
+     * See bench/host/ThresholdScannerBenchmark.cpp.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    class ThresholdScanner
+    {
+    public:
+        static constexpr size_t s_CHUNK{16};
+
+        constexpr ThresholdScanner(const uint16_t lowThreshold, const uint16_t highThreshold)
+            : m_lowThreshold(lowThreshold),
+              m_highThreshold(highThreshold) {}
+
+        inline uint16_t getLowThreshold() const { return m_lowThreshold; }
+        inline uint16_t getHighThreshold() const { return m_highThreshold; }
+
+        // Initial state from a single sample. Samples inside the hysteresis band are low
+        inline bool initialState(const uint16_t sample) const { return sample >= m_highThreshold; }
+
+        /**
+         * @brief Scan a block of samples.
+         *
+         * @param samples Samples in chronological order.
+         * @param count Number of samples.
+         * @param high Current state. Output, the state after the last sample.
+         * @return Number of state changes (crossings) within the block.
+         */
+        uint32_t scan(const uint16_t *const samples, const size_t count, bool &high) const
+        {
+            uint32_t crossings{0};
+            size_t i{0};
+            while (true)
+            {
+                i = high ? find<Below>(samples, i, count, m_lowThreshold)
+                         : find<AtOrAbove>(samples, i, count, m_highThreshold);
+                if (i == count)
+                    return crossings;
+                high = !high;
+                crossings++;
+                i++;
+            }
+        }
+
+    private:
+        struct Below
+        {
+            static inline bool test(const uint16_t sample, const uint16_t threshold) { return sample <= threshold; }
+            static constexpr uint16_t s_IDENTITY{UINT16_MAX};
+            static inline uint16_t reduce(const uint16_t a, const uint16_t b) { return a < b ? a : b; }
+        };
+        struct AtOrAbove
+        {
+            static inline bool test(const uint16_t sample, const uint16_t threshold) { return sample >= threshold; }
+            static constexpr uint16_t s_IDENTITY{0};
+            static inline uint16_t reduce(const uint16_t a, const uint16_t b) { return a > b ? a : b; }
+        };
+
+        // Index of the first sample from "first" that passes "Compare", or "count" if none does
+        template <typename Compare>
+        static size_t find(const uint16_t *const samples, size_t first, const size_t count, const uint16_t threshold)
+        {
+            // Whole chunks, a chunk has a crossing when its extreme sample passes
+            while (first + s_CHUNK <= count)
+            {
+                uint16_t extreme{Compare::s_IDENTITY};
+                for (size_t j{0}; j < s_CHUNK; j++)
+                    extreme = Compare::reduce(extreme, samples[first + j]);
+                if (Compare::test(extreme, threshold))
+                    break;
+                first += s_CHUNK;
+            }
+            // Locate the crossing within the chunk (or walk the tail of the block)
+            for (; first < count; first++)
+                if (Compare::test(samples[first], threshold))
+                    return first;
+            return count;
+        }
+
+    private:
+        const uint16_t m_lowThreshold;
+        const uint16_t m_highThreshold;
+    }; // class ThresholdScanner
+
+} // namespace AT
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AT
+{
+
+    /**
+     * @brief Bit-parallel debouncer for 32 inputs using vertical counters.
+     * Bit i of every counter word belongs to input i, so the counters of the 32 inputs are
+     * incremented (or reset) together with a few word-wide logic operations per sample.
+     * An input toggles its debounced state after 2^CounterBits consecutive samples
+     * different from it, any sample equal to the debounced state resets its counter.
+     * It does not depend on the Arduino framework so it can be built on the host.
+     */
+    template <uint8_t CounterBits = 2>
+    class VerticalCounter
+    {
+        static_assert(CounterBits > 0 && CounterBits <= 8, "CounterBits must be in [1, 8]");
+
+    public:
+        // Set the debounced state without waiting (e.g. with the first sample)
+        inline void reset(const uint32_t state)
+        {
+            m_state = state;
+            for (uint32_t &counter : m_counters)
+                counter = 0;
+        }
+
+        /**
+         * @brief Feed a new sample of the 32 inputs.
+         *
+         * @param sample Raw value of the inputs.
+         * @return The mask of the inputs whose debounced state has toggled.
+         */
+        __attribute__((always_inline)) inline uint32_t update(const uint32_t sample)
+        {
+            // Inputs whose raw value differs from the debounced state
+            const uint32_t delta{sample ^ m_state};
+            // Ripple-carry increment of the inputs in "delta", the others are reset to 0
+            uint32_t carry{delta};
+            for (uint32_t &counter : m_counters)
+            {
+                const uint32_t sum{counter ^ carry};
+                carry &= counter;
+                counter = sum & delta;
+            }
+            // The inputs whose counter has overflowed toggle (their counter wraps to 0)
+            m_state ^= carry;
+            return carry;
+        }
+
+        inline uint32_t getState() const { return m_state; }
+
+        static constexpr uint32_t s_SAMPLES_TO_TOGGLE{1UL << CounterBits};
+
+    private:
+        uint32_t m_state{0};
+        uint32_t m_counters[CounterBits]{};
+    }; // class VerticalCounter
+
+} // namespace AT
@@ -1,103 +1,122 @@
-#include <WiFiUdp.h>
-
-#include <NTPClient.h>
+#define AT_LOG_MODULE NTP
 
 #include "ArduinoToolkit/WiFi/NTPClientDaemon.h"
 
 namespace AT
 {
 
-    namespace NTPClientDaemon
+    NTPClientDaemon::NTPClientDaemon()
+        : m_timeClient{m_ntpUDP}
     {
+        // Create the update datetime timer, its period is set on start
+#ifdef AT_STATIC_ALLOCATION
+        m_timerUpdateDateTime = xTimerCreateStatic("timerUpdateDatetime",
+                                                   pdMS_TO_TICKS(1000),
+                                                   pdTRUE,
+                                                   nullptr,
+                                                   timerUpdateDateTimeCB,
+                                                   &m_timerBuffer);
+#else
+        m_timerUpdateDateTime = xTimerCreate("timerUpdateDatetime",
+                                             pdMS_TO_TICKS(1000),
+                                             pdTRUE,
+                                             nullptr,
+                                             timerUpdateDateTimeCB);
+#endif
+        if (!m_timerUpdateDateTime)
+            AT_LOG_E("Could not create timer");
+    }
 
-        // Static variables
-        static WiFiUDP ntpUDP;
-        static NTPClient timeClient(ntpUDP);
-        static uint32_t updateDateTimePeriodTicks;
-        static uint32_t retryUpdateDateTimePeriodTicks;
-        static TimerHandle_t timerUpdateDateTime;
-
-        // Static functions
-        static void changeTimerPeriodToNormal(const TimerHandle_t &xTimer,
-                                              BaseType_t *const pxHigherPriorityTaskWoken)
+    void NTPClientDaemon::changeTimerPeriod(const TimerHandle_t xTimer,
+                                            const TickType_t periodTicks,
+                                            BaseType_t *const pxHigherPriorityTaskWoken)
+    {
+        if (xTimerGetPeriod(xTimer) != periodTicks)
         {
-            if (xTimerGetPeriod(xTimer) != updateDateTimePeriodTicks)
-            {
-                xTimerChangePeriodFromISR(xTimer, updateDateTimePeriodTicks, pxHigherPriorityTaskWoken);
-                AT_LOG_V("Update DateTime timer period changed to %ums", pdTICKS_TO_MS(updateDateTimePeriodTicks));
-            }
+            xTimerChangePeriodFromISR(xTimer, periodTicks, pxHigherPriorityTaskWoken);
+            AT_LOG_V("Update DateTime timer period changed to %ums", pdTICKS_TO_MS(periodTicks));
         }
+    }
 
-        static void changeTimerPeriodToRetry(const TimerHandle_t &xTimer,
-                                             BaseType_t *const pxHigherPriorityTaskWoken)
+    void NTPClientDaemon::timerUpdateDateTimeCB(const TimerHandle_t xTimer)
+    {
+        NTPClientDaemon &daemon{instance()};
+        xSemaphoreTake(daemon.m_updating, portMAX_DELAY);
+        // Expired before the daemon was stopped or suspended, changing the period would restart it
+        const DaemonState state{daemon.getState()};
+        if (state == DaemonState::Stopping || state == DaemonState::Stopped ||
+            state == DaemonState::Suspending || state == DaemonState::Suspended)
         {
-            if (xTimerGetPeriod(xTimer) != retryUpdateDateTimePeriodTicks)
-            {
-                xTimerChangePeriodFromISR(xTimer, retryUpdateDateTimePeriodTicks, pxHigherPriorityTaskWoken);
-                AT_LOG_V("Update DateTime timer period changed to %ums", pdTICKS_TO_MS(retryUpdateDateTimePeriodTicks));
-            }
+            xSemaphoreGive(daemon.m_updating);
+            return;
         }
-
-        static void timerUpdateDateTimeCB(const TimerHandle_t xTimer)
+        BaseType_t xHigherPriorityTaskWoken{pdFALSE};
+        if (WiFiDaemon::isInstanced() && WiFiDaemon::instance().isConnected())
         {
-            BaseType_t xHigherPriorityTaskWoken{pdFALSE};
-            if (WiFiDaemon::isConnected())
+            if (daemon.m_timeClient.forceUpdate())
             {
-                if (timeClient.forceUpdate())
-                {
-                    AT_LOG_D("Current time is: %s", timeClient.getFormattedTime());
-                    changeTimerPeriodToNormal(xTimer, &xHigherPriorityTaskWoken);
-                }
-                else
-                {
-                    AT_LOG_W("Could not update timeClient");
-                    changeTimerPeriodToRetry(xTimer, &xHigherPriorityTaskWoken);
-                }
+                AT_LOG_D("Current time is: %s", daemon.m_timeClient.getFormattedTime().c_str());
+                daemon.changeTimerPeriod(xTimer, daemon.m_updateDateTimePeriodTicks, &xHigherPriorityTaskWoken);
             }
             else
             {
-                AT_LOG_W("Could not update timeClient because WiFi is not connected");
-                changeTimerPeriodToRetry(xTimer, &xHigherPriorityTaskWoken);
+                // The retry timer fires every second or so, warn once a minute at most
+                AT_LOG_W_LIMITED(60 * 1000, "Could not update timeClient");
+                daemon.changeTimerPeriod(xTimer, daemon.m_retryUpdateDateTimePeriodTicks, &xHigherPriorityTaskWoken);
             }
-            // Did this action unblock a higher priority task?
-            if (xHigherPriorityTaskWoken)
-                portYIELD_FROM_ISR();
         }
-
-        // Public functions
-        void start(const TickType_t _updateDateTimePeriodTicks,
-                   const TickType_t _retryUpdateDateTimePeriodTicks)
+        else
         {
-            // Initialize static variables
-            updateDateTimePeriodTicks = _updateDateTimePeriodTicks;
-            retryUpdateDateTimePeriodTicks = _retryUpdateDateTimePeriodTicks;
+            AT_LOG_W_LIMITED(60 * 1000, "Could not update timeClient because WiFi is not connected");
+            daemon.changeTimerPeriod(xTimer, daemon.m_retryUpdateDateTimePeriodTicks, &xHigherPriorityTaskWoken);
+        }
+        xSemaphoreGive(daemon.m_updating);
+        // Did this action unblock a higher priority task?
+        if (xHigherPriorityTaskWoken)
+            portYIELD_FROM_ISR();
+    }
 
-            // Initialize a NTPClient to get time
-            timeClient.begin();
-            // Set offset time in seconds to adjust for your timezone, for example:
-            // GMT +1 = 3600
-            timeClient.setTimeOffset(3600);
+    bool NTPClientDaemon::onStart(const TickType_t updateDateTimePeriodTicks,
+                                  const TickType_t retryUpdateDateTimePeriodTicks)
+    {
+        if (!m_timerUpdateDateTime)
+            return false;
+        m_updateDateTimePeriodTicks = updateDateTimePeriodTicks;
+        m_retryUpdateDateTimePeriodTicks = retryUpdateDateTimePeriodTicks;
 
-            // Create the update datetime timer
-            timerUpdateDateTime = xTimerCreate(
-                "timerUpdateDatetime",
-                retryUpdateDateTimePeriodTicks,
-                pdTRUE,
-                (void *)0,
-                timerUpdateDateTimeCB);
-            if (!timerUpdateDateTime)
-                AT_LOG_E("Could not create timer");
-            // Start the timer
-            xTimerStart(timerUpdateDateTime, portMAX_DELAY);
-        }
+        // Initialize a NTPClient to get time
+        m_timeClient.begin();
+        // Set offset time in seconds to adjust for your timezone, for example:
+        // GMT +1 = 3600
+        m_timeClient.setTimeOffset(3600);
 
-        void stop()
-        {
-            xTimerStop(timerUpdateDateTime, portMAX_DELAY);
-            timeClient.end();
-            AT_LOG_I("NTPClientDaemon Deleted");
-        }
+        // Update soon after starting, then with the normal period. Changing the period starts the timer
+        xTimerChangePeriod(m_timerUpdateDateTime, m_retryUpdateDateTimePeriodTicks, portMAX_DELAY);
+        return true;
+    }
 
-    } // namespace NTPClientDaemon
+    void NTPClientDaemon::onStop()
+    {
+        // Wait for an update in progress, the later ones see the daemon stopping
+        xSemaphoreTake(m_updating, portMAX_DELAY);
+        xTimerStop(m_timerUpdateDateTime, portMAX_DELAY);
+        m_timeClient.end();
+        xSemaphoreGive(m_updating);
+        AT_LOG_I("NTPClientDaemon stopped");
+    }
+
+    void NTPClientDaemon::onSuspend()
+    {
+        xSemaphoreTake(m_updating, portMAX_DELAY);
+        xTimerStop(m_timerUpdateDateTime, portMAX_DELAY);
+        xSemaphoreGive(m_updating);
+        AT_LOG_I("NTPClientDaemon suspended");
+    }
+
+    void NTPClientDaemon::onResume()
+    {
+        xTimerStart(m_timerUpdateDateTime, portMAX_DELAY);
+        AT_LOG_I("NTPClientDaemon resumed");
+    }
 
 } // namespace AT
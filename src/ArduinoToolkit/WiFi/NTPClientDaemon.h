@@ -1,17 +1,49 @@
 #pragma once
 
+#include <WiFiUdp.h>
+
+#include <NTPClient.h>
+
 #include "ArduinoToolkit/WiFi/WiFiDaemon.h"
 
 namespace AT
 {
 
-    namespace NTPClientDaemon
+    /**
+     * @brief Daemon that keeps the time updated from NTP, e.g. "AT::NTPClientDaemon::instance().start()".
+     * It retries with the retry period until an update succeeds. Suspending it stops the updates.
+     * Stopping or suspending it waits for an update in progress.
+     */
+    class NTPClientDaemon : public Daemon<NTPClientDaemon>
     {
+        friend class Daemon<NTPClientDaemon>;
+
+    private:
+        NTPClientDaemon();
+
+        bool onStart(const TickType_t updateDateTimePeriodTicks = pdMS_TO_TICKS(60 * 1000),
+                     const TickType_t retryUpdateDateTimePeriodTicks = pdMS_TO_TICKS(1000));
+        void onStop();
+        void onSuspend();
+        void onResume();
+
+        void changeTimerPeriod(const TimerHandle_t xTimer,
+                               const TickType_t periodTicks,
+                               BaseType_t *const pxHigherPriorityTaskWoken);
 
-        void start(const TickType_t updateDateTimePeriodTicks = pdMS_TO_TICKS(60 * 1000),
-                   const TickType_t retryUpdateDateTimePeriodTicks = pdMS_TO_TICKS(1000));
-        void stop();
+        static void timerUpdateDateTimeCB(const TimerHandle_t xTimer);
 
-    } // namespace NTPClientDaemon
+    private:
+        WiFiUDP m_ntpUDP;
+        NTPClient m_timeClient;
+        TickType_t m_updateDateTimePeriodTicks{0};
+        TickType_t m_retryUpdateDateTimePeriodTicks{0};
+        TimerHandle_t m_timerUpdateDateTime{nullptr};
+        // Held by the timer callback while it runs, the timer can not be stopped from its own callback
+        Mutex m_updating;
+#ifdef AT_STATIC_ALLOCATION
+        StaticTimer_t m_timerBuffer;
+#endif
+    }; // class NTPClientDaemon
 
 } // namespace AT
@@ -2,8 +2,11 @@
  * Based on Arvind Ravulavaru sketch <https://github.com/arvindr21>
  */
 
+#define AT_LOG_MODULE OTA
+
 #include <Update.h>
 
+#include "ArduinoToolkit/Core/Pool.h"
 #include "ArduinoToolkit/WiFi/OTA_AWS_S3.h"
 
 namespace AT
@@ -24,12 +27,12 @@ namespace AT
                 m_bin = url.substr(splitCharIdx + 1);
             }
 
-            inline const std::string &getHost() const { return m_host; }
-            inline const std::string &getBin() const { return m_bin; }
+            inline const PoolString &getHost() const { return m_host; }
+            inline const PoolString &getBin() const { return m_bin; }
 
         private:
-            std::string m_host;
-            std::string m_bin;
+            PoolString m_host;
+            PoolString m_bin;
         };
 
         struct headerResponseSteps_t
@@ -131,7 +134,7 @@ namespace AT
             }
         }
 
-        static size_t requestS3BinFile(const std::string &host, const std::string &bin, const uint16_t port)
+        static size_t requestS3BinFile(const PoolString &host, const PoolString &bin, const uint16_t port)
         {
             if (s_wifiClient.connect(host.c_str(), port))
             {
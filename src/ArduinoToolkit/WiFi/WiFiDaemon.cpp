@@ -1,229 +1,238 @@
-#include <vector>
+#define AT_LOG_MODULE WiFi
 
 #include "ArduinoToolkit/WiFi/WiFiDaemon.h"
 
 namespace AT
 {
 
-    namespace WiFiDaemon
+    WiFiDaemon::WiFiDaemon()
     {
-
-        /**
-         * Static variables
-         */
-        static constexpr uint32_t WIFI_RECONNECT_WAIT_TIME_MS{5 * 1000};
-        // WiFi credentials
-        static const char *wifiSSID{nullptr};
-        static const char *wifiPASS{nullptr};
-        static TaskHandle_t taskHandle{nullptr};
-        // FreeRTOS binary semaphore
-        static SemaphoreHandle_t binarySemphrTryToConnectWiFi{nullptr};
-        static SemaphoreHandle_t binarySemphrWiFiConnected{nullptr};
-        // Vector of FreeRTOS tasks that rely on WiFi
-        static std::vector<TaskHandle_t> wifiDependentTasks;
-
-        /**
-         * Static functions
-         */
-        static void timerReconnectWiFiCB(const TimerHandle_t xTimer)
+        // Create the WiFi connection timeout timer, it runs while the daemon does
+#ifdef AT_STATIC_ALLOCATION
+        m_timerReconnect = xTimerCreateStatic("timerReconnectWiFi",
+                                              pdMS_TO_TICKS(s_RECONNECT_WAIT_TIME_MS),
+                                              pdTRUE,
+                                              nullptr,
+                                              timerReconnectCB,
+                                              &m_timerBuffer);
+#else
+        m_timerReconnect = xTimerCreate("timerReconnectWiFi",
+                                        pdMS_TO_TICKS(s_RECONNECT_WAIT_TIME_MS),
+                                        pdTRUE,
+                                        nullptr,
+                                        timerReconnectCB);
+#endif
+        if (!m_timerReconnect)
+            AT_LOG_E("Could not create timer");
+    }
+
+    void WiFiDaemon::timerReconnectCB(const TimerHandle_t xTimer)
+    {
+        (void)xTimer;
+        WiFiDaemon &daemon{instance()};
+        if (!uxSemaphoreGetCount(daemon.m_connected))
         {
-            if (!uxSemaphoreGetCount(binarySemphrWiFiConnected))
-            {
-                BaseType_t xHigherPriorityTaskWoken{pdFALSE};
-                xSemaphoreGiveFromISR(binarySemphrTryToConnectWiFi, &xHigherPriorityTaskWoken);
-                // Did this action unblock a higher priority task?
-                if (xHigherPriorityTaskWoken)
-                    portYIELD_FROM_ISR();
-            }
+            BaseType_t xHigherPriorityTaskWoken{pdFALSE};
+            xSemaphoreGiveFromISR(daemon.m_tryToConnect, &xHigherPriorityTaskWoken);
+            // Did this action unblock a higher priority task?
+            if (xHigherPriorityTaskWoken)
+                portYIELD_FROM_ISR();
         }
+    }
 
-        // Suspend all tasks included in "wifiDependentTasks" vector
-        static void suspendWiFiDependentTasks()
+    // Suspend all tasks included in "m_dependentTasks" but the current one
+    void WiFiDaemon::suspendDependentTasks()
+    {
+        if (m_dependentTaskCount)
         {
-            if (wifiDependentTasks.size())
+            const TaskHandle_t currentTask{xTaskGetCurrentTaskHandle()};
+            for (size_t i{0}; i < m_dependentTaskCount; i++)
             {
-                for (const TaskHandle_t &task : wifiDependentTasks)
-                {
-                    vTaskSuspend(task);
-                    AT_LOG_V("Task %s suspended", pcTaskGetName(task));
-                }
-                AT_LOG_D("WiFi dependent tasks suspended");
+                if (m_dependentTasks[i] == currentTask)
+                    continue;
+                vTaskSuspend(m_dependentTasks[i]);
+                AT_LOG_V("Task %s suspended", pcTaskGetName(m_dependentTasks[i]));
             }
+            AT_LOG_D("WiFi dependent tasks suspended");
         }
+    }
 
-        // Resume all tasks included in "wifiDependentTasks" vector
-        static void resumeWiFiDependentTasks()
+    // Resume all tasks included in "m_dependentTasks"
+    void WiFiDaemon::resumeDependentTasks()
+    {
+        if (m_dependentTaskCount)
         {
-            if (wifiDependentTasks.size())
+            for (size_t i{0}; i < m_dependentTaskCount; i++)
             {
-                for (const TaskHandle_t &task : wifiDependentTasks)
-                {
-                    xTaskResumeFromISR(task);
-                    AT_LOG_V("Task %s resumed", pcTaskGetName(task));
-                }
-                AT_LOG_D("WiFi dependent tasks resumed");
+                xTaskResumeFromISR(m_dependentTasks[i]);
+                AT_LOG_V("Task %s resumed", pcTaskGetName(m_dependentTasks[i]));
             }
+            AT_LOG_D("WiFi dependent tasks resumed");
         }
+    }
 
-        static void WiFiEventCB(const WiFiEvent_t &event, const WiFiEventInfo_t &info)
+    void WiFiDaemon::eventCB(const WiFiEvent_t &event, const WiFiEventInfo_t &info)
+    {
+        WiFiDaemon &daemon{instance()};
+        BaseType_t xHigherPriorityTaskWoken{pdFALSE};
+        switch (event)
         {
-            BaseType_t xHigherPriorityTaskWoken{pdFALSE};
-            switch (event)
-            {
-            // Got WIFI_STA_DISCONNECTED event (WiFi disconnected)
-            case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
-            {
-                const uint8_t reason{info.wifi_sta_disconnected.reason};
-                AT_LOG_W("ARDUINO_EVENT_WIFI_STA_DISCONNECTED (Reason: %u)", reason);
-                // Take the "binarySemphrWiFiConnected" to notify to other tasks that WiFi is OFF
-                xSemaphoreTakeFromISR(binarySemphrWiFiConnected, &xHigherPriorityTaskWoken);
-                AT_LOG_V("binarySemphrWiFiConnected set to 0");
-                // Suspend all tasks included in "wifiDependentTasks" vector
-                suspendWiFiDependentTasks();
-                if (!reason)
-                    AT_LOG_E("WIFI_STA_DISCONNECTED with reason 0");
-                // On reson ASSOC_FAIL wait some time to try to reconnect, otherwise reconnect immediately
-                if (reason != WIFI_REASON_ASSOC_FAIL)
-                    xSemaphoreGiveFromISR(binarySemphrTryToConnectWiFi, &xHigherPriorityTaskWoken);
-                break;
-            }
-            // Got WIFI_STA_GOT_IP event (WiFi connection stablished)
-            case ARDUINO_EVENT_WIFI_STA_GOT_IP:
-            {
-                AT_LOG_I("ARDUINO_EVENT_WIFI_STA_GOT_IP. WiFi connected");
-                // Give the "binarySemphrWiFiConnected" to notify to other tasks that WiFi is ON
-                xSemaphoreGiveFromISR(binarySemphrWiFiConnected, &xHigherPriorityTaskWoken);
-                AT_LOG_V("binarySemphrWiFiConnected set to 1");
-                // Resume all tasks included in "wifiDependentTasks" vector
-                resumeWiFiDependentTasks();
-                // Take the "binarySemphrTryToConnectWiFi" to stop reconnecting
-                xSemaphoreTakeFromISR(binarySemphrTryToConnectWiFi, &xHigherPriorityTaskWoken);
-                break;
-            }
-            default:
-                break;
-            }
-
-            // Did this action unblock a higher priority task?
-            if (xHigherPriorityTaskWoken)
-                portYIELD_FROM_ISR();
-        }
-
-        static void WiFiDaemonTask(void *const parameters)
+        // Got WIFI_STA_DISCONNECTED event (WiFi disconnected)
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
         {
-            AT_LOG_I("WiFiDaemonTask created");
-            // Create a binary semaphore to know when WiFi is connected
-            binarySemphrWiFiConnected = xSemaphoreCreateBinary();
-            if (!binarySemphrWiFiConnected)
-                AT_LOG_E("Could not create binary semaphore");
-
-            // Create binary semaphore to know when to reconnect WiFi
-            binarySemphrTryToConnectWiFi = xSemaphoreCreateBinary();
-            if (!binarySemphrTryToConnectWiFi)
-                AT_LOG_E("Could not create binary semaphore");
-            xSemaphoreGive(binarySemphrTryToConnectWiFi);
-
-            // Create the WiFi connection timeout timer
-            static TimerHandle_t timerReconnectWiFi{nullptr};
-            timerReconnectWiFi = xTimerCreate(
-                "timerReconnectWiFi",
-                pdMS_TO_TICKS(WIFI_RECONNECT_WAIT_TIME_MS),
-                pdTRUE,
-                (void *)0,
-                timerReconnectWiFiCB);
-            if (!timerReconnectWiFi)
-                AT_LOG_E("Could not create timer");
-            // Start the timer
-            xTimerStart(timerReconnectWiFi, portMAX_DELAY);
-
-            // Set the WiFi callback
-            WiFi.onEvent(WiFiEventCB);
-            // Disable auto reconnect, the current task will take care of that
-            WiFi.setAutoReconnect(false);
-            // Configure WiFi as STA
-            WiFi.mode(WIFI_STA);
-
-            // Connect or reconect to WiFi
-            while (true)
-            {
-                if (xSemaphoreTake(binarySemphrTryToConnectWiFi, portMAX_DELAY))
-                {
-                    // Connect to WiFi
-                    AT_LOG_D("Connecting to %s", wifiSSID);
-                    WiFi.begin(wifiSSID, wifiPASS);
-                }
-            }
+            const uint8_t reason{info.wifi_sta_disconnected.reason};
+            // It comes back on every failed reconnection while the access point is away
+            AT_LOG_W_LIMITED(10 * 1000, "ARDUINO_EVENT_WIFI_STA_DISCONNECTED (Reason: %u)", reason);
+            // Take "m_connected" to notify to other tasks that WiFi is OFF
+            xSemaphoreTakeFromISR(daemon.m_connected, &xHigherPriorityTaskWoken);
+            AT_LOG_V("m_connected set to 0");
+            // Suspend all tasks included in "m_dependentTasks"
+            daemon.suspendDependentTasks();
+            if (!reason)
+                AT_LOG_E("WIFI_STA_DISCONNECTED with reason 0");
+            // On reson ASSOC_FAIL wait some time to try to reconnect, otherwise reconnect immediately
+            if (reason != WIFI_REASON_ASSOC_FAIL)
+                xSemaphoreGiveFromISR(daemon.m_tryToConnect, &xHigherPriorityTaskWoken);
+            break;
         }
-
-        /**
-         * Public functions
-         */
-        void start(const char *const ssid,
-                   const char *const passphrase,
-                   const UBaseType_t uxPriority)
+        // Got WIFI_STA_GOT_IP event (WiFi connection stablished)
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
         {
-            if (taskHandle)
-            {
-                AT_LOG_W("WiFi daemon already started");
-                ASSERT(false);
-                return;
-            }
-
-            wifiSSID = ssid;
-            wifiPASS = passphrase;
-
-            xTaskCreatePinnedToCore(
-                WiFiDaemonTask,
-                "WiFiDaemonTask",
-                3 * 1024,
-                nullptr,
-                uxPriority,
-                &taskHandle,
-                ARDUINO_RUNNING_CORE);
+            AT_LOG_I("ARDUINO_EVENT_WIFI_STA_GOT_IP. WiFi connected");
+            // Give "m_connected" to notify to other tasks that WiFi is ON
+            xSemaphoreGiveFromISR(daemon.m_connected, &xHigherPriorityTaskWoken);
+            AT_LOG_V("m_connected set to 1");
+            // Resume all tasks included in "m_dependentTasks"
+            daemon.resumeDependentTasks();
+            // Take "m_tryToConnect" to stop reconnecting
+            xSemaphoreTakeFromISR(daemon.m_tryToConnect, &xHigherPriorityTaskWoken);
+            break;
         }
+        default:
+            break;
+        }
+
+        // Did this action unblock a higher priority task?
+        if (xHigherPriorityTaskWoken)
+            portYIELD_FROM_ISR();
+    }
 
-        void stop()
+    void WiFiDaemon::daemonTask(void *const parameters)
+    {
+        WiFiDaemon &daemon{*static_cast<WiFiDaemon *>(parameters)};
+        AT_LOG_I("WiFiDaemonTask created");
+        // Connect or reconect to WiFi
+        while (true)
         {
-            if (taskHandle)
+            if (xSemaphoreTake(daemon.m_tryToConnect, portMAX_DELAY))
             {
-                vTaskDelete(taskHandle);
-                AT_LOG_I("WiFiDaemon Deleted");
-            }
-            else
-            {
-                AT_LOG_W("WiFiDaemon not started");
+                // Requests that arrive while suspended are dropped, resuming makes a new one
+                const DaemonState state{daemon.getState()};
+                if (state == DaemonState::Suspending || state == DaemonState::Suspended)
+                    continue;
+                // Connect to WiFi
+                AT_LOG_D("Connecting to %s", daemon.m_ssid);
+                xSemaphoreTake(daemon.m_connecting, portMAX_DELAY);
+                WiFi.begin(daemon.m_ssid, daemon.m_passphrase);
+                xSemaphoreGive(daemon.m_connecting);
             }
         }
+    }
 
-        BaseType_t blockUntilConnected(const TickType_t xTicksToWait)
+    bool WiFiDaemon::onStart(const char *const ssid,
+                             const char *const passphrase,
+                             const UBaseType_t uxPriority)
+    {
+        if (!m_timerReconnect)
+            return false;
+        m_ssid = ssid;
+        m_passphrase = passphrase;
+
+        // Set the WiFi callback
+        m_eventId = WiFi.onEvent(eventCB);
+        // Disable auto reconnect, the daemon task will take care of that
+        WiFi.setAutoReconnect(false);
+        // Configure WiFi as STA
+        WiFi.mode(WIFI_STA);
+
+        // Connect right away, then retry with the timer
+        xSemaphoreGive(m_tryToConnect);
+#ifdef AT_STATIC_ALLOCATION
+        m_taskHandle = xTaskCreateStaticPinnedToCore(daemonTask, "WiFiDaemonTask", s_TASK_STACK_SIZE, this,
+                                                     uxPriority, m_taskStack, &m_taskBuffer, ARDUINO_RUNNING_CORE);
+#else
+        xTaskCreatePinnedToCore(daemonTask, "WiFiDaemonTask", s_TASK_STACK_SIZE, this,
+                                uxPriority, &m_taskHandle, ARDUINO_RUNNING_CORE);
+#endif
+        if (!m_taskHandle)
         {
-            if (binarySemphrWiFiConnected)
-                return xQueuePeek(binarySemphrWiFiConnected, (void *)nullptr, xTicksToWait);
-            return pdFALSE;
+            AT_LOG_E("Could not create WiFiDaemonTask");
+            WiFi.removeEvent(m_eventId);
+            return false;
         }
+        xTimerStart(m_timerReconnect, portMAX_DELAY);
+        return true;
+    }
+
+    void WiFiDaemon::onStop()
+    {
+        WiFi.removeEvent(m_eventId);
+        xTimerStop(m_timerReconnect, portMAX_DELAY);
+        // Wait for a connection in progress
+        xSemaphoreTake(m_connecting, portMAX_DELAY);
+        vTaskDelete(m_taskHandle);
+        m_taskHandle = nullptr;
+        xSemaphoreGive(m_connecting);
+        WiFi.disconnect();
+        // The disconnection is not reported anymore
+        xSemaphoreTake(m_connected, 0);
+        suspendDependentTasks();
+        AT_LOG_I("WiFiDaemon stopped");
+    }
+
+    void WiFiDaemon::onSuspend()
+    {
+        xTimerStop(m_timerReconnect, portMAX_DELAY);
+        WiFi.disconnect();
+        AT_LOG_I("WiFiDaemon suspended");
+    }
+
+    void WiFiDaemon::onResume()
+    {
+        xSemaphoreGive(m_tryToConnect);
+        xTimerStart(m_timerReconnect, portMAX_DELAY);
+        AT_LOG_I("WiFiDaemon resumed");
+    }
 
-        bool isConnected()
+    BaseType_t WiFiDaemon::blockUntilConnected(const TickType_t xTicksToWait)
+    {
+        return xQueuePeek(m_connected, (void *)nullptr, xTicksToWait);
+    }
+
+    bool WiFiDaemon::isConnected()
+    {
+        return uxSemaphoreGetCount(m_connected);
+    }
+
+    bool WiFiDaemon::addDependentTask(TaskHandle_t task)
+    {
+        if (m_dependentTaskCount == AT_WIFI_MAX_DEPENDENT_TASKS)
         {
-            if (binarySemphrWiFiConnected)
-                return uxSemaphoreGetCount(binarySemphrWiFiConnected);
+            AT_LOG_E("Too many WiFi dependent tasks, increase AT_WIFI_MAX_DEPENDENT_TASKS");
             return false;
         }
-
-        void addDependentTask(TaskHandle_t task)
+        // If task is nullptr get the current task handle
+        if (!task)
+            task = xTaskGetCurrentTaskHandle();
+        // Add the task to "m_dependentTasks"
+        m_dependentTasks[m_dependentTaskCount++] = task;
+        // Suspend the task if the WiFi is not enabled
+        if (!isConnected())
         {
-            // If task is nullptr get the current task handle
-            if (!task)
-                task = xTaskGetCurrentTaskHandle();
-            // Add the task to the "wifiDependentTasks" vector
-            wifiDependentTasks.push_back(task);
-            // Suspend the task if the WiFi is not enabled
-            if (!isConnected())
-            {
-                AT_LOG_V("Task %s suspended", pcTaskGetName(task));
-                vTaskSuspend(task);
-            }
+            AT_LOG_V("Task %s suspended", pcTaskGetName(task));
+            vTaskSuspend(task);
         }
-
-    } // namespace WiFiDaemon
+        return true;
+    }
 
 } // namespace AT
@@ -3,22 +3,82 @@
 #include <WiFi.h>
 
 #include "ArduinoToolkit/Core.h"
+#include "ArduinoToolkit/Core/BinarySemaphore.h"
+#include "ArduinoToolkit/Core/Daemon.h"
+#include "ArduinoToolkit/Core/Mutex.h"
+
+// Maximum number of tasks suspended while the WiFi is not connected
+#ifndef AT_WIFI_MAX_DEPENDENT_TASKS
+#define AT_WIFI_MAX_DEPENDENT_TASKS 8
+#endif
+
+// Stack size (in bytes) of the WiFi daemon task
+#ifndef AT_WIFI_DAEMON_TASK_STACK_SIZE
+#define AT_WIFI_DAEMON_TASK_STACK_SIZE (3 * 1024)
+#endif
 
 namespace AT
 {
 
-    namespace WiFiDaemon
+    /**
+     * @brief Daemon that keeps the WiFi station connected, e.g.
+     * "AT::WiFiDaemon::instance().start(ssid, passphrase, priority)".
+     * Suspending it disconnects the WiFi until it is resumed. The tasks added with
+     * "addDependentTask()" are suspended while the WiFi is not connected, except the one that
+     * stops the daemon.
+     */
+    class WiFiDaemon : public Daemon<WiFiDaemon>
     {
+        friend class Daemon<WiFiDaemon>;
 
-        void start(const char *const ssid,
-                   const char *const passphrase,
-                   const UBaseType_t uxPriority);
-        void stop();
-
+    public:
         BaseType_t blockUntilConnected(const TickType_t xTicksToWait = portMAX_DELAY);
         bool isConnected();
-        void addDependentTask(TaskHandle_t task = nullptr);
+        bool addDependentTask(TaskHandle_t task = nullptr);
+
+    public:
+        static constexpr uint32_t s_TASK_STACK_SIZE{AT_WIFI_DAEMON_TASK_STACK_SIZE};
+
+    private:
+        WiFiDaemon();
+
+        bool onStart(const char *const ssid,
+                     const char *const passphrase,
+                     const UBaseType_t uxPriority);
+        void onStop();
+        void onSuspend();
+        void onResume();
+
+        void suspendDependentTasks();
+        void resumeDependentTasks();
+
+        static void timerReconnectCB(const TimerHandle_t xTimer);
+        static void eventCB(const WiFiEvent_t &event, const WiFiEventInfo_t &info);
+        static void daemonTask(void *const parameters);
+
+    private:
+        static constexpr uint32_t s_RECONNECT_WAIT_TIME_MS{5 * 1000};
 
-    } // namespace WiFiDaemon
+        // WiFi credentials
+        const char *m_ssid{nullptr};
+        const char *m_passphrase{nullptr};
+        TaskHandle_t m_taskHandle{nullptr};
+        TimerHandle_t m_timerReconnect{nullptr};
+        wifi_event_id_t m_eventId{0};
+        // Given to (re)connect the WiFi
+        BinarySemaphore m_tryToConnect;
+        // Available while the WiFi is connected
+        BinarySemaphore m_connected;
+        // Held by the daemon task while it connects, so it is not deleted in the middle of "WiFi.begin()"
+        Mutex m_connecting;
+        // Tasks that rely on WiFi
+        TaskHandle_t m_dependentTasks[AT_WIFI_MAX_DEPENDENT_TASKS]{};
+        size_t m_dependentTaskCount{0};
+#ifdef AT_STATIC_ALLOCATION
+        StaticTimer_t m_timerBuffer;
+        StackType_t m_taskStack[s_TASK_STACK_SIZE];
+        StaticTask_t m_taskBuffer;
+#endif
+    }; // class WiFiDaemon
 
 } // namespace AT
@@ -0,0 +1,189 @@
+/**
+ * Tests of DeadlineQueue, the deadline heap of DeadlineScheduler, driven by a virtual clock.
+ */
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Core/DeadlineQueue.h>
+
+using namespace AT;
+
+void setUp() {}
+void tearDown() {}
+
+static void noop(void *const) {}
+
+// Register a deadline in a queue with owned storage, growing it when needed
+static void registerGrowing(DeadlineQueue &queue, Deadline &deadline)
+{
+    const size_t capacity{queue.growCapacity()};
+    if (capacity)
+        queue.replaceStorage(std::unique_ptr<Deadline *[]>(new Deadline *[capacity]), capacity);
+    TEST_ASSERT_TRUE(queue.registerDeadline(deadline));
+}
+
+static void test_pops_in_time_order()
+{
+    static constexpr size_t COUNT{100};
+    DeadlineQueue queue;
+    std::vector<Deadline> deadlines(COUNT, Deadline{noop, nullptr});
+    std::minstd_rand random{11};
+    for (Deadline &deadline : deadlines)
+    {
+        registerGrowing(queue, deadline);
+        queue.schedule(deadline, 1000 + random() % 100000);
+    }
+    TEST_ASSERT_EQUAL_UINT(COUNT, queue.size());
+    // Nothing has expired before the earliest time
+    TEST_ASSERT_NULL(queue.popExpired(queue.nextTimeUs() - 1));
+    uint64_t previousUs{0};
+    for (size_t i{0}; i < COUNT; i++)
+    {
+        Deadline *const deadline{queue.popExpired(200000)};
+        TEST_ASSERT_NOT_NULL(deadline);
+        TEST_ASSERT_TRUE(deadline->getTimeUs() >= previousUs);
+        TEST_ASSERT_FALSE(deadline->isScheduled());
+        previousUs = deadline->getTimeUs();
+    }
+    TEST_ASSERT_NULL(queue.popExpired(200000));
+    TEST_ASSERT_EQUAL_UINT64(DeadlineQueue::s_NEVER, queue.nextTimeUs());
+}
+
+static void test_reschedule_earlier_and_later()
+{
+    DeadlineQueue queue;
+    Deadline a{noop, nullptr}, b{noop, nullptr}, c{noop, nullptr};
+    for (Deadline *const deadline : {&a, &b, &c})
+        registerGrowing(queue, *deadline);
+    queue.schedule(a, 100);
+    queue.schedule(b, 200);
+    queue.schedule(c, 300);
+    // Move the last one first and the first one last
+    queue.schedule(c, 50);
+    queue.schedule(a, 400);
+    TEST_ASSERT_EQUAL_UINT(3, queue.size());
+    TEST_ASSERT_EQUAL_PTR(&c, queue.popExpired(1000));
+    TEST_ASSERT_EQUAL_PTR(&b, queue.popExpired(1000));
+    TEST_ASSERT_EQUAL_PTR(&a, queue.popExpired(1000));
+    TEST_ASSERT_NULL(queue.popExpired(1000));
+}
+
+static void test_cancel_from_the_middle()
+{
+    static constexpr size_t COUNT{31};
+    DeadlineQueue queue;
+    std::vector<Deadline> deadlines(COUNT, Deadline{noop, nullptr});
+    for (size_t i{0}; i < COUNT; i++)
+    {
+        registerGrowing(queue, deadlines[i]);
+        queue.schedule(deadlines[i], (i * 7919) % 1000);
+    }
+    // Cancel every third deadline, wherever it is in the heap
+    for (size_t i{0}; i < COUNT; i += 3)
+        queue.cancel(deadlines[i]);
+    // Cancelling twice does nothing
+    queue.cancel(deadlines[0]);
+    TEST_ASSERT_EQUAL_UINT(COUNT - (COUNT + 2) / 3, queue.size());
+    uint64_t previousUs{0};
+    while (Deadline *const deadline{queue.popExpired(1000)})
+    {
+        TEST_ASSERT_TRUE((deadline - deadlines.data()) % 3 != 0);
+        TEST_ASSERT_TRUE(deadline->getTimeUs() >= previousUs);
+        previousUs = deadline->getTimeUs();
+    }
+    TEST_ASSERT_EQUAL_UINT(0, queue.size());
+}
+
+static void test_periodic_deadline_does_not_catch_up()
+{
+    DeadlineQueue queue;
+    Deadline periodic{noop, nullptr};
+    registerGrowing(queue, periodic);
+    queue.schedule(periodic, 1000, 1000);
+    TEST_ASSERT_EQUAL_PTR(&periodic, queue.popExpired(1000));
+    TEST_ASSERT_TRUE(periodic.isScheduled());
+    TEST_ASSERT_EQUAL_UINT64(2000, queue.nextTimeUs());
+    // Late by several periods: the next one is one period from now, not a burst of missed ones
+    TEST_ASSERT_EQUAL_PTR(&periodic, queue.popExpired(5500));
+    TEST_ASSERT_EQUAL_UINT64(6500, queue.nextTimeUs());
+    TEST_ASSERT_NULL(queue.popExpired(5500));
+    // Slightly late: the period is kept
+    TEST_ASSERT_EQUAL_PTR(&periodic, queue.popExpired(6600));
+    TEST_ASSERT_EQUAL_UINT64(7500, queue.nextTimeUs());
+    queue.cancel(periodic);
+    TEST_ASSERT_NULL(queue.popExpired(UINT64_MAX - 1));
+}
+
+static void test_unregistered_deadline_is_not_scheduled()
+{
+    DeadlineQueue queue;
+    Deadline deadline{noop, nullptr};
+    queue.schedule(deadline, 100);
+    TEST_ASSERT_FALSE(deadline.isScheduled());
+    TEST_ASSERT_EQUAL_UINT(0, queue.size());
+    // Unregistering cancels it
+    registerGrowing(queue, deadline);
+    queue.schedule(deadline, 100);
+    queue.unregisterDeadline(deadline);
+    TEST_ASSERT_FALSE(deadline.isRegistered());
+    TEST_ASSERT_FALSE(deadline.isScheduled());
+    TEST_ASSERT_EQUAL_UINT(0, queue.size());
+    queue.schedule(deadline, 100);
+    TEST_ASSERT_NULL(queue.popExpired(1000));
+}
+
+static void test_supplied_storage_is_bounded()
+{
+    Deadline *storage[2];
+    DeadlineQueue queue{storage, 2};
+    Deadline a{noop, nullptr}, b{noop, nullptr}, c{noop, nullptr};
+    TEST_ASSERT_TRUE(queue.registerDeadline(a));
+    TEST_ASSERT_TRUE(queue.registerDeadline(b));
+    // The storage of the owner is never grown
+    TEST_ASSERT_EQUAL_UINT(0, queue.growCapacity());
+    TEST_ASSERT_FALSE(queue.registerDeadline(c));
+    TEST_ASSERT_FALSE(c.isRegistered());
+    queue.unregisterDeadline(a);
+    TEST_ASSERT_TRUE(queue.registerDeadline(c));
+}
+
+static void test_owned_storage_grows_with_scheduled_deadlines()
+{
+    DeadlineQueue queue;
+    TEST_ASSERT_EQUAL_UINT(4, queue.growCapacity());
+    Deadline a{noop, nullptr};
+    TEST_ASSERT_FALSE(queue.registerDeadline(a));
+    std::vector<Deadline> deadlines(5, Deadline{noop, nullptr});
+    for (size_t i{0}; i < 4; i++)
+    {
+        registerGrowing(queue, deadlines[i]);
+        queue.schedule(deadlines[i], 100 - i);
+    }
+    TEST_ASSERT_EQUAL_UINT(8, queue.growCapacity());
+    // The scheduled deadlines move to the new storage, the old one is handed back
+    const std::unique_ptr<Deadline *[]> previous{queue.replaceStorage(std::unique_ptr<Deadline *[]>(new Deadline *[8]), 8)};
+    TEST_ASSERT_NOT_NULL(previous.get());
+    TEST_ASSERT_EQUAL_UINT(0, queue.growCapacity());
+    TEST_ASSERT_TRUE(queue.registerDeadline(deadlines[4]));
+    queue.schedule(deadlines[4], 50);
+    TEST_ASSERT_EQUAL_PTR(&deadlines[4], queue.popExpired(1000));
+    for (size_t i{4}; i > 0; i--)
+        TEST_ASSERT_EQUAL_PTR(&deadlines[i - 1], queue.popExpired(1000));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pops_in_time_order);
+    RUN_TEST(test_reschedule_earlier_and_later);
+    RUN_TEST(test_cancel_from_the_middle);
+    RUN_TEST(test_periodic_deadline_does_not_catch_up);
+    RUN_TEST(test_unregistered_deadline_is_not_scheduled);
+    RUN_TEST(test_supplied_storage_is_bounded);
+    RUN_TEST(test_owned_storage_grows_with_scheduled_deadlines);
+    return UNITY_END();
+}
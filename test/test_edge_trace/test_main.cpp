@@ -0,0 +1,248 @@
+/**
+ * Tests of the edge trace format (EdgeTraceWriter and EdgeTraceReader), of DebounceFilter and
+ * of the replay of traces through the filter, and of EdgeTraceRecorder on the simulated GPIOs.
+ */
+
+#include <random>
+#include <vector>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/EdgeTraceRecorder.h>
+#include <ArduinoToolkit/Interrupt/EdgeTraceReplay.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+static constexpr uint8_t PIN_RECORDED{8};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_round_trip()
+{
+    uint8_t buffer[4096];
+    EdgeTraceWriter writer{buffer, sizeof(buffer)};
+    std::vector<EdgeTraceRecord> records;
+    std::minstd_rand random{5};
+    uint64_t timeUs[4]{};
+    for (uint32_t i{0}; i < 200; i++)
+    {
+        const uint8_t pin{static_cast<uint8_t>(random() % 4 * 20)};
+        // Deltas from a few us to hours, to use every varint length
+        timeUs[pin / 20] += static_cast<uint64_t>(random()) >> (random() % 31);
+        const PinState state{random() % 2 ? PinState::High : PinState::Low};
+        TEST_ASSERT_TRUE(writer.write(pin, timeUs[pin / 20], state));
+        records.push_back({pin, timeUs[pin / 20], state});
+    }
+    // A very long delta takes the longest varint
+    TEST_ASSERT_TRUE(writer.write(63, UINT64_MAX >> 1, PinState::High));
+    records.push_back({63, UINT64_MAX >> 1, PinState::High});
+    EdgeTraceReader reader{writer.data(), writer.size()};
+    TEST_ASSERT_TRUE(reader.isValid());
+    for (uint32_t pass{0}; pass < 2; pass++)
+    {
+        EdgeTraceRecord record;
+        for (const EdgeTraceRecord &expected : records)
+        {
+            TEST_ASSERT_TRUE(reader.next(record));
+            TEST_ASSERT_EQUAL_UINT8(expected.pin, record.pin);
+            TEST_ASSERT_EQUAL_UINT64(expected.timeUs, record.timeUs);
+            TEST_ASSERT_TRUE(expected.state == record.state);
+        }
+        TEST_ASSERT_FALSE(reader.next(record));
+        TEST_ASSERT_TRUE(reader.isValid());
+        reader.rewind();
+    }
+}
+
+static void test_writer_rejects_invalid_edges()
+{
+    uint8_t small[EdgeTrace::s_HEADER_SIZE - 1];
+    EdgeTraceWriter tooSmall{small, sizeof(small)};
+    TEST_ASSERT_FALSE(tooSmall.write(0, 0, PinState::High));
+    uint8_t buffer[EdgeTrace::s_HEADER_SIZE + EdgeTrace::s_MAX_RECORD_SIZE];
+    EdgeTraceWriter writer{buffer, sizeof(buffer)};
+    TEST_ASSERT_FALSE(writer.write(EdgeTrace::s_MAX_PINS, 0, PinState::High));
+    TEST_ASSERT_FALSE(writer.write(0, 0, PinState::Unknown));
+    TEST_ASSERT_TRUE(writer.write(0, 100, PinState::High));
+    // Time going backwards on the same pin, then a full buffer
+    TEST_ASSERT_FALSE(writer.write(0, 50, PinState::Low));
+    TEST_ASSERT_TRUE(writer.isFull());
+    TEST_ASSERT_FALSE(writer.write(1, 200, PinState::Low));
+    TEST_ASSERT_EQUAL_UINT32(4, writer.getDroppedCount());
+}
+
+static void test_reader_rejects_corrupt_traces()
+{
+    uint8_t buffer[64];
+    EdgeTraceWriter writer{buffer, sizeof(buffer)};
+    writer.write(3, 1000000, PinState::High);
+    // Bad magic and bad version
+    buffer[0] = 'X';
+    TEST_ASSERT_FALSE((EdgeTraceReader{buffer, writer.size()}.isValid()));
+    buffer[0] = 'A';
+    buffer[4] = EdgeTrace::s_VERSION + 1;
+    TEST_ASSERT_FALSE((EdgeTraceReader{buffer, writer.size()}.isValid()));
+    buffer[4] = EdgeTrace::s_VERSION;
+    // Truncated varint
+    EdgeTraceRecord record;
+    EdgeTraceReader truncated{buffer, writer.size() - 1};
+    TEST_ASSERT_TRUE(truncated.isValid());
+    TEST_ASSERT_FALSE(truncated.next(record));
+    TEST_ASSERT_FALSE(truncated.isValid());
+    // Pin out of range
+    buffer[EdgeTrace::s_HEADER_SIZE] = EdgeTrace::s_MAX_PINS;
+    EdgeTraceReader badPin{buffer, writer.size()};
+    TEST_ASSERT_FALSE(badPin.next(record));
+    TEST_ASSERT_FALSE(badPin.isValid());
+}
+
+static void test_debounce_filter_decisions()
+{
+    constexpr DebounceFilter filter{5000, 20000};
+    TEST_ASSERT_TRUE(DebounceFilter::onRawState(PinState::Unknown, PinState::Low) == DebounceFilter::Action::Commit);
+    TEST_ASSERT_TRUE(DebounceFilter::onRawState(PinState::Low, PinState::High) == DebounceFilter::Action::StartTimer);
+    TEST_ASSERT_TRUE(DebounceFilter::onRawState(PinState::Low, PinState::Low) == DebounceFilter::Action::StopTimer);
+    TEST_ASSERT_TRUE(DebounceFilter::onTimerExpired(PinState::Low, PinState::High));
+    TEST_ASSERT_FALSE(DebounceFilter::onTimerExpired(PinState::High, PinState::High));
+    TEST_ASSERT_EQUAL_UINT64(5000, filter.filterTimeUs(PinState::High));
+    TEST_ASSERT_EQUAL_UINT64(20000, filter.filterTimeUs(PinState::Low));
+}
+
+static void recordFiltered(void *const context, const EdgeTraceRecord &filtered)
+{
+    static_cast<std::vector<EdgeTraceRecord> *>(context)->push_back(filtered);
+}
+
+static void test_replay_filters_the_bounces()
+{
+    uint8_t buffer[256];
+    EdgeTraceWriter writer{buffer, sizeof(buffer)};
+    // Initial low, a bouncing press, a glitch shorter than the filter and a release
+    const EdgeTraceRecord raw[]{{2, 0, PinState::Low},
+                                {2, 10000, PinState::High},
+                                {2, 10300, PinState::Low},
+                                {2, 10500, PinState::High},
+                                {2, 50000, PinState::Low},
+                                {2, 52000, PinState::High},
+                                {2, 80000, PinState::Low},
+                                // Pin without a filter
+                                {9, 1000, PinState::High}};
+    for (const EdgeTraceRecord &record : raw)
+        TEST_ASSERT_TRUE(writer.write(record.pin, record.timeUs, record.state));
+    std::vector<EdgeTraceRecord> filtered;
+    EdgeTraceReplay replay{recordFiltered, &filtered};
+    TEST_ASSERT_TRUE(replay.addFilter(2, 5, 10));
+    TEST_ASSERT_FALSE(replay.addFilter(EdgeTrace::s_MAX_PINS, 5, 10));
+    EdgeTraceReader reader{writer.data(), writer.size()};
+    TEST_ASSERT_EQUAL_UINT(7, replay.run(reader));
+    // The timer still running at the end of the trace is expired
+    const EdgeTraceRecord expected[]{{2, 0, PinState::Low},
+                                     {2, 15500, PinState::High},
+                                     {2, 90000, PinState::Low}};
+    TEST_ASSERT_EQUAL_UINT(3, filtered.size());
+    TEST_ASSERT_EQUAL_UINT32(3, replay.getFilteredEdgeCount());
+    for (size_t i{0}; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(expected[i].pin, filtered[i].pin);
+        TEST_ASSERT_EQUAL_UINT64(expected[i].timeUs, filtered[i].timeUs);
+        TEST_ASSERT_TRUE(expected[i].state == filtered[i].state);
+    }
+    TEST_ASSERT_TRUE(replay.getFilteredState(2) == PinState::Low);
+    TEST_ASSERT_TRUE(replay.getFilteredState(9) == PinState::Unknown);
+}
+
+static void test_recorder_captures_the_edges()
+{
+    HostGpio::setLevel(PIN_RECORDED, false);
+    BasicInterrupt input(PIN_RECORDED, INPUT);
+    uint8_t buffer[512];
+    EdgeTraceRecorder recorder{buffer, sizeof(buffer)};
+    EdgeEvent storage[16];
+    TEST_ASSERT_TRUE(recorder.add(input, storage, 16));
+    for (uint8_t i{0}; i < 6; i++)
+    {
+        HostGpio::setLevel(PIN_RECORDED, !(i % 2));
+        TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) != PinState::Unknown);
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    TEST_ASSERT_EQUAL_UINT(6, recorder.poll());
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.getLostEventCount());
+    EdgeTraceReader reader{recorder.data(), recorder.size()};
+    EdgeTraceRecord record;
+    uint64_t previousUs{0};
+    for (uint8_t i{0}; i < 6; i++)
+    {
+        TEST_ASSERT_TRUE(reader.next(record));
+        TEST_ASSERT_EQUAL_UINT8(PIN_RECORDED, record.pin);
+        TEST_ASSERT_TRUE(record.state == (i % 2 ? PinState::Low : PinState::High));
+        // The edges were at least 2 ms apart
+        if (i)
+            TEST_ASSERT_TRUE(record.timeUs - previousUs >= 1000);
+        previousUs = record.timeUs;
+    }
+    TEST_ASSERT_FALSE(reader.next(record));
+}
+
+// Source of edges with chosen cycle counts, recorded like an interrupt object
+class FakeSource
+{
+public:
+    std::vector<EdgeEvent> events;
+
+    bool enableEventBuffer(EdgeEvent *const, const size_t) { return true; }
+    uint8_t getPin() const { return 3; }
+    uint32_t getEventOverflowCount() const { return 0; }
+    size_t drainEvents(EdgeEvent *const out, const size_t maxEvents)
+    {
+        size_t count{0};
+        for (; count < maxEvents && m_next < events.size(); count++)
+            out[count] = events[m_next++];
+        return count;
+    }
+
+private:
+    size_t m_next{0};
+};
+
+static void test_recorder_keeps_the_sub_microsecond_cycles()
+{
+    const uint32_t cyclesPerUs{ESP.getCpuFreqMHz()};
+    FakeSource source;
+    // Edges a bit less than 1 us apart, starting close to a wrap of the cycle counter
+    uint32_t cycles{UINT32_MAX - 100 * cyclesPerUs};
+    for (uint32_t i{0}; i < 1000; i++)
+    {
+        source.events.push_back({cycles, i % 2 ? PinState::Low : PinState::High});
+        cycles += cyclesPerUs - 1;
+    }
+    uint8_t buffer[4096];
+    EdgeTraceRecorder recorder{buffer, sizeof(buffer)};
+    TEST_ASSERT_TRUE(recorder.add(source, nullptr, 0));
+    TEST_ASSERT_EQUAL_UINT(1000, recorder.poll());
+    EdgeTraceReader reader{recorder.data(), recorder.size()};
+    EdgeTraceRecord record;
+    TEST_ASSERT_TRUE(reader.next(record));
+    const uint64_t firstUs{record.timeUs};
+    for (uint32_t i{1}; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(reader.next(record));
+        // The time of every edge is its cycle count truncated once, not an accumulated error
+        TEST_ASSERT_EQUAL_UINT64(firstUs + i * (cyclesPerUs - 1) / cyclesPerUs, record.timeUs);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_writer_rejects_invalid_edges);
+    RUN_TEST(test_reader_rejects_corrupt_traces);
+    RUN_TEST(test_debounce_filter_decisions);
+    RUN_TEST(test_replay_filters_the_bounces);
+    RUN_TEST(test_recorder_captures_the_edges);
+    RUN_TEST(test_recorder_keeps_the_sub_microsecond_cycles);
+    return UNITY_END();
+}
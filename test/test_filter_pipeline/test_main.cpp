@@ -0,0 +1,157 @@
+/**
+ * Tests of the FilterPipeline stages under a virtual clock and of PipelineInterrupt on the
+ * simulated GPIOs, including its teardown while edges arrive.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/PipelineInterrupt.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+static constexpr uint8_t PIN_PIPELINE{20};
+static constexpr uint64_t NEVER{DeadlineQueue::s_NEVER};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_debounce_holds_each_state()
+{
+    Debounce<5, 10> stage;
+    TEST_ASSERT_TRUE(stage.update(PinState::Unknown, 0) == PinState::Unknown);
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 0) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 1000) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(6000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 6000) == PinState::High);
+    // A glitch back to the output stops the hold time
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 7000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(17000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 8000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, stage.nextUpdateUs());
+}
+
+static void test_min_hold_keeps_the_output()
+{
+    MinHold<10> stage;
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 0) == PinState::High);
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 1000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(10000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 10000) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, stage.nextUpdateUs());
+    // The new output is held too
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 10500) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(20000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 20000) == PinState::High);
+}
+
+static void test_majority_ignores_short_glitches()
+{
+    Majority<3, 1> stage;
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 0) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 0) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(1000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 1000) == PinState::Low);
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 2000) == PinState::High);
+    // A glitch between two samples is never sampled
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 2500) == PinState::High);
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 2600) == PinState::High);
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 3000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, stage.nextUpdateUs());
+    // A long gap only takes the samples that can change the window
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 100000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(101000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 101000) == PinState::High);
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 102000) == PinState::Low);
+}
+
+static void test_rate_limit_spends_its_credit()
+{
+    RateLimit<2, 1000> stage;
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 0) == PinState::Low);
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 1000) == PinState::High);
+    TEST_ASSERT_TRUE(stage.update(PinState::Low, 2000) == PinState::Low);
+    // The bucket is empty, the edge waits for the credit of one edge
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 3000) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(501000, stage.nextUpdateUs());
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 500999) == PinState::Low);
+    TEST_ASSERT_TRUE(stage.update(PinState::High, 501000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, stage.nextUpdateUs());
+}
+
+static void test_pipeline_chains_the_stages()
+{
+    FilterPipeline<Debounce<5>, MinHold<20>> pipeline;
+    TEST_ASSERT_TRUE(pipeline.update(PinState::Low, 0) == PinState::Low);
+    TEST_ASSERT_TRUE(pipeline.update(PinState::High, 1000) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(6000, pipeline.nextUpdateUs());
+    // The debounced edge reaches MinHold on the same update, which holds the initial Low
+    TEST_ASSERT_TRUE(pipeline.update(PinState::High, 6000) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, pipeline.getStage<0>().nextUpdateUs());
+    TEST_ASSERT_EQUAL_UINT64(20000, pipeline.nextUpdateUs());
+    TEST_ASSERT_TRUE(pipeline.update(PinState::High, 20000) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT64(NEVER, pipeline.nextUpdateUs());
+}
+
+static void test_pipeline_interrupt_delivers_filtered_edges()
+{
+    HostGpio::setLevel(PIN_PIPELINE, false);
+    PipelineInterrupt<FilterPipeline<Debounce<5>>> input(PIN_PIPELINE, INPUT);
+    HostGpio::setLevel(PIN_PIPELINE, true);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) == PinState::High);
+    // A glitch shorter than the debounce time is not delivered
+    HostGpio::setLevel(PIN_PIPELINE, false);
+    HostGpio::setLevel(PIN_PIPELINE, true);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(50)) == PinState::Unknown);
+    TEST_ASSERT_TRUE(input.getPipeline().getStage<0>().nextUpdateUs() == NEVER);
+}
+
+// Objects destroyed while their pipelines are running or due (run with the sanitizers)
+static void test_destroy_while_edges_arrive()
+{
+    using Input = PipelineInterrupt<FilterPipeline<Debounce<1>, MinHold<2>, RateLimit<100>>>;
+    std::atomic<bool> running{true};
+    std::thread generator{[&running]()
+                          {
+                              bool level{false};
+                              while (running.load())
+                              {
+                                  for (uint8_t pin{PIN_PIPELINE}; pin < PIN_PIPELINE + 4; pin++)
+                                      HostGpio::setLevel(pin, level);
+                                  level = !level;
+                                  std::this_thread::sleep_for(std::chrono::microseconds(300));
+                              }
+                          }};
+    for (uint32_t i{0}; i < 100; i++)
+    {
+        Input *inputs[4];
+        for (uint8_t pin{0}; pin < 4; pin++)
+            inputs[pin] = new Input(PIN_PIPELINE + pin, INPUT);
+        vTaskDelay(1 + i % 3);
+        for (Input *const input : inputs)
+            delete input;
+    }
+    running = false;
+    generator.join();
+    // The worker keeps running for new objects
+    test_pipeline_interrupt_delivers_filtered_edges();
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_debounce_holds_each_state);
+    RUN_TEST(test_min_hold_keeps_the_output);
+    RUN_TEST(test_majority_ignores_short_glitches);
+    RUN_TEST(test_rate_limit_spends_its_credit);
+    RUN_TEST(test_pipeline_chains_the_stages);
+    RUN_TEST(test_pipeline_interrupt_delivers_filtered_edges);
+    RUN_TEST(test_destroy_while_edges_arrive);
+    return UNITY_END();
+}
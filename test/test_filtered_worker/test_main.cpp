@@ -0,0 +1,136 @@
+/**
+ * Tests of the ready queue of the filtered-interrupt worker (MPSCQueue) and of the teardown
+ * of FilteredInterrupt objects while their worker is processing them.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Core/MPSCQueue.h>
+#include <ArduinoToolkit/Interrupt/FilteredInterrupt.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+static constexpr uint8_t PIN_FILTERED{12};
+
+void setUp() {}
+void tearDown() {}
+
+struct Item : MPSCQueueNode
+{
+    uint32_t producer{0};
+    uint32_t sequence{0};
+};
+
+static void test_pop_empty_queue()
+{
+    MPSCQueue queue;
+    TEST_ASSERT_NULL(queue.pop());
+}
+
+static void test_single_producer_fifo()
+{
+    MPSCQueue queue;
+    Item items[5];
+    for (Item &item : items)
+        queue.push(&item);
+    for (Item &item : items)
+        TEST_ASSERT_EQUAL_PTR(&item, queue.pop());
+    TEST_ASSERT_NULL(queue.pop());
+    // Nodes can be pushed again once popped
+    queue.push(&items[2]);
+    TEST_ASSERT_EQUAL_PTR(&items[2], queue.pop());
+    TEST_ASSERT_NULL(queue.pop());
+}
+
+static void test_multiple_producers_keep_their_order()
+{
+    static constexpr uint32_t PRODUCERS{4};
+    static constexpr uint32_t ITEMS{20000};
+    MPSCQueue queue;
+    std::vector<Item> items(PRODUCERS * ITEMS);
+    std::vector<std::thread> producers;
+    for (uint32_t producer{0}; producer < PRODUCERS; producer++)
+        producers.emplace_back([&, producer]()
+                               {
+                                   for (uint32_t i{0}; i < ITEMS; i++)
+                                   {
+                                       Item &item{items[producer * ITEMS + i]};
+                                       item.producer = producer;
+                                       item.sequence = i;
+                                       queue.push(&item);
+                                   } });
+    uint32_t next[PRODUCERS]{};
+    uint32_t popped{0};
+    bool ordered{true};
+    while (popped < PRODUCERS * ITEMS)
+    {
+        const Item *const item{static_cast<const Item *>(queue.pop())};
+        if (!item)
+            continue;
+        ordered &= item->sequence == next[item->producer]++;
+        popped++;
+    }
+    for (std::thread &producer : producers)
+        producer.join();
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_NULL(queue.pop());
+}
+
+static void test_filtered_edge_is_delivered()
+{
+    HostGpio::setLevel(PIN_FILTERED, false);
+    FilteredInterrupt input(PIN_FILTERED, INPUT, 5, 5);
+    HostGpio::setLevel(PIN_FILTERED, true);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) == PinState::High);
+    // A glitch shorter than the filter time is not delivered
+    HostGpio::setLevel(PIN_FILTERED, false);
+    HostGpio::setLevel(PIN_FILTERED, true);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(50)) == PinState::Unknown);
+}
+
+// Objects destroyed while the worker is filtering their raw edges (run with the sanitizers)
+static void test_destroy_while_edges_arrive()
+{
+    std::atomic<bool> running{true};
+    std::thread generator{[&running]()
+                          {
+                              bool level{false};
+                              while (running.load())
+                              {
+                                  for (uint8_t pin{PIN_FILTERED}; pin < PIN_FILTERED + 4; pin++)
+                                      HostGpio::setLevel(pin, level);
+                                  level = !level;
+                                  std::this_thread::sleep_for(std::chrono::microseconds(200));
+                              }
+                          }};
+    for (uint32_t i{0}; i < 100; i++)
+    {
+        FilteredInterrupt *inputs[4];
+        for (uint8_t pin{0}; pin < 4; pin++)
+            inputs[pin] = new FilteredInterrupt(PIN_FILTERED + pin, INPUT, 1, 1);
+        vTaskDelay(1 + i % 3);
+        for (FilteredInterrupt *const input : inputs)
+            delete input;
+    }
+    running = false;
+    generator.join();
+    // The worker keeps running for new objects
+    test_filtered_edge_is_delivered();
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pop_empty_queue);
+    RUN_TEST(test_single_producer_fifo);
+    RUN_TEST(test_multiple_producers_keep_their_order);
+    RUN_TEST(test_filtered_edge_is_delivered);
+    RUN_TEST(test_destroy_while_edges_arrive);
+    return UNITY_END();
+}
@@ -0,0 +1,121 @@
+/**
+ * Tests of LogFormat, the encoding of the deferred log records and their formatting, against
+ * the text of snprintf for the same arguments.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Core/LogFormat.h>
+
+using namespace AT;
+using namespace AT::LogFormat;
+
+void setUp() {}
+void tearDown() {}
+
+// Words of a record of the arguments, as a deferred log call site encodes them
+template <typename... Args>
+static size_t encodeRecord(uint32_t *const words, const Args... args)
+{
+    size_t count{2};
+    ((count += encodeArg(words + count, args)), ...);
+    words[0] = header(1, static_cast<uint8_t>(count), 3);
+    words[1] = types<Args...>();
+    return count;
+}
+
+// Format the record of the arguments and compare the text with snprintf
+template <typename... Args>
+static void checkRoundTrip(const char *const format, const Args... args)
+{
+    uint32_t words[maxRecordWords<Args...>()];
+    const size_t count{encodeRecord(words, args...)};
+    TEST_ASSERT_EQUAL_UINT(count, headerWords(words[0]));
+    char expected[256];
+    std::snprintf(expected, sizeof(expected), format, args...);
+    char text[256];
+    TEST_ASSERT_EQUAL_UINT(std::strlen(expected), formatRecord(text, sizeof(text), format, words, count));
+    TEST_ASSERT_EQUAL_STRING(expected, text);
+}
+
+static void test_numbers_match_snprintf()
+{
+    checkRoundTrip("%d %i %5d|%-5d|", int32_t{-5}, int32_t{INT32_MIN}, int32_t{42}, int32_t{7});
+    checkRoundTrip("%u %x %08X %o", uint32_t{4000000000U}, uint32_t{0xBEEF}, uint32_t{0xC0FFEE}, uint32_t{8});
+    checkRoundTrip("%lld %llu %llx", int64_t{-1234567890123LL}, uint64_t{UINT64_MAX}, uint64_t{0x123456789ABCDEFULL});
+    checkRoundTrip("%ld %lu", long{-70000}, static_cast<unsigned long>(70000));
+    checkRoundTrip("%f %.3f %e %g %8.2f", 3.25, -0.0001, 6.02e23, 1e-10, 2.0 / 3);
+    checkRoundTrip("%c%c", 'O', 'K');
+}
+
+static void test_pointers_strings_and_percent()
+{
+    int object{0};
+    checkRoundTrip("%p at %s", static_cast<void *>(&object), "object");
+    checkRoundTrip("%p", static_cast<const void *>(nullptr));
+    checkRoundTrip("100%% of %s (%-8s|%8s)", "edges", "left", "right");
+    checkRoundTrip("empty \"%s\"", "");
+    checkRoundTrip("no arguments, 50%%");
+}
+
+static void test_long_strings_are_truncated()
+{
+    const std::string longText(AT_DEFERRED_LOG_MAX_STRING + 10, 'x');
+    uint32_t words[maxRecordWords<const char *>()];
+    const size_t count{encodeRecord(words, longText.c_str())};
+    TEST_ASSERT_EQUAL_UINT(2 + s_STRING_WORDS, count);
+    char text[128];
+    formatRecord(text, sizeof(text), "<%s>", words, count);
+    TEST_ASSERT_EQUAL_STRING(("<" + longText.substr(0, AT_DEFERRED_LOG_MAX_STRING) + ">").c_str(), text);
+    // A null string is empty
+    const size_t nullCount{encodeRecord(words, static_cast<const char *>(nullptr))};
+    formatRecord(text, sizeof(text), "<%s>", words, nullCount);
+    TEST_ASSERT_EQUAL_STRING("<>", text);
+}
+
+static void test_short_output_buffer()
+{
+    uint32_t words[maxRecordWords<int32_t, const char *, double>()];
+    const size_t count{encodeRecord(words, int32_t{-123456}, "text", 1.5)};
+    const char *const format{"value %d, %s: %.2f%%"};
+    char full[64];
+    const int fullLength{std::snprintf(full, sizeof(full), format, -123456, "text", 1.5)};
+    // Every size cuts the text where snprintf does, the output is always terminated
+    for (size_t size{1}; size <= static_cast<size_t>(fullLength) + 1; size++)
+    {
+        char expected[64];
+        std::snprintf(expected, size, format, -123456, "text", 1.5);
+        char text[64];
+        std::memset(text, '#', sizeof(text));
+        TEST_ASSERT_EQUAL_UINT(std::strlen(expected), formatRecord(text, size, format, words, count));
+        TEST_ASSERT_EQUAL_STRING(expected, text);
+        TEST_ASSERT_EQUAL_UINT8('#', text[size]);
+    }
+    char untouched{'#'};
+    TEST_ASSERT_EQUAL_UINT(0, formatRecord(&untouched, 0, format, words, count));
+    TEST_ASSERT_EQUAL_UINT8('#', untouched);
+}
+
+static void test_missing_arguments()
+{
+    uint32_t words[maxRecordWords<int32_t>()];
+    const size_t count{encodeRecord(words, int32_t{1})};
+    char text[64];
+    formatRecord(text, sizeof(text), "%d %d", words, count);
+    TEST_ASSERT_EQUAL_STRING("1 <?>", text);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_numbers_match_snprintf);
+    RUN_TEST(test_pointers_strings_and_percent);
+    RUN_TEST(test_long_strings_are_truncated);
+    RUN_TEST(test_short_output_buffer);
+    RUN_TEST(test_missing_arguments);
+    return UNITY_END();
+}
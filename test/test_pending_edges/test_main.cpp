@@ -0,0 +1,119 @@
+/**
+ * Tests of PendingEdges, the packed state and pending edge count of the interrupt classes.
+ */
+
+#include <thread>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/PendingEdges.h>
+
+using namespace AT;
+
+void setUp() {}
+void tearDown() {}
+
+// Record "count" alternating edges starting with High
+static void toggle(PendingEdges &edges, const uint32_t count)
+{
+    for (uint32_t i{0}; i < count; i++)
+        edges.update(edges.getState() == PinState::High ? PinState::Low : PinState::High);
+}
+
+static void test_starts_unknown_without_edges()
+{
+    PendingEdges edges;
+    uint32_t taken{1};
+    TEST_ASSERT_TRUE(edges.getState() == PinState::Unknown);
+    TEST_ASSERT_TRUE(edges.take(ReceiveMode::Next, taken) == PinState::Unknown);
+    TEST_ASSERT_EQUAL_UINT32(0, taken);
+}
+
+static void test_update_only_counts_changes()
+{
+    PendingEdges edges;
+    TEST_ASSERT_TRUE(edges.update(PinState::Low));
+    TEST_ASSERT_FALSE(edges.update(PinState::Low));
+    TEST_ASSERT_TRUE(edges.update(PinState::High));
+    TEST_ASSERT_FALSE(edges.update(PinState::High));
+    TEST_ASSERT_EQUAL_UINT32(2, edges.getPending());
+    TEST_ASSERT_TRUE(edges.getState() == PinState::High);
+}
+
+static void test_next_returns_edges_in_order()
+{
+    PendingEdges edges;
+    toggle(edges, 5);
+    uint32_t taken;
+    for (uint32_t i{0}; i < 5; i++)
+    {
+        TEST_ASSERT_TRUE(edges.take(ReceiveMode::Next, taken) == (i % 2 ? PinState::Low : PinState::High));
+        TEST_ASSERT_EQUAL_UINT32(1, taken);
+    }
+    TEST_ASSERT_TRUE(edges.take(ReceiveMode::Next, taken) == PinState::Unknown);
+}
+
+static void test_discard_intermediate_keeps_parity()
+{
+    uint32_t taken;
+    // Odd number of edges, the state has changed: the last edge is returned
+    PendingEdges odd;
+    toggle(odd, 5);
+    TEST_ASSERT_TRUE(odd.take(ReceiveMode::DiscardIntermediate, taken) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT32(5, taken);
+    TEST_ASSERT_EQUAL_UINT32(0, odd.getPending());
+    // Even number of edges: all but one are consumed, the next receive sees the last one
+    PendingEdges even;
+    toggle(even, 4);
+    TEST_ASSERT_TRUE(even.take(ReceiveMode::DiscardIntermediate, taken) == PinState::High);
+    TEST_ASSERT_EQUAL_UINT32(3, taken);
+    TEST_ASSERT_TRUE(even.take(ReceiveMode::DiscardIntermediate, taken) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT32(1, taken);
+}
+
+static void test_last_consumes_everything()
+{
+    PendingEdges edges;
+    toggle(edges, 6);
+    uint32_t taken;
+    TEST_ASSERT_TRUE(edges.take(ReceiveMode::Last, taken) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT32(6, taken);
+    TEST_ASSERT_EQUAL_UINT32(0, edges.getPending());
+    TEST_ASSERT_TRUE(edges.getState() == PinState::Low);
+}
+
+static void test_concurrent_update_and_take()
+{
+    static constexpr uint32_t EDGES{100000};
+    PendingEdges edges;
+    std::thread producer{[&edges]()
+                         { toggle(edges, EDGES); }};
+    uint32_t received{0};
+    PinState previous{PinState::Low};
+    bool alternating{true};
+    while (received < EDGES)
+    {
+        uint32_t taken;
+        const PinState state{edges.take(ReceiveMode::Next, taken)};
+        if (state == PinState::Unknown)
+            continue;
+        alternating &= state != previous;
+        previous = state;
+        received += taken;
+    }
+    producer.join();
+    TEST_ASSERT_TRUE(alternating);
+    TEST_ASSERT_EQUAL_UINT32(EDGES, received);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_unknown_without_edges);
+    RUN_TEST(test_update_only_counts_changes);
+    RUN_TEST(test_next_returns_edges_in_order);
+    RUN_TEST(test_discard_intermediate_keeps_parity);
+    RUN_TEST(test_last_consumes_everything);
+    RUN_TEST(test_concurrent_update_and_take);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+/**
+ * Tests of Pool, the fixed-block allocator of the toolkit internals, and of its containers.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Core/Pool.h>
+
+using namespace AT;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_blocks_are_aligned_and_distinct()
+{
+    const PoolStats before{Pool::getStats(0)};
+    std::vector<void *> blocks;
+    for (uint16_t i{0}; i < before.blocks - before.inUse; i++)
+    {
+        void *const block{Pool::allocate(before.blockSize)};
+        TEST_ASSERT_NOT_NULL(block);
+        TEST_ASSERT_EQUAL_UINT(0, reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t));
+        std::memset(block, 0xA5, before.blockSize);
+        blocks.push_back(block);
+    }
+    std::vector<void *> sorted{blocks};
+    std::sort(sorted.begin(), sorted.end());
+    TEST_ASSERT_TRUE(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    const PoolStats full{Pool::getStats(0)};
+    TEST_ASSERT_EQUAL_UINT16(full.blocks, full.inUse);
+    TEST_ASSERT_EQUAL_UINT16(full.blocks, full.peak);
+    for (void *const block : blocks)
+        Pool::deallocate(block);
+    const PoolStats after{Pool::getStats(0)};
+    TEST_ASSERT_EQUAL_UINT16(before.inUse, after.inUse);
+    TEST_ASSERT_EQUAL_UINT16(full.peak, after.peak);
+    TEST_ASSERT_EQUAL_UINT32(before.allocations + full.blocks - before.inUse, after.allocations);
+}
+
+static void test_exhausted_class_falls_back_to_the_heap()
+{
+    const PoolStats before{Pool::getStats(0)};
+    std::vector<void *> blocks;
+    for (uint16_t i{0}; i < before.blocks - before.inUse; i++)
+        blocks.push_back(Pool::allocate(1));
+    void *const fallback{Pool::allocate(before.blockSize)};
+    TEST_ASSERT_NOT_NULL(fallback);
+    TEST_ASSERT_EQUAL_UINT32(before.failures + 1, Pool::getStats(0).failures);
+    Pool::deallocate(fallback);
+    // A freed block is the next one given
+    Pool::deallocate(blocks.back());
+    TEST_ASSERT_EQUAL_PTR(blocks.back(), Pool::allocate(1));
+    for (void *const block : blocks)
+        Pool::deallocate(block);
+    TEST_ASSERT_EQUAL_UINT16(before.inUse, Pool::getStats(0).inUse);
+}
+
+static void test_sizes_go_to_the_smallest_class()
+{
+    for (size_t sizeClass{0}; sizeClass < Pool::s_NUM_SIZE_CLASSES; sizeClass++)
+    {
+        const PoolStats before{Pool::getStats(sizeClass)};
+        if (!before.blocks)
+            continue;
+        if (sizeClass)
+            TEST_ASSERT_TRUE(before.blockSize > Pool::getStats(sizeClass - 1).blockSize);
+        void *const block{Pool::allocate(before.blockSize)};
+        TEST_ASSERT_EQUAL_UINT32(before.allocations + 1, Pool::getStats(sizeClass).allocations);
+        Pool::deallocate(block);
+    }
+    const uint32_t oversized{Pool::getOversizedCount()};
+    Pool::deallocate(Pool::allocate(4096));
+    TEST_ASSERT_EQUAL_UINT32(oversized + 1, Pool::getOversizedCount());
+}
+
+static void test_concurrent_allocations()
+{
+    static constexpr uint32_t THREADS{4};
+    const PoolStats before{Pool::getStats(1)};
+    std::vector<std::thread> threads;
+    bool intact[THREADS]{};
+    for (uint32_t thread{0}; thread < THREADS; thread++)
+        threads.emplace_back([thread, &intact]()
+                             {
+                                 bool ok{true};
+                                 for (uint32_t i{0}; i < 20000; i++)
+                                 {
+                                     uint8_t *const block{static_cast<uint8_t *>(Pool::allocate(48))};
+                                     std::memset(block, static_cast<int>(thread), 48);
+                                     std::this_thread::yield();
+                                     ok &= std::count(block, block + 48, thread) == 48;
+                                     Pool::deallocate(block);
+                                 }
+                                 intact[thread] = ok; });
+    for (std::thread &thread : threads)
+        thread.join();
+    for (const bool ok : intact)
+        TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_UINT16(before.inUse, Pool::getStats(1).inUse);
+}
+
+static void test_containers()
+{
+    PoolVector<uint32_t> vector;
+    for (uint32_t i{0}; i < 40; i++)
+        vector.push_back(i);
+    TEST_ASSERT_EQUAL_UINT32(39, vector[39]);
+    const PoolString string{"host.s3.amazonaws.com/firmware.bin"};
+    TEST_ASSERT_EQUAL_UINT(21, string.find('/'));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_blocks_are_aligned_and_distinct);
+    RUN_TEST(test_exhausted_class_falls_back_to_the_heap);
+    RUN_TEST(test_sizes_go_to_the_smallest_class);
+    RUN_TEST(test_concurrent_allocations);
+    RUN_TEST(test_containers);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+/**
+ * Tests of the pulse math of PulseInput (WrappingCounter and PulseWindow) and of PulseInput
+ * driven by a fake backend.
+ */
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/PulseInput.h>
+
+using namespace AT;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_counter_extends_across_overflows()
+{
+    WrappingCounter counter{1000};
+    TEST_ASSERT_EQUAL_UINT64(0, counter.extend(0, 0));
+    TEST_ASSERT_EQUAL_UINT64(999, counter.extend(0, 999));
+    TEST_ASSERT_EQUAL_UINT64(1005, counter.extend(1, 5));
+    TEST_ASSERT_EQUAL_UINT64(3200, counter.extend(3, 200));
+    TEST_ASSERT_EQUAL_UINT32(1000, counter.getModulus());
+}
+
+static void test_counter_corrects_a_late_overflow()
+{
+    WrappingCounter counter{1000};
+    TEST_ASSERT_EQUAL_UINT64(990, counter.extend(0, 990));
+    // The counter wrapped but its overflow has not been counted yet
+    TEST_ASSERT_EQUAL_UINT64(1010, counter.extend(0, 10));
+    // Once counted the total does not move backwards
+    TEST_ASSERT_EQUAL_UINT64(1020, counter.extend(1, 20));
+}
+
+static void test_counter_survives_the_overflow_count_wrap()
+{
+    WrappingCounter counter{0x10000};
+    counter.extend(UINT32_MAX, 0);
+    const uint64_t before{counter.extend(UINT32_MAX, 100)};
+    TEST_ASSERT_EQUAL_UINT64(static_cast<uint64_t>(UINT32_MAX) * 0x10000 + 100, before);
+    TEST_ASSERT_EQUAL_UINT64(before + 0x10000, counter.extend(0, 100));
+}
+
+static void test_first_sample_only_opens_a_window()
+{
+    PulseWindow window;
+    PulseMeasurement measurement{};
+    TEST_ASSERT_FALSE(window.update({1000, 10, 0, false}, measurement));
+    // An empty window gives no measurement either
+    TEST_ASSERT_FALSE(window.update({1000, 20, 0, false}, measurement));
+    TEST_ASSERT_TRUE(window.update({2000, 30, 0, false}, measurement));
+    TEST_ASSERT_EQUAL_UINT32(10, measurement.count);
+    TEST_ASSERT_EQUAL_UINT64(30, measurement.totalCount);
+}
+
+static void test_window_frequency_and_duty_cycle()
+{
+    PulseWindow window;
+    PulseMeasurement measurement{};
+    window.update({1000000, 500, 200000, true}, measurement);
+    TEST_ASSERT_TRUE(window.update({1500000, 1000, 400000, true}, measurement));
+    TEST_ASSERT_EQUAL_UINT32(500, measurement.count);
+    TEST_ASSERT_EQUAL_UINT64(500000, measurement.windowUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1000.0f, measurement.frequencyHz);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.4f, measurement.dutyCycle);
+    // The high time read slightly after the window is capped
+    TEST_ASSERT_TRUE(window.update({1600000, 1100, 510000, true}, measurement));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, measurement.dutyCycle);
+    // Without high time there is no duty cycle
+    TEST_ASSERT_TRUE(window.update({1700000, 1200, 0, false}, measurement));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, measurement.dutyCycle);
+}
+
+// Backend with a 10 kHz input and a 25% duty cycle
+class FakeBackend : public PulseBackend
+{
+public:
+    uint8_t getPin() const override { return 0; }
+    PinState getState() const override { return PinState::Low; }
+    uint64_t readCount() override { return esp_timer_get_time() / 100; }
+    bool hasHighTime() const override { return true; }
+    uint64_t readHighTimeUs() override { return esp_timer_get_time() / 4; }
+};
+
+static void test_pulse_input_measures_the_backend()
+{
+    FakeBackend backend;
+    PulseInput input(backend, 50);
+    PulseMeasurement measurement{};
+    TEST_ASSERT_TRUE(input.receiveMeasurement(measurement, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_FLOAT_WITHIN(500.0f, 10000.0f, measurement.frequencyHz);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.25f, measurement.dutyCycle);
+    TEST_ASSERT_EQUAL_UINT64(measurement.totalCount, input.getCount());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_extends_across_overflows);
+    RUN_TEST(test_counter_corrects_a_late_overflow);
+    RUN_TEST(test_counter_survives_the_overflow_count_wrap);
+    RUN_TEST(test_first_sample_only_opens_a_window);
+    RUN_TEST(test_window_frequency_and_duty_cycle);
+    RUN_TEST(test_pulse_input_measures_the_backend);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+/**
+ * Tests of ReadySet, the ready bitmask of the interrupt objects with pending edges.
+ */
+
+#include <memory>
+#include <thread>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Core.h>
+#include <ArduinoToolkit/Core/BinarySemaphore.h>
+#include <ArduinoToolkit/Interrupt/BasicInterrupt.h>
+#include <ArduinoToolkit/Interrupt/ReadySet.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+// More objects than slots, on pins not used by the other tests
+static constexpr uint8_t PIN_FIRST{24};
+static constexpr uint8_t NUM_PINS{40};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_slots_are_unique_and_reused()
+{
+    ReadySet set;
+    int8_t slots[ReadySet::s_MAX_SLOTS];
+    uint32_t allocated{0};
+    for (int8_t &slot : slots)
+    {
+        slot = set.allocateSlot();
+        TEST_ASSERT_TRUE(slot != ReadySet::s_NO_SLOT);
+        TEST_ASSERT_FALSE(allocated & ReadySet::slotMask(slot));
+        allocated |= ReadySet::slotMask(slot);
+    }
+    TEST_ASSERT_EQUAL(ReadySet::s_NO_SLOT, set.allocateSlot());
+    set.releaseSlot(slots[5]);
+    TEST_ASSERT_EQUAL(slots[5], set.allocateSlot());
+    TEST_ASSERT_EQUAL_UINT32(0, ReadySet::slotMask(ReadySet::s_NO_SLOT));
+}
+
+static void test_receive_clears_the_bit_once_drained()
+{
+    ReadySet set;
+    BinarySemaphore semaphore;
+    PendingEdges edges;
+    const int8_t slot{set.allocateSlot()};
+    edges.update(PinState::High);
+    edges.update(PinState::Low);
+    set.mark(slot);
+    TEST_ASSERT_EQUAL_UINT32(ReadySet::slotMask(slot), set.getMask());
+    TEST_ASSERT_TRUE(set.receive(edges, semaphore, slot, ReceiveMode::Next, 0) == PinState::High);
+    // One edge is still pending
+    TEST_ASSERT_EQUAL_UINT32(ReadySet::slotMask(slot), set.getMask());
+    TEST_ASSERT_TRUE(set.receive(edges, semaphore, slot, ReceiveMode::Next, 0) == PinState::Low);
+    TEST_ASSERT_EQUAL_UINT32(0, set.getMask());
+    TEST_ASSERT_TRUE(set.receive(edges, semaphore, slot, ReceiveMode::Next, 0) == PinState::Unknown);
+}
+
+static void test_receive_times_out()
+{
+    ReadySet set;
+    BinarySemaphore semaphore;
+    PendingEdges edges;
+    const int8_t slot{set.allocateSlot()};
+    const TickType_t start{xTaskGetTickCount()};
+    TEST_ASSERT_TRUE(set.receive(edges, semaphore, slot, ReceiveMode::Next, pdMS_TO_TICKS(50)) == PinState::Unknown);
+    TEST_ASSERT_TRUE(xTaskGetTickCount() - start >= pdMS_TO_TICKS(50));
+}
+
+static void test_wait_wakes_up_on_mark()
+{
+    ReadySet set;
+    const int8_t slot{set.allocateSlot()};
+    TEST_ASSERT_EQUAL_UINT32(0, set.wait(0));
+    std::thread producer{[&set, slot]()
+                         {
+                             vTaskDelay(pdMS_TO_TICKS(20));
+                             BaseType_t woken{pdFALSE};
+                             set.markFromISR(slot, &woken);
+                         }};
+    TEST_ASSERT_EQUAL_UINT32(ReadySet::slotMask(slot), set.wait(pdMS_TO_TICKS(1000)));
+    producer.join();
+}
+
+static void test_mark_mask_sets_several_bits()
+{
+    ReadySet set;
+    const int8_t first{set.allocateSlot()};
+    const int8_t second{set.allocateSlot()};
+    BaseType_t woken{pdFALSE};
+    set.markMaskFromISR(ReadySet::slotMask(first) | ReadySet::slotMask(second), &woken);
+    TEST_ASSERT_EQUAL_UINT32(ReadySet::slotMask(first) | ReadySet::slotMask(second), set.wait(0));
+    set.releaseSlot(first);
+    TEST_ASSERT_EQUAL_UINT32(ReadySet::slotMask(second), set.getMask());
+}
+
+static void test_objects_without_slot_wake_wait_any()
+{
+    ReadySet set;
+    for (uint8_t i{0}; i < ReadySet::s_MAX_SLOTS; i++)
+        set.allocateSlot();
+    TEST_ASSERT_FALSE(set.waitAny(0));
+    std::thread producer{[&set]()
+                         {
+                             vTaskDelay(pdMS_TO_TICKS(20));
+                             BaseType_t woken{pdFALSE};
+                             set.markFromISR(ReadySet::s_NO_SLOT, &woken);
+                         }};
+    TEST_ASSERT_TRUE(set.waitAny(pdMS_TO_TICKS(1000)));
+    producer.join();
+    // They are reported once and never appear in the mask
+    TEST_ASSERT_FALSE(set.waitAny(0));
+    TEST_ASSERT_EQUAL_UINT32(0, set.getMask());
+    set.mark(ReadySet::s_NO_SLOT);
+    TEST_ASSERT_EQUAL_UINT32(0, set.wait(0));
+    TEST_ASSERT_TRUE(set.waitAny(0));
+}
+
+static void test_interrupts_past_the_slots_keep_working()
+{
+    std::unique_ptr<BasicInterrupt> inputs[NUM_PINS];
+    for (uint8_t i{0}; i < NUM_PINS; i++)
+    {
+        HostGpio::setLevel(PIN_FIRST + i, false);
+        inputs[i].reset(new BasicInterrupt(PIN_FIRST + i, INPUT));
+    }
+    BasicInterrupt &last{*inputs[NUM_PINS - 1]};
+    TEST_ASSERT_EQUAL_UINT32(0, last.getInterruptMask());
+    TEST_ASSERT_TRUE(inputs[0]->getInterruptMask() != 0);
+    BasicInterrupt::waitUntilAnyInterrupt(0);
+    HostGpio::setLevel(PIN_FIRST + NUM_PINS - 1, true);
+    TEST_ASSERT_TRUE(BasicInterrupt::waitUntilAnyInterrupt(pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_TRUE(last.receiveInterrupt(0) == PinState::High);
+    HostGpio::setLevel(PIN_FIRST + NUM_PINS - 1, false);
+    TEST_ASSERT_TRUE(last.receiveInterrupt(pdMS_TO_TICKS(1000)) == PinState::Low);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_slots_are_unique_and_reused);
+    RUN_TEST(test_receive_clears_the_bit_once_drained);
+    RUN_TEST(test_receive_times_out);
+    RUN_TEST(test_wait_wakes_up_on_mark);
+    RUN_TEST(test_mark_mask_sets_several_bits);
+    RUN_TEST(test_objects_without_slot_wake_wait_any);
+    RUN_TEST(test_interrupts_past_the_slots_keep_working);
+    return UNITY_END();
+}
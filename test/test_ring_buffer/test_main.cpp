@@ -0,0 +1,141 @@
+/**
+ * Tests of SPSCRingBuffer and the edge event buffer of BasicInterrupt.
+ */
+
+#include <thread>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Core/RingBuffer.h>
+#include <ArduinoToolkit/Interrupt/BasicInterrupt.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+static constexpr uint8_t PIN_EVENTS{4};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_assign_requires_power_of_two()
+{
+    uint32_t storage[8];
+    SPSCRingBuffer<uint32_t> buffer;
+    TEST_ASSERT_FALSE(buffer.isAssigned());
+    TEST_ASSERT_FALSE(buffer.assign(nullptr, 8));
+    TEST_ASSERT_FALSE(buffer.assign(storage, 0));
+    TEST_ASSERT_FALSE(buffer.assign(storage, 6));
+    TEST_ASSERT_TRUE(buffer.assign(storage, 8));
+    TEST_ASSERT_EQUAL_UINT(8, buffer.capacity());
+}
+
+static void test_push_pop_in_order_across_wrap()
+{
+    uint32_t storage[4];
+    SPSCRingBuffer<uint32_t> buffer{storage, 4};
+    uint32_t out[4];
+    uint32_t next{0};
+    for (uint32_t round{0}; round < 10; round++)
+    {
+        TEST_ASSERT_TRUE(buffer.push(next));
+        TEST_ASSERT_TRUE(buffer.push(next + 1));
+        TEST_ASSERT_TRUE(buffer.push(next + 2));
+        TEST_ASSERT_EQUAL_UINT(3, buffer.size());
+        TEST_ASSERT_EQUAL_UINT(3, buffer.pop(out, 4));
+        for (uint32_t i{0}; i < 3; i++)
+            TEST_ASSERT_EQUAL_UINT32(next + i, out[i]);
+        next += 3;
+    }
+    TEST_ASSERT_EQUAL_UINT(0, buffer.pop(out, 4));
+}
+
+static void test_full_buffer_drops_and_counts()
+{
+    uint32_t storage[4];
+    SPSCRingBuffer<uint32_t> buffer{storage, 4};
+    for (uint32_t i{0}; i < 4; i++)
+        TEST_ASSERT_TRUE(buffer.push(i));
+    TEST_ASSERT_FALSE(buffer.push(4));
+    TEST_ASSERT_EQUAL_UINT32(1, buffer.getOverflowCount());
+    uint32_t out[2];
+    TEST_ASSERT_EQUAL_UINT(2, buffer.pop(out, 2));
+    TEST_ASSERT_EQUAL_UINT32(0, out[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, out[1]);
+    TEST_ASSERT_TRUE(buffer.push(4));
+}
+
+static void test_push_many_is_all_or_nothing()
+{
+    uint32_t storage[4];
+    SPSCRingBuffer<uint32_t> buffer{storage, 4};
+    const uint32_t items[3]{7, 8, 9};
+    TEST_ASSERT_TRUE(buffer.push(items, 3));
+    TEST_ASSERT_FALSE(buffer.push(items, 2));
+    TEST_ASSERT_EQUAL_UINT(3, buffer.size());
+    TEST_ASSERT_EQUAL_UINT32(1, buffer.getOverflowCount());
+    uint32_t out[4];
+    TEST_ASSERT_EQUAL_UINT(3, buffer.pop(out, 4));
+    TEST_ASSERT_EQUAL_MEMORY(items, out, sizeof(items));
+}
+
+static void test_producer_and_consumer_threads()
+{
+    static constexpr uint32_t COUNT{200000};
+    uint32_t storage[64];
+    SPSCRingBuffer<uint32_t> buffer{storage, 64};
+    std::thread producer{[&buffer]()
+                         {
+                             for (uint32_t i{0}; i < COUNT;)
+                                 if (buffer.push(i))
+                                     i++;
+                         }};
+    uint32_t expected{0};
+    bool ordered{true};
+    while (expected < COUNT)
+    {
+        uint32_t out[16];
+        const size_t count{buffer.pop(out, 16)};
+        for (size_t i{0}; i < count; i++)
+            ordered &= out[i] == expected++;
+    }
+    producer.join();
+    TEST_ASSERT_TRUE(ordered);
+}
+
+static void test_basic_interrupt_records_every_edge()
+{
+    HostGpio::setLevel(PIN_EVENTS, false);
+    BasicInterrupt input(PIN_EVENTS, INPUT);
+    EdgeEvent storage[8];
+    TEST_ASSERT_FALSE(input.enableEventBuffer(storage, 6));
+    TEST_ASSERT_TRUE(input.enableEventBuffer(storage, 8));
+    TEST_ASSERT_FALSE(input.enableEventBuffer(storage, 8));
+    for (uint8_t i{0}; i < 6; i++)
+    {
+        HostGpio::setLevel(PIN_EVENTS, !(i % 2));
+        TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) != PinState::Unknown);
+    }
+    EdgeEvent events[8];
+    TEST_ASSERT_EQUAL_UINT(6, input.drainEvents(events, 8));
+    for (uint8_t i{0}; i < 6; i++)
+    {
+        TEST_ASSERT_TRUE(events[i].state == (i % 2 ? PinState::Low : PinState::High));
+        if (i)
+            TEST_ASSERT_TRUE(static_cast<int32_t>(events[i].cycles - events[i - 1].cycles) >= 0);
+    }
+    TEST_ASSERT_EQUAL_UINT(0, input.drainEvents(events, 8));
+    TEST_ASSERT_EQUAL_UINT32(0, input.getEventOverflowCount());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_assign_requires_power_of_two);
+    RUN_TEST(test_push_pop_in_order_across_wrap);
+    RUN_TEST(test_full_buffer_drops_and_counts);
+    RUN_TEST(test_push_many_is_all_or_nothing);
+    RUN_TEST(test_producer_and_consumer_threads);
+    RUN_TEST(test_basic_interrupt_records_every_edge);
+    return UNITY_END();
+}
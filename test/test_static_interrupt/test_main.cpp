@@ -0,0 +1,91 @@
+/**
+ * Tests of StaticBasicInterrupt, the BasicInterrupt whose pin and logic are template arguments.
+ */
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/StaticBasicInterrupt.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+static constexpr uint8_t PIN_LOW_BANK{5};
+static constexpr uint8_t PIN_REVERSED{6};
+static constexpr uint8_t PIN_HIGH_BANK{34};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_read_pin_uses_the_right_register()
+{
+    using LowBank = StaticBasicInterrupt<PIN_LOW_BANK, INPUT>;
+    using HighBank = StaticBasicInterrupt<PIN_HIGH_BANK, INPUT>;
+    HostGpio::setLevel(PIN_LOW_BANK, true);
+    HostGpio::setLevel(PIN_HIGH_BANK, false);
+    // Same bit in the other register
+    HostGpio::setLevel(PIN_HIGH_BANK - 32, false);
+    HostGpio::setLevel(PIN_LOW_BANK + 32, true);
+    TEST_ASSERT_TRUE(LowBank::readPin() == PinState::High);
+    TEST_ASSERT_TRUE(HighBank::readPin() == PinState::Low);
+    HostGpio::setLevel(PIN_HIGH_BANK, true);
+    HostGpio::setLevel(PIN_LOW_BANK, false);
+    TEST_ASSERT_TRUE(LowBank::readPin() == PinState::Low);
+    TEST_ASSERT_TRUE(HighBank::readPin() == PinState::High);
+}
+
+static void test_read_pin_reverses_the_logic()
+{
+    using Reversed = StaticBasicInterrupt<PIN_REVERSED, INPUT, true>;
+    HostGpio::setLevel(PIN_REVERSED, true);
+    TEST_ASSERT_TRUE(Reversed::readPin() == PinState::Low);
+    HostGpio::setLevel(PIN_REVERSED, false);
+    TEST_ASSERT_TRUE(Reversed::readPin() == PinState::High);
+}
+
+static void test_receives_the_edges()
+{
+    HostGpio::setLevel(PIN_LOW_BANK, false);
+    StaticBasicInterrupt<PIN_LOW_BANK, INPUT> input;
+    for (uint8_t i{0}; i < 6; i++)
+    {
+        HostGpio::setLevel(PIN_LOW_BANK, !(i % 2));
+        TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) == (i % 2 ? PinState::Low : PinState::High));
+    }
+    TEST_ASSERT_TRUE(input.getState() == PinState::Low);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(0) == PinState::Unknown);
+}
+
+static void test_receives_the_edges_reversed()
+{
+    HostGpio::setLevel(PIN_REVERSED, true);
+    StaticBasicInterrupt<PIN_REVERSED, INPUT, true> input;
+    HostGpio::setLevel(PIN_REVERSED, false);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) == PinState::High);
+    HostGpio::setLevel(PIN_REVERSED, true);
+    TEST_ASSERT_TRUE(input.receiveInterrupt(pdMS_TO_TICKS(1000)) == PinState::Low);
+}
+
+static void test_ready_mask_is_shared_with_basic_interrupt()
+{
+    HostGpio::setLevel(PIN_LOW_BANK, false);
+    HostGpio::setLevel(PIN_HIGH_BANK, false);
+    BasicInterrupt basic(PIN_HIGH_BANK, INPUT);
+    StaticBasicInterrupt<PIN_LOW_BANK, INPUT> input;
+    TEST_ASSERT_TRUE(basic.getInterruptMask() != input.getInterruptMask());
+    BasicInterrupt::waitForInterruptMask(0);
+    HostGpio::setLevel(PIN_LOW_BANK, true);
+    TEST_ASSERT_EQUAL_HEX32(input.getInterruptMask(), BasicInterrupt::waitForInterruptMask(pdMS_TO_TICKS(1000)) & input.getInterruptMask());
+    TEST_ASSERT_TRUE(input.receiveInterrupt(0) == PinState::High);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_read_pin_uses_the_right_register);
+    RUN_TEST(test_read_pin_reverses_the_logic);
+    RUN_TEST(test_receives_the_edges);
+    RUN_TEST(test_receives_the_edges_reversed);
+    RUN_TEST(test_ready_mask_is_shared_with_basic_interrupt);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+/**
+ * Tests of ThresholdScanner, the hysteresis detector of AnalogThresholdInterrupt.
+ */
+
+#include <random>
+#include <vector>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/ThresholdScanner.h>
+
+using namespace AT;
+
+static constexpr uint16_t LOW_THRESHOLD{1000};
+static constexpr uint16_t HIGH_THRESHOLD{3000};
+
+void setUp() {}
+void tearDown() {}
+
+// Sample by sample reference of the scanner
+static uint32_t scanScalar(const std::vector<uint16_t> &samples, bool &high)
+{
+    uint32_t crossings{0};
+    for (const uint16_t sample : samples)
+    {
+        if (high ? sample <= LOW_THRESHOLD : sample >= HIGH_THRESHOLD)
+        {
+            high = !high;
+            crossings++;
+        }
+    }
+    return crossings;
+}
+
+static void test_initial_state_is_low_inside_the_band()
+{
+    const ThresholdScanner scanner{LOW_THRESHOLD, HIGH_THRESHOLD};
+    TEST_ASSERT_FALSE(scanner.initialState(LOW_THRESHOLD));
+    TEST_ASSERT_FALSE(scanner.initialState(HIGH_THRESHOLD - 1));
+    TEST_ASSERT_TRUE(scanner.initialState(HIGH_THRESHOLD));
+}
+
+static void test_samples_inside_the_band_keep_the_state()
+{
+    const ThresholdScanner scanner{LOW_THRESHOLD, HIGH_THRESHOLD};
+    const std::vector<uint16_t> samples(100, 2000);
+    bool high{false};
+    TEST_ASSERT_EQUAL_UINT32(0, scanner.scan(samples.data(), samples.size(), high));
+    TEST_ASSERT_FALSE(high);
+    high = true;
+    TEST_ASSERT_EQUAL_UINT32(0, scanner.scan(samples.data(), samples.size(), high));
+    TEST_ASSERT_TRUE(high);
+}
+
+static void test_thresholds_are_inclusive()
+{
+    const ThresholdScanner scanner{LOW_THRESHOLD, HIGH_THRESHOLD};
+    const uint16_t samples[4]{HIGH_THRESHOLD - 1, HIGH_THRESHOLD, LOW_THRESHOLD + 1, LOW_THRESHOLD};
+    bool high{false};
+    TEST_ASSERT_EQUAL_UINT32(2, scanner.scan(samples, 4, high));
+    TEST_ASSERT_FALSE(high);
+    TEST_ASSERT_EQUAL_UINT32(1, scanner.scan(samples, 2, high));
+    TEST_ASSERT_TRUE(high);
+}
+
+// Crossings on every position around the chunk boundaries and in the tail of the block
+static void test_crossing_at_every_position()
+{
+    const ThresholdScanner scanner{LOW_THRESHOLD, HIGH_THRESHOLD};
+    static constexpr size_t COUNT{ThresholdScanner::s_CHUNK * 3 + 5};
+    for (size_t position{0}; position < COUNT; position++)
+    {
+        std::vector<uint16_t> samples(COUNT, 0);
+        samples[position] = 4095;
+        bool high{false};
+        TEST_ASSERT_EQUAL_UINT32(position + 1 < COUNT ? 2 : 1, scanner.scan(samples.data(), samples.size(), high));
+        TEST_ASSERT_EQUAL(position + 1 == COUNT, high);
+    }
+}
+
+static void test_matches_scalar_model()
+{
+    const ThresholdScanner scanner{LOW_THRESHOLD, HIGH_THRESHOLD};
+    std::minstd_rand random{3};
+    bool high{false};
+    bool expectedHigh{false};
+    for (uint32_t block{0}; block < 500; block++)
+    {
+        // Slow noisy signal, so blocks have from no crossings to many
+        std::vector<uint16_t> samples(1 + random() % 200);
+        int32_t level{static_cast<int32_t>(random() % 4096)};
+        for (uint16_t &sample : samples)
+        {
+            level += static_cast<int32_t>(random() % 401) - 200;
+            level = level < 0 ? 0 : (level > 4095 ? 4095 : level);
+            sample = static_cast<uint16_t>(level);
+        }
+        const uint32_t expected{scanScalar(samples, expectedHigh)};
+        TEST_ASSERT_EQUAL_UINT32(expected, scanner.scan(samples.data(), samples.size(), high));
+        TEST_ASSERT_EQUAL(expectedHigh, high);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_state_is_low_inside_the_band);
+    RUN_TEST(test_samples_inside_the_band_keep_the_state);
+    RUN_TEST(test_thresholds_are_inclusive);
+    RUN_TEST(test_crossing_at_every_position);
+    RUN_TEST(test_matches_scalar_model);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+/**
+ * Tests of VerticalCounter and of the BankDebouncer built on it.
+ */
+
+#include <random>
+
+#include <unity.h>
+
+#include <ArduinoToolkit/Interrupt/BankDebouncer.h>
+#include <ArduinoToolkit/Interrupt/VerticalCounter.h>
+
+#include "HostGpio.h"
+
+using namespace AT;
+
+static constexpr uint8_t PIN_BANK{18};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_toggles_after_samples_to_toggle()
+{
+    VerticalCounter<2> counter;
+    counter.reset(0);
+    for (uint32_t i{1}; i < VerticalCounter<2>::s_SAMPLES_TO_TOGGLE; i++)
+        TEST_ASSERT_EQUAL_HEX32(0, counter.update(0x5));
+    TEST_ASSERT_EQUAL_HEX32(0x5, counter.update(0x5));
+    TEST_ASSERT_EQUAL_HEX32(0x5, counter.getState());
+    // Stable inputs do not toggle again
+    TEST_ASSERT_EQUAL_HEX32(0, counter.update(0x5));
+}
+
+static void test_equal_sample_resets_the_count()
+{
+    VerticalCounter<3> counter;
+    counter.reset(0);
+    for (uint32_t i{1}; i < VerticalCounter<3>::s_SAMPLES_TO_TOGGLE; i++)
+        counter.update(0x1);
+    // A glitch back to the debounced state starts the count again
+    counter.update(0x0);
+    for (uint32_t i{1}; i < VerticalCounter<3>::s_SAMPLES_TO_TOGGLE; i++)
+        TEST_ASSERT_EQUAL_HEX32(0, counter.update(0x1));
+    TEST_ASSERT_EQUAL_HEX32(0x1, counter.update(0x1));
+}
+
+// Every input against a scalar counter fed with the same random samples
+static void test_matches_scalar_model()
+{
+    static constexpr uint8_t BITS{2};
+    VerticalCounter<BITS> counter;
+    counter.reset(0);
+    uint32_t state{0};
+    uint8_t counts[32]{};
+    uint32_t raw{0};
+    std::minstd_rand random{7};
+    for (uint32_t sample{0}; sample < 20000; sample++)
+    {
+        // Inputs that change rarely, so most of them get to toggle
+        if (!(random() % 4))
+            raw ^= 1U << (random() % 32);
+        uint32_t toggled{0};
+        for (uint8_t bit{0}; bit < 32; bit++)
+        {
+            const uint32_t mask{1U << bit};
+            if ((raw & mask) == (state & mask))
+            {
+                counts[bit] = 0;
+                continue;
+            }
+            if (++counts[bit] == VerticalCounter<BITS>::s_SAMPLES_TO_TOGGLE)
+            {
+                counts[bit] = 0;
+                toggled |= mask;
+            }
+        }
+        state ^= toggled;
+        TEST_ASSERT_EQUAL_HEX32(toggled, counter.update(raw));
+        TEST_ASSERT_EQUAL_HEX32(state, counter.getState());
+    }
+}
+
+static void test_bank_interrupt_mask_is_bounded()
+{
+    BankDebouncer low(1UL << PIN_BANK, INPUT, 1000);
+    TEST_ASSERT_EQUAL_HEX32(1UL << PIN_BANK, low.getInterruptMask(PIN_BANK));
+    TEST_ASSERT_EQUAL_HEX32(0, low.getInterruptMask(32));
+    TEST_ASSERT_EQUAL_HEX32(0, low.getInterruptMask(255));
+    BankDebouncer high(0x3, INPUT, 1000, 0, BankDebouncer::Bank::Gpio32To39, 1);
+    TEST_ASSERT_EQUAL_HEX32(0x2, high.getInterruptMask(33));
+    TEST_ASSERT_EQUAL_HEX32(0, high.getInterruptMask(PIN_BANK));
+    TEST_ASSERT_TRUE(high.getState(PIN_BANK) == PinState::Unknown);
+}
+
+static void test_bank_debounces_the_pin()
+{
+    HostGpio::setLevel(PIN_BANK, false);
+    BankDebouncer bank(1UL << PIN_BANK, INPUT, 1000);
+    vTaskDelay(pdMS_TO_TICKS(20));
+    TEST_ASSERT_TRUE(bank.getState(PIN_BANK) == PinState::Low);
+    // The first sample records the initial state
+    TEST_ASSERT_TRUE(bank.receiveInterrupt(PIN_BANK, 0) == PinState::Low);
+    HostGpio::setLevel(PIN_BANK, true);
+    TEST_ASSERT_TRUE(bank.receiveInterrupt(PIN_BANK, pdMS_TO_TICKS(1000)) == PinState::High);
+    TEST_ASSERT_TRUE(bank.getState(PIN_BANK) == PinState::High);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_toggles_after_samples_to_toggle);
+    RUN_TEST(test_equal_sample_resets_the_count);
+    RUN_TEST(test_matches_scalar_model);
+    RUN_TEST(test_bank_interrupt_mask_is_bounded);
+    RUN_TEST(test_bank_debounces_the_pin);
+    return UNITY_END();
+}
@@ -0,0 +1,111 @@
+/**
+ * Decoder of the binary output of the DeferredLog.
+ * Reads a capture of the serial port (a file, or the standard input) and prints every record
+ * as "[L] text", formatted with the format of its call site. The site frames that describe
+ * the call sites are sent by the device before their first record, so the capture must
+ * include them (i.e. start it before the device, or reset the device once it is running).
+ * Bytes outside the frames (e.g. the boot messages of the ESP32) are printed as they come.
+ *
+ * Usage: logDecoder [capture]
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ArduinoToolkit/Core/LogFormat.h>
+
+using namespace AT::LogFormat;
+
+namespace
+{
+
+    struct Site
+    {
+        uint8_t level;
+        std::string format;
+    };
+
+    std::unordered_map<uint16_t, Site> s_sites;
+
+    bool readBytes(FILE *const in, void *const data, const size_t size)
+    {
+        return std::fread(data, 1, size, in) == size;
+    }
+
+    bool decodeSite(FILE *const in)
+    {
+        uint8_t fields[5];
+        if (!readBytes(in, fields, sizeof(fields)))
+            return false;
+        const uint16_t id{static_cast<uint16_t>(fields[0] | fields[1] << 8)};
+        std::string format(fields[3] | fields[4] << 8, '\0');
+        if (!readBytes(in, format.data(), format.size()))
+            return false;
+        s_sites[id] = {fields[2], std::move(format)};
+        return true;
+    }
+
+    bool decodeRecord(FILE *const in)
+    {
+        uint32_t words[UINT8_MAX];
+        if (!readBytes(in, &words[0], sizeof(uint32_t)))
+            return false;
+        const size_t count{headerWords(words[0])};
+        if (count < 2 || !readBytes(in, &words[1], (count - 1) * sizeof(uint32_t)))
+            return false;
+        const auto site{s_sites.find(headerId(words[0]))};
+        if (site == s_sites.end())
+        {
+            std::printf("[?] Record of unknown site %u\n", headerId(words[0]));
+            return true;
+        }
+        char text[1024];
+        formatRecord(text, sizeof(text), site->second.format.c_str(), words, count);
+        std::printf("[%c] %s\n", levelLetter(site->second.level), text);
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    FILE *const in{argc > 1 ? std::fopen(argv[1], "rb") : stdin};
+    if (!in)
+    {
+        std::fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+    int byte;
+    while ((byte = std::fgetc(in)) != EOF)
+    {
+        if (byte != s_FRAME_SYNC)
+        {
+            std::putchar(byte);
+            continue;
+        }
+        const int kind{std::fgetc(in)};
+        bool complete{true};
+        if (kind == s_FRAME_SITE)
+            complete = decodeSite(in);
+        else if (kind == s_FRAME_RECORD)
+            complete = decodeRecord(in);
+        else
+        {
+            // Not a frame, the sync byte was part of the text
+            std::putchar(byte);
+            if (kind != EOF)
+                std::putchar(kind);
+        }
+        if (!complete)
+        {
+            std::fprintf(stderr, "Truncated frame at the end of the capture\n");
+            break;
+        }
+    }
+    if (in != stdin)
+        std::fclose(in);
+    return 0;
+}